@@ -442,6 +442,17 @@
     #define CFG_RETAIN_RAM_2_BLOCK
 #endif
 
+/****************************************************************************************************************/
+/* Hibernation (CFG_HIBERNATION in da1458x_config_basic.h). Every RAM block stays powered and address 0 is      */
+/* remapped to RAM1, where the image was loaded, so the wake-up reset runs the image in place instead of        */
+/* booting again from flash. Powering the RAM blocks down lowers the hibernation current but makes every        */
+/* wake-up a full boot; then remap address 0 to ROM.                                                            */
+/****************************************************************************************************************/
+#define CFG_HIBERNATION_RAM1        PD_SYS_DOWN_RAM_ON
+#define CFG_HIBERNATION_RAM2        PD_SYS_DOWN_RAM_ON
+#define CFG_HIBERNATION_RAM3        PD_SYS_DOWN_RAM_ON
+#define CFG_HIBERNATION_REMAP       REMAP_ADDR0_TO_RAM1
+
 /****************************************************************************************************************/
 /* Code location selection.                                                                                     */
 /*     - CFG_CODE_LOCATION_EXT: Code is loaded from SPI flash / I2C EEPROM / UART                               */
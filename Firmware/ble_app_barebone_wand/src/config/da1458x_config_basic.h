@@ -77,6 +77,48 @@
     #define CFG_PRINTF_UART2
 #endif
 
+/****************************************************************************************************************/
+/* Binary event trace. If CFG_TRACE is defined, application events are stored as fixed-size binary records in a */
+/* RAM ring buffer and written to UART2 while the system is idle, instead of being formatted by arch_printf.    */
+/* Decode the UART2 output with Firmware/host/trace_decode. For development builds only: UART2 stays powered    */
+/* and the records are written out, blocking, before every sleep.                                               */
+/****************************************************************************************************************/
+#undef CFG_TRACE
+
+/****************************************************************************************************************/
+/* Cycle profiler. If CFG_PROFILER is defined in a development build (CFG_DEVELOPMENT_DEBUG), the hot paths     */
+/* are timed with SysTick and the statistics are printed before the wand goes to sleep. Needs CFG_PRINTF.       */
+/****************************************************************************************************************/
+#undef CFG_PROFILER
+
+/****************************************************************************************************************/
+/* Gesture latency statistics. If CFG_GESTURE_LATENCY is defined, the time from motion onset to detection,      */
+/* payload write and advertising data update is collected in histograms kept in retention memory. They are      */
+/* written to the trace before the wand goes to sleep. Needs CFG_TRACE.                                         */
+/****************************************************************************************************************/
+#undef CFG_GESTURE_LATENCY
+
+/****************************************************************************************************************/
+/* Energy counters. If CFG_ENERGY_COUNTERS is defined, awake and sleep time, I2C traffic, advertising time and  */
+/* motor on-time are counted and written to the trace before the wand goes to sleep, for the host energy        */
+/* model in Firmware/host/energy_model. Needs CFG_TRACE.                                                        */
+/****************************************************************************************************************/
+#undef CFG_ENERGY_COUNTERS
+
+/****************************************************************************************************************/
+/* Accelerometer capture. If CFG_CAPTURE is defined, every raw sample is timestamped, delta and varint encoded  */
+/* and streamed to UART2 in checksummed chunks, together with the gestures the firmware recognised. Convert the */
+/* UART2 output into a corpus file with Firmware/host/capture.                                                  */
+/****************************************************************************************************************/
+#undef CFG_CAPTURE
+
+/****************************************************************************************************************/
+/* Raw sample streaming. If CFG_STREAM is defined, the accelerometer runs at 400Hz from its FIFO and every      */
+/* sample is sent on UART2 at 1Mbaud in CRC-checked frames, by DMA on the DA14531. UART2 is taken over:         */
+/* undefine CFG_PRINTF, CFG_TRACE and CFG_CAPTURE. Decode with Firmware/host/stream_decode.                     */
+/****************************************************************************************************************/
+#undef CFG_STREAM
+
 /****************************************************************************************************************/
 /* UART1 Driver Implementation. If CFG_UART1_SDK is defined, UART1 ROM driver will be overriden and UART SDK    */
 /* driver will be used, else ROM driver will be used for UART1 module.                                          */
@@ -166,6 +208,58 @@
     #define CFG_PRINTF_UART2
 #endif
 
+/****************************************************************************************************************/
+/* Binary event trace. If CFG_TRACE is defined, application events are stored as fixed-size binary records in a */
+/* RAM ring buffer and written to UART2 while the system is idle, instead of being formatted by arch_printf.    */
+/* Decode the UART2 output with Firmware/host/trace_decode. For development builds only: UART2 stays powered    */
+/* and the records are written out, blocking, before every sleep.                                               */
+/****************************************************************************************************************/
+#undef CFG_TRACE
+
+/****************************************************************************************************************/
+/* Cycle profiler. If CFG_PROFILER is defined in a development build (CFG_DEVELOPMENT_DEBUG), the hot paths     */
+/* are timed with SysTick and the statistics are printed before the wand goes to sleep. Needs CFG_PRINTF.       */
+/****************************************************************************************************************/
+#undef CFG_PROFILER
+
+/****************************************************************************************************************/
+/* Gesture latency statistics. If CFG_GESTURE_LATENCY is defined, the time from motion onset to detection,      */
+/* payload write and advertising data update is collected in histograms kept in retention memory. They are      */
+/* written to the trace before the wand goes to sleep. Needs CFG_TRACE.                                         */
+/****************************************************************************************************************/
+#undef CFG_GESTURE_LATENCY
+
+/****************************************************************************************************************/
+/* Energy counters. If CFG_ENERGY_COUNTERS is defined, awake and sleep time, I2C traffic, advertising time and  */
+/* motor on-time are counted and written to the trace before the wand goes to sleep, for the host energy        */
+/* model in Firmware/host/energy_model. Needs CFG_TRACE.                                                        */
+/****************************************************************************************************************/
+#undef CFG_ENERGY_COUNTERS
+
+/****************************************************************************************************************/
+/* Accelerometer capture. If CFG_CAPTURE is defined, every raw sample is timestamped, delta and varint encoded  */
+/* and streamed to UART2 in checksummed chunks, together with the gestures the firmware recognised. Convert the */
+/* UART2 output into a corpus file with Firmware/host/capture.                                                  */
+/****************************************************************************************************************/
+#undef CFG_CAPTURE
+
+/****************************************************************************************************************/
+/* Raw sample streaming. If CFG_STREAM is defined, the accelerometer runs at 400Hz from its FIFO and every      */
+/* sample is sent on UART2 at 1Mbaud in CRC-checked frames, by DMA on the DA14531. UART2 is taken over:         */
+/* undefine CFG_PRINTF, CFG_TRACE and CFG_CAPTURE. Decode with Firmware/host/stream_decode.                     */
+/****************************************************************************************************************/
+#undef CFG_STREAM
+
+/****************************************************************************************************************/
+/* Hibernation. If CFG_HIBERNATION is defined, a wand left asleep for APP_HIBERNATE_TO moves from extended      */
+/* sleep to hibernation, at the next periodic wake-up of the BLE core                                           */
+/* (CFG_MAX_SLEEP_DURATION_EXTERNAL_WAKEUP_MS in da1458x_config_advanced.h). Only the accelerometer interrupt   */
+/* wakes it from there, through a reset that starts from the retained RAM image (see                            */
+/* da1458x_config_advanced.h). Needs GPIO_INT_PIN on P0_1 to P0_5, the only hibernation wake-up pins, see       */
+/* user_periph_setup.h.                                                                                         */
+/****************************************************************************************************************/
+#undef CFG_HIBERNATION
+
 /****************************************************************************************************************/
 /* UART1 Driver Implementation. If CFG_UART1_SDK is defined, UART1 ROM driver will be overriden and UART SDK    */
 /* driver will be used, else ROM driver will be used for UART1 module.                                          */
@@ -188,7 +282,11 @@
 /*     - I2C                                                                                                    */
 /*     - ADC                                                                                                    */
 /****************************************************************************************************************/
+#if defined (CFG_STREAM)
+#define CFG_UART_DMA_SUPPORT
+#else
 #undef CFG_UART_DMA_SUPPORT
+#endif
 #undef CFG_SPI_DMA_SUPPORT
 #undef CFG_I2C_DMA_SUPPORT
 #undef CFG_ADC_DMA_SUPPORT
@@ -108,12 +108,12 @@ static const struct arch_main_loop_callbacks user_app_main_loop_callbacks = {
     // The user has to take into account the watchdog timer handling (keep it running,
     // freeze it, reload it, resume it, etc), when the app_on_system_powered() is being
     // called and may potentially affect the main loop.
-    .app_on_system_powered  = NULL,
+    .app_on_system_powered  = user_app_on_system_powered,
 
-    .app_before_sleep       = NULL,
-    .app_validate_sleep     = NULL,
-    .app_going_to_sleep     = NULL,
-    .app_resume_from_sleep  = NULL,
+    .app_before_sleep       = user_app_before_sleep,
+    .app_validate_sleep     = user_app_validate_sleep,
+    .app_going_to_sleep     = user_app_sleep_enter,
+    .app_resume_from_sleep  = user_app_sleep_exit,
 };
 
 
@@ -75,9 +75,18 @@
  * - ARCH_EXT_SLEEP_ON
  * - ARCH_EXT_SLEEP_OTP_COPY_ON
  *
+ * The wand sleeps between samples too: the
+ * sample tick and the BLE events wake it,
+ * and only the button once it has gone to
+ * sleep (arch_ble_ext_wakeup_on).
+ *
+ * The current this saves is modelled by
+ * Firmware/host/energy_model from assumed
+ * datasheet currents; it has not been
+ * measured on a board yet.
  ******************************************
  */
-static const sleep_state_t app_default_sleep_mode = ARCH_SLEEP_OFF;
+static const sleep_state_t app_default_sleep_mode = ARCH_EXT_SLEEP_ON;
 
 /*
  ****************************************************************************************
@@ -0,0 +1,148 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_gesture_config.h
+ *
+ * @brief Gesture pipeline configuration file.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _USER_GESTURE_CONFIG_H_
+#define _USER_GESTURE_CONFIG_H_
+
+/**
+ ****************************************************************************************
+ * @addtogroup APP
+ * @ingroup
+ *
+ * @brief Gesture pipeline configuration. Everything is resolved by the preprocessor:
+ *        a disabled stage leaves no code and no RAM behind.
+ *
+ * @{
+ ****************************************************************************************
+ */
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/***************************************************************************************/
+/* Pipeline stages. Every stage runs once per accelerometer sample, in this order.     */
+/*                                                                                     */
+/* (1) - The stage is built and runs.                                                  */
+/*                                                                                     */
+/* (0) - The stage is compiled out.                                                    */
+/*                                                                                     */
+/* CFG_GESTURE_STAGE_DIRECTION: left/right/up/down swings from the averaged X/Y axes   */
+/* CFG_GESTURE_STAGE_SHAKE:     sustained 2-8Hz oscillation (Goertzel filters)         */
+/* CFG_GESTURE_STAGE_TWIST:     roll of the gravity vector about the long axis         */
+/* CFG_GESTURE_STAGE_CIRCLE:    full turn of the X/Y linear acceleration phase         */
+/***************************************************************************************/
+#if defined (__DA14531__)
+#define CFG_GESTURE_STAGE_DIRECTION         (1)
+#define CFG_GESTURE_STAGE_SHAKE             (1)
+#define CFG_GESTURE_STAGE_TWIST             (1)
+#define CFG_GESTURE_STAGE_CIRCLE            (1)
+#else
+#define CFG_GESTURE_STAGE_DIRECTION         (1)
+#define CFG_GESTURE_STAGE_SHAKE             (1)
+#define CFG_GESTURE_STAGE_TWIST             (1)
+#define CFG_GESTURE_STAGE_CIRCLE            (1)
+#endif
+
+/***************************************************************************************/
+/* Sampling and gesture timing                                                         */
+/***************************************************************************************/
+/* Rate of the sample tick (APP_ADV_DATA_UPDATE_TO)                                    */
+#define CFG_GESTURE_SAMPLE_RATE_HZ          (100)
+
+/* Lowest pipeline rate the battery levels may ask for, as a shift of the sample tick. */
+/* The stages scale their windows to it: 100Hz >> 2 = 25Hz                             */
+#define CFG_GESTURE_MAX_RATE_SHIFT          (2)
+
+/* Time after a gesture during which direction and twist gestures are ignored          */
+#define CFG_GESTURE_LOCK_TO                 (50)    // 50*10ms = 0.5sec
+
+/* Time after the last gesture before the payload is cleared and the wand goes to sleep*/
+#define CFG_GESTURE_RESET_DISPLAY_TO        (300)   // 300*10ms = 3sec
+
+/***************************************************************************************/
+/* Stage parameters. The DA14585/586 have twice the RAM of the DA14531 and use longer  */
+/* windows and more Goertzel bins.                                                     */
+/***************************************************************************************/
+#if defined (__DA14531__)
+/* Direction: samples in the decaying average window (at most 257)                     */
+#define CFG_GESTURE_DIRECTION_WINDOW        (16)
+/* Shake: Goertzel block length as a power of two and the tracked frequencies, 1-12Hz  */
+#define CFG_GESTURE_SHAKE_BLOCK_SHIFT       (5)     // 32*10ms = 0.32sec
+#define CFG_GESTURE_SHAKE_NUM_BINS          (3)
+#define CFG_GESTURE_SHAKE_BIN_FREQS_HZ      {3, 5, 7}
+/* Twist: roll window as a power of two                                                */
+#define CFG_GESTURE_TWIST_WINDOW_SHIFT      (5)     // 32*10ms = 0.32sec
+#else
+#define CFG_GESTURE_DIRECTION_WINDOW        (16)
+#define CFG_GESTURE_SHAKE_BLOCK_SHIFT       (5)     // 32*10ms = 0.32sec
+#define CFG_GESTURE_SHAKE_NUM_BINS          (4)
+#define CFG_GESTURE_SHAKE_BIN_FREQS_HZ      {3, 4, 6, 8}
+#define CFG_GESTURE_TWIST_WINDOW_SHIFT      (6)     // 64*10ms = 0.64sec
+#endif
+
+/* Direction: averaged X/Y magnitude in counts above which a swing is a gesture        */
+#define CFG_GESTURE_DIRECTION_THRESHOLD     (15)
+
+/* Twist: roll change within the window reported as a twist                            */
+#define CFG_GESTURE_TWIST_ANGLE_DEG         (60)
+
+/* Circle: time allowed to complete a circle, in samples                               */
+#define CFG_GESTURE_CIRCLE_MAX_SAMPLES      (200)   // 200*10ms = 2sec
+
+/***************************************************************************************/
+/* Gesture alphabet. X(name, code): the code is the byte stored in the manufacturer    */
+/* specific data, an ASCII letter so it reads in a scanner app.                        */
+/***************************************************************************************/
+#define CFG_GESTURE_ALPHABET(X)         \
+    X(LEFT,         0x4C)   /* 'L' */   \
+    X(RIGHT,        0x52)   /* 'R' */   \
+    X(DOWN,         0x44)   /* 'D' */   \
+    X(UP,           0x55)   /* 'U' */   \
+    X(SHAKE,        0x53)   /* 'S' */   \
+    X(TWIST_CW,     0x54)   /* 'T' */   \
+    X(TWIST_CCW,    0x74)   /* 't' */   \
+    X(CIRCLE_CW,    0x43)   /* 'C' */   \
+    X(CIRCLE_ACW,   0x41)   /* 'A' */
+
+/* Shared building blocks, built when a stage needs them                               */
+#define CFG_GESTURE_USES_MOTION             (CFG_GESTURE_STAGE_SHAKE || CFG_GESTURE_STAGE_TWIST || CFG_GESTURE_STAGE_CIRCLE)
+#define CFG_GESTURE_USES_ANGLE              (CFG_GESTURE_STAGE_TWIST || CFG_GESTURE_STAGE_CIRCLE)
+
+/*
+ * CONFIGURATION CHECKS
+ ****************************************************************************************
+ */
+
+#if (CFG_GESTURE_DIRECTION_WINDOW < 1) || (CFG_GESTURE_DIRECTION_WINDOW > 257)
+    #error "CFG_GESTURE_DIRECTION_WINDOW must be 1..257 (16-bit packed lane sums)"
+#endif
+
+#if (CFG_GESTURE_DIRECTION_WINDOW % (1 << CFG_GESTURE_MAX_RATE_SHIFT)) || (CFG_GESTURE_SHAKE_BLOCK_SHIFT < CFG_GESTURE_MAX_RATE_SHIFT) || \
+    (CFG_GESTURE_TWIST_WINDOW_SHIFT < CFG_GESTURE_MAX_RATE_SHIFT)
+    #error "the direction window, shake block and twist window must divide by 1 << CFG_GESTURE_MAX_RATE_SHIFT"
+#endif
+
+#if (CFG_GESTURE_SHAKE_BLOCK_SHIFT > 6)
+    #error "CFG_GESTURE_SHAKE_BLOCK_SHIFT above 6 overflows the Goertzel power"
+#endif
+
+#if (CFG_GESTURE_CIRCLE_MAX_SAMPLES > 254)
+    #error "CFG_GESTURE_CIRCLE_MAX_SAMPLES above 254 overflows the uint8_t sample counter"
+#endif
+
+#if (CFG_GESTURE_TWIST_WINDOW_SHIFT > 7)
+    #error "CFG_GESTURE_TWIST_WINDOW_SHIFT above 7 overflows the uint8_t ring index"
+#endif
+
+/// @} APP
+
+#endif // _USER_GESTURE_CONFIG_H_
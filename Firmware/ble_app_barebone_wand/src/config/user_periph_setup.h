@@ -55,8 +55,12 @@
     #define I2C_SCL_PORT           GPIO_PORT_0
     #define I2C_SCL_PIN            GPIO_PIN_7
 		
+    // Accelerometer interrupt; with CFG_HIBERNATION it must be one of P0_1 to P0_5, a
+    // board wired for it sets the pin in the compiler options
     #define GPIO_INT_PORT           GPIO_PORT_0
+#if !defined (GPIO_INT_PIN)
     #define GPIO_INT_PIN            GPIO_PIN_9
+#endif
 /****************************************************************************************/
 /* UART2 configuration to use with arch_console print messages                          */
 /****************************************************************************************/
@@ -70,15 +74,42 @@
 #endif
 
 // Define UART2 Settings
+#if defined (CFG_STREAM)
+#define UART2_BAUDRATE              UART_BAUDRATE_1000000
+#else
 #define UART2_BAUDRATE              UART_BAUDRATE_115200
+#endif
 #define UART2_DATABITS              UART_DATABITS_8
 #define UART2_PARITY                UART_PARITY_NONE
 #define UART2_STOPBITS              UART_STOPBITS_1
 #define UART2_AFCE                  UART_AFCE_DIS
 #define UART2_FIFO                  UART_FIFO_EN
+#if defined (CFG_STREAM)
+// Refill the FIFO when it is half empty, not when it has run dry
+#define UART2_TX_FIFO_LEVEL         UART_TX_FIFO_LEVEL_3
+#else
 #define UART2_TX_FIFO_LEVEL         UART_TX_FIFO_LEVEL_0
+#endif
 #define UART2_RX_FIFO_LEVEL         UART_RX_FIFO_LEVEL_0
 
+/****************************************************************************************/
+/* I2C configuration of the accelerometer bus                                           */
+/****************************************************************************************/
+// Fast mode, 400kHz. The controller counts the 16MHz peripheral clock and adds 8 cycles
+// to the high count and 1 to the low count: low 22 cycles (1.375us, 1.3us at least),
+// high 14 cycles (0.875us, 0.6us at least), which leaves 4 cycles (250ns) of the 2.5us
+// period to the rise time of SCL
+#define I2C_XL_SPEED                I2C_SPEED_FAST
+#define I2C_XL_FS_SCL_HCNT          (6)
+#define I2C_XL_FS_SCL_LCNT          (21)
+
+// A sample is one 6-byte burst. The receive level raises RX_FULL once the whole burst is
+// in, the controller caps it to its FIFO depth; the transmit level asks for more read
+// commands once half the burst has gone out
+#define I2C_XL_BURST_BYTES          (6)
+#define I2C_XL_TX_FIFO_LEVEL        (I2C_XL_BURST_BYTES / 2)
+#define I2C_XL_RX_FIFO_LEVEL        (I2C_XL_BURST_BYTES - 1)
+
 /****************************************************************************************/
 /* SPI configuration                                                                    */
 /****************************************************************************************/
@@ -41,7 +41,7 @@ void GPIO_reservations(void)
     RESERVE_GPIO(DESCRIPTIVE_NAME, GPIO_PORT_0, GPIO_PIN_1, PID_GPIO);
 */
 
-#if defined (CFG_PRINTF_UART2)
+#if defined (CFG_PRINTF_UART2) || defined (CFG_TRACE) || defined (CFG_CAPTURE) || defined (CFG_STREAM)
     RESERVE_GPIO(UART2_TX, UART2_TX_PORT, UART2_TX_PIN, PID_UART2_TX);
 #endif
 	
@@ -79,7 +79,7 @@ void set_pad_functions(void)
 		GPIO_ConfigurePin(I2C_SCL_PORT, I2C_SCL_PIN, INPUT, PID_I2C_SCL, false);  
 		GPIO_ConfigurePin(I2C_SDA_PORT, I2C_SDA_PIN, INPUT, PID_I2C_SDA, false);
 
-#if defined (CFG_PRINTF_UART2)
+#if defined (CFG_PRINTF_UART2) || defined (CFG_TRACE) || defined (CFG_CAPTURE) || defined (CFG_STREAM)
     // Configure UART2 TX Pad
     GPIO_ConfigurePin(UART2_TX_PORT, UART2_TX_PIN, OUTPUT, PID_UART2_TX, false);
 #endif
@@ -89,20 +89,20 @@ void set_pad_functions(void)
 static const i2c_cfg_t i2c_cfg = {
   .clock_cfg.ss_hcnt = I2C_SS_SCL_HCNT_REG_RESET,
   .clock_cfg.ss_lcnt = I2C_SS_SCL_LCNT_REG_RESET,
-  .clock_cfg.fs_hcnt = I2C_FS_SCL_HCNT_REG_RESET,
-  .clock_cfg.fs_lcnt = I2C_FS_SCL_LCNT_REG_RESET,
+  .clock_cfg.fs_hcnt = I2C_XL_FS_SCL_HCNT,
+  .clock_cfg.fs_lcnt = I2C_XL_FS_SCL_LCNT,
   .restart_en = I2C_RESTART_ENABLE,
-  .speed = I2C_SPEED_STANDARD,
+  .speed = I2C_XL_SPEED,
   .mode = I2C_MODE_MASTER,
   .addr_mode = I2C_ADDRESSING_7B,
   /* Device address specified when read/write takes place allowing 
      multiple devices to be present on the same I2C bus */
   .address = 0,
-  .tx_fifo_level = 1,
-  .rx_fifo_level = 1,
+  .tx_fifo_level = I2C_XL_TX_FIFO_LEVEL,
+  .rx_fifo_level = I2C_XL_RX_FIFO_LEVEL,
 };
 
-#if defined (CFG_PRINTF_UART2)
+#if defined (CFG_PRINTF_UART2) || defined (CFG_TRACE) || defined (CFG_CAPTURE) || defined (CFG_STREAM)
 // Configuration struct for UART2
 static const uart_cfg_t uart_cfg = {
     .baud_rate = UART2_BAUDRATE,
@@ -114,6 +114,10 @@ static const uart_cfg_t uart_cfg = {
     .tx_fifo_tr_lvl = UART2_TX_FIFO_LEVEL,
     .rx_fifo_tr_lvl = UART2_RX_FIFO_LEVEL,
     .intr_priority = 2,
+#if defined (CFG_UART_DMA_SUPPORT)
+    .uart_dma_channel = UART_DMA_CHANNEL_01,
+    .uart_dma_priority = DMA_PRIO_0,
+#endif
 };
 #endif
 
@@ -133,7 +137,7 @@ void periph_init(void)
     patch_func();
 
     // Initialize peripherals
-#if defined (CFG_PRINTF_UART2)
+#if defined (CFG_PRINTF_UART2) || defined (CFG_TRACE) || defined (CFG_CAPTURE) || defined (CFG_STREAM)
     // Initialize UART2
     uart_initialize(UART2, &uart_cfg);
 #endif
@@ -145,4 +149,6 @@ void periph_init(void)
     GPIO_set_pad_latch_en(true);
 		
 		i2c_init(&i2c_cfg);
+		// A new bus session: the first transaction addresses the accelerometer again
+		i2c_XL_Session_Reset();
 }
@@ -0,0 +1,84 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_angle.c
+ *
+ * @brief Integer atan2 with a lookup table, returning binary angles.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "user_angle.h"
+#include "user_gesture_config.h"
+
+#if (CFG_GESTURE_USES_ANGLE)
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+// atan(i/32) in binary angle units for i = 0..32, i.e. 0 to 45 degrees
+static const uint8_t angleAtanLut[ANGLE_LUT_SIZE] =
+{
+	 0,  1,  3,  4,  5,  6,  8,  9, 10, 11, 12, 13, 15, 16, 17, 18,
+	19, 20, 21, 22, 23, 24, 25, 25, 26, 27, 28, 29, 29, 30, 31, 31,
+	32
+};
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+ /**
+ ****************************************************************************************
+ * @brief Angle of the vector (x,y), counter-clockwise from the positive x-axis
+ ****************************************************************************************
+ */
+uint8_t angle_atan2(int16_t y, int16_t x)
+{
+	int32_t xAbs = abs(x);
+	int32_t yAbs = abs(y);
+	uint8_t octantAngle;
+
+	if((xAbs == 0) && (yAbs == 0))
+	{
+		return 0;
+	}
+
+	// Reduce to the first octant so one division indexes the table
+	if(xAbs >= yAbs)
+	{
+		octantAngle = angleAtanLut[((yAbs << ANGLE_LUT_SHIFT) + (xAbs >> 1)) / xAbs];
+	}
+	else
+	{
+		octantAngle = ANGLE_QUARTER_TURN - angleAtanLut[((xAbs << ANGLE_LUT_SHIFT) + (yAbs >> 1)) / yAbs];
+	}
+
+	if(x >= 0)
+	{
+		return (uint8_t)((y >= 0) ? octantAngle : (ANGLE_FULL_TURN - octantAngle));
+	}
+	return (uint8_t)((y >= 0) ? (ANGLE_HALF_TURN - octantAngle) : (ANGLE_HALF_TURN + octantAngle));
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Signed shortest rotation from one angle to another
+ ****************************************************************************************
+ */
+int8_t angle_delta(uint8_t from, uint8_t to)
+{
+	return (int8_t)(uint8_t)(to - from);
+}
+
+#endif // CFG_GESTURE_USES_ANGLE
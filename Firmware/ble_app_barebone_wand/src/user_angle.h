@@ -0,0 +1,60 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_angle.h
+ *
+ * @brief Integer atan2 with a lookup table, returning binary angles.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _USER_ANGLE_H_
+#define _USER_ANGLE_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include <stdint.h>
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/* Binary angle units: a full turn is 256, so differences wrap naturally in an int8_t        */
+#define ANGLE_FULL_TURN                     (256)
+#define ANGLE_HALF_TURN                     (128)
+#define ANGLE_QUARTER_TURN                  (64)
+#define ANGLE_DEG_TO_BRAD(deg)              (((deg) * ANGLE_FULL_TURN + 180) / 360)
+
+/* Resolution of the tangent ratio used to index the lookup table                            */
+#define ANGLE_LUT_SHIFT                     (5)
+#define ANGLE_LUT_SIZE                      ((1 << ANGLE_LUT_SHIFT) + 1)
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+ /**
+ ****************************************************************************************
+ * @brief Angle of the vector (x,y), counter-clockwise from the positive x-axis
+ * @param[in] y  y component
+ * @param[in] x  x component
+ * @return angle in binary angle units (0..255), 0 for the zero vector
+ ****************************************************************************************
+ */
+uint8_t angle_atan2(int16_t y, int16_t x);
+
+ /**
+ ****************************************************************************************
+ * @brief Signed shortest rotation from one angle to another
+ * @param[in] from  start angle in binary angle units
+ * @param[in] to    end angle in binary angle units
+ * @return rotation in binary angle units (-128..127), positive is counter-clockwise
+ ****************************************************************************************
+ */
+int8_t angle_delta(uint8_t from, uint8_t to);
+
+#endif // _USER_ANGLE_H_
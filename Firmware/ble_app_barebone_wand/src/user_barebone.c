@@ -35,11 +35,32 @@
 #include "user_periph_setup.h"
 #include "arch_system.h"
 #include "user_xl_driver.h"
+#include "user_gesture.h"
+#include "user_motion.h"
+#include "user_direction.h"
+#include "user_shake.h"
+#include "user_twist.h"
+#include "user_circle.h"
+#include "user_swar.h"
+#include "user_trace.h"
+#include "user_profiler.h"
+#include "user_latency.h"
+#include "user_energy.h"
+#include "user_capture.h"
+#include "user_stream.h"
+#include "user_lifecycle.h"
+#include "user_timer_wheel.h"
+#include "user_work.h"
+#include "user_haptic.h"
+#include "user_battery.h"
 #include "arch_console.h"
 #include "math.h"
 #include "stdlib.h"
 #include "user_wakeup.h"
 #include "wkupct_quadec.h" 
+#if defined (CFG_HIBERNATION)
+#include "arch_hibernation.h"
+#endif
 
 
 /*
@@ -55,22 +76,8 @@ const uint8_t DEBOUNCE_MS	= 30;	// In ms.
 const bool INPUT_LEVEL = true;	// Input will generate IRQ if input is low.
 const bool EDGE_LEVEL = true;	// Wait for key release after interrupt was set.
 
-uint8_t xlDataArrayCounter;
-volatile int8_t xDataArray[XL_AVERAGE_NUM_SAMPLES];
-volatile int8_t yDataArray[XL_AVERAGE_NUM_SAMPLES];
-volatile int8_t zDataArray[XL_AVERAGE_NUM_SAMPLES];
-
 bool buttonActive = false;
 
-bool gestureLockedOut = false;
-
-bool gestureDisplayReset = false;
-
-bool continueUpdatingAdvertisementData = true;
-
-bool deviceWokeUpStartCountdownToSleep = true;
-
-volatile uint8_t gestureCounter = 0;
  
 // Interrupt function declarations
 void systick_isr(void);
@@ -97,69 +104,57 @@ bool three_second_push = 0;
 
 void LED_Blink(void);
 
-// Manufacturer Specific Data ADV structure type
-struct mnf_specific_data_ad_structure
-{
-    uint8_t ad_structure_size;
-    uint8_t ad_structure_type;
-    //uint8_t company_id[APP_AD_MSD_COMPANY_ID_LEN];
-    uint8_t proprietary_data[APP_AD_MSD_DATA_LEN];
-};
-
 /*
  * GLOBAL VARIABLE DEFINITIONS
  ****************************************************************************************
  */
 
-uint8_t app_connection_idx                      __SECTION_ZERO("retention_mem_area0"); //@RETENTION MEMORY
-timer_hnd app_adv_data_update_timer_used        __SECTION_ZERO("retention_mem_area0"); //@RETENTION MEMORY
-timer_hnd app_param_update_request_timer_used   __SECTION_ZERO("retention_mem_area0"); //@RETENTION MEMORY
-timer_hnd app_gesture_direction_timer_used      __SECTION_ZERO("retention_mem_area0"); //@RETENTION MEMORY
-timer_hnd app_gesture_display_reset_timer_used  __SECTION_ZERO("retention_mem_area0"); //@RETENTION MEMORY
-timer_hnd app_motor_on_timer_used  							__SECTION_ZERO("retention_mem_area0"); //@RETENTION MEMORY
-
-// Retained variables
-struct mnf_specific_data_ad_structure mnf_data  __SECTION_ZERO("retention_mem_area0"); //@RETENTION MEMORY
-// Index of manufacturer data in advertising data or scan response data (when MSB is 1)
-uint8_t mnf_data_index                          __SECTION_ZERO("retention_mem_area0"); //@RETENTION MEMORY
-uint8_t stored_adv_data_len                     __SECTION_ZERO("retention_mem_area0"); //@RETENTION MEMORY
-uint8_t stored_scan_rsp_data_len                __SECTION_ZERO("retention_mem_area0"); //@RETENTION MEMORY
-uint8_t stored_adv_data[ADV_DATA_LEN]           __SECTION_ZERO("retention_mem_area0"); //@RETENTION MEMORY
-uint8_t stored_scan_rsp_data[SCAN_RSP_DATA_LEN] __SECTION_ZERO("retention_mem_area0"); //@RETENTION MEMORY
+// Everything the application keeps across sleep, see struct app_retained
+struct app_retained appRetained                 __SECTION_ZERO("retention_mem_area0"); //@RETENTION MEMORY
+
+typedef char app_retained_size[(sizeof(struct app_retained) == APP_RETAINED_SIZE) ? 1 : -1];
+
+// Every module keeps its retained state in one struct. Pointers are 4 bytes on the target;
+// a host build with wider ones lays the structs out differently and skips the sum
+#define APP_RETAINED_MODULES_SIZE           (APP_RETAINED_SIZE + XL_RETAINED_SIZE + GESTURE_RETAINED_SIZE + \
+	MOTION_RETAINED_SIZE + DIRECTION_RETAINED_SIZE + SHAKE_RETAINED_SIZE + TWIST_RETAINED_SIZE + \
+	CIRCLE_RETAINED_SIZE + LIFECYCLE_RETAINED_SIZE + TIMER_WHEEL_RETAINED_SIZE + WORK_RETAINED_SIZE + \
+	HAPTIC_RETAINED_SIZE + BATTERY_RETAINED_SIZE + ENERGY_RETAINED_SIZE + LATENCY_RETAINED_SIZE)
+
+typedef char app_retained_total_size[((APP_RETAINED_MODULES_SIZE == APP_RETAINED_TOTAL_SIZE) ||
+	(sizeof(void *) != 4)) ? 1 : -1];
 
 /*
  * FUNCTION DEFINITIONS
  ****************************************************************************************
 */
 
-
-
 /**
  ****************************************************************************************
- * @brief Gesture display reset timer callback function.
+ * @brief Store a recognised gesture in the next Manufacturer Specific Data slot.
+ *        The lifecycle handles the GESTURE event once the sample is done.
+ * @param[in] gestureCode APP_GESTURE_CODE_x value
  ****************************************************************************************
-*/
-static void gesture_display_reset_timer_cb()
+ */
+static void gesture_commit(uint8_t gestureCode)
 {
-	//arch_printf("RESETTING THE GESTURE COUNTER AND DISPLAY\n\r");	
-	for(int i=0; i<APP_AD_MSD_DATA_NUM_BYTES;i++)
+	TRACE_EVENT(TRACE_EVT_GESTURE, gestureCode, appRetained.gestureCounter);
+	LATENCY_COMMITTED();
+	capture_gesture(gestureCode);
+	appRetained.mnf_data.proprietary_data[appRetained.gestureCounter] = gestureCode;
+	//arch_printf("mnfData[%d] = [%d]\n\r",gestureCounter,mnf_data.proprietary_data[gestureCounter]);
+	if(appRetained.gestureCounter<(APP_AD_MSD_DATA_NUM_BYTES-1))
 	{
-		mnf_data.proprietary_data[i] = 0;
+		appRetained.gestureCounter++;
+		haptic_play(HAPTIC_GESTURE);
 	}
-	gestureCounter = 0;	
-	gestureDisplayReset = false;
-	arch_printf("gesture display reset called\n\r");
-	user_app_going_to_sleep();
-}
-
-/**
- ****************************************************************************************
- * @brief Lockout the gesture recognition timer callback function.
- ****************************************************************************************
-*/
-static void gesture_lockout_timer_cb()
-{
-	gestureLockedOut = false;
+	else
+	{
+		// The gesture completes the spell the display holds
+		appRetained.gestureCounter = 0;
+		haptic_play(HAPTIC_SPELL);
+	}
+	lifecycle_post(LIFECYCLE_EVT_GESTURE, gestureCode);
 }
 
 /**
@@ -169,190 +164,64 @@ static void gesture_lockout_timer_cb()
  */
 static void mnf_data_init()
 {
-    mnf_data.ad_structure_size = sizeof(struct mnf_specific_data_ad_structure ) - sizeof(uint8_t); // minus the size of the ad_structure_size field
-    mnf_data.ad_structure_type = GAP_AD_TYPE_MANU_SPECIFIC_DATA;
+    appRetained.mnf_data.ad_structure_size = sizeof(struct mnf_specific_data_ad_structure ) - sizeof(uint8_t); // minus the size of the ad_structure_size field
+    appRetained.mnf_data.ad_structure_type = GAP_AD_TYPE_MANU_SPECIFIC_DATA;
     //mnf_data.company_id[0] = (APP_AD_MSD_COMPANY_ID >> 16 )& 0xFF; // MSB
     //mnf_data.company_id[1] = (APP_AD_MSD_COMPANY_ID >> 8 )& 0xFF; // MSB
     //mnf_data.company_id[2] = APP_AD_MSD_COMPANY_ID & 0xFF; // LSB
-    mnf_data.proprietary_data[0] = 0;
-    mnf_data.proprietary_data[1] = 0;
-    mnf_data.proprietary_data[2] = 0;
+    appRetained.mnf_data.proprietary_data[0] = 0;
+    appRetained.mnf_data.proprietary_data[1] = 0;
+    appRetained.mnf_data.proprietary_data[2] = 0;
     //mnf_data.proprietary_data[3] = 0;
-		gestureCounter = 0;
-		xlDataArrayCounter = 0;
-				
+    appRetained.mnf_data.battery = 0;
+		appRetained.gestureCounter = 0;
+		gesture_pipeline_init(gesture_commit);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Measure the battery, apply the policy of its level and advertise the voltage.
+ *        The sample tick and advertising take the new policy when they restart.
+ ****************************************************************************************
+ */
+static void battery_update(void)
+{
+	if(battery_measure())
+	{
+		haptic_set_intensity(battery_current()->haptic);
+	}
+	appRetained.mnf_data.battery = battery_adv_level();
+}
+
+/**
+ ****************************************************************************************
+ * @brief Period of the sample tick at the battery level, in 10ms units. The stream
+ *        needs every FIFO sample and keeps the full rate.
+ ****************************************************************************************
+ */
+static uint32_t sample_tick_period(void)
+{
+#if defined (CFG_STREAM)
+	return APP_ADV_DATA_UPDATE_TO;
+#else
+	return APP_ADV_DATA_UPDATE_TO * battery_current()->reads;
+#endif
 }
 
 /**
  ****************************************************************************************
  * @brief Update Manufacturer Specific Data
+ * @param[in] xlSample  XL_NUM_AXES cell array (x,y,z)
+ * @param[in] ticks     sample ticks the sample stands for
  ****************************************************************************************
  */
-static void mnf_data_update()
+static void mnf_data_update(const int8_t *xlSample, uint8_t ticks)
 {
-    //uint16_t data;
-
-//    data = mnf_data.proprietary_data[0] | (mnf_data.proprietary_data[1] << 8);
-//    data += 1;
-//    mnf_data.proprietary_data[0] = data & 0xFF;
-//    mnf_data.proprietary_data[1] = (data >> 8) & 0xFF;
-
-//    if (data == 0xFFFF) {
-//         mnf_data.proprietary_data[0] = 0;
-//         mnf_data.proprietary_data[1] = 0;
-//    }
-		
-			//i2c_XL_Read_ALL();
-	
-//			mnf_data.proprietary_data[0] = (i2c_XL_Read_X()>>8); //0x86;
-//			mnf_data.proprietary_data[1] = (i2c_XL_Read_Y()>>8); //0x24;
-//			mnf_data.proprietary_data[2] = (i2c_XL_Read_Z()>>8); //0x28;
-	
-				int xData = 0;
-				int	yData = 0;
-				int zData = 0;
-
-				for(int imCounting=0; imCounting<XL_AVERAGE_NUM_SAMPLES;imCounting++)
-				{
-						xDataArray[imCounting] *= 0.9;
-						yDataArray[imCounting] *= 0.9;
-						zDataArray[imCounting] *= 0.9;
-				}
-
-				xDataArray[xlDataArrayCounter] = (i2c_XL_Read_X()>>8);
-				yDataArray[xlDataArrayCounter] = (i2c_XL_Read_Y()>>8);
-				zDataArray[xlDataArrayCounter] = (i2c_XL_Read_Z()>>8);
-
-				
-				for(int i=0; i<XL_AVERAGE_NUM_SAMPLES;i++)
-				{
-					xData += xDataArray[i];
-					yData += yDataArray[i];
-					zData += zDataArray[i];
-				}
-				
-				xData = (xData/XL_AVERAGE_NUM_SAMPLES);//(xData>>XL_AVERAGE_NUM_MULTIPLIER);
-				yData = (yData/XL_AVERAGE_NUM_SAMPLES);//(yData>>XL_AVERAGE_NUM_MULTIPLIER);
-				zData = (zData/XL_AVERAGE_NUM_SAMPLES);//(zData>>XL_AVERAGE_NUM_MULTIPLIER);
-						
-				//arch_printf("x:%d, y:%d, z:%d\n\r",xData,yData,zData);
-				//arch_printf("x:%d, y:%d\n\r",xData,yData);
-				
-				if(xlDataArrayCounter<XL_AVERAGE_NUM_SAMPLES)
-				{
-					xlDataArrayCounter++;
-				}
-				else
-				{
-					xlDataArrayCounter = 0;
-				}
-	
-	
-//			int8_t xData = (i2c_XL_Read_X()>>8);
-//			int8_t yData = (i2c_XL_Read_Y()>>8);
-//			int8_t zData = (i2c_XL_Read_Z()>>8);
-//			
-//			int8_t zxAngle = ((atan2(zData,xData)*180)/3.1415)-90;
-//			int8_t zyAngle = ((atan2(zData,yData)*180)/3.1415)-90;
-//			int8_t xyAngle = ((atan2(xData,yData)*180)/3.1415)-90;
-			
-			int8_t deltaData[3];
-			//i2c_XL_Vector_Delta(deltaData);
-			//volatile int8_t threshholdValue = 70;
-			volatile int8_t threshholdValue = 15;
-			deltaData[0] = xData;
-			deltaData[1] = yData;	
-			volatile int8_t minMaxValue = 0;
-			volatile int8_t largestDelta = 0;
-			for(int i=0;i<2;i++)
-			{		
-				if(abs(deltaData[i])>minMaxValue)
-				{
-					minMaxValue = abs(deltaData[i]);
-					largestDelta = i;
-				}
-			}
-			deltaData[2] = largestDelta;
-			//if((abs(deltaData[0])>threshholdValue)||(abs(deltaData[1])>threshholdValue)||(abs(deltaData[2])>threshholdValue))
-			if((abs(deltaData[0])>threshholdValue)||(abs(deltaData[1])>threshholdValue))
-			{
-				if(!gestureLockedOut)
-				{
-					volatile uint8_t newGestureData = 0x00;
-					switch(deltaData[2])
-					{
-						case 0:
-							arch_printf("\n\r*****\n\r**X** x:%d, y:%d, z:%d, gestureSlot:%d\n\r*****\n\r\n\r",deltaData[0],deltaData[1],deltaData[2],gestureCounter);
-							newGestureData = ((deltaData[0]>0)?0x4C:0x52);
-							break;
-						case 1:
-							arch_printf("\n\r*****\n\r**Y** x:%d, y:%d, z:%d, gestureSlot:%d\n\r*****\n\r\n\r",deltaData[0],deltaData[1],deltaData[2],gestureCounter);
-							newGestureData = ((deltaData[1]>0)?0x44:0x55);
-							break;
-//						case 2:
-//							arch_printf("\n\r*****\n\r**Z** x:%d, y:%d, z:%d, gestureSlot:%d\n\r*****\n\r\n\r",deltaData[0],deltaData[1],deltaData[2],gestureCounter);
-//							newGestureData = ((deltaData[2]>0)?0x55:0x44);
-//							break;
-						default:
-							break;
-					}
-					mnf_data.proprietary_data[gestureCounter] = newGestureData;
-					//arch_printf("mnfData[%d] = [%d]\n\r",gestureCounter,mnf_data.proprietary_data[gestureCounter]);
-					if(gestureCounter<(APP_AD_MSD_DATA_NUM_BYTES-1))
-					{
-						gestureCounter++;
-					}
-					else
-					{
-						gestureCounter = 0;
-					}
-					gestureLockedOut = true;
-					app_gesture_direction_timer_used = app_easy_timer(APP_GESTURE_LOCK_TO, gesture_lockout_timer_cb);
-					if(gestureDisplayReset)
-					{
-							app_easy_timer_cancel(app_gesture_display_reset_timer_used);
-					}
-					app_gesture_display_reset_timer_used = app_easy_timer(APP_GESTURE_RESET_DISPLAY_TO, gesture_display_reset_timer_cb);
-					gestureDisplayReset = true;
-				}
-			}
-			if(deviceWokeUpStartCountdownToSleep)
-			{		
-					if(gestureDisplayReset)
-					{
-							app_easy_timer_cancel(app_gesture_display_reset_timer_used);
-					}
-					app_gesture_display_reset_timer_used = app_easy_timer(APP_GESTURE_RESET_DISPLAY_TO, gesture_display_reset_timer_cb);
-					gestureDisplayReset = true;
-					deviceWokeUpStartCountdownToSleep = false;
-			}
-
-			//arch_printf("x:%d, y:%d, z:%d\n\r",deltaData[0],deltaData[1],deltaData[2]);
-			//arch_printf("xData:%d, yData:%d, zData:%d, upperBound:128, lowerBound:-128\n\r",xData,yData,zData);
-			//arch_printf("xzAngle:%d, yzAngle:%d, xyAngle:%d, upperBound:120, lowerBound:-120\n\r",zxAngle,zyAngle,xyAngle);	
-	
-//			uint8_t uartDataLength = 7;
-//			uint8_t uartData[uartDataLength];
-//			
-//			uartData[0] = mnf_data.proprietary_data[0];
-//			uartData[1] = 0x2C;
-//			uartData[2] = mnf_data.proprietary_data[1];
-//			uartData[3] = 0x2C;
-//			uartData[4] = mnf_data.proprietary_data[2];
-//			uartData[5] = 0x0A;
-//			uartData[6] = 0x0D;
-//		
-//			uart_write_buffer(UART2, uartData, sizeof(&uartData));
-	
-			//mnf_data.proprietary_data[3] = 0;
-//			if(buttonActive)
-//			{
-//				mnf_data.proprietary_data[3] = 0x22;
-//			}
-//			else
-//			{
-//				mnf_data.proprietary_data[3] = 0x24;
-//			}
+	PROFILER_BEGIN(SAMPLE_TICK);
+	// The stages follow the rate of the reads, which the battery level sets
+	gesture_pipeline_set_rate(ticks);
+	gesture_pipeline_update(xlSample, lifecycle_state() == LIFECYCLE_LOCKED);
+	PROFILER_END(SAMPLE_TICK);
 }
 
 /**
@@ -380,7 +249,7 @@ static void app_add_ad_struct(struct gapm_start_advertise_cmd *cmd, void *ad_str
         cmd->info.host.adv_data_len += ad_struct_len;
         
         // Store index of manufacturer data which are included in the advertising data
-        mnf_data_index = cmd->info.host.adv_data_len - sizeof(struct mnf_specific_data_ad_structure);
+        appRetained.mnf_data_index = cmd->info.host.adv_data_len - sizeof(struct mnf_specific_data_ad_structure);
     }
     else if ((SCAN_RSP_DATA_LEN - cmd->info.host.scan_rsp_data_len) >= ad_struct_len)
     {
@@ -391,9 +260,9 @@ static void app_add_ad_struct(struct gapm_start_advertise_cmd *cmd, void *ad_str
         cmd->info.host.scan_rsp_data_len += ad_struct_len;
         
         // Store index of manufacturer data which are included in the scan response data
-        mnf_data_index = cmd->info.host.scan_rsp_data_len - sizeof(struct mnf_specific_data_ad_structure);
+        appRetained.mnf_data_index = cmd->info.host.scan_rsp_data_len - sizeof(struct mnf_specific_data_ad_structure);
         // Mark that manufacturer data is in scan response and not advertising data
-        mnf_data_index |= 0x80;
+        appRetained.mnf_data_index |= 0x80;
     }
     else
     {
@@ -401,41 +270,280 @@ static void app_add_ad_struct(struct gapm_start_advertise_cmd *cmd, void *ad_str
         ASSERT_WARNING(0);
     }
     // Store advertising data length
-    stored_adv_data_len = cmd->info.host.adv_data_len;
+    appRetained.stored_adv_data_len = cmd->info.host.adv_data_len;
     // Store advertising data
-    memcpy(stored_adv_data, cmd->info.host.adv_data, stored_adv_data_len);
+    memcpy(appRetained.stored_adv_data, cmd->info.host.adv_data, appRetained.stored_adv_data_len);
     // Store scan response data length
-    stored_scan_rsp_data_len = cmd->info.host.scan_rsp_data_len;
+    appRetained.stored_scan_rsp_data_len = cmd->info.host.scan_rsp_data_len;
     // Store scan_response data
-    memcpy(stored_scan_rsp_data, cmd->info.host.scan_rsp_data, stored_scan_rsp_data_len);
+    memcpy(appRetained.stored_scan_rsp_data, cmd->info.host.scan_rsp_data, appRetained.stored_scan_rsp_data_len);
 }
 
 /**
  ****************************************************************************************
- * @brief Advertisement data update timer callback function.
+ * @brief Sample tick timer callback function. Runs while the state holds
+ *        LIFECYCLE_RES_TICK; leaving such a state cancels it.
  ****************************************************************************************
 */
 static void adv_data_update_timer_cb()
 {
+    int8_t xlSample[XL_NUM_AXES];
+    uint32_t period = sample_tick_period();
+
+    // Restart timer for the next sample
+    appRetained.app_adv_data_update_timer_used = app_easy_timer(period, adv_data_update_timer_cb);
+
+    // Only read and queue the sample, the pipeline runs from the main loop
+#if defined (CFG_STREAM)
+    stream_xl_update(xlSample);
+#else
+    i2c_XL_Read_Sample(xlSample);
+#endif
+    LATENCY_SAMPLE(xlSample);
+    energy_sample();
+    capture_sample(xlSample);
+    // On a low battery the read stands for the ticks skipped, so the timeouts keep
+    // counting 10ms samples; the pipeline and the advertising data see it once
+    work_push_sample(xlSample, (uint8_t)(period / APP_ADV_DATA_UPDATE_TO));
+}
+
+/**
+ ****************************************************************************************
+ * @brief SAMPLE: run one sample through the pipeline and advertise the gestures.
+ * @param[in] param  sample ticks the sample stands for
+ ****************************************************************************************
+*/
+static void lifecycle_sample(uint8_t param)
+{
+    PROFILER_BEGIN(ADV_UPDATE);
     // If mnd_data_index has MSB set, manufacturer data is stored in scan response
-    uint8_t *mnf_data_storage = (mnf_data_index & 0x80) ? stored_scan_rsp_data : stored_adv_data;
+    uint8_t *mnf_data_storage = (appRetained.mnf_data_index & 0x80) ? appRetained.stored_scan_rsp_data : appRetained.stored_adv_data;
 
     // Update manufacturer data
-    mnf_data_update();
+    mnf_data_update(appRetained.processedSample, param);
 
     // Update the selected fields of the advertising data (manufacturer data)
-    memcpy(mnf_data_storage + (mnf_data_index & 0x7F), &mnf_data, sizeof(struct mnf_specific_data_ad_structure));
+    memcpy(mnf_data_storage + (appRetained.mnf_data_index & 0x7F), &appRetained.mnf_data, sizeof(struct mnf_specific_data_ad_structure));
 
     // Update advertising data on the fly
-    app_easy_gap_update_adv_data(stored_adv_data, stored_adv_data_len, stored_scan_rsp_data, stored_scan_rsp_data_len);
-    
-    // Restart timer for the next advertising update
-		if(continueUpdatingAdvertisementData)
+    app_easy_gap_update_adv_data(appRetained.stored_adv_data, appRetained.stored_adv_data_len, appRetained.stored_scan_rsp_data, appRetained.stored_scan_rsp_data_len);
+    LATENCY_ADVERTISED();
+    PROFILER_END(ADV_UPDATE);
+
+    // Measure while the motor is off, it pulls the cell down
+    if(battery_tick(param) && !haptic_busy())
+    {
+        battery_update();
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief LOCKED timeout: the pipeline recognises gestures again.
+ ****************************************************************************************
+*/
+static void lifecycle_lockout_end(uint8_t param)
+{
+	TRACE_EVENT(TRACE_EVT_LOCKOUT_END, 0, 0);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Switch the accelerometer and the sample tick as the states require.
+ ****************************************************************************************
+*/
+static void lifecycle_resources(uint8_t on, uint8_t off)
+{
+	if(off & LIFECYCLE_RES_TICK)
+	{
+		if(appRetained.app_adv_data_update_timer_used != EASY_TIMER_INVALID_TIMER)
 		{
-			app_adv_data_update_timer_used = app_easy_timer(APP_ADV_DATA_UPDATE_TO, adv_data_update_timer_cb);
+			app_easy_timer_cancel(appRetained.app_adv_data_update_timer_used);
+			appRetained.app_adv_data_update_timer_used = EASY_TIMER_INVALID_TIMER;
 		}
+		// Queued samples belong to the state that was left
+		work_init();
+	}
+	if(off & LIFECYCLE_RES_XL)
+	{
+		stream_stop();
+		i2c_XL_Sleep_Mode();
+	}
+	if(on & LIFECYCLE_RES_XL)
+	{
+		i2c_XL_initialize();
+		stream_start();
+	}
+	if(on & LIFECYCLE_RES_TICK)
+	{
+		appRetained.app_adv_data_update_timer_used = app_easy_timer(sample_tick_period(), adv_data_update_timer_cb);
+	}
+}
+
+/**
+ ****************************************************************************************
+ * @brief SLEEPING entry: sleep until the button wakes the system. The system sleeps
+ *        between samples as well; external wake-up only stops the BLE timer from
+ *        waking it but every CFG_MAX_SLEEP_DURATION_EXTERNAL_WAKEUP_MS, when
+ *        lifecycle_poll() counts the time to hibernation.
+ ****************************************************************************************
+*/
+static void lifecycle_sleeping_entry(void)
+{
+	arch_ble_ext_wakeup_on();
+	user_reset_event_counter(); // When callback is triggerd the event counter is not set 0 for the 531, that is why this function is called.
+	profiler_dump();
 }
 
+/**
+ ****************************************************************************************
+ * @brief WAKE: let the sample tick and the BLE events wake the system, advertise again,
+ *        restart the pipeline, measure the battery and buzz. Sampling starts right away,
+ *        the pattern plays next to it. Not an exit action of SLEEPING, which hibernation
+ *        leaves too.
+ ****************************************************************************************
+*/
+static void lifecycle_wake(uint8_t param)
+{
+	arch_ble_force_wakeup();
+	arch_ble_ext_wakeup_off();
+	// If state is idle, start advertising
+	if (ke_state_get(TASK_APP) == APP_CONNECTABLE)
+	{
+		user_app_adv_start();
+	}
+	PROFILER_BEGIN(WAKE);
+	gesture_pipeline_reset();
+	latency_reset();
+	// Before the motor and the sample tick start, so both run at the level measured
+	battery_update();
+	haptic_play(HAPTIC_WAKE);
+	PROFILER_END(WAKE);
+}
+
+/**
+ ****************************************************************************************
+ * @brief GOING_TO_SLEEP entry: clear the display, empty the reports and stop
+ *        advertising. The accelerometer is already in sleep mode.
+ ****************************************************************************************
+*/
+static void lifecycle_going_to_sleep_entry(void)
+{
+	PROFILER_BEGIN(GOING_TO_SLEEP);
+	haptic_stop();
+	//arch_printf("RESETTING THE GESTURE COUNTER AND DISPLAY\n\r");
+	for(int i=0; i<APP_AD_MSD_DATA_NUM_BYTES;i++)
+	{
+		appRetained.mnf_data.proprietary_data[i] = 0;
+	}
+	TRACE_EVENT(TRACE_EVT_DISPLAY_RESET, appRetained.gestureCounter, 0);
+	appRetained.gestureCounter = 0;
+
+	TRACE_EVENT(TRACE_EVT_SLEEP, 0, 0);
+	latency_dump();
+	energy_report();
+	lifecycle_report();
+	// Nothing runs until the button wakes the system, so empty the trace now
+	trace_flush(TRACE_RING_LEN);
+	capture_close();
+
+	energy_off(ENERGY_ADV_SLOTS);
+	PROFILER_END(GOING_TO_SLEEP);
+	// Sleep once the stack confirms, see user_app_adv_undirect_complete()
+	if(appRetained.advertisingCommands > 0)
+	{
+		app_easy_gap_advertise_stop();
+	}
+	else
+	{
+		lifecycle_post(LIFECYCLE_EVT_ADV_STOPPED, 0);
+	}
+}
+
+/**
+ ****************************************************************************************
+ * @brief CONNECTED exit: advertise again.
+ ****************************************************************************************
+*/
+static void lifecycle_connected_exit(void)
+{
+	user_app_adv_start();
+}
+
+/**
+ ****************************************************************************************
+ * @brief HIBERNATING entry: power down until the accelerometer interrupt resets the
+ *        system. Does not return.
+ ****************************************************************************************
+*/
+static void lifecycle_hibernating_entry(void)
+{
+#if defined (CFG_HIBERNATION)
+	// The button is no wake-up source any more, the accelerometer stays in sleep mode
+	wkupct_disable_irq();
+	trace_flush(TRACE_RING_LEN);
+	arch_set_hibernation(1 << GPIO_INT_PIN, CFG_HIBERNATION_RAM1, CFG_HIBERNATION_RAM2, CFG_HIBERNATION_RAM3,
+		CFG_HIBERNATION_REMAP, false);
+#endif
+}
+
+// The timer wheel counts sample ticks, the state timeouts 10ms units
+typedef char lifecycle_tick_is_10ms[(APP_ADV_DATA_UPDATE_TO == 1) ? 1 : -1];
+
+// Sampling states hold the accelerometer and the tick. A gesture restarts the display
+// reset countdown, which LOCKED and DISPLAY_HOLD split between them
+typedef char lifecycle_lock_shorter_than_display[(APP_GESTURE_LOCK_TO < APP_GESTURE_RESET_DISPLAY_TO) ? 1 : -1];
+
+// SLEEPING ends in hibernation after a long idle period, or lasts until the button. The
+// periodic wake-ups of the BLE core count the idle time, so it ends up to
+// CFG_MAX_SLEEP_DURATION_EXTERNAL_WAKEUP_MS after APP_HIBERNATE_TO
+#if defined (CFG_HIBERNATION)
+#define LIFECYCLE_SLEEPING_TO               APP_HIBERNATE_TO
+// Bit n of the arch_set_hibernation() wake-up mask selects P0_n, for P0_1 to P0_5 only
+typedef char lifecycle_hibernation_wake_pin[((GPIO_INT_PORT == GPIO_PORT_0) && (GPIO_INT_PIN >= GPIO_PIN_1) &&
+	(GPIO_INT_PIN <= GPIO_PIN_5)) ? 1 : -1];
+#else
+#define LIFECYCLE_SLEEPING_TO               LIFECYCLE_NO_TIMEOUT
+#endif
+
+static const struct lifecycle_state_conf lifecycleStates[LIFECYCLE_NUM_STATES] =
+{
+	[LIFECYCLE_SLEEPING]        = {LIFECYCLE_SLEEPING_TO, 0, lifecycle_sleeping_entry, NULL},
+	[LIFECYCLE_SAMPLING]        = {APP_GESTURE_RESET_DISPLAY_TO, LIFECYCLE_RES_XL | LIFECYCLE_RES_TICK, NULL, NULL},
+	[LIFECYCLE_LOCKED]          = {APP_GESTURE_LOCK_TO, LIFECYCLE_RES_XL | LIFECYCLE_RES_TICK, NULL, NULL},
+	[LIFECYCLE_DISPLAY_HOLD]    = {APP_GESTURE_RESET_DISPLAY_TO - APP_GESTURE_LOCK_TO, LIFECYCLE_RES_XL | LIFECYCLE_RES_TICK, NULL, NULL},
+	[LIFECYCLE_GOING_TO_SLEEP]  = {LIFECYCLE_NO_TIMEOUT, 0, lifecycle_going_to_sleep_entry, NULL},
+	[LIFECYCLE_CONNECTED]       = {LIFECYCLE_NO_TIMEOUT, LIFECYCLE_RES_XL, NULL, lifecycle_connected_exit},
+	[LIFECYCLE_HIBERNATING]     = {LIFECYCLE_NO_TIMEOUT, 0, lifecycle_hibernating_entry, NULL},
+};
+
+static const struct lifecycle_transition lifecycleTransitions[] =
+{
+	{LIFECYCLE_SLEEPING,        LIFECYCLE_EVT_WAKE,         LIFECYCLE_SAMPLING,         lifecycle_wake},
+	{LIFECYCLE_SLEEPING,        LIFECYCLE_EVT_TIMEOUT,      LIFECYCLE_HIBERNATING,      NULL},
+	{LIFECYCLE_SAMPLING,        LIFECYCLE_EVT_TIMEOUT,      LIFECYCLE_GOING_TO_SLEEP,   NULL},
+	{LIFECYCLE_LOCKED,          LIFECYCLE_EVT_TIMEOUT,      LIFECYCLE_DISPLAY_HOLD,     lifecycle_lockout_end},
+	{LIFECYCLE_DISPLAY_HOLD,    LIFECYCLE_EVT_TIMEOUT,      LIFECYCLE_GOING_TO_SLEEP,   NULL},
+	{LIFECYCLE_SAMPLING,        LIFECYCLE_EVT_SAMPLE,       LIFECYCLE_SAME,             lifecycle_sample},
+	{LIFECYCLE_LOCKED,          LIFECYCLE_EVT_SAMPLE,       LIFECYCLE_SAME,             lifecycle_sample},
+	{LIFECYCLE_DISPLAY_HOLD,    LIFECYCLE_EVT_SAMPLE,       LIFECYCLE_SAME,             lifecycle_sample},
+	{LIFECYCLE_SAMPLING,        LIFECYCLE_EVT_GESTURE,      LIFECYCLE_LOCKED,           NULL},
+	{LIFECYCLE_LOCKED,          LIFECYCLE_EVT_GESTURE,      LIFECYCLE_LOCKED,           NULL},
+	{LIFECYCLE_DISPLAY_HOLD,    LIFECYCLE_EVT_GESTURE,      LIFECYCLE_LOCKED,           NULL},
+	{LIFECYCLE_GOING_TO_SLEEP,  LIFECYCLE_EVT_ADV_STOPPED,  LIFECYCLE_SLEEPING,         NULL},
+	{LIFECYCLE_SLEEPING,        LIFECYCLE_EVT_CONNECT,      LIFECYCLE_SAME,             NULL},
+	{LIFECYCLE_ANY,             LIFECYCLE_EVT_CONNECT,      LIFECYCLE_CONNECTED,        NULL},
+	{LIFECYCLE_CONNECTED,       LIFECYCLE_EVT_DISCONNECT,   LIFECYCLE_SAMPLING,         NULL},
+};
+
+static const struct lifecycle_conf lifecycleConfig =
+{
+	lifecycleStates,
+	lifecycleTransitions,
+	sizeof(lifecycleTransitions) / sizeof(lifecycleTransitions[0]),
+	lifecycle_resources,
+};
+
 /**
  ****************************************************************************************
  * @brief Parameter update request timer callback function.
@@ -443,54 +551,70 @@ static void adv_data_update_timer_cb()
 */
 static void param_update_request_timer_cb()
 {
-    app_easy_gap_param_update_start(app_connection_idx);
-    app_param_update_request_timer_used = EASY_TIMER_INVALID_TIMER;
+    app_easy_gap_param_update_start(appRetained.app_connection_idx);
+    appRetained.app_param_update_request_timer_used = EASY_TIMER_INVALID_TIMER;
 }
 
 void user_app_init(void)
 {
-    app_param_update_request_timer_used = EASY_TIMER_INVALID_TIMER;  
-		continueUpdatingAdvertisementData = true;
-	
+    appRetained.app_param_update_request_timer_used = EASY_TIMER_INVALID_TIMER;
+    appRetained.app_adv_data_update_timer_used = EASY_TIMER_INVALID_TIMER;
+		appRetained.advertisingCommands = 0;
+
     // Initialize Manufacturer Specific Data
 		user_wakeup_example_init();
     mnf_data_init();
 		//interruptsInit();
-    
+
     // Initialize Advertising and Scan Response Data
-    memcpy(stored_adv_data, USER_ADVERTISE_DATA, USER_ADVERTISE_DATA_LEN);
-    stored_adv_data_len = USER_ADVERTISE_DATA_LEN;
-    memcpy(stored_scan_rsp_data, USER_ADVERTISE_SCAN_RESPONSE_DATA, USER_ADVERTISE_SCAN_RESPONSE_DATA_LEN);
-    stored_scan_rsp_data_len = USER_ADVERTISE_SCAN_RESPONSE_DATA_LEN;
-    
+    memcpy(appRetained.stored_adv_data, USER_ADVERTISE_DATA, USER_ADVERTISE_DATA_LEN);
+    appRetained.stored_adv_data_len = USER_ADVERTISE_DATA_LEN;
+    memcpy(appRetained.stored_scan_rsp_data, USER_ADVERTISE_SCAN_RESPONSE_DATA, USER_ADVERTISE_SCAN_RESPONSE_DATA_LEN);
+    appRetained.stored_scan_rsp_data_len = USER_ADVERTISE_SCAN_RESPONSE_DATA_LEN;
+
     default_app_on_init();
-	
-		i2c_XL_initialize();
-		//user_app_waking_from_sleep();
+		trace_init();
+		profiler_init();
+		latency_reset();
+		energy_init();
+		haptic_init();
+		battery_init();
+		battery_update();
+		capture_init();
+		stream_init();
+
+		// Powered up awake, counting down to the first sleep
+		timer_wheel_init();
+		work_init();
+		lifecycle_init(&lifecycleConfig, LIFECYCLE_SAMPLING);
+#if defined (CFG_SWAR_BENCHMARK)
+		swar_benchmark();
+#endif
 }
 
 void user_app_adv_start(void)
 {
-    // Schedule the next advertising data update
-    app_adv_data_update_timer_used = app_easy_timer(APP_ADV_DATA_UPDATE_TO, adv_data_update_timer_cb);
-    
     struct gapm_start_advertise_cmd* cmd;
     cmd = app_easy_gap_undirected_advertise_get_active();
-    
+
+    // Advertise less often on a low battery
+    cmd->intv_min = user_adv_conf.intv_min * battery_current()->adv;
+    cmd->intv_max = user_adv_conf.intv_max * battery_current()->adv;
+
     // Add manufacturer data to initial advertising or scan response data, if there is enough space
-    app_add_ad_struct(cmd, &mnf_data, sizeof(struct mnf_specific_data_ad_structure), 1);
+    app_add_ad_struct(cmd, &appRetained.mnf_data, sizeof(struct mnf_specific_data_ad_structure), 1);
 
     app_easy_gap_undirected_advertise_start();
+    appRetained.advertisingCommands++;
+    energy_on(ENERGY_ADV_SLOTS);
 }
 
 void user_app_connection(uint8_t connection_idx, struct gapc_connection_req_ind const *param)
 {
     if (app_env[connection_idx].conidx != GAP_INVALID_CONIDX)
     {
-        app_connection_idx = connection_idx;
-
-        // Stop the advertising data update timer
-        app_easy_timer_cancel(app_adv_data_update_timer_used);
+        appRetained.app_connection_idx = connection_idx;
+        energy_off(ENERGY_ADV_SLOTS);
 
         // Check if the parameters of the established connection are the preferred ones.
         // If not then schedule a connection parameter update request.
@@ -500,8 +624,10 @@ void user_app_connection(uint8_t connection_idx, struct gapc_connection_req_ind
             (param->sup_to != user_connection_param_conf.time_out))
         {
             // Connection params are not these that we expect
-            app_param_update_request_timer_used = app_easy_timer(APP_PARAM_UPDATE_REQUEST_TO, param_update_request_timer_cb);
+            appRetained.app_param_update_request_timer_used = app_easy_timer(APP_PARAM_UPDATE_REQUEST_TO, param_update_request_timer_cb);
         }
+        // Stops the sample tick
+        lifecycle_post(LIFECYCLE_EVT_CONNECT, connection_idx);
     }
     else
     {
@@ -514,25 +640,28 @@ void user_app_connection(uint8_t connection_idx, struct gapc_connection_req_ind
 
 void user_app_adv_undirect_complete(uint8_t status)
 {
-    // If advertising was canceled then update advertising data and start advertising again
-    if (status == GAP_ERR_CANCELED)
+    // Advertising ended: a connection, or the stop of GOING_TO_SLEEP. It is not
+    // restarted on GAP_ERR_CANCELED, that brought it back after going to sleep.
+    if (appRetained.advertisingCommands > 0)
     {
-        user_app_adv_start();
+        appRetained.advertisingCommands--;
+    }
+    if (appRetained.advertisingCommands == 0)
+    {
+        lifecycle_post(LIFECYCLE_EVT_ADV_STOPPED, status);
     }
 }
 
 void user_app_disconnect(struct gapc_disconnect_ind const *param)
 {
     // Cancel the parameter update request timer
-    if (app_param_update_request_timer_used != EASY_TIMER_INVALID_TIMER)
+    if (appRetained.app_param_update_request_timer_used != EASY_TIMER_INVALID_TIMER)
     {
-        app_easy_timer_cancel(app_param_update_request_timer_used);
-        app_param_update_request_timer_used = EASY_TIMER_INVALID_TIMER;
+        app_easy_timer_cancel(appRetained.app_param_update_request_timer_used);
+        appRetained.app_param_update_request_timer_used = EASY_TIMER_INVALID_TIMER;
     }
-    // Update manufacturer data for the next advertsing event
-    mnf_data_update();
-    // Restart Advertising
-    user_app_adv_start();
+    // Restart advertising and sampling
+    lifecycle_post(LIFECYCLE_EVT_DISCONNECT, 0);
 }
 
 void user_catch_rest_hndl(ke_msg_id_t const msgid,
@@ -560,39 +689,68 @@ void user_catch_rest_hndl(ke_msg_id_t const msgid,
             break;
     }
 }
-/**
- ****************************************************************************************
- * @brief Gesture display reset timer callback function.
- ****************************************************************************************
-*/
-static void motor_on_timer_cb()
+
+arch_main_loop_callback_ret_t user_app_on_system_powered(void)
 {
-	arch_printf("Motor stopping\n\r");	
-	GPIO_SetInactive(MOTOR_PORT, MOTOR_PIN);
-	continueUpdatingAdvertisementData = true;
-	app_adv_data_update_timer_used = app_easy_timer(APP_ADV_DATA_UPDATE_TO, adv_data_update_timer_cb);
-	deviceWokeUpStartCountdownToSleep = true;
+	uint16_t dropped = work_take_dropped();
+
+	// Every wake-up runs this callback, the periodic ones of the BLE core in SLEEPING too
+	lifecycle_poll();
+	if(dropped > 0)
+	{
+		TRACE_EVENT(TRACE_EVT_WORK_DROPPED, 0, dropped);
+	}
+	for(uint8_t i=0;i<WORK_BUDGET;i++)
+	{
+		uint8_t ticks;
+
+		if(!work_pop_sample(appRetained.processedSample, &ticks))
+		{
+			break;
+		}
+		lifecycle_post(LIFECYCLE_EVT_SAMPLE, ticks);
+		// After the sample, so a gesture in it restarts the timeouts it would have met
+		for(uint8_t tick=0;tick<ticks;tick++)
+		{
+			timer_wheel_tick();
+		}
+	}
+	// Let the BLE scheduler run before the next samples
+	return work_pending() ? KEEP_POWERED : GOTO_SLEEP;
 }
 
-void user_app_waking_from_sleep(void)
+void user_app_before_sleep(void)
 {
-	i2c_XL_initialize();
-	arch_printf("Motor starting\n\r");	
-	app_motor_on_timer_used = app_easy_timer(APP_MOTOR_ON_TO, motor_on_timer_cb);
-	GPIO_SetActive(MOTOR_PORT, MOTOR_PIN);
+	// Idle time, write out a few trace records and a capture chunk
+	trace_flush(TRACE_FLUSH_BATCH);
+	capture_flush(1);
 }
-void user_app_going_to_sleep(void)
+
+sleep_mode_t user_app_validate_sleep(sleep_mode_t sleep_mode)
 {
-	continueUpdatingAdvertisementData = false;
-	i2c_XL_Sleep_Mode();
-	arch_printf("\n\rSystem going to sleep",NULL);
+	// A sample queued since the main loop callback ran, go round again
+	if(work_pending())
+	{
+		return mode_active;
+	}
+	// A stream frame on the wire needs the UART clock and a haptic pattern the Timer0
+	// PWM, wait for them in idle
+	if((stream_busy() || haptic_busy()) && (sleep_mode != mode_active))
+	{
+		return mode_idle;
+	}
+	return sleep_mode;
+}
 
-	app_easy_gap_advertise_stop();
+void user_app_sleep_enter(sleep_mode_t sleep_mode)
+{
+	energy_sleep_enter();
+}
 
-	arch_set_sleep_mode(ARCH_EXT_SLEEP_ON);				
-	arch_ble_ext_wakeup_on();
-	user_reset_event_counter(); // When callback is triggerd the event counter is not set 0 for the 531, that is why this function is called. 		
-}                                                               
+void user_app_sleep_exit(void)
+{
+	energy_sleep_exit();
+}
 
 ///**
 // ****************************************************************************************
@@ -35,6 +35,11 @@
 #include "app_task.h"                  // application task
 #include "app.h"                       // application definitions
 #include "app_callback.h"
+#include "arch_api.h"
+#include "app_easy_timer.h"
+#include "co_bt.h"
+#include "user_gesture_config.h"
+#include "user_xl_driver.h"
 
 /*
  * DEFINES
@@ -47,12 +52,10 @@
 /* Advertising data update timer */
 //#define APP_ADV_DATA_UPDATE_TO              (3000)   // 3000*10ms = 30sec, The maximum allowed value is 41943sec (4194300 * 10ms)
 #define APP_ADV_DATA_UPDATE_TO              (1)   // 1*10ms = 0.01sec, The maximum allowed value is 41943sec (4194300 * 10ms)
-#define APP_GESTURE_LOCK_TO              		(50)   // 50*10ms = 0.5sec, The maximum allowed value is 41943sec (4194300 * 10ms)
-#define APP_GESTURE_RESET_DISPLAY_TO       	(300)   // 300*10ms = 3sec, The maximum allowed value is 41943sec (4194300 * 10ms)
-#define APP_MOTOR_ON_TO       							(100)   // 50*10ms = 0.5sec, The maximum allowed value is 41943sec (4194300 * 10ms)
-
-#define XL_AVERAGE_NUM_MULTIPLIER						3
-#define XL_AVERAGE_NUM_SAMPLES							(16) //8
+#define APP_GESTURE_LOCK_TO              		CFG_GESTURE_LOCK_TO   // see user_gesture_config.h
+#define APP_GESTURE_RESET_DISPLAY_TO       	CFG_GESTURE_RESET_DISPLAY_TO   // see user_gesture_config.h
+/* Sleep before hibernation, with CFG_HIBERNATION */
+#define APP_HIBERNATE_TO                    (360000)   // 360000*10ms = 1h, The maximum allowed value is 41943sec (4194300 * 10ms)
 
 /* Manufacturer specific data constants */
 //#define APP_AD_MSD_COMPANY_ID               (0xABCD)
@@ -61,6 +64,63 @@
 #define APP_AD_MSD_DATA_NUM_BYTES           (5)
 #define APP_AD_MSD_DATA_LEN                 (APP_AD_MSD_DATA_NUM_BYTES*sizeof(uint8_t))
 
+/* Bytes of struct app_retained, checked at compile time in user_barebone.c */
+#define APP_RETAINED_SIZE                   (ADV_DATA_LEN + SCAN_RSP_DATA_LEN + 3 + APP_AD_MSD_DATA_LEN + XL_NUM_AXES + 8)
+
+/* Retention RAM of the application on the target: struct app_retained and the retained
+   struct of every module, summed and checked at compile time in user_barebone.c. The
+   energy and latency counters add theirs when they are enabled */
+#if defined (__DA14531__)
+#define APP_RETAINED_TOTAL_SIZE             (585 + ENERGY_RETAINED_SIZE + LATENCY_RETAINED_SIZE)
+#else
+#define APP_RETAINED_TOTAL_SIZE             (637 + ENERGY_RETAINED_SIZE + LATENCY_RETAINED_SIZE)
+#endif
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+// Manufacturer Specific Data ADV structure type
+struct mnf_specific_data_ad_structure
+{
+    uint8_t ad_structure_size;
+    uint8_t ad_structure_type;
+    //uint8_t company_id[APP_AD_MSD_COMPANY_ID_LEN];
+    uint8_t proprietary_data[APP_AD_MSD_DATA_LEN];
+    /// Battery voltage after the gesture slots, see battery_adv_level()
+    uint8_t battery;
+};
+
+/// Application state kept in retention RAM. Byte fields only, so there is no padding and
+/// the struct is exactly APP_RETAINED_SIZE bytes; zeroed at power-on like any
+/// retention_mem_area0 variable.
+struct app_retained
+{
+    uint8_t stored_adv_data[ADV_DATA_LEN];
+    uint8_t stored_scan_rsp_data[SCAN_RSP_DATA_LEN];
+    struct mnf_specific_data_ad_structure mnf_data;
+    /// Sample taken from the work queue for the SAMPLE event
+    int8_t processedSample[XL_NUM_AXES];
+    uint8_t stored_adv_data_len;
+    uint8_t stored_scan_rsp_data_len;
+    /// Index of manufacturer data in advertising data or scan response data (when MSB is 1)
+    uint8_t mnf_data_index;
+    uint8_t app_connection_idx;
+    timer_hnd app_adv_data_update_timer_used;
+    timer_hnd app_param_update_request_timer_used;
+    /// Advertising commands the stack has not completed yet
+    uint8_t advertisingCommands;
+    volatile uint8_t gestureCounter;
+};
+
+/*
+ * GLOBAL VARIABLE DECLARATIONS
+ ****************************************************************************************
+ */
+
+extern struct app_retained appRetained;
+
 /*
  * FUNCTION DECLARATIONS
  ****************************************************************************************
@@ -120,16 +180,40 @@ void user_catch_rest_hndl(ke_msg_id_t const msgid,
                           ke_task_id_t const src_id);
 /**
  ****************************************************************************************
- * @brief Waking up from sleep
+ * @brief Called by the main loop when the BLE stack has nothing to do; runs the queued
+ *        samples, a few at a time
+ * @return KEEP_POWERED while samples are still queued
+ ****************************************************************************************
+*/
+arch_main_loop_callback_ret_t user_app_on_system_powered(void);
+
+/**
+ ****************************************************************************************
+ * @brief Called by the main loop every time before the system may sleep
+ ****************************************************************************************
+*/
+void user_app_before_sleep(void);
+/**
+ ****************************************************************************************
+ * @brief Called by the main loop to confirm or lower the sleep mode it has chosen
+ * @param[in] sleep_mode  sleep mode chosen by the stack
+ * @return sleep mode to enter
+ ****************************************************************************************
+*/
+sleep_mode_t user_app_validate_sleep(sleep_mode_t sleep_mode);
+/**
+ ****************************************************************************************
+ * @brief Called by the main loop right before the system sleeps
+ * @param[in] sleep_mode  sleep mode about to be entered
  ****************************************************************************************
 */
-void user_app_waking_from_sleep(void);
+void user_app_sleep_enter(sleep_mode_t sleep_mode);
 /**
  ****************************************************************************************
- * @brief Going tosleep
+ * @brief Called by the main loop when the system wakes up
  ****************************************************************************************
 */
-void user_app_going_to_sleep(void);
+void user_app_sleep_exit(void);
 
 /// @} APP
 
@@ -0,0 +1,141 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_battery.c
+ *
+ * @brief Battery monitoring and the degradation policy of the battery levels.
+ *
+ * The DA14531 driver measures VBAT_HIGH with the general purpose ADC in a few tens of
+ * microseconds. The DA14585/586 driver only reports coin cell percentages, so these
+ * targets stay at the best level.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "user_battery.h"
+#include "compiler.h"
+#include "battery.h"
+#include "user_trace.h"
+#include "user_gesture_config.h"
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+#define BATTERY_LEVEL_DESC(name, min_mv, reads, adv, haptic) {(min_mv), (reads), (adv), (haptic)},
+
+static const struct battery_policy batteryLevels[BATTERY_NUM_LEVELS] =
+{
+	BATTERY_LEVELS(BATTERY_LEVEL_DESC)
+};
+
+// A read per tick or less, at a rate the pipeline scales its windows to: a power of two
+// of ticks up to 1 << CFG_GESTURE_MAX_RATE_SHIFT. The motor drive is a percentage
+#define BATTERY_LEVEL_CHECK(name, min_mv, reads, adv, haptic) \
+	typedef char battery_level_##name[(((reads) > 0) && ((reads) <= (1 << CFG_GESTURE_MAX_RATE_SHIFT)) && \
+		!((reads) & ((reads) - 1)) && ((adv) > 0) && ((haptic) <= 100)) ? 1 : -1];
+BATTERY_LEVELS(BATTERY_LEVEL_CHECK)
+
+// Everything the module keeps across sleep, see struct battery_retained
+struct battery_retained batteryRetained         __SECTION_ZERO("retention_mem_area0"); //@RETENTION MEMORY
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+ /**
+ ****************************************************************************************
+ * @brief Level a voltage falls in, without hysteresis
+ ****************************************************************************************
+ */
+static uint8_t battery_level_of(uint16_t mv)
+{
+	uint8_t level = 0;
+
+	while((level < (BATTERY_NUM_LEVELS - 1)) && (mv < batteryLevels[level].minMv))
+	{
+		level++;
+	}
+	return level;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief VBAT_HIGH in mV, 0 when the target cannot measure it
+ ****************************************************************************************
+ */
+static uint16_t battery_read_mv(void)
+{
+#if defined (__DA14531__)
+	return battery_get_voltage();
+#else
+	return 0;
+#endif
+}
+
+void battery_init(void)
+{
+	batteryRetained.mv = 0;
+	batteryRetained.countdown = BATTERY_MEASURE_TICKS;
+	batteryRetained.level = BATTERY_FULL;
+}
+
+bool battery_measure(void)
+{
+	uint8_t previous = batteryRetained.level;
+	uint16_t mv = battery_read_mv();
+	uint8_t level;
+
+	batteryRetained.countdown = BATTERY_MEASURE_TICKS;
+	if(mv == 0)
+	{
+		return false;
+	}
+	batteryRetained.mv = mv;
+	level = battery_level_of(batteryRetained.mv);
+	if(level < batteryRetained.level)
+	{
+		// Rising: only as far as the voltage clears the lowest one of the level
+		uint8_t cleared = battery_level_of((batteryRetained.mv > BATTERY_HYSTERESIS_MV) ? (batteryRetained.mv - BATTERY_HYSTERESIS_MV) : 0);
+
+		level = (cleared < batteryRetained.level) ? cleared : batteryRetained.level;
+	}
+	batteryRetained.level = level;
+	if(batteryRetained.level != previous)
+	{
+		TRACE_EVENT(TRACE_EVT_BATTERY, batteryRetained.level, batteryRetained.mv);
+	}
+	return batteryRetained.level != previous;
+}
+
+bool battery_tick(uint8_t ticks)
+{
+	batteryRetained.countdown = (batteryRetained.countdown > ticks) ? (batteryRetained.countdown - ticks) : 0;
+	return batteryRetained.countdown == 0;
+}
+
+const struct battery_policy *battery_current(void)
+{
+	return &batteryLevels[batteryRetained.level];
+}
+
+uint8_t battery_level(void)
+{
+	return batteryRetained.level;
+}
+
+uint8_t battery_adv_level(void)
+{
+	uint16_t level = batteryRetained.mv / BATTERY_ADV_UNIT_MV;
+
+	return (level > UINT8_MAX) ? UINT8_MAX : (uint8_t)level;
+}
@@ -0,0 +1,149 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_battery.h
+ *
+ * @brief Battery monitoring and the degradation policy of the battery levels.
+ *
+ * The LiPo cell feeds VBAT_HIGH through a 3.3V buck converter, so the voltage the ADC
+ * measures stays at the regulated 3.3V until the cell falls into the dropout of the
+ * buck, and follows the cell from then on. That is the last few percent of the charge,
+ * where a motor pulse can pull the cell into its protection cut-off. The levels below
+ * therefore all sit under 3.3V.
+ *
+ * The battery is measured when the wand wakes, before the wake pattern starts the
+ * motor, and every BATTERY_MEASURE_TICKS sample ticks while it stays awake. Every level
+ * carries a policy the application applies: fewer accelerometer reads and pipeline
+ * runs, a longer advertising interval and a weaker motor.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _USER_BATTERY_H_
+#define _USER_BATTERY_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/* Levels, from the best down. X(name, min_mv, reads, adv, haptic): lowest VBAT_HIGH of the */
+/* level in mV, 0 for the last one; the sample tick reads the accelerometer and runs the    */
+/* pipeline, its windows scaled to the rate, once every `reads` ticks, a power of two; the  */
+/* timeouts still count every tick; `adv` multiplies the advertising interval; `haptic`     */
+/* scales the motor drive in percent, 0 for no motor                                        */
+#define BATTERY_LEVELS(X)                                                                  \
+	X(FULL,                       3150,   1,      1,      100)                             \
+	X(LOW,                        3000,   2,      2,      75)                              \
+	X(CRITICAL,                   0,      4,      4,      0)
+
+#define BATTERY_LEVEL_ENUM(name, min_mv, reads, adv, haptic) BATTERY_##name,
+
+/* Samples between two measurements while the wand is awake: 6000*10ms = 60sec              */
+#define BATTERY_MEASURE_TICKS               (6000)
+
+/* A level is only regained this far above its lowest voltage, the cell recovers after load */
+#define BATTERY_HYSTERESIS_MV               (50)
+
+/* Unit of the battery byte in the advertising data: VBAT_HIGH in 20mV, 0 before the first  */
+/* measurement                                                                              */
+#define BATTERY_ADV_UNIT_MV                 (20)
+
+/* Retention RAM of the module, struct battery_retained                                     */
+#define BATTERY_RETAINED_SIZE               (sizeof(struct battery_retained))
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Battery levels
+enum battery_level_id
+{
+	BATTERY_LEVELS(BATTERY_LEVEL_ENUM)
+	BATTERY_NUM_LEVELS
+};
+
+/// Policy of a battery level
+struct battery_policy
+{
+	/// Lowest VBAT_HIGH of the level in mV
+	uint16_t minMv;
+	/// Sample ticks per accelerometer read, at least 1
+	uint8_t reads;
+	/// Advertising interval multiplier, at least 1
+	uint8_t adv;
+	/// Motor drive in percent of the pattern's
+	uint8_t haptic;
+};
+
+/// State of user_battery.c kept in retention RAM
+struct battery_retained
+{
+	/// Last VBAT_HIGH measurement in mV, 0 before the first
+	uint16_t mv;
+	/// Sample ticks to the next measurement
+	uint16_t countdown;
+	/// enum battery_level_id
+	uint8_t level;
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+ /**
+ ****************************************************************************************
+ * @brief Start at the best level with no measurement
+ ****************************************************************************************
+ */
+void battery_init(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Measure VBAT_HIGH and move to the level it falls in. Falling is immediate,
+ *        rising takes BATTERY_HYSTERESIS_MV more. Restarts the measurement countdown.
+ * @return true when the level changed
+ ****************************************************************************************
+ */
+bool battery_measure(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Count the sample ticks of one processed sample
+ * @return true once BATTERY_MEASURE_TICKS ticks went by since the last measurement,
+ *         until the next one
+ ****************************************************************************************
+ */
+bool battery_tick(uint8_t ticks);
+
+ /**
+ ****************************************************************************************
+ * @brief Policy of the current level
+ ****************************************************************************************
+ */
+const struct battery_policy *battery_current(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Current level, enum battery_level_id
+ ****************************************************************************************
+ */
+uint8_t battery_level(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Last measurement for the advertising data, in BATTERY_ADV_UNIT_MV, saturated
+ ****************************************************************************************
+ */
+uint8_t battery_adv_level(void);
+
+#endif // _USER_BATTERY_H_
@@ -0,0 +1,248 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_capture.c
+ *
+ * @brief Accelerometer capture. Raw samples are encoded into chunks in RAM and written
+ *        to UART2 when the system is about to sleep. See user_capture_format.h.
+ *
+ * Samples, gestures and the flush all run from the application callbacks, never from
+ * an interrupt, so the chunk ring needs no locking.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "user_capture.h"
+#include "user_xl_driver.h"
+
+#if defined (CFG_CAPTURE)
+
+#include "ll.h"
+#include "lld_evt.h"
+#include "uart.h"
+
+#if (CAPTURE_NUM_CHUNKS & (CAPTURE_NUM_CHUNKS - 1)) || (CAPTURE_NUM_CHUNKS > 128)
+    #error "CAPTURE_NUM_CHUNKS must be a power of two, at most 128"
+#endif
+
+#if (CAPTURE_CHUNK_PAYLOAD < (1 + CAPTURE_SAMPLE_MAX_SIZE)) || (CAPTURE_CHUNK_PAYLOAD > CAPTURE_CHUNK_MAX_PAYLOAD)
+    #error "CAPTURE_CHUNK_PAYLOAD must hold at least one sample and fit the length byte"
+#endif
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// One chunk as it is sent, without the sync and checksum
+struct capture_chunk
+{
+	uint8_t type;
+	uint8_t length;
+	uint8_t payload[CAPTURE_CHUNK_PAYLOAD];
+};
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+struct capture_chunk captureChunks[CAPTURE_NUM_CHUNKS];
+// Free-running indexes: chunks from tail to head are complete, the chunk at head is
+// being filled when captureOpen is set
+uint8_t captureHead;
+uint8_t captureTail;
+bool captureOpen;
+uint8_t captureDropped;
+// Delta reference, the previous sample of the open chunk
+uint32_t capturePrevTimestamp;
+int8_t capturePrevSample[XL_NUM_AXES];
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+ /**
+ ****************************************************************************************
+ * @brief Append an unsigned varint to a chunk
+ ****************************************************************************************
+ */
+static void capture_put_varint(struct capture_chunk *chunk, uint32_t value)
+{
+	while(value >= 0x80)
+	{
+		chunk->payload[chunk->length++] = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+	chunk->payload[chunk->length++] = (uint8_t)value;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Start a chunk at head
+ * @return the chunk, NULL when all chunks are waiting to be written
+ ****************************************************************************************
+ */
+static struct capture_chunk *capture_open_chunk(uint8_t type)
+{
+	struct capture_chunk *chunk;
+
+	if((uint8_t)(captureHead - captureTail) >= CAPTURE_NUM_CHUNKS)
+	{
+		return NULL;
+	}
+	chunk = &captureChunks[captureHead & (CAPTURE_NUM_CHUNKS - 1)];
+	chunk->type = type;
+	chunk->length = 0;
+	captureOpen = true;
+	return chunk;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Complete the chunk at head so the flush can send it
+ ****************************************************************************************
+ */
+static void capture_close_chunk(void)
+{
+	if(captureOpen)
+	{
+		captureOpen = false;
+		captureHead++;
+	}
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Drop all buffered chunks
+ ****************************************************************************************
+ */
+void capture_init(void)
+{
+	captureHead = 0;
+	captureTail = 0;
+	captureOpen = false;
+	captureDropped = 0;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Append one sample, timestamped now
+ ****************************************************************************************
+ */
+void capture_sample(const int8_t *sample)
+{
+	uint32_t timestamp = lld_evt_time_get() & CAPTURE_TIMESTAMP_MASK;
+	struct capture_chunk *chunk = &captureChunks[captureHead & (CAPTURE_NUM_CHUNKS - 1)];
+
+	if(captureOpen && ((chunk->type != CAPTURE_CHUNK_SAMPLES) ||
+		((chunk->length + CAPTURE_SAMPLE_MAX_SIZE) > CAPTURE_CHUNK_PAYLOAD)))
+	{
+		capture_close_chunk();
+	}
+	if(!captureOpen)
+	{
+		if((chunk = capture_open_chunk(CAPTURE_CHUNK_SAMPLES)) == NULL)
+		{
+			if(captureDropped < UINT8_MAX)
+			{
+				captureDropped++;
+			}
+			return;
+		}
+		chunk->payload[chunk->length++] = captureDropped;
+		captureDropped = 0;
+		// The first sample of a chunk is relative to zero, i.e. absolute
+		capturePrevTimestamp = 0;
+		for(int i=0;i<XL_NUM_AXES;i++)
+		{
+			capturePrevSample[i] = 0;
+		}
+	}
+
+	capture_put_varint(chunk, (timestamp - capturePrevTimestamp) & CAPTURE_TIMESTAMP_MASK);
+	for(int i=0;i<XL_NUM_AXES;i++)
+	{
+		int16_t delta = (int16_t)sample[i] - capturePrevSample[i];
+
+		capture_put_varint(chunk, CAPTURE_ZIGZAG(delta));
+		capturePrevSample[i] = sample[i];
+	}
+	capturePrevTimestamp = timestamp;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Record a committed gesture, timestamped now
+ ****************************************************************************************
+ */
+void capture_gesture(uint8_t gestureCode)
+{
+	struct capture_chunk *chunk;
+
+	capture_close_chunk();
+	// A gesture that finds no free chunk is lost; the host sees the samples around it
+	if((chunk = capture_open_chunk(CAPTURE_CHUNK_GESTURE)) != NULL)
+	{
+		capture_put_varint(chunk, lld_evt_time_get() & CAPTURE_TIMESTAMP_MASK);
+		chunk->payload[chunk->length++] = gestureCode;
+		capture_close_chunk();
+	}
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Close the open chunk and write all buffered chunks to UART2
+ ****************************************************************************************
+ */
+void capture_close(void)
+{
+	capture_close_chunk();
+	capture_flush(CAPTURE_NUM_CHUNKS);
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Write up to maxChunks full chunks to UART2
+ ****************************************************************************************
+ */
+void capture_flush(uint8_t maxChunks)
+{
+	bool written = false;
+
+	while((maxChunks-- > 0) && (captureTail != captureHead))
+	{
+		const struct capture_chunk *chunk = &captureChunks[captureTail & (CAPTURE_NUM_CHUNKS - 1)];
+		uint8_t header[CAPTURE_CHUNK_HEADER_SIZE];
+		uint8_t checksum = chunk->type + chunk->length;
+
+		header[0] = CAPTURE_SYNC_0;
+		header[1] = CAPTURE_SYNC_1;
+		header[2] = chunk->type;
+		header[3] = chunk->length;
+		for(int i=0;i<chunk->length;i++)
+		{
+			checksum += chunk->payload[i];
+		}
+		uart_write_buffer(UART2, header, CAPTURE_CHUNK_HEADER_SIZE);
+		uart_write_buffer(UART2, chunk->payload, chunk->length);
+		uart_write_buffer(UART2, &checksum, 1);
+		captureTail++;
+		written = true;
+	}
+	if(written)
+	{
+		uart_wait_tx_finish(UART2);
+	}
+}
+
+#endif // CFG_CAPTURE
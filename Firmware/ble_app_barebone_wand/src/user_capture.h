@@ -0,0 +1,91 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_capture.h
+ *
+ * @brief Accelerometer capture. Raw samples are encoded into chunks in RAM and written
+ *        to UART2 when the system is about to sleep. See user_capture_format.h.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _USER_CAPTURE_H_
+#define _USER_CAPTURE_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include <stdint.h>
+#include "user_capture_format.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/* Payload bytes per chunk. A full chunk takes about 3ms at 115200 baud and holds 7 or 8   */
+/* samples of a wand at rest                                                                */
+#define CAPTURE_CHUNK_PAYLOAD               (32)
+
+/* Chunks buffered in RAM. Must be a power of two                                           */
+#define CAPTURE_NUM_CHUNKS                  (4)
+
+#if defined (CFG_CAPTURE)
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+ /**
+ ****************************************************************************************
+ * @brief Drop all buffered chunks
+ ****************************************************************************************
+ */
+void capture_init(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Append one sample, timestamped now. When no chunk is free the sample is dropped
+ *        and counted in the next chunk.
+ * @param[in] sample  XL_NUM_AXES cell array (x,y,z)
+ ****************************************************************************************
+ */
+void capture_sample(const int8_t *sample);
+
+ /**
+ ****************************************************************************************
+ * @brief Record a committed gesture, timestamped now
+ * @param[in] gestureCode  APP_GESTURE_CODE_x value
+ ****************************************************************************************
+ */
+void capture_gesture(uint8_t gestureCode);
+
+ /**
+ ****************************************************************************************
+ * @brief Close the open chunk and write all buffered chunks to UART2. Called before the
+ *        wand goes to sleep.
+ ****************************************************************************************
+ */
+void capture_close(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Write up to maxChunks full chunks to UART2 and wait for the UART to drain
+ * @param[in] maxChunks  chunks to write at most
+ ****************************************************************************************
+ */
+void capture_flush(uint8_t maxChunks);
+
+#else
+
+#define capture_init()
+#define capture_sample(sample)
+#define capture_gesture(gestureCode)
+#define capture_close()
+#define capture_flush(maxChunks)
+
+#endif // CFG_CAPTURE
+
+#endif // _USER_CAPTURE_H_
@@ -0,0 +1,74 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_capture_format.h
+ *
+ * @brief Accelerometer capture wire and file format, shared with the host tools.
+ *
+ * This header is included by Firmware/host/capture, so it must not depend on the SDK.
+ *
+ * A capture is a sequence of chunks. On UART2 the chunks are sent as they fill up; a
+ * corpus file is CAPTURE_FILE_HEADER_SIZE bytes of header followed by the same chunks.
+ *
+ * Chunk: CAPTURE_SYNC_0, CAPTURE_SYNC_1, type, payload length, payload, 8-bit sum of
+ * type, length and payload. Every chunk decodes on its own, so a lost or corrupted chunk
+ * only loses its own samples.
+ *
+ * Numbers in the payload are unsigned LEB128 varints: 7 bits per byte, least significant
+ * group first, bit 7 set on every byte but the last. Signed values are zigzag encoded
+ * first (0, -1, 1, -2 ... become 0, 1, 2, 3 ...).
+ *
+ * SAMPLES payload: dropped samples before this chunk (uint8_t, saturating), then one
+ * record per sample: timestamp delta, X delta, Y delta, Z delta. Deltas are taken from
+ * the previous sample of the chunk, the first sample of a chunk from zero, so the first
+ * record carries the absolute timestamp and axes. The axis deltas are zigzag encoded.
+ * A sample at rest costs four bytes.
+ *
+ * GESTURE payload: timestamp, gesture code. Written by the firmware when it commits a
+ * gesture.
+ *
+ * LABEL payload: start timestamp, length in ticks, gesture code. Ground truth added to a
+ * corpus file on the host; the firmware never sends it.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _USER_CAPTURE_FORMAT_H_
+#define _USER_CAPTURE_FORMAT_H_
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/* Chunk framing. The sync differs from the event trace (TRACE_SYNC_x) so both can share    */
+/* UART2                                                                                    */
+#define CAPTURE_SYNC_0                      (0xC3)
+#define CAPTURE_SYNC_1                      (0x3C)
+#define CAPTURE_CHUNK_HEADER_SIZE           (4)
+#define CAPTURE_CHUNK_MAX_PAYLOAD           (255)
+
+/* Chunk types                                                                              */
+#define CAPTURE_CHUNK_SAMPLES               (0x01)
+#define CAPTURE_CHUNK_GESTURE               (0x02)
+#define CAPTURE_CHUNK_LABEL                 (0x03)
+
+/* Largest encoded sample: 27-bit timestamp delta (4 bytes) and three axis deltas in        */
+/* -255..255 (2 bytes each)                                                                 */
+#define CAPTURE_SAMPLE_MAX_SIZE             (10)
+
+/* Timestamps count BLE slots and wrap at 27 bits, as lld_evt_time_get()                    */
+#define CAPTURE_TICK_NS                     (625000)
+#define CAPTURE_TIMESTAMP_MASK              (0x07FFFFFF)
+
+/* Corpus file header: CAPTURE_FILE_MAGIC, format version, sample rate in Hz (uint16_t,    */
+/* little endian), reserved                                                                 */
+#define CAPTURE_FILE_MAGIC                  "WCAP"
+#define CAPTURE_FILE_VERSION                (1)
+#define CAPTURE_FILE_HEADER_SIZE            (8)
+
+/* Zigzag encoding of a signed axis delta                                                   */
+#define CAPTURE_ZIGZAG(value)               ((uint16_t)(((value) < 0) ? ((-(value) * 2) - 1) : ((value) * 2)))
+#define CAPTURE_UNZIGZAG(value)             (((value) & 1) ? -(int32_t)(((value) + 1) >> 1) : (int32_t)((value) >> 1))
+
+#endif // _USER_CAPTURE_FORMAT_H_
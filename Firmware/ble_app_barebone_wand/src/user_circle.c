@@ -0,0 +1,125 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_circle.c
+ *
+ * @brief Circle gesture detection by tracking the phase of the X/Y linear acceleration.
+ *
+ * While the tip draws a circle the linear acceleration vector turns with it. The phase
+ * steps between samples are unwrapped into a signed running total; a full turn in one
+ * direction, with enough magnitude and no reversals, is a circle.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "user_circle.h"
+#include "compiler.h"
+
+#if (CFG_GESTURE_STAGE_CIRCLE)
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+// Everything the module keeps across sleep, see struct circle_retained
+struct circle_retained circleRetained           __SECTION_ZERO("retention_mem_area0"); //@RETENTION MEMORY
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+ /**
+ ****************************************************************************************
+ * @brief Restart the phase tracking
+ ****************************************************************************************
+ */
+void circle_init(void)
+{
+	circleRetained.rotation = 0;
+	circleRetained.gapCounter = 0;
+	circleRetained.sampleCounter = 0;
+	circleRetained.tracking = false;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Keep the time limits of a circle at a lower sample rate
+ ****************************************************************************************
+ */
+void circle_set_rate(uint8_t rateShift)
+{
+	// At least one weak sample is always tolerated
+	circleRetained.maxGap = (CIRCLE_MAX_GAP >> rateShift) ? (CIRCLE_MAX_GAP >> rateShift) : 1;
+	circleRetained.maxSamples = CIRCLE_MAX_SAMPLES >> rateShift;
+	circle_init();
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Feed one linear acceleration sample of the X and Y axes
+ ****************************************************************************************
+ */
+enum circle_direction circle_update(int8_t xLinear, int8_t yLinear)
+{
+	uint8_t phase;
+	int8_t phaseStep;
+	enum circle_direction direction;
+
+	if((abs(xLinear) + abs(yLinear)) < CIRCLE_MIN_MAGNITUDE)
+	{
+		if(circleRetained.tracking && (++circleRetained.gapCounter > circleRetained.maxGap))
+		{
+			circle_init();
+		}
+		return CIRCLE_NONE;
+	}
+	circleRetained.gapCounter = 0;
+
+	phase = angle_atan2(yLinear, xLinear);
+	if(!circleRetained.tracking)
+	{
+		circleRetained.previousPhase = phase;
+		circleRetained.tracking = true;
+		return CIRCLE_NONE;
+	}
+
+	phaseStep = angle_delta(circleRetained.previousPhase, phase);
+	circleRetained.previousPhase = phase;
+
+	// Too slow, a reversal of a straight swing or a change of direction
+	if((++circleRetained.sampleCounter > circleRetained.maxSamples) ||
+		(abs(phaseStep) > CIRCLE_MAX_STEP) ||
+		((phaseStep > CIRCLE_MAX_BACKSTEP) && (circleRetained.rotation < 0)) ||
+		((phaseStep < -CIRCLE_MAX_BACKSTEP) && (circleRetained.rotation > 0)))
+	{
+		circle_init();
+		circleRetained.previousPhase = phase;
+		circleRetained.tracking = true;
+		return CIRCLE_NONE;
+	}
+
+	circleRetained.rotation += phaseStep;
+	if(abs(circleRetained.rotation) < CIRCLE_TURN_THRESHOLD)
+	{
+		return CIRCLE_NONE;
+	}
+
+	// Counter-clockwise phase rotation in the sensor frame
+	direction = (circleRetained.rotation > 0) ? CIRCLE_ANTICLOCKWISE : CIRCLE_CLOCKWISE;
+	circle_init();
+	circleRetained.previousPhase = phase;
+	circleRetained.tracking = true;
+	return direction;
+}
+
+#endif // CFG_GESTURE_STAGE_CIRCLE
@@ -0,0 +1,110 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_circle.h
+ *
+ * @brief Circle gesture detection by tracking the phase of the X/Y linear acceleration.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _USER_CIRCLE_H_
+#define _USER_CIRCLE_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "user_angle.h"
+#include "user_gesture_config.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/* Linear acceleration (|x|+|y| in counts) below which the phase is not tracked              */
+#define CIRCLE_MIN_MAGNITUDE                (12)
+
+/* Largest phase step between two samples that still counts as rotation. A straight swing    */
+/* flips the phase by half a turn when it reverses and restarts the tracking                 */
+#define CIRCLE_MAX_STEP                     ANGLE_DEG_TO_BRAD(60)
+
+/* Largest phase step against the direction of the rotation so far that is taken as noise   */
+#define CIRCLE_MAX_BACKSTEP                 ANGLE_DEG_TO_BRAD(20)
+
+/* Weak samples tolerated in a row before the tracking restarts                              */
+#define CIRCLE_MAX_GAP                      (5)     // 5*10ms = 50ms
+
+/* Time allowed to complete a circle                                                         */
+#define CIRCLE_MAX_SAMPLES                  CFG_GESTURE_CIRCLE_MAX_SAMPLES
+
+/* Accumulated rotation reported as a circle                                                 */
+#define CIRCLE_TURN_THRESHOLD               ANGLE_FULL_TURN
+
+/// Result of circle_update()
+enum circle_direction
+{
+	CIRCLE_NONE = 0,
+	/// Clockwise in the X/Y plane of the sensor
+	CIRCLE_CLOCKWISE,
+	CIRCLE_ANTICLOCKWISE
+};
+
+/* Retention RAM of the stage, struct circle_retained                                       */
+#define CIRCLE_RETAINED_SIZE                ((CFG_GESTURE_STAGE_CIRCLE) ? sizeof(struct circle_retained) : 0)
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// State of user_circle.c kept in retention RAM
+struct circle_retained
+{
+	/// Phase turned since the tracking started, signed
+	int16_t rotation;
+	uint8_t previousPhase;
+	/// Weak samples in a row
+	uint8_t gapCounter;
+	uint8_t sampleCounter;
+	bool tracking;
+	/// CIRCLE_MAX_GAP and CIRCLE_MAX_SAMPLES at the sample rate
+	uint8_t maxGap;
+	uint8_t maxSamples;
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+ /**
+ ****************************************************************************************
+ * @brief Restart the phase tracking
+ ****************************************************************************************
+ */
+void circle_init(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Keep the time limits of a circle at a lower sample rate
+ * @param[in] rateShift  samples arrive every 1 << rateShift sample ticks
+ ****************************************************************************************
+ */
+void circle_set_rate(uint8_t rateShift);
+
+ /**
+ ****************************************************************************************
+ * @brief Feed one linear acceleration sample of the X and Y axes
+ * @param[in] xLinear  X-axis linear acceleration in counts
+ * @param[in] yLinear  Y-axis linear acceleration in counts
+ * @return CIRCLE_CLOCKWISE or CIRCLE_ANTICLOCKWISE once per completed circle,
+ *         CIRCLE_NONE otherwise
+ ****************************************************************************************
+ */
+enum circle_direction circle_update(int8_t xLinear, int8_t yLinear);
+
+#endif // _USER_CIRCLE_H_
@@ -0,0 +1,113 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_direction.c
+ *
+ * @brief Left/right/up/down swing detection from the averaged X and Y axes.
+ *
+ * The samples are kept packed (see user_swar.h) in a window where older samples decay,
+ * so one pass over the window both ages the samples and sums all three axes.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include "user_direction.h"
+#include "user_gesture.h"
+#include "user_swar.h"
+#include "compiler.h"
+
+#if (CFG_GESTURE_STAGE_DIRECTION)
+
+#if (DIRECTION_DECAY_SHIFT <= CFG_GESTURE_MAX_RATE_SHIFT)
+    #error "the window decay needs a shift left at the lowest pipeline rate"
+#endif
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+// Everything the module keeps across sleep, see struct direction_retained
+struct direction_retained directionRetained     __SECTION_ZERO("retention_mem_area0"); //@RETENTION MEMORY
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+ /**
+ ****************************************************************************************
+ * @brief Clear the averaging window
+ ****************************************************************************************
+ */
+void direction_init(void)
+{
+	for(int i=0;i<DIRECTION_WINDOW;i++)
+	{
+		directionRetained.window[i] = 0;
+	}
+	directionRetained.windowIndex = 0;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Keep the length and the decay of the window in time at a lower sample rate
+ ****************************************************************************************
+ */
+void direction_set_rate(uint8_t rateShift)
+{
+	directionRetained.rateShift = rateShift;
+	direction_init();
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Feed one accelerometer sample
+ ****************************************************************************************
+ */
+uint8_t direction_update(const int8_t *sample)
+{
+	int16_t sum[XL_NUM_AXES];
+	int8_t average[XL_NUM_AXES];
+	uint8_t largestAxis;
+	uint16_t windowLength = DIRECTION_WINDOW >> directionRetained.rateShift;
+
+	// Decay the stored samples, store the new one and sum all axes in one pass. A sample
+	// stands for 1 << directionRetained.rateShift ticks, so it decays that much faster
+	swar_window_update(directionRetained.window, windowLength, directionRetained.windowIndex,
+		swar_pack(sample), DIRECTION_DECAY_SHIFT - directionRetained.rateShift, sum);
+
+	if(directionRetained.windowIndex<(windowLength-1))
+	{
+		directionRetained.windowIndex++;
+	}
+	else
+	{
+		directionRetained.windowIndex = 0;
+	}
+
+	// Only X and Y take part in the direction decision. Scaling the sum up keeps the
+	// division by a constant
+	average[XL_AXIS_X] = (int8_t)((sum[XL_AXIS_X] * (1 << directionRetained.rateShift))/DIRECTION_WINDOW);
+	average[XL_AXIS_Y] = (int8_t)((sum[XL_AXIS_Y] * (1 << directionRetained.rateShift))/DIRECTION_WINDOW);
+	average[XL_AXIS_Z] = 0;
+
+	if(swar_abs_max(swar_pack(average), &largestAxis) <= DIRECTION_THRESHOLD)
+	{
+		return APP_GESTURE_CODE_NONE;
+	}
+
+	if(largestAxis == XL_AXIS_X)
+	{
+		return (average[XL_AXIS_X]>0) ? APP_GESTURE_CODE_LEFT : APP_GESTURE_CODE_RIGHT;
+	}
+	return (average[XL_AXIS_Y]>0) ? APP_GESTURE_CODE_DOWN : APP_GESTURE_CODE_UP;
+}
+
+#endif // CFG_GESTURE_STAGE_DIRECTION
@@ -0,0 +1,83 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_direction.h
+ *
+ * @brief Left/right/up/down swing detection from the averaged X and Y axes.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _USER_DIRECTION_H_
+#define _USER_DIRECTION_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include <stdint.h>
+#include "user_gesture_config.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/* Samples in the averaging window at the sample tick; a lower rate averages fewer, so the   */
+/* window keeps its length in time                                                           */
+#define DIRECTION_WINDOW                    CFG_GESTURE_DIRECTION_WINDOW
+
+/* Stored samples lose 1/2^DIRECTION_DECAY_SHIFT of their value per sample                   */
+#define DIRECTION_DECAY_SHIFT               (3)
+
+/* Averaged magnitude of the dominant axis above which a swing is reported                   */
+#define DIRECTION_THRESHOLD                 CFG_GESTURE_DIRECTION_THRESHOLD
+
+/* Retention RAM of the stage, struct direction_retained                                    */
+#define DIRECTION_RETAINED_SIZE             ((CFG_GESTURE_STAGE_DIRECTION) ? sizeof(struct direction_retained) : 0)
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// State of user_direction.c kept in retention RAM
+struct direction_retained
+{
+	/// Averaging window, one packed x/y/z sample per word
+	uint32_t window[DIRECTION_WINDOW];
+	uint16_t windowIndex;
+	uint8_t rateShift;
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+ /**
+ ****************************************************************************************
+ * @brief Clear the averaging window
+ ****************************************************************************************
+ */
+void direction_init(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Keep the length and the decay of the window in time at a lower sample rate
+ * @param[in] rateShift  samples arrive every 1 << rateShift sample ticks
+ ****************************************************************************************
+ */
+void direction_set_rate(uint8_t rateShift);
+
+ /**
+ ****************************************************************************************
+ * @brief Feed one accelerometer sample
+ * @param[in] sample XL_NUM_AXES cell array (x,y,z)
+ * @return APP_GESTURE_CODE_LEFT/RIGHT/DOWN/UP while the average is past the threshold,
+ *         APP_GESTURE_CODE_NONE otherwise
+ ****************************************************************************************
+ */
+uint8_t direction_update(const int8_t *sample);
+
+#endif // _USER_DIRECTION_H_
@@ -0,0 +1,191 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_energy.c
+ *
+ * @brief Per-subsystem activity counters for the energy model in Firmware/host/energy_model.
+ *
+ * The firmware only counts time and traffic; the host tool multiplies them by the
+ * datasheet currents. Times come from the BLE timer, which keeps running in sleep,
+ * so awake and sleep periods are both measured on the same 625us time base.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "user_energy.h"
+
+#if defined (CFG_ENERGY_COUNTERS)
+
+#include "compiler.h"
+#include "lld_evt.h"
+#include "user_trace.h"
+#include "user_battery.h"
+
+#if !defined (CFG_TRACE)
+    #error "CFG_ENERGY_COUNTERS is read out over the trace and needs CFG_TRACE"
+#endif
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/* lld_evt_time_get() counts BLE slots in 27 bits                                           */
+#define ENERGY_TIME_MASK                    (0x07FFFFFFUL)
+
+/* The trace carries 24-bit counter values                                                  */
+#define ENERGY_REPORT_MAX                   (0x00FFFFFFUL)
+
+// energy_report() walks the counters and the ENERGY trace events in step
+typedef char energy_trace_events_match[((TRACE_EVT_ENERGY_WAKEUPS - TRACE_EVT_ENERGY_AWAKE_SLOTS) ==
+	(ENERGY_WAKEUPS - ENERGY_AWAKE_SLOTS)) ? 1 : -1];
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+// Everything the module keeps across sleep, see struct energy_retained
+struct energy_retained energyRetained           __SECTION_ZERO("retention_mem_area0"); //@RETENTION MEMORY
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+ /**
+ ****************************************************************************************
+ * @brief Slots since a timestamp, moving the timestamp to now
+ ****************************************************************************************
+ */
+static uint32_t energy_elapsed(uint32_t *since)
+{
+	uint32_t now = lld_evt_time_get();
+	uint32_t elapsed = (now - *since) & ENERGY_TIME_MASK;
+
+	*since = now;
+	return elapsed;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Clear the counters and start timing the awake period
+ ****************************************************************************************
+ */
+void energy_init(void)
+{
+	for(int i=0;i<ENERGY_NUM_COUNTERS;i++)
+	{
+		energyRetained.counters[i] = 0;
+	}
+	energyRetained.lastEdge = lld_evt_time_get();
+	energyRetained.active = 0;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief The system is about to sleep
+ ****************************************************************************************
+ */
+void energy_sleep_enter(void)
+{
+	energyRetained.counters[ENERGY_AWAKE_SLOTS] += energy_elapsed(&energyRetained.lastEdge);
+}
+
+ /**
+ ****************************************************************************************
+ * @brief The system woke up
+ ****************************************************************************************
+ */
+void energy_sleep_exit(void)
+{
+	energyRetained.counters[ENERGY_SLEEP_SLOTS] += energy_elapsed(&energyRetained.lastEdge);
+	energyRetained.counters[ENERGY_WAKEUPS]++;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Count I2C traffic
+ ****************************************************************************************
+ */
+void energy_i2c(uint16_t bytes)
+{
+	energyRetained.counters[ENERGY_I2C_TRANSACTIONS]++;
+	energyRetained.counters[ENERGY_I2C_BYTES] += bytes;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Start timing a subsystem
+ ****************************************************************************************
+ */
+void energy_on(uint8_t counter)
+{
+	if(!(energyRetained.active & (1UL << counter)))
+	{
+		energyRetained.start[counter] = lld_evt_time_get();
+		energyRetained.active |= (1UL << counter);
+	}
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Stop timing a subsystem and add its on-time
+ ****************************************************************************************
+ */
+void energy_off(uint8_t counter)
+{
+	if(energyRetained.active & (1UL << counter))
+	{
+		energyRetained.counters[counter] += energy_elapsed(&energyRetained.start[counter]);
+		energyRetained.active &= ~(1UL << counter);
+	}
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Count one accelerometer sample
+ ****************************************************************************************
+ */
+void energy_sample(void)
+{
+	energyRetained.counters[ENERGY_SAMPLES]++;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Write the counters to the trace and start a new reporting period
+ ****************************************************************************************
+ */
+void energy_report(void)
+{
+	// Close the periods still running so they are reported in this period
+	energyRetained.counters[ENERGY_AWAKE_SLOTS] += energy_elapsed(&energyRetained.lastEdge);
+	for(uint8_t i=0;i<ENERGY_NUM_COUNTERS;i++)
+	{
+		if(energyRetained.active & (1UL << i))
+		{
+			energyRetained.counters[i] += energy_elapsed(&energyRetained.start[i]);
+		}
+	}
+	energyRetained.counters[ENERGY_ADV_INTERVAL_SLOTS] = user_adv_conf.intv_max * battery_current()->adv;
+
+	// Make room for the report
+	trace_flush(TRACE_RING_LEN);
+	for(uint8_t i=0;i<ENERGY_NUM_COUNTERS;i++)
+	{
+		uint32_t value = (energyRetained.counters[i] > ENERGY_REPORT_MAX) ? ENERGY_REPORT_MAX : energyRetained.counters[i];
+
+		TRACE_EVENT(TRACE_EVT_ENERGY_AWAKE_SLOTS + i, (uint8_t)(value >> 16), (uint16_t)value);
+		energyRetained.counters[i] = 0;
+	}
+}
+
+#endif // CFG_ENERGY_COUNTERS
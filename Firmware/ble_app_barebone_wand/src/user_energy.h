@@ -0,0 +1,146 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_energy.h
+ *
+ * @brief Per-subsystem activity counters for the energy model in Firmware/host/energy_model.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _USER_ENERGY_H_
+#define _USER_ENERGY_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include <stdint.h>
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/* Counters. Times are in BLE slots of 625us. X(name)                                        */
+#define ENERGY_COUNTERS(X)                  \
+	X(AWAKE_SLOTS)                          \
+	X(SLEEP_SLOTS)                          \
+	X(I2C_TRANSACTIONS)                     \
+	X(I2C_BYTES)                            \
+	X(ADV_SLOTS)                            \
+	X(ADV_INTERVAL_SLOTS)                   \
+	X(MOTOR_SLOTS)                          \
+	X(XL_ACTIVE_SLOTS)                      \
+	X(SAMPLES)                              \
+	X(WAKEUPS)
+
+#define ENERGY_COUNTER_ENUM(name)           ENERGY_##name,
+
+/// Counter identifiers
+enum energy_counter
+{
+	ENERGY_COUNTERS(ENERGY_COUNTER_ENUM)
+	ENERGY_NUM_COUNTERS
+};
+
+#if defined (CFG_ENERGY_COUNTERS)
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// State of user_energy.c kept in retention RAM
+struct energy_retained
+{
+	uint32_t counters[ENERGY_NUM_COUNTERS];
+	/// Start of the running period of every timed counter
+	uint32_t start[ENERGY_NUM_COUNTERS];
+	uint32_t lastEdge;
+	/// One bit per timed counter that is running
+	uint32_t active;
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+ /**
+ ****************************************************************************************
+ * @brief Clear the counters and start timing the awake period
+ ****************************************************************************************
+ */
+void energy_init(void);
+
+ /**
+ ****************************************************************************************
+ * @brief The system is about to sleep (app_going_to_sleep callback)
+ ****************************************************************************************
+ */
+void energy_sleep_enter(void);
+
+ /**
+ ****************************************************************************************
+ * @brief The system woke up (app_resume_from_sleep callback)
+ ****************************************************************************************
+ */
+void energy_sleep_exit(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Count I2C traffic
+ * @param[in] bytes  bytes moved by one transaction
+ ****************************************************************************************
+ */
+void energy_i2c(uint16_t bytes);
+
+ /**
+ ****************************************************************************************
+ * @brief Start timing a subsystem. Does nothing if it is already on.
+ * @param[in] counter  ENERGY_ADV_SLOTS, ENERGY_MOTOR_SLOTS or ENERGY_XL_ACTIVE_SLOTS
+ ****************************************************************************************
+ */
+void energy_on(uint8_t counter);
+
+ /**
+ ****************************************************************************************
+ * @brief Stop timing a subsystem and add its on-time. Does nothing if it is off.
+ * @param[in] counter  ENERGY_ADV_SLOTS, ENERGY_MOTOR_SLOTS or ENERGY_XL_ACTIVE_SLOTS
+ ****************************************************************************************
+ */
+void energy_off(uint8_t counter);
+
+ /**
+ ****************************************************************************************
+ * @brief Count one accelerometer sample
+ ****************************************************************************************
+ */
+void energy_sample(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Write the counters to the trace and start a new reporting period
+ ****************************************************************************************
+ */
+void energy_report(void);
+
+#define ENERGY_I2C(bytes)                   energy_i2c(bytes)
+#define ENERGY_RETAINED_SIZE                (sizeof(struct energy_retained))
+
+#else
+
+#define ENERGY_RETAINED_SIZE                (0)
+#define energy_init()
+#define energy_sleep_enter()
+#define energy_sleep_exit()
+#define energy_on(counter)
+#define energy_off(counter)
+#define energy_sample()
+#define energy_report()
+#define ENERGY_I2C(bytes)
+
+#endif // CFG_ENERGY_COUNTERS
+
+#endif // _USER_ENERGY_H_
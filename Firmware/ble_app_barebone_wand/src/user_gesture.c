@@ -0,0 +1,239 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_gesture.c
+ *
+ * @brief Gesture pipeline built from the stages enabled in user_gesture_config.h.
+ *
+ * Every stage is an X(name, bypassLockout) entry of GESTURE_PIPELINE_STAGES. A stage
+ * disabled in the configuration expands to nothing, so neither its call nor (with the
+ * module source guarded by the same flag) its code and RAM end up in the image.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "user_gesture.h"
+#include "user_motion.h"
+#include "user_direction.h"
+#include "user_shake.h"
+#include "user_twist.h"
+#include "user_circle.h"
+#include "user_latency.h"
+#include "compiler.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/* Stage table entries, X(name, bypassLockout). Shakes and circles cross the direction       */
+/* thresholds on their way, so they are reported even while that lockout holds              */
+#if (CFG_GESTURE_STAGE_DIRECTION)
+#define GESTURE_STAGE_DIRECTION(X)          X(direction, false)
+#else
+#define GESTURE_STAGE_DIRECTION(X)
+#endif
+
+#if (CFG_GESTURE_STAGE_SHAKE)
+#define GESTURE_STAGE_SHAKE(X)              X(shake, true)
+#else
+#define GESTURE_STAGE_SHAKE(X)
+#endif
+
+#if (CFG_GESTURE_STAGE_TWIST)
+#define GESTURE_STAGE_TWIST(X)              X(twist, false)
+#else
+#define GESTURE_STAGE_TWIST(X)
+#endif
+
+#if (CFG_GESTURE_STAGE_CIRCLE)
+#define GESTURE_STAGE_CIRCLE(X)             X(circle, true)
+#else
+#define GESTURE_STAGE_CIRCLE(X)
+#endif
+
+/* Stages in the order they see every sample                                                 */
+#define GESTURE_PIPELINE_STAGES(X)          \
+	GESTURE_STAGE_DIRECTION(X)              \
+	GESTURE_STAGE_SHAKE(X)                  \
+	GESTURE_STAGE_TWIST(X)                  \
+	GESTURE_STAGE_CIRCLE(X)
+
+#define GESTURE_STAGE_INIT(name, bypassLockout)     name##_init();
+#define GESTURE_STAGE_RESET(name, bypassLockout)    gesture_##name##_reset();
+#define GESTURE_STAGE_SET_RATE(name, bypassLockout) name##_set_rate(rateShift);
+#define GESTURE_STAGE_RUN(name, bypassLockout)      gesture_stage_run(gesture_##name##_update(sample), (bypassLockout), &lockedOut);
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+// Everything the module keeps across sleep, see struct gesture_retained
+struct gesture_retained gestureRetained         __SECTION_ZERO("retention_mem_area0"); //@RETENTION MEMORY
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+#if (CFG_GESTURE_STAGE_DIRECTION)
+static void gesture_direction_reset(void)
+{
+	direction_init();
+}
+
+static uint8_t gesture_direction_update(const int8_t *sample)
+{
+	return direction_update(sample);
+}
+#endif
+
+#if (CFG_GESTURE_STAGE_SHAKE)
+static void gesture_shake_reset(void)
+{
+	// Keep the Goertzel coefficients, only the running block is stale
+	shake_reset();
+}
+
+static uint8_t gesture_shake_update(const int8_t *sample)
+{
+	return shake_update(motion_linear(XL_AXIS_X), motion_linear(XL_AXIS_Y)) ? APP_GESTURE_CODE_SHAKE : APP_GESTURE_CODE_NONE;
+}
+#endif
+
+#if (CFG_GESTURE_STAGE_TWIST)
+static void gesture_twist_reset(void)
+{
+	twist_init();
+}
+
+static uint8_t gesture_twist_update(const int8_t *sample)
+{
+	switch(twist_update())
+	{
+		case TWIST_CLOCKWISE:
+			return APP_GESTURE_CODE_TWIST_CW;
+		case TWIST_COUNTER_CLOCKWISE:
+			return APP_GESTURE_CODE_TWIST_CCW;
+		default:
+			return APP_GESTURE_CODE_NONE;
+	}
+}
+#endif
+
+#if (CFG_GESTURE_STAGE_CIRCLE)
+static void gesture_circle_reset(void)
+{
+	circle_init();
+}
+
+static uint8_t gesture_circle_update(const int8_t *sample)
+{
+	switch(circle_update(motion_linear(XL_AXIS_X), motion_linear(XL_AXIS_Y)))
+	{
+		case CIRCLE_CLOCKWISE:
+			return APP_GESTURE_CODE_CIRCLE_CW;
+		case CIRCLE_ANTICLOCKWISE:
+			return APP_GESTURE_CODE_CIRCLE_ACW;
+		default:
+			return APP_GESTURE_CODE_NONE;
+	}
+}
+#endif
+
+ /**
+ ****************************************************************************************
+ * @brief Commit the result of one stage unless the lockout holds it back
+ ****************************************************************************************
+ */
+static inline void gesture_stage_run(uint8_t gestureCode, bool bypassLockout, bool *lockedOut)
+{
+	if(gestureCode == APP_GESTURE_CODE_NONE)
+	{
+		return;
+	}
+	LATENCY_DETECTED();
+	if(bypassLockout || !*lockedOut)
+	{
+		gestureRetained.commitCallback(gestureCode);
+		// Committing arms the lockout for the stages that follow
+		*lockedOut = true;
+	}
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Initialize the enabled stages
+ ****************************************************************************************
+ */
+void gesture_pipeline_init(gesture_commit_cb_t commit)
+{
+	gestureRetained.commitCallback = commit;
+#if (CFG_GESTURE_USES_MOTION)
+	motion_init();
+#endif
+	GESTURE_PIPELINE_STAGES(GESTURE_STAGE_INIT)
+	gestureRetained.ticks = 0;
+	gesture_pipeline_set_rate(1);
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Scale the windows of the enabled stages to a lower sample rate and restart them
+ ****************************************************************************************
+ */
+void gesture_pipeline_set_rate(uint8_t ticks)
+{
+	uint8_t rateShift = 0;
+
+	if(ticks == gestureRetained.ticks)
+	{
+		return;
+	}
+	gestureRetained.ticks = ticks;
+
+	// Power of two ticks, checked against the battery levels that ask for them
+	while((1 << rateShift) < ticks)
+	{
+		rateShift++;
+	}
+#if (CFG_GESTURE_USES_MOTION)
+	motion_set_rate(rateShift);
+	motion_init();
+#endif
+	GESTURE_PIPELINE_STAGES(GESTURE_STAGE_SET_RATE)
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Restart the enabled stages
+ ****************************************************************************************
+ */
+void gesture_pipeline_reset(void)
+{
+#if (CFG_GESTURE_USES_MOTION)
+	motion_init();
+#endif
+	GESTURE_PIPELINE_STAGES(GESTURE_STAGE_RESET)
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Run one accelerometer sample through the enabled stages
+ ****************************************************************************************
+ */
+void gesture_pipeline_update(const int8_t *sample, bool lockedOut)
+{
+#if (CFG_GESTURE_USES_MOTION)
+	motion_update(sample);
+#endif
+	GESTURE_PIPELINE_STAGES(GESTURE_STAGE_RUN)
+}
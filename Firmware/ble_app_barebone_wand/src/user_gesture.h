@@ -0,0 +1,96 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_gesture.h
+ *
+ * @brief Gesture pipeline built from the stages enabled in user_gesture_config.h.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _USER_GESTURE_H_
+#define _USER_GESTURE_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "user_gesture_config.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+#define GESTURE_CODE_ENUM(name, code)       APP_GESTURE_CODE_##name = (code),
+
+/// Gesture codes stored in the manufacturer specific data
+enum app_gesture_code
+{
+	/// No gesture in this sample
+	APP_GESTURE_CODE_NONE = 0,
+	CFG_GESTURE_ALPHABET(GESTURE_CODE_ENUM)
+};
+
+/* Retention RAM of the pipeline, struct gesture_retained                                   */
+#define GESTURE_RETAINED_SIZE               (sizeof(struct gesture_retained))
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Called with every recognised gesture
+typedef void (*gesture_commit_cb_t)(uint8_t gestureCode);
+
+/// State of user_gesture.c kept in retention RAM
+struct gesture_retained
+{
+	gesture_commit_cb_t commitCallback;
+	/// Sample ticks per run the stages are scaled to, 0 before the first
+	uint8_t ticks;
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+ /**
+ ****************************************************************************************
+ * @brief Initialize the enabled stages
+ * @param[in] commit  called with every recognised gesture
+ ****************************************************************************************
+ */
+void gesture_pipeline_init(gesture_commit_cb_t commit);
+
+ /**
+ ****************************************************************************************
+ * @brief Restart the enabled stages, e.g. after waking up, without touching the
+ *        state computed once at initialization
+ ****************************************************************************************
+ */
+void gesture_pipeline_reset(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Scale the windows of the enabled stages to a lower sample rate, so they keep
+ *        their length in time, and restart them. Nothing happens at the current rate.
+ * @param[in] ticks  sample ticks between two samples: 1, 2, ... 1 << CFG_GESTURE_MAX_RATE_SHIFT
+ ****************************************************************************************
+ */
+void gesture_pipeline_set_rate(uint8_t ticks);
+
+ /**
+ ****************************************************************************************
+ * @brief Run one accelerometer sample through the enabled stages
+ * @param[in] sample      XL_NUM_AXES cell array (x,y,z)
+ * @param[in] lockedOut   true while a recent gesture blocks the stages that respect
+ *                        the lockout
+ ****************************************************************************************
+ */
+void gesture_pipeline_update(const int8_t *sample, bool lockedOut);
+
+#endif // _USER_GESTURE_H_
@@ -0,0 +1,183 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_haptic.c
+ *
+ * @brief Haptic patterns on the vibration motor, driven by the Timer0 PWM.
+ *
+ * The motor pad is a GPIO output while the motor is off or fully driven, and the PWM0
+ * output of Timer0 for any other duty.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "user_haptic.h"
+#include "user_periph_setup.h"
+#include "compiler.h"
+#include "gpio.h"
+#include "timer0.h"
+#include "timer0_2.h"
+#include "app_easy_timer.h"
+#include "user_trace.h"
+#include "user_energy.h"
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+#define HAPTIC_PATTERN_DESC(name, duty, on, off, repeat) {(duty), (on), (off), (repeat)},
+
+static const struct haptic_pattern hapticPatterns[HAPTIC_NUM_PATTERNS] =
+{
+	HAPTIC_PATTERNS(HAPTIC_PATTERN_DESC)
+};
+
+#define HAPTIC_PATTERN_CHECK(name, duty, on, off, repeat) \
+	typedef char haptic_pattern_##name[(((duty) <= 100) && ((on) > 0) && ((repeat) > 0)) ? 1 : -1];
+HAPTIC_PATTERNS(HAPTIC_PATTERN_CHECK)
+
+// Everything the module keeps across sleep, see struct haptic_retained
+struct haptic_retained hapticRetained           __SECTION_ZERO("retention_mem_area0"); //@RETENTION MEMORY
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+static void haptic_timer_cb(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Drive the motor at a duty, 0 for off
+ ****************************************************************************************
+ */
+static void haptic_output(uint8_t duty)
+{
+	if((duty > 0) && (duty < 100))
+	{
+		uint16_t high = (uint16_t)(((uint32_t)HAPTIC_PWM_PERIOD * duty) / 100);
+		tim0_2_clk_div_config_t clkDiv = { .clk_div = TIM0_2_CLK_DIV_1 };
+
+		timer0_2_clk_enable();
+		timer0_2_clk_div_set(&clkDiv);
+		timer0_init(TIM0_CLK_FAST, PWM_MODE_ONE, TIM0_CLK_NO_DIV);
+		timer0_set(HAPTIC_PWM_PERIOD, high, HAPTIC_PWM_PERIOD - high);
+		timer0_start();
+		GPIO_ConfigurePin(MOTOR_PORT, MOTOR_PIN, OUTPUT, PID_PWM0, false);
+		hapticRetained.pwm = true;
+	}
+	else
+	{
+		GPIO_ConfigurePin(MOTOR_PORT, MOTOR_PIN, OUTPUT, PID_GPIO, duty > 0);
+		if(hapticRetained.pwm)
+		{
+			timer0_stop();
+			timer0_2_clk_disable();
+			hapticRetained.pwm = false;
+		}
+	}
+
+	if((duty > 0) && !hapticRetained.driven)
+	{
+		energy_on(ENERGY_MOTOR_SLOTS);
+	}
+	else if((duty == 0) && hapticRetained.driven)
+	{
+		energy_off(ENERGY_MOTOR_SLOTS);
+	}
+	hapticRetained.driven = (duty > 0);
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Start the next pulse of the pattern
+ ****************************************************************************************
+ */
+static void haptic_pulse(const struct haptic_pattern *pattern)
+{
+	hapticRetained.pulsesLeft--;
+	haptic_output(hapticRetained.duty);
+	hapticRetained.timer = app_easy_timer(pattern->on, haptic_timer_cb);
+}
+
+ /**
+ ****************************************************************************************
+ * @brief End of a pulse or a gap
+ ****************************************************************************************
+ */
+static void haptic_timer_cb(void)
+{
+	const struct haptic_pattern *pattern = &hapticPatterns[hapticRetained.pattern];
+
+	hapticRetained.timer = EASY_TIMER_INVALID_TIMER;
+	if((hapticRetained.pulsesLeft > 0) && hapticRetained.driven && (pattern->off > 0))
+	{
+		haptic_output(0);
+		hapticRetained.timer = app_easy_timer(pattern->off, haptic_timer_cb);
+	}
+	else if(hapticRetained.pulsesLeft > 0)
+	{
+		haptic_pulse(pattern);
+	}
+	else
+	{
+		haptic_stop();
+	}
+}
+
+void haptic_init(void)
+{
+	hapticRetained.timer = EASY_TIMER_INVALID_TIMER;
+	hapticRetained.playing = false;
+	hapticRetained.driven = false;
+	hapticRetained.pwm = false;
+	hapticRetained.intensity = 100;
+}
+
+void haptic_play(uint8_t pattern)
+{
+	haptic_stop();
+	if((pattern >= HAPTIC_NUM_PATTERNS) || (hapticRetained.intensity == 0))
+	{
+		return;
+	}
+	TRACE_EVENT(TRACE_EVT_MOTOR_START, pattern, 0);
+	hapticRetained.pattern = pattern;
+	hapticRetained.duty = (uint8_t)(((uint16_t)hapticPatterns[pattern].duty * hapticRetained.intensity) / 100);
+	hapticRetained.pulsesLeft = hapticPatterns[pattern].repeat;
+	hapticRetained.playing = true;
+	haptic_pulse(&hapticPatterns[pattern]);
+}
+
+void haptic_stop(void)
+{
+	if(hapticRetained.timer != EASY_TIMER_INVALID_TIMER)
+	{
+		app_easy_timer_cancel(hapticRetained.timer);
+		hapticRetained.timer = EASY_TIMER_INVALID_TIMER;
+	}
+	if(hapticRetained.playing)
+	{
+		haptic_output(0);
+		hapticRetained.playing = false;
+		TRACE_EVENT(TRACE_EVT_MOTOR_STOP, 0, 0);
+	}
+}
+
+void haptic_set_intensity(uint8_t percent)
+{
+	hapticRetained.intensity = (percent > 100) ? 100 : percent;
+}
+
+bool haptic_busy(void)
+{
+	return hapticRetained.playing;
+}
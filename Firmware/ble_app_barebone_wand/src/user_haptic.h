@@ -0,0 +1,136 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_haptic.h
+ *
+ * @brief Haptic patterns on the vibration motor, driven by the Timer0 PWM.
+ *
+ * A pattern is a train of identical pulses: the drive level, the pulse and gap times
+ * and the number of pulses. Timer0 generates the PWM of a pulse by itself; the pulse
+ * and gap times run on one app_easy_timer(), so a pattern plays next to sampling
+ * without holding anything up. Playing a pattern cuts the one playing short. The drive
+ * of every pattern is scaled by an intensity, which the battery policy lowers.
+ *
+ * Timer0 stops in extended sleep, so the system only idles while a pattern plays, see
+ * haptic_busy().
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _USER_HAPTIC_H_
+#define _USER_HAPTIC_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "app_easy_timer.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/* Patterns. X(name, duty, on, off, repeat): duty in percent of full drive, 100 drives the  */
+/* pin without PWM; on and off in 10ms units; repeat is the number of pulses                */
+#define HAPTIC_PATTERNS(X)                                                                 \
+	X(WAKE,                       80,     8,      0,      1)                               \
+	X(GESTURE,                    60,     3,      0,      1)                               \
+	X(SPELL,                      100,    6,      6,      3)
+
+#define HAPTIC_PATTERN_ENUM(name, duty, on, off, repeat) HAPTIC_##name,
+
+/* Timer0 PWM period in fast clock cycles: 20kHz at 16MHz, above the audible range          */
+#define HAPTIC_PWM_PERIOD                   (800)
+
+/* Retention RAM of the module, struct haptic_retained                                      */
+#define HAPTIC_RETAINED_SIZE                (sizeof(struct haptic_retained))
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Haptic patterns
+enum haptic_pattern_id
+{
+	HAPTIC_PATTERNS(HAPTIC_PATTERN_ENUM)
+	HAPTIC_NUM_PATTERNS
+};
+
+/// Pattern descriptor
+struct haptic_pattern
+{
+	/// Percent of full drive
+	uint8_t duty;
+	/// Pulse time, 10ms units, at least 1
+	uint8_t on;
+	/// Gap between two pulses, 10ms units
+	uint8_t off;
+	/// Number of pulses, at least 1
+	uint8_t repeat;
+};
+
+/// State of user_haptic.c kept in retention RAM
+struct haptic_retained
+{
+	/// Pulse or gap in progress
+	timer_hnd timer;
+	uint8_t pattern;
+	uint8_t pulsesLeft;
+	bool playing;
+	bool driven;
+	/// Timer0 running with its clock enabled; a 100% duty drives the pin as a GPIO without it
+	bool pwm;
+	/// Duty of the patterns started, percent of their table entry
+	uint8_t intensity;
+	/// Duty of the pattern playing
+	uint8_t duty;
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+ /**
+ ****************************************************************************************
+ * @brief Forget any pattern, play at full intensity and leave the motor off. The pad
+ *        itself is set up by set_pad_functions().
+ ****************************************************************************************
+ */
+void haptic_init(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Start a pattern, cutting short the one playing
+ * @param[in] pattern  enum haptic_pattern_id
+ ****************************************************************************************
+ */
+void haptic_play(uint8_t pattern);
+
+ /**
+ ****************************************************************************************
+ * @brief Stop the pattern playing, if any, and switch the motor off
+ ****************************************************************************************
+ */
+void haptic_stop(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Scale the drive of the patterns started from now on
+ * @param[in] percent  percent of the drive of the pattern table, 0 for no motor at all
+ ****************************************************************************************
+ */
+void haptic_set_intensity(uint8_t percent);
+
+ /**
+ ****************************************************************************************
+ * @brief True while a pattern plays; the system must not go deeper than idle
+ ****************************************************************************************
+ */
+bool haptic_busy(void);
+
+#endif // _USER_HAPTIC_H_
@@ -0,0 +1,237 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_latency.c
+ *
+ * @brief Gesture latency histograms, from motion onset to the advertising data update.
+ *
+ * Every movement is timestamped at onset, first recognition, payload write and the
+ * advertising data update, in BLE slots. The intervals go into log2 histograms kept
+ * in retention memory, so they build up across extended sleep and wake cycles until
+ * they are read out over the trace UART.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "user_latency.h"
+
+#if defined (CFG_GESTURE_LATENCY)
+
+#include "compiler.h"
+#include "lld_evt.h"
+#include "user_xl_driver.h"
+#include "user_trace.h"
+
+#if !defined (CFG_TRACE)
+    #error "CFG_GESTURE_LATENCY is read out over the trace and needs CFG_TRACE"
+#endif
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/* lld_evt_time_get() counts BLE slots in 27 bits                                           */
+#define LATENCY_TIME_MASK                   (0x07FFFFFFUL)
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Progress of the movement being timed
+enum latency_state
+{
+	LATENCY_IDLE = 0,
+	LATENCY_MOVING,
+	LATENCY_DETECTED,
+	LATENCY_COMMITTED
+};
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+// Everything the module keeps across sleep, see struct latency_retained
+struct latency_retained latencyRetained         __SECTION_ZERO("retention_mem_area0"); //@RETENTION MEMORY
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+ /**
+ ****************************************************************************************
+ * @brief BLE slots elapsed since a lld_evt_time_get() reading
+ ****************************************************************************************
+ */
+static uint32_t latency_since(uint32_t start)
+{
+	return (lld_evt_time_get() - start) & LATENCY_TIME_MASK;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Count one interval in the histogram of a stage
+ ****************************************************************************************
+ */
+static void latency_record(uint8_t stage, uint32_t slots)
+{
+	uint8_t bin = 0;
+
+	while((slots != 0) && (bin < (LATENCY_NUM_BINS - 1)))
+	{
+		slots >>= 1;
+		bin++;
+	}
+	if(latencyRetained.stats.histogram[stage][bin] < UINT16_MAX)
+	{
+		latencyRetained.stats.histogram[stage][bin]++;
+	}
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Forget the movement in progress
+ ****************************************************************************************
+ */
+void latency_reset(void)
+{
+	for(int i=0;i<XL_NUM_AXES;i++)
+	{
+		latencyRetained.previousSample[i] = 0;
+	}
+	latencyRetained.quietSamples = 0;
+	latencyRetained.state = LATENCY_IDLE;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Sample acquisition
+ ****************************************************************************************
+ */
+void latency_sample(const int8_t *sample)
+{
+	int16_t change = 0;
+
+	for(int i=0;i<XL_NUM_AXES;i++)
+	{
+		change += abs(sample[i] - latencyRetained.previousSample[i]);
+		latencyRetained.previousSample[i] = sample[i];
+	}
+
+	if((latencyRetained.state != LATENCY_IDLE) && (latency_since(latencyRetained.onsetTime) > LATENCY_TIMEOUT))
+	{
+		// Moved without making a gesture
+		if(latencyRetained.stats.timeouts < UINT16_MAX)
+		{
+			latencyRetained.stats.timeouts++;
+		}
+		latencyRetained.state = LATENCY_IDLE;
+	}
+
+	if(change < LATENCY_ONSET_THRESHOLD)
+	{
+		if(latencyRetained.quietSamples < LATENCY_QUIET_SAMPLES)
+		{
+			latencyRetained.quietSamples++;
+		}
+		return;
+	}
+
+	if((latencyRetained.state == LATENCY_IDLE) && (latencyRetained.quietSamples >= LATENCY_QUIET_SAMPLES))
+	{
+		latencyRetained.onsetTime = lld_evt_time_get();
+		latencyRetained.state = LATENCY_MOVING;
+		if(latencyRetained.stats.onsets < UINT16_MAX)
+		{
+			latencyRetained.stats.onsets++;
+		}
+	}
+	latencyRetained.quietSamples = 0;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief A pipeline stage recognised a gesture
+ ****************************************************************************************
+ */
+void latency_detected(void)
+{
+	if(latencyRetained.state == LATENCY_MOVING)
+	{
+		latencyRetained.detectTime = lld_evt_time_get();
+		latencyRetained.state = LATENCY_DETECTED;
+	}
+}
+
+ /**
+ ****************************************************************************************
+ * @brief The gesture was written to the manufacturer specific data
+ ****************************************************************************************
+ */
+void latency_committed(void)
+{
+	if((latencyRetained.state != LATENCY_MOVING) && (latencyRetained.state != LATENCY_DETECTED))
+	{
+		return;
+	}
+	latencyRetained.commitTime = lld_evt_time_get();
+	if(latencyRetained.state == LATENCY_MOVING)
+	{
+		latencyRetained.detectTime = latencyRetained.commitTime;
+	}
+	latency_record(LATENCY_ONSET_TO_DETECT, (latencyRetained.detectTime - latencyRetained.onsetTime) & LATENCY_TIME_MASK);
+	latency_record(LATENCY_DETECT_TO_COMMIT, (latencyRetained.commitTime - latencyRetained.detectTime) & LATENCY_TIME_MASK);
+	latencyRetained.state = LATENCY_COMMITTED;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief The advertising data holding the payload was handed to the stack
+ ****************************************************************************************
+ */
+void latency_advertised(void)
+{
+	if(latencyRetained.state != LATENCY_COMMITTED)
+	{
+		return;
+	}
+	latency_record(LATENCY_COMMIT_TO_ADV, latency_since(latencyRetained.commitTime));
+	latency_record(LATENCY_ONSET_TO_ADV, latency_since(latencyRetained.onsetTime));
+	latencyRetained.state = LATENCY_IDLE;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Write the histograms to the trace
+ ****************************************************************************************
+ */
+void latency_dump(void)
+{
+	TRACE_EVENT(TRACE_EVT_LATENCY_MOVEMENTS, 0, latencyRetained.stats.onsets);
+	TRACE_EVENT(TRACE_EVT_LATENCY_TIMEOUTS, 0, latencyRetained.stats.timeouts);
+	for(uint8_t stage=0;stage<LATENCY_NUM_STAGES;stage++)
+	{
+		// One stage at most fills LATENCY_NUM_BINS records, make room for it
+		trace_flush(TRACE_RING_LEN);
+		for(uint8_t bin=0;bin<LATENCY_NUM_BINS;bin++)
+		{
+			if(latencyRetained.stats.histogram[stage][bin] != 0)
+			{
+				TRACE_EVENT(TRACE_EVT_LATENCY_ONSET_TO_DETECT + stage, bin, latencyRetained.stats.histogram[stage][bin]);
+			}
+		}
+	}
+}
+
+#endif // CFG_GESTURE_LATENCY
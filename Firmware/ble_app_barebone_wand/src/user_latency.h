@@ -0,0 +1,149 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_latency.h
+ *
+ * @brief Gesture latency histograms, from motion onset to the advertising data update.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _USER_LATENCY_H_
+#define _USER_LATENCY_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include <stdint.h>
+#include "user_xl_driver.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/* Sum of |sample - previous sample| over the axes, in counts, that starts a movement       */
+#define LATENCY_ONSET_THRESHOLD             (8)
+
+/* Samples below the onset threshold needed before a new onset is taken                     */
+#define LATENCY_QUIET_SAMPLES               (10)    // 10*10ms = 0.1sec
+
+/* A movement that has not produced a gesture after this many BLE slots is dropped          */
+#define LATENCY_TIMEOUT                     (3200)  // 3200*625us = 2sec
+
+/* Log2 histogram: bin 0 holds 0 slots, bin n holds 2^(n-1)..2^n-1 slots of 625us. The last */
+/* bin also takes everything longer                                                          */
+#define LATENCY_NUM_BINS                    (13)
+
+/// Measured intervals
+enum latency_stage
+{
+	/// Motion onset to the first sample a stage recognised the gesture in (filter delay, threshold)
+	LATENCY_ONSET_TO_DETECT = 0,
+	/// First recognition to the payload write (lockout)
+	LATENCY_DETECT_TO_COMMIT,
+	/// Payload write to the advertising data update handed to the stack
+	LATENCY_COMMIT_TO_ADV,
+	/// Motion onset to the advertising data update
+	LATENCY_ONSET_TO_ADV,
+	LATENCY_NUM_STAGES
+};
+
+#if defined (CFG_GESTURE_LATENCY)
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Retained statistics
+struct latency_stats
+{
+	uint16_t histogram[LATENCY_NUM_STAGES][LATENCY_NUM_BINS];
+	uint16_t onsets;
+	uint16_t timeouts;
+};
+
+/// State of user_latency.c kept in retention RAM
+struct latency_retained
+{
+	struct latency_stats stats;
+	/// The movement being timed, which spans sleeps between samples
+	uint32_t onsetTime;
+	uint32_t detectTime;
+	uint32_t commitTime;
+	int8_t previousSample[XL_NUM_AXES];
+	uint8_t quietSamples;
+	/// enum latency_state
+	uint8_t state;
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+ /**
+ ****************************************************************************************
+ * @brief Forget the movement in progress. The histograms are kept.
+ ****************************************************************************************
+ */
+void latency_reset(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Sample acquisition. Detects the onset of a movement.
+ * @param[in] sample XL_NUM_AXES cell array (x,y,z)
+ ****************************************************************************************
+ */
+void latency_sample(const int8_t *sample);
+
+ /**
+ ****************************************************************************************
+ * @brief A pipeline stage recognised a gesture, whether or not the lockout lets it through
+ ****************************************************************************************
+ */
+void latency_detected(void);
+
+ /**
+ ****************************************************************************************
+ * @brief The gesture was written to the manufacturer specific data
+ ****************************************************************************************
+ */
+void latency_committed(void);
+
+ /**
+ ****************************************************************************************
+ * @brief The advertising data holding the payload was handed to the stack. It goes on
+ *        air at the next advertising event.
+ ****************************************************************************************
+ */
+void latency_advertised(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Write the histograms to the trace (see user_trace.h)
+ ****************************************************************************************
+ */
+void latency_dump(void);
+
+#define LATENCY_SAMPLE(sample)              latency_sample(sample)
+#define LATENCY_DETECTED()                  latency_detected()
+#define LATENCY_COMMITTED()                 latency_committed()
+#define LATENCY_ADVERTISED()                latency_advertised()
+#define LATENCY_RETAINED_SIZE               (sizeof(struct latency_retained))
+
+#else
+
+#define LATENCY_RETAINED_SIZE               (0)
+#define latency_reset()
+#define latency_dump()
+#define LATENCY_SAMPLE(sample)
+#define LATENCY_DETECTED()
+#define LATENCY_COMMITTED()
+#define LATENCY_ADVERTISED()
+
+#endif // CFG_GESTURE_LATENCY
+
+#endif // _USER_LATENCY_H_
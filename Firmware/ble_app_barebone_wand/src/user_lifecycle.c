@@ -0,0 +1,272 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_lifecycle.c
+ *
+ * @brief Event driven state machine of the wand.
+ *
+ * Residency times come from the BLE timer, which keeps running in sleep, so the time
+ * spent in SLEEPING is measured on the same 625us time base as the awake states.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "user_lifecycle.h"
+#include "arch.h"
+#include "ll.h"
+#include "lld_evt.h"
+#include "user_timer_wheel.h"
+#include "user_trace.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/* lld_evt_time_get() counts BLE slots in 27 bits                                           */
+#define LIFECYCLE_TIME_MASK                 (0x07FFFFFFUL)
+
+/* BLE slots per 10ms unit of the residency trace and of the state timeouts                 */
+#define LIFECYCLE_SLOTS_PER_10MS            (16)
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+// Everything the module keeps across sleep, see struct lifecycle_retained
+struct lifecycle_retained lifecycleRetained     __SECTION_ZERO("retention_mem_area0"); //@RETENTION MEMORY
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+ /**
+ ****************************************************************************************
+ * @brief Timeout of the current state, on the timer wheel
+ ****************************************************************************************
+ */
+static void lifecycle_wheel_cb(void)
+{
+	lifecycle_post(LIFECYCLE_EVT_TIMEOUT, 0);
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Enter a state: start its residency period, arm its timeout, run its entry action
+ ****************************************************************************************
+ */
+static void lifecycle_enter(uint8_t state)
+{
+	const struct lifecycle_state_conf *conf = &lifecycleRetained.conf->states[state];
+
+	lifecycleRetained.current = state;
+	lifecycleRetained.entered = lld_evt_time_get();
+	if((conf->timeout != LIFECYCLE_NO_TIMEOUT) && (conf->resources & LIFECYCLE_RES_TICK))
+	{
+		timer_wheel_arm(&lifecycleRetained.wheelTimer, conf->timeout, lifecycle_wheel_cb);
+	}
+	else if(conf->timeout != LIFECYCLE_NO_TIMEOUT)
+	{
+		ASSERT_WARNING(conf->timeout <= LIFECYCLE_MAX_POLLED_TIMEOUT);
+		// lifecycle_report() restarts lifecycleRetained.entered, the timeout keeps its own start
+		lifecycleRetained.timeoutStart = lifecycleRetained.entered;
+		lifecycleRetained.polledTimeout = true;
+	}
+	if(conf->entry != NULL)
+	{
+		conf->entry();
+	}
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Leave the current state: cancel its timeout, run its exit action, add its
+ *        residency period
+ ****************************************************************************************
+ */
+static void lifecycle_leave(void)
+{
+	const struct lifecycle_state_conf *conf = &lifecycleRetained.conf->states[lifecycleRetained.current];
+
+	lifecycleRetained.polledTimeout = false;
+	timer_wheel_cancel(&lifecycleRetained.wheelTimer);
+	if(conf->exit != NULL)
+	{
+		conf->exit();
+	}
+	lifecycleRetained.residency[lifecycleRetained.current] += (lld_evt_time_get() - lifecycleRetained.entered) & LIFECYCLE_TIME_MASK;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Handle one event in the current state
+ ****************************************************************************************
+ */
+static void lifecycle_dispatch(uint8_t event, uint8_t param)
+{
+	const struct lifecycle_transition *row = NULL;
+	uint8_t from = lifecycleRetained.current;
+	uint8_t fromResources, toResources;
+
+	for(uint8_t i=0;i<lifecycleRetained.conf->numTransitions;i++)
+	{
+		const struct lifecycle_transition *candidate = &lifecycleRetained.conf->transitions[i];
+
+		if((candidate->event == event) && ((candidate->state == from) || (candidate->state == LIFECYCLE_ANY)))
+		{
+			row = candidate;
+			break;
+		}
+	}
+	if(row == NULL)
+	{
+		return;
+	}
+	if(row->next == LIFECYCLE_SAME)
+	{
+		if(row->action != NULL)
+		{
+			row->action(param);
+		}
+		return;
+	}
+
+	TRACE_EVENT(TRACE_EVT_STATE, row->next, event);
+	lifecycle_leave();
+	if(row->action != NULL)
+	{
+		row->action(param);
+	}
+	fromResources = lifecycleRetained.conf->states[from].resources;
+	toResources = lifecycleRetained.conf->states[row->next].resources;
+	if(fromResources != toResources)
+	{
+		lifecycleRetained.conf->resources(toResources & ~fromResources, fromResources & ~toResources);
+	}
+	lifecycle_enter(row->next);
+}
+
+void lifecycle_init(const struct lifecycle_conf *conf, uint8_t initial)
+{
+	lifecycleRetained.conf = conf;
+	lifecycleRetained.polledTimeout = false;
+	lifecycleRetained.wheelTimer.next = NULL;
+	lifecycleRetained.wheelTimer.pprev = NULL;
+	lifecycleRetained.queueHead = 0;
+	lifecycleRetained.queueTail = 0;
+	lifecycleRetained.dispatching = false;
+	for(uint8_t i=0;i<LIFECYCLE_NUM_STATES;i++)
+	{
+		lifecycleRetained.residency[i] = 0;
+	}
+	lifecycleRetained.conf->resources(lifecycleRetained.conf->states[initial].resources, 0);
+	lifecycle_enter(initial);
+}
+
+void lifecycle_post(uint8_t event, uint8_t param)
+{
+	bool dispatch;
+
+	GLOBAL_INT_DISABLE();
+	if((uint8_t)(lifecycleRetained.queueHead - lifecycleRetained.queueTail) < LIFECYCLE_QUEUE_LEN)
+	{
+		struct lifecycle_queued_event *queued = &lifecycleRetained.queue[lifecycleRetained.queueHead & (LIFECYCLE_QUEUE_LEN - 1)];
+
+		queued->event = event;
+		queued->param = param;
+		lifecycleRetained.queueHead++;
+	}
+	else
+	{
+		// More events than one run to completion can post, the table loops
+		ASSERT_WARNING(0);
+	}
+	dispatch = !lifecycleRetained.dispatching;
+	lifecycleRetained.dispatching = true;
+	GLOBAL_INT_RESTORE();
+
+	// Handle the queue unless the caller interrupted, or was called by, a handler
+	while(dispatch)
+	{
+		struct lifecycle_queued_event next = {0, 0};
+
+		GLOBAL_INT_DISABLE();
+		if(lifecycleRetained.queueHead != lifecycleRetained.queueTail)
+		{
+			next = lifecycleRetained.queue[lifecycleRetained.queueTail & (LIFECYCLE_QUEUE_LEN - 1)];
+			lifecycleRetained.queueTail++;
+		}
+		else
+		{
+			lifecycleRetained.dispatching = false;
+			dispatch = false;
+		}
+		GLOBAL_INT_RESTORE();
+
+		if(dispatch)
+		{
+			lifecycle_dispatch(next.event, next.param);
+		}
+	}
+}
+
+uint8_t lifecycle_state(void)
+{
+	return lifecycleRetained.current;
+}
+
+void lifecycle_poll(void)
+{
+	uint32_t elapsed = (lld_evt_time_get() - lifecycleRetained.timeoutStart) & LIFECYCLE_TIME_MASK;
+
+	if(lifecycleRetained.polledTimeout && (elapsed >= (lifecycleRetained.conf->states[lifecycleRetained.current].timeout * LIFECYCLE_SLOTS_PER_10MS)))
+	{
+		// Once per state, whether or not the table has a TIMEOUT row for it
+		lifecycleRetained.polledTimeout = false;
+		lifecycle_post(LIFECYCLE_EVT_TIMEOUT, 0);
+	}
+}
+
+uint32_t lifecycle_residency(uint8_t state)
+{
+	uint32_t residency = lifecycleRetained.residency[state];
+
+	if(state == lifecycleRetained.current)
+	{
+		residency += (lld_evt_time_get() - lifecycleRetained.entered) & LIFECYCLE_TIME_MASK;
+	}
+	return residency;
+}
+
+void lifecycle_report(void)
+{
+	uint32_t now = lld_evt_time_get();
+
+	// Close the period of the current state so it is reported in this period
+	lifecycleRetained.residency[lifecycleRetained.current] += (now - lifecycleRetained.entered) & LIFECYCLE_TIME_MASK;
+	lifecycleRetained.entered = now;
+
+	// Make room for the report
+	trace_flush(TRACE_RING_LEN);
+	for(uint8_t i=0;i<LIFECYCLE_NUM_STATES;i++)
+	{
+		// 10ms units, saturated to the 16 bits of the trace
+		uint32_t residency = lifecycleRetained.residency[i] / LIFECYCLE_SLOTS_PER_10MS;
+
+		if(residency > UINT16_MAX)
+		{
+			residency = UINT16_MAX;
+		}
+		TRACE_EVENT(TRACE_EVT_STATE_RESIDENCY, i, (uint16_t)residency);
+		lifecycleRetained.residency[i] = 0;
+	}
+}
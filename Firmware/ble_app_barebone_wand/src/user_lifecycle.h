@@ -0,0 +1,232 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_lifecycle.h
+ *
+ * @brief Event driven state machine of the wand, from button wake-up to sleep.
+ *
+ * The application describes every state (its timeout, the resources it holds, entry
+ * and exit actions) and a transition table; this module runs it. Events are queued and
+ * handled one at a time to completion, so an event posted by an action, e.g. a gesture
+ * found while handling a sample, is handled after that action returns.
+ *
+ * A transition runs the exit action of the old state, the action of the transition,
+ * the resource change and the entry action of the new state, in that order. The
+ * resource change only touches the resources that differ between the two states, and
+ * the timeout of the old state is cancelled before anything else runs, so no timer of
+ * a state outlives it.
+ *
+ * The timeout of a state that holds LIFECYCLE_RES_TICK runs on the timer wheel, which
+ * the application advances with timer_wheel_tick() from its sample tick; re-arming it,
+ * as a gesture does in LOCKED, costs no app_easy_timer. Other timeouts are counted on
+ * the BLE timer, which keeps running in sleep, and checked by lifecycle_poll() at every
+ * wake-up. No kernel timer runs for them, so a state that sleeps with external wake-up
+ * sees its timeout at the first periodic wake-up of the BLE core after it.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _USER_LIFECYCLE_H_
+#define _USER_LIFECYCLE_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "user_timer_wheel.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/* States. X(name)                                                                          */
+#define LIFECYCLE_STATES(X)                                                                \
+	X(SLEEPING)                                                                            \
+	X(SAMPLING)                                                                            \
+	X(LOCKED)                                                                              \
+	X(DISPLAY_HOLD)                                                                        \
+	X(GOING_TO_SLEEP)                                                                      \
+	X(CONNECTED)                                                                           \
+	X(HIBERNATING)
+
+/* Events. X(name)                                                                          */
+#define LIFECYCLE_EVENTS(X)                                                                \
+	X(WAKE)                                                                                \
+	X(SAMPLE)                                                                              \
+	X(GESTURE)                                                                             \
+	X(TIMEOUT)                                                                             \
+	X(CONNECT)                                                                             \
+	X(DISCONNECT)                                                                          \
+	X(ADV_STOPPED)
+
+#define LIFECYCLE_STATE_ENUM(name)          LIFECYCLE_##name,
+#define LIFECYCLE_EVENT_ENUM(name)          LIFECYCLE_EVT_##name,
+
+/* Queued events, a power of 2                                                              */
+#define LIFECYCLE_QUEUE_LEN                 (8)
+
+/* Transition row matching every state                                                      */
+#define LIFECYCLE_ANY                       (0xFE)
+
+/* Next state of an internal transition: the action runs, the state is not left             */
+#define LIFECYCLE_SAME                      (0xFF)
+
+/* State without timeout                                                                    */
+#define LIFECYCLE_NO_TIMEOUT                (0)
+
+/* Longest timeout of a state without LIFECYCLE_RES_TICK: the 27-bit BLE slot count, 23h    */
+#define LIFECYCLE_MAX_POLLED_TIMEOUT        (0x07FFFFFFUL / 16)
+
+/* Resources a state holds, switched by the resources hook of struct lifecycle_conf         */
+#define LIFECYCLE_RES_XL                    (1 << 0)    // accelerometer running
+#define LIFECYCLE_RES_TICK                  (1 << 1)    // 10ms sample tick running, see below
+
+/* Retention RAM of the state machine, struct lifecycle_retained                            */
+#define LIFECYCLE_RETAINED_SIZE             (sizeof(struct lifecycle_retained))
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Lifecycle states
+enum lifecycle_state
+{
+	LIFECYCLE_STATES(LIFECYCLE_STATE_ENUM)
+	LIFECYCLE_NUM_STATES
+};
+
+/// Lifecycle events
+enum lifecycle_event
+{
+	LIFECYCLE_EVENTS(LIFECYCLE_EVENT_ENUM)
+	LIFECYCLE_NUM_EVENTS
+};
+
+/// Action of a transition, with the parameter the event was posted with
+typedef void (*lifecycle_action_t)(uint8_t param);
+
+/// One state
+struct lifecycle_state_conf
+{
+	/// Time in the state before TIMEOUT is posted, in 10ms units, or LIFECYCLE_NO_TIMEOUT
+	uint32_t timeout;
+	/// LIFECYCLE_RES_x bits
+	uint8_t resources;
+	/// Run when the state is entered, may be NULL
+	void (*entry)(void);
+	/// Run when the state is left, may be NULL
+	void (*exit)(void);
+};
+
+/// One row of the transition table
+struct lifecycle_transition
+{
+	/// State the row applies in, or LIFECYCLE_ANY
+	uint8_t state;
+	uint8_t event;
+	/// Next state, or LIFECYCLE_SAME
+	uint8_t next;
+	/// May be NULL
+	lifecycle_action_t action;
+};
+
+/// State machine description
+struct lifecycle_conf
+{
+	/// LIFECYCLE_NUM_STATES entries, indexed by enum lifecycle_state
+	const struct lifecycle_state_conf *states;
+	/// Searched in order, the first matching row wins; events without a row are ignored
+	const struct lifecycle_transition *transitions;
+	uint8_t numTransitions;
+	/// Switches resources on and off, LIFECYCLE_RES_x bits
+	void (*resources)(uint8_t on, uint8_t off);
+};
+
+/// Queued event
+struct lifecycle_queued_event
+{
+	uint8_t event;
+	uint8_t param;
+};
+
+/// State of user_lifecycle.c kept in retention RAM
+struct lifecycle_retained
+{
+	const struct lifecycle_conf *conf;
+	/// Timeout of the current state: on the timer wheel while the state holds the sample
+	/// tick, otherwise counted from timeoutStart on the BLE timer until lifecycle_poll()
+	/// posts it
+	struct timer_wheel_timer wheelTimer;
+	uint32_t timeoutStart;
+	/// Entry time of the current state and time spent in every state, in BLE slots
+	uint32_t entered;
+	uint32_t residency[LIFECYCLE_NUM_STATES];
+	struct lifecycle_queued_event queue[LIFECYCLE_QUEUE_LEN];
+	/// enum lifecycle_state
+	uint8_t current;
+	bool polledTimeout;
+	uint8_t queueHead;
+	uint8_t queueTail;
+	/// Set while lifecycle_post() is emptying the queue
+	bool dispatching;
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+ /**
+ ****************************************************************************************
+ * @brief Empty the queue and the residency times, switch on the resources of the initial
+ *        state and enter it
+ * @param[in] conf     state machine, must stay valid
+ * @param[in] initial  enum lifecycle_state
+ ****************************************************************************************
+ */
+void lifecycle_init(const struct lifecycle_conf *conf, uint8_t initial);
+
+ /**
+ ****************************************************************************************
+ * @brief Queue an event and, unless an event is being handled already, handle the queue
+ *        until it is empty. May be called from an interrupt handler.
+ * @param[in] event  enum lifecycle_event
+ * @param[in] param  passed to the action of the transition
+ ****************************************************************************************
+ */
+void lifecycle_post(uint8_t event, uint8_t param);
+
+ /**
+ ****************************************************************************************
+ * @brief Current state, enum lifecycle_state
+ ****************************************************************************************
+ */
+uint8_t lifecycle_state(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Post TIMEOUT once a state without LIFECYCLE_RES_TICK has lasted its timeout.
+ *        Called from the main loop, which runs at every wake-up of the system.
+ ****************************************************************************************
+ */
+void lifecycle_poll(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Time spent in a state since the last lifecycle_report(), in BLE slots
+ ****************************************************************************************
+ */
+uint32_t lifecycle_residency(uint8_t state);
+
+ /**
+ ****************************************************************************************
+ * @brief Trace the residency time of every state and start counting again
+ ****************************************************************************************
+ */
+void lifecycle_report(void);
+
+#endif // _USER_LIFECYCLE_H_
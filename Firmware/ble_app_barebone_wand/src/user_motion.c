@@ -0,0 +1,134 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_motion.c
+ *
+ * @brief Gravity estimate and linear acceleration shared by the gesture detectors.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "user_motion.h"
+#include "user_gesture_config.h"
+#include "compiler.h"
+
+#if (CFG_GESTURE_USES_MOTION)
+
+#if (MOTION_GRAVITY_SHIFT <= CFG_GESTURE_MAX_RATE_SHIFT)
+    #error "the gravity filter needs a shift left at the lowest pipeline rate"
+#endif
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+// Everything the module keeps across sleep, see struct motion_retained
+struct motion_retained motionRetained           __SECTION_ZERO("retention_mem_area0"); //@RETENTION MEMORY
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+ /**
+ ****************************************************************************************
+ * @brief Reset the gravity estimate. The next sample seeds it.
+ ****************************************************************************************
+ */
+void motion_init(void)
+{
+	for(int i=0;i<XL_NUM_AXES;i++)
+	{
+		motionRetained.gravity[i] = 0;
+		motionRetained.linear[i] = 0;
+	}
+	motionRetained.normSq = 0;
+	motionRetained.seeded = false;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Keep the time constant of the gravity estimate at a lower sample rate
+ ****************************************************************************************
+ */
+void motion_set_rate(uint8_t rateShift)
+{
+	// Every sample stands for 1 << rateShift ticks of the filter
+	motionRetained.gravityShift = MOTION_GRAVITY_SHIFT - rateShift;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Feed one accelerometer sample
+ ****************************************************************************************
+ */
+void motion_update(const int8_t *sample)
+{
+	motionRetained.normSq = 0;
+	for(int i=0;i<XL_NUM_AXES;i++)
+	{
+		int16_t sampleScaled = (int16_t)(sample[i] * (1 << MOTION_GRAVITY_FRAC_BITS));
+		int16_t linear;
+
+		// Seed with the first sample so waking up does not look like a swing
+		if(!motionRetained.seeded)
+		{
+			motionRetained.gravity[i] = sampleScaled;
+		}
+		motionRetained.gravity[i] += (sampleScaled - motionRetained.gravity[i]) >> motionRetained.gravityShift;
+
+		linear = sample[i] - motion_gravity(i);
+		if(linear > INT8_MAX)
+		{
+			linear = INT8_MAX;
+		}
+		else if(linear < INT8_MIN)
+		{
+			linear = INT8_MIN;
+		}
+		motionRetained.linear[i] = (int8_t)linear;
+		motionRetained.normSq += sample[i] * sample[i];
+	}
+	motionRetained.seeded = true;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Slowly varying gravity component of one axis
+ ****************************************************************************************
+ */
+int8_t motion_gravity(uint8_t axis)
+{
+	// Round to nearest count
+	return (int8_t)((motionRetained.gravity[axis] + (1 << (MOTION_GRAVITY_FRAC_BITS - 1))) >> MOTION_GRAVITY_FRAC_BITS);
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Squared magnitude of the last sample
+ ****************************************************************************************
+ */
+int32_t motion_norm_sq(void)
+{
+	return motionRetained.normSq;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Linear acceleration (sample minus gravity) of one axis
+ ****************************************************************************************
+ */
+int8_t motion_linear(uint8_t axis)
+{
+	return motionRetained.linear[axis];
+}
+
+#endif // CFG_GESTURE_USES_MOTION
@@ -0,0 +1,112 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_motion.h
+ *
+ * @brief Gravity estimate and linear acceleration shared by the gesture detectors.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _USER_MOTION_H_
+#define _USER_MOTION_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "user_xl_driver.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/* Gravity low pass filter: gravity += (sample - gravity) >> MOTION_GRAVITY_SHIFT             */
+/* At the 10ms sample tick a shift of 4 gives a time constant of roughly 160ms; at a lower   */
+/* rate the shift shrinks with it, see motion_set_rate()                                     */
+#define MOTION_GRAVITY_SHIFT                (4)
+
+/* Fractional bits kept in the gravity estimate                                              */
+#define MOTION_GRAVITY_FRAC_BITS            (8)
+
+/* Accelerometer counts of 1g in the 8-bit samples (+/-2g full scale)                        */
+#define MOTION_ONE_G                        (64)
+
+/* Retention RAM of the filter, struct motion_retained                                      */
+#define MOTION_RETAINED_SIZE                ((CFG_GESTURE_USES_MOTION) ? sizeof(struct motion_retained) : 0)
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// State of user_motion.c kept in retention RAM
+struct motion_retained
+{
+	int32_t normSq;
+	/// Gravity estimate per axis, MOTION_GRAVITY_FRAC_BITS fractional bits
+	int16_t gravity[XL_NUM_AXES];
+	int8_t linear[XL_NUM_AXES];
+	bool seeded;
+	uint8_t gravityShift;
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+ /**
+ ****************************************************************************************
+ * @brief Reset the gravity estimate. The next sample seeds it.
+ ****************************************************************************************
+ */
+void motion_init(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Keep the time constant of the gravity estimate at a lower sample rate
+ * @param[in] rateShift  samples arrive every 1 << rateShift sample ticks
+ ****************************************************************************************
+ */
+void motion_set_rate(uint8_t rateShift);
+
+ /**
+ ****************************************************************************************
+ * @brief Feed one accelerometer sample
+ * @param[in] sample XL_NUM_AXES cell array (x,y,z)
+ ****************************************************************************************
+ */
+void motion_update(const int8_t *sample);
+
+ /**
+ ****************************************************************************************
+ * @brief Slowly varying gravity component of one axis
+ * @param[in] axis  XL_AXIS_X, XL_AXIS_Y or XL_AXIS_Z
+ * @return gravity in accelerometer counts
+ ****************************************************************************************
+ */
+int8_t motion_gravity(uint8_t axis);
+
+ /**
+ ****************************************************************************************
+ * @brief Squared magnitude of the last sample. Stays close to MOTION_ONE_G^2 while the
+ *        wand is only rotated and departs from it when the wand is swung.
+ * @return x^2 + y^2 + z^2 in counts^2
+ ****************************************************************************************
+ */
+int32_t motion_norm_sq(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Linear acceleration (sample minus gravity) of one axis
+ * @param[in] axis  XL_AXIS_X, XL_AXIS_Y or XL_AXIS_Z
+ * @return linear acceleration in accelerometer counts
+ ****************************************************************************************
+ */
+int8_t motion_linear(uint8_t axis);
+
+#endif // _USER_MOTION_H_
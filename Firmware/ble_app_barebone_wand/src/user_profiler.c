@@ -0,0 +1,201 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_profiler.c
+ *
+ * @brief Cycle profiler for the hot paths, using SysTick as a free-running counter.
+ *
+ * SysTick is clocked from the core clock (CLKSOURCE = 1) instead of the 1MHz reference
+ * that systick_start() selects, so the counter reads CPU cycles. It runs through its
+ * 24-bit range without interrupts; regions up to about one second at 16MHz measure
+ * correctly. Extended sleep powers the core down, so the counter is restarted on the
+ * first read after waking up.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include "user_profiler.h"
+
+#if defined (PROFILER_ENABLED)
+
+#include "datasheet.h"
+#include "arch_console.h"
+
+#if !defined (CFG_PRINTF)
+    #error "CFG_PROFILER prints its statistics with arch_printf and needs CFG_PRINTF"
+#endif
+
+#if defined (CFG_SWAR_BENCHMARK)
+    #error "CFG_SWAR_BENCHMARK reprograms SysTick and cannot run with CFG_PROFILER"
+#endif
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+#define PROFILER_COUNTER_MASK               (0x00FFFFFFUL)
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Statistics of one region
+struct profiler_stats
+{
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+	uint64_t total;
+	uint16_t histogram[PROFILER_NUM_BINS];
+};
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+#define PROFILER_REGION_NAME(name)          #name,
+
+static const char * const profilerRegionNames[PROFILER_NUM_REGIONS] =
+{
+	PROFILER_REGIONS(PROFILER_REGION_NAME)
+};
+
+struct profiler_stats profilerStats[PROFILER_NUM_REGIONS];
+// Cycles of an empty region, subtracted from every measurement
+uint32_t profilerOverhead;
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+ /**
+ ****************************************************************************************
+ * @brief Run SysTick from the core clock over its full range, interrupt disabled
+ ****************************************************************************************
+ */
+static void profiler_counter_start(void)
+{
+	SysTick->CTRL = 0;
+	SysTick->LOAD = PROFILER_COUNTER_MASK;
+	SysTick->VAL = 0;
+	SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Clear the statistics and measure the cost of an empty region
+ ****************************************************************************************
+ */
+void profiler_init(void)
+{
+	uint32_t start;
+
+	for(int region=0;region<PROFILER_NUM_REGIONS;region++)
+	{
+		struct profiler_stats *stats = &profilerStats[region];
+
+		stats->count = 0;
+		stats->min = UINT32_MAX;
+		stats->max = 0;
+		stats->total = 0;
+		for(int bin=0;bin<PROFILER_NUM_BINS;bin++)
+		{
+			stats->histogram[bin] = 0;
+		}
+	}
+
+	profiler_counter_start();
+	profilerOverhead = 0;
+	start = profiler_now();
+	profilerOverhead = (start - profiler_now()) & PROFILER_COUNTER_MASK;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Current counter value
+ ****************************************************************************************
+ */
+uint32_t profiler_now(void)
+{
+	if(!(SysTick->CTRL & SysTick_CTRL_ENABLE_Msk))
+	{
+		profiler_counter_start();
+	}
+	return SysTick->VAL;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Account one pass through a region
+ ****************************************************************************************
+ */
+void profiler_record(uint8_t region, uint32_t start)
+{
+	// The counter runs down, the mask takes care of the wrap
+	uint32_t cycles = (start - SysTick->VAL) & PROFILER_COUNTER_MASK;
+	struct profiler_stats *stats = &profilerStats[region];
+	uint8_t bin = 0;
+
+	cycles = (cycles > profilerOverhead) ? (cycles - profilerOverhead) : 0;
+
+	stats->count++;
+	stats->total += cycles;
+	if(cycles < stats->min)
+	{
+		stats->min = cycles;
+	}
+	if(cycles > stats->max)
+	{
+		stats->max = cycles;
+	}
+
+	// No CLZ on the Cortex-M0, the loop runs at most 23 times
+	for(uint32_t c = cycles >> 1; c != 0; c >>= 1)
+	{
+		bin++;
+	}
+	if(stats->histogram[bin] < UINT16_MAX)
+	{
+		stats->histogram[bin]++;
+	}
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Print count, min/max/mean and the histogram of every region on the console
+ ****************************************************************************************
+ */
+void profiler_dump(void)
+{
+	arch_printf("\n\rprofile, cycles (overhead %d removed)\n\r", profilerOverhead);
+	for(int region=0;region<PROFILER_NUM_REGIONS;region++)
+	{
+		const struct profiler_stats *stats = &profilerStats[region];
+
+		if(stats->count == 0)
+		{
+			continue;
+		}
+		arch_printf("%s: n=%d min=%d max=%d mean=%d\n\r", profilerRegionNames[region],
+			stats->count, stats->min, stats->max, (uint32_t)(stats->total / stats->count));
+		for(int bin=0;bin<PROFILER_NUM_BINS;bin++)
+		{
+			if(stats->histogram[bin] != 0)
+			{
+				arch_printf("  >=2^%d: %d\n\r", bin, stats->histogram[bin]);
+			}
+		}
+	}
+}
+
+#endif // PROFILER_ENABLED
@@ -0,0 +1,105 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_profiler.h
+ *
+ * @brief Cycle profiler for the hot paths, using SysTick as a free-running counter.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _USER_PROFILER_H_
+#define _USER_PROFILER_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include <stdint.h>
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/* Profiling needs CFG_PROFILER and a development build. Release builds                      */
+/* (CFG_DEVELOPMENT_DEBUG undefined) never profile, whatever CFG_PROFILER says              */
+#if defined (CFG_PROFILER) && defined (CFG_DEVELOPMENT_DEBUG)
+#define PROFILER_ENABLED
+#endif
+
+/* Profiled regions. X(name)                                                                 */
+#define PROFILER_REGIONS(X)                 \
+	X(ADV_UPDATE)                           \
+	X(SAMPLE_TICK)                          \
+	X(XL_READ_SAMPLE)                       \
+	X(XL_READ_AXIS)                         \
+	X(XL_INIT)                              \
+	X(XL_SLEEP)                             \
+	X(WAKE)                                 \
+	X(GOING_TO_SLEEP)
+
+/* Log2 histogram bins: bin n counts regions of 2^n..2^(n+1)-1 cycles. SysTick is 24 bits   */
+#define PROFILER_NUM_BINS                   (24)
+
+#define PROFILER_REGION_ENUM(name)          PROFILER_##name,
+
+/// Profiled region identifiers
+enum profiler_region
+{
+	PROFILER_REGIONS(PROFILER_REGION_ENUM)
+	PROFILER_NUM_REGIONS
+};
+
+#if defined (PROFILER_ENABLED)
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+ /**
+ ****************************************************************************************
+ * @brief Clear the statistics and measure the cost of an empty region
+ ****************************************************************************************
+ */
+void profiler_init(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Current counter value. Restarts SysTick on the core clock if sleep stopped it.
+ * @return SysTick value, counting down
+ ****************************************************************************************
+ */
+uint32_t profiler_now(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Account one pass through a region
+ * @param[in] region  PROFILER_x value
+ * @param[in] start   profiler_now() at the start of the region
+ ****************************************************************************************
+ */
+void profiler_record(uint8_t region, uint32_t start);
+
+ /**
+ ****************************************************************************************
+ * @brief Print count, min/max/mean and the histogram of every region on the console
+ ****************************************************************************************
+ */
+void profiler_dump(void);
+
+/* Bracket a region inside one function. Both macros must be in the same scope            */
+#define PROFILER_BEGIN(name)                uint32_t profilerStart_##name = profiler_now()
+#define PROFILER_END(name)                  profiler_record(PROFILER_##name, profilerStart_##name)
+
+#else
+
+#define profiler_init()
+#define profiler_dump()
+#define PROFILER_BEGIN(name)
+#define PROFILER_END(name)
+
+#endif // PROFILER_ENABLED
+
+#endif // _USER_PROFILER_H_
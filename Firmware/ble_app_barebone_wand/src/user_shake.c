@@ -0,0 +1,209 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_shake.c
+ *
+ * @brief Shake detection with fixed-point Goertzel filters on the linear acceleration.
+ *
+ * Every sample costs one multiply per bin and axis. Once per block the power of every
+ * bin is compared with the block energy: a deliberate shake concentrates its energy in
+ * one bin for several blocks, a single flick spreads a short burst over all of them.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "user_shake.h"
+#include "compiler.h"
+
+#if (CFG_GESTURE_STAGE_SHAKE)
+
+#if (SHAKE_SAMPLE_RATE_HZ != 100)
+    #error "shakeCoeffLut holds the coefficients of a 100Hz sample rate"
+#endif
+
+#if ((SHAKE_MAX_FREQ_HZ << CFG_GESTURE_MAX_RATE_SHIFT) > SHAKE_MAX_LUT_FREQ_HZ)
+    #error "shakeCoeffLut ends below the highest bin at the lowest pipeline rate"
+#endif
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+// 2*cos(2*pi*f/100Hz) for f = 0..SHAKE_MAX_LUT_FREQ_HZ, SHAKE_COEFF_FRAC_BITS fractional
+// bits. At 100Hz >> n a bin of f Hz takes the coefficient of f << n
+static const int32_t shakeCoeffLut[SHAKE_MAX_LUT_FREQ_HZ + 1] =
+{
+	32768, 32703, 32510, 32188, 31739, 31164, 30467, 29649, 28715, 27667, 26510, 25248,
+	23887, 22431, 20887, 19261, 17558, 15786, 13952, 12063, 10126, 8149, 6140, 4107,
+	2058, 0, -2058, -4107, -6140, -8149, -10126, -12063, -13952, -15786, -17558, -19261,
+	-20887, -22431, -23887, -25248, -26510, -27667, -28715, -29649, -30467, -31164, -31739, -32188,
+	-32510
+};
+
+// Everything the module keeps across sleep, see struct shake_retained
+struct shake_retained shakeRetained             __SECTION_ZERO("retention_mem_area0"); //@RETENTION MEMORY
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+ /**
+ ****************************************************************************************
+ * @brief Clear the filter state at the start of a block
+ ****************************************************************************************
+ */
+static void shake_block_reset(void)
+{
+	for(int axis=0;axis<SHAKE_NUM_AXES;axis++)
+	{
+		for(int bin=0;bin<SHAKE_NUM_BINS;bin++)
+		{
+			shakeRetained.filter[axis][bin].s1 = 0;
+			shakeRetained.filter[axis][bin].s2 = 0;
+		}
+		shakeRetained.energy[axis] = 0;
+	}
+	shakeRetained.sampleCounter = 0;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Power of one bin at the end of a block
+ ****************************************************************************************
+ */
+static int32_t shake_bin_power(const struct shake_goertzel *filter, int32_t coeff)
+{
+	int32_t s1 = filter->s1 >> SHAKE_POWER_PRESHIFT;
+	int32_t s2 = filter->s2 >> SHAKE_POWER_PRESHIFT;
+
+	return (s1 * s1) + (s2 * s2) - (((coeff * s1) >> SHAKE_COEFF_FRAC_BITS) * s2);
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Check whether the finished block holds a tonal oscillation
+ ****************************************************************************************
+ */
+static bool shake_block_is_tonal(void)
+{
+	for(int axis=0;axis<SHAKE_NUM_AXES;axis++)
+	{
+		for(int bin=0;bin<SHAKE_NUM_BINS;bin++)
+		{
+			int32_t power = shake_bin_power(&shakeRetained.filter[axis][bin], shakeRetained.coeff[bin]);
+
+			// A block of fewer samples holds a tone with the square of their share of the power
+			if((power >= (SHAKE_POWER_THRESHOLD >> (2 * shakeRetained.rateShift))) &&
+				((power << SHAKE_TONAL_SHIFT) >= (shakeRetained.energy[axis] << (SHAKE_BLOCK_LEN_SHIFT - shakeRetained.rateShift))))
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Look up the Goertzel coefficients of the sample tick and reset the filter state
+ ****************************************************************************************
+ */
+void shake_init(void)
+{
+	shake_set_rate(0);
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Look up the Goertzel coefficients of a lower sample rate and reset the filter
+ *        state
+ ****************************************************************************************
+ */
+void shake_set_rate(uint8_t rateShift)
+{
+	const uint8_t binFreqs[SHAKE_NUM_BINS] = SHAKE_BIN_FREQS_HZ;
+
+	shakeRetained.rateShift = rateShift;
+	for(int bin=0;bin<SHAKE_NUM_BINS;bin++)
+	{
+		shakeRetained.coeff[bin] = shakeCoeffLut[binFreqs[bin] << rateShift];
+	}
+	shake_reset();
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Reset the filter state, keeping the coefficients
+ ****************************************************************************************
+ */
+void shake_reset(void)
+{
+	shake_block_reset();
+	shakeRetained.tonalBlocks = 0;
+	shakeRetained.reported = false;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Feed one linear acceleration sample of the X and Y axes
+ ****************************************************************************************
+ */
+bool shake_update(int8_t xLinear, int8_t yLinear)
+{
+	const int8_t input[SHAKE_NUM_AXES] = {xLinear, yLinear};
+	bool shakeDetected = false;
+
+	for(int axis=0;axis<SHAKE_NUM_AXES;axis++)
+	{
+		int32_t x = input[axis];
+
+		for(int bin=0;bin<SHAKE_NUM_BINS;bin++)
+		{
+			struct shake_goertzel *filter = &shakeRetained.filter[axis][bin];
+			int32_t s0 = x + ((shakeRetained.coeff[bin] * filter->s1) >> SHAKE_COEFF_FRAC_BITS) - filter->s2;
+
+			filter->s2 = filter->s1;
+			filter->s1 = s0;
+		}
+		shakeRetained.energy[axis] += x * x;
+	}
+
+	// Blocks keep their length in time
+	if(++shakeRetained.sampleCounter < (SHAKE_BLOCK_LEN >> shakeRetained.rateShift))
+	{
+		return false;
+	}
+
+	if(shake_block_is_tonal())
+	{
+		if(shakeRetained.tonalBlocks < SHAKE_MIN_BLOCKS)
+		{
+			shakeRetained.tonalBlocks++;
+		}
+		// Report once, then wait for the oscillation to stop
+		if((shakeRetained.tonalBlocks >= SHAKE_MIN_BLOCKS) && !shakeRetained.reported)
+		{
+			shakeRetained.reported = true;
+			shakeDetected = true;
+		}
+	}
+	else
+	{
+		shakeRetained.tonalBlocks = 0;
+		shakeRetained.reported = false;
+	}
+	shake_block_reset();
+
+	return shakeDetected;
+}
+
+#endif // CFG_GESTURE_STAGE_SHAKE
@@ -0,0 +1,130 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_shake.h
+ *
+ * @brief Shake detection with fixed-point Goertzel filters on the linear acceleration.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _USER_SHAKE_H_
+#define _USER_SHAKE_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "user_gesture_config.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/* Rate at which shake_update() is called                                                    */
+#define SHAKE_SAMPLE_RATE_HZ                CFG_GESTURE_SAMPLE_RATE_HZ
+
+/* Frequencies tracked by the Goertzel filters, in Hz                                        */
+#define SHAKE_BIN_FREQS_HZ                  CFG_GESTURE_SHAKE_BIN_FREQS_HZ
+/* Highest bin frequency, in Hz                                                              */
+#define SHAKE_MAX_FREQ_HZ                   (12)
+/* Last frequency of the coefficient table: at 100Hz >> n a bin of f Hz takes the            */
+/* coefficient of f << n Hz                                                                  */
+#define SHAKE_MAX_LUT_FREQ_HZ               (48)
+#define SHAKE_NUM_BINS                      CFG_GESTURE_SHAKE_NUM_BINS
+
+/* Samples per Goertzel block at the sample tick. Must be a power of two                     */
+#define SHAKE_BLOCK_LEN_SHIFT               CFG_GESTURE_SHAKE_BLOCK_SHIFT
+#define SHAKE_BLOCK_LEN                     (1 << SHAKE_BLOCK_LEN_SHIFT)
+
+/* Fractional bits of the Goertzel coefficients 2*cos(w)                                     */
+#define SHAKE_COEFF_FRAC_BITS               (14)
+
+/* Filter state is scaled down by this shift before the power is computed                    */
+#define SHAKE_POWER_PRESHIFT                (2)
+
+/* Minimum bin power of a block. A tone of amplitude A counts gives roughly                  */
+/* (A*SHAKE_BLOCK_LEN/2)^2 >> (2*SHAKE_POWER_PRESHIFT), i.e. 4096 for A = 16 (0.25g)         */
+#define SHAKE_POWER_THRESHOLD               (4096)
+
+/* Share of the block energy the strongest bin must hold, as a shift: the block passes when  */
+/* power << SHAKE_TONAL_SHIFT >= energy * SHAKE_BLOCK_LEN. A pure tone at a bin frequency    */
+/* scores 2 in these units, a single flick well below 1                                      */
+#define SHAKE_TONAL_SHIFT                   (6)
+
+/* Consecutive tonal blocks needed before a shake is reported                                */
+#define SHAKE_MIN_BLOCKS                    (2)
+
+/* Axes filtered, X and Y                                                                    */
+#define SHAKE_NUM_AXES                      (2)
+
+/* Retention RAM of the stage, struct shake_retained                                        */
+#define SHAKE_RETAINED_SIZE                 ((CFG_GESTURE_STAGE_SHAKE) ? sizeof(struct shake_retained) : 0)
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Goertzel state of one bin on one axis
+struct shake_goertzel
+{
+	int32_t s1;
+	int32_t s2;
+};
+
+/// State of user_shake.c kept in retention RAM
+struct shake_retained
+{
+	/// Coefficient of each bin, looked up by shake_set_rate()
+	int32_t coeff[SHAKE_NUM_BINS];
+	struct shake_goertzel filter[SHAKE_NUM_AXES][SHAKE_NUM_BINS];
+	int32_t energy[SHAKE_NUM_AXES];
+	uint8_t sampleCounter;
+	uint8_t rateShift;
+	uint8_t tonalBlocks;
+	bool reported;
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+ /**
+ ****************************************************************************************
+ * @brief Compute the Goertzel coefficients and reset the filter state
+ ****************************************************************************************
+ */
+void shake_init(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Look up the Goertzel coefficients of a lower sample rate, where blocks keep
+ *        their length in time, and reset the filter state
+ * @param[in] rateShift  samples arrive every 1 << rateShift sample ticks
+ ****************************************************************************************
+ */
+void shake_set_rate(uint8_t rateShift);
+
+ /**
+ ****************************************************************************************
+ * @brief Reset the filter state, keeping the coefficients computed by shake_init()
+ ****************************************************************************************
+ */
+void shake_reset(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Feed one linear acceleration sample of the X and Y axes
+ * @param[in] xLinear  X-axis linear acceleration in counts
+ * @param[in] yLinear  Y-axis linear acceleration in counts
+ * @return true once per sustained oscillation, when the shake is recognised
+ ****************************************************************************************
+ */
+bool shake_update(int8_t xLinear, int8_t yLinear);
+
+#endif // _USER_SHAKE_H_
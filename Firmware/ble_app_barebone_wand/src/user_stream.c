@@ -0,0 +1,270 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_stream.c
+ *
+ * @brief Raw sample streaming for data collection. See user_stream_format.h.
+ *
+ * Frames are built in one of two buffers while the other one is sent. The transfer is
+ * started with uart_send() and runs by DMA on the DA14531 (CFG_UART_DMA_SUPPORT) and by
+ * the UART interrupt on the DA14585/586, which have no DMA controller. Either way the
+ * CPU only waits in WFI: the sleep validation keeps the system out of extended sleep,
+ * not out of idle, while a frame is on the wire. When a frame completes and the other
+ * buffer is still being sent, the new frame is dropped and counted.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "user_stream.h"
+#include "user_xl_driver.h"
+
+#if defined (CFG_STREAM)
+
+#include "ll.h"
+#include "lld_evt.h"
+#include "uart.h"
+
+#if defined (CFG_PRINTF_UART2) || defined (CFG_TRACE) || defined (CFG_CAPTURE)
+    #error "CFG_STREAM takes UART2 over, undefine CFG_PRINTF, CFG_TRACE and CFG_CAPTURE"
+#endif
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+#if defined (CFG_UART_DMA_SUPPORT)
+#define STREAM_UART_OP                      UART_OP_DMA
+#else
+#define STREAM_UART_OP                      UART_OP_INTR
+#endif
+
+/* BLE slots between two accelerometer samples                                              */
+#define STREAM_SLOTS_PER_SAMPLE             (1600 / XL_FIFO_RATE_HZ)
+
+/* Header field offsets                                                                     */
+#define STREAM_OFS_SEQUENCE                 (2)
+#define STREAM_OFS_DROPPED                  (4)
+#define STREAM_OFS_OVERRUNS                 (6)
+#define STREAM_OFS_TIMESTAMP                (8)
+#define STREAM_OFS_RATE                     (12)
+#define STREAM_OFS_COUNT                    (14)
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+// CRC-16/CCITT-FALSE, one nibble at a time
+static const uint16_t streamCrcTable[16] =
+{
+	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+	0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+};
+
+uint8_t streamBuffers[2][STREAM_FRAME_MAX_SIZE];
+// Buffer being filled; the other one may be on the wire
+uint8_t streamFill;
+uint8_t streamCount;
+volatile bool streamTxBusy;
+struct stream_stats streamStats;
+int8_t streamLastSample[XL_NUM_AXES];
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+static uint16_t stream_crc(const uint8_t *data, uint16_t len)
+{
+	uint16_t crc = STREAM_CRC_INIT;
+
+	for(uint16_t i=0;i<len;i++)
+	{
+		crc = (uint16_t)(crc << 4) ^ streamCrcTable[(crc >> 12) ^ (data[i] >> 4)];
+		crc = (uint16_t)(crc << 4) ^ streamCrcTable[(crc >> 12) ^ (data[i] & 0x0F)];
+	}
+	return crc;
+}
+
+static void stream_put_u16(uint8_t *bytes, uint16_t value)
+{
+	bytes[0] = (uint8_t)value;
+	bytes[1] = (uint8_t)(value >> 8);
+}
+
+ /**
+ ****************************************************************************************
+ * @brief UART2 transmit complete, called from the UART or DMA interrupt
+ ****************************************************************************************
+ */
+static void stream_tx_done(uint16_t length)
+{
+	streamTxBusy = false;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Close the frame being filled and send it, or drop it when the other buffer is
+ *        still on the wire
+ ****************************************************************************************
+ */
+static void stream_send_frame(void)
+{
+	uint8_t *frame = streamBuffers[streamFill];
+	uint16_t len = STREAM_HEADER_SIZE + (streamCount * STREAM_SAMPLE_SIZE);
+	uint16_t crc;
+
+	frame[0] = STREAM_SYNC_0;
+	frame[1] = STREAM_SYNC_1;
+	stream_put_u16(&frame[STREAM_OFS_SEQUENCE], streamStats.frames);
+	stream_put_u16(&frame[STREAM_OFS_DROPPED], streamStats.droppedFrames);
+	stream_put_u16(&frame[STREAM_OFS_OVERRUNS], streamStats.overruns);
+	stream_put_u16(&frame[STREAM_OFS_RATE], XL_FIFO_RATE_HZ);
+	frame[STREAM_OFS_COUNT] = streamCount;
+	crc = stream_crc(&frame[2], len - 2);
+	stream_put_u16(&frame[len], crc);
+	len += STREAM_CRC_SIZE;
+
+	streamStats.frames++;
+	streamCount = 0;
+	if(streamTxBusy)
+	{
+		streamStats.droppedFrames++;
+		return;
+	}
+	streamTxBusy = true;
+	uart_send(UART2, frame, len, STREAM_UART_OP);
+	streamFill ^= 1;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Register the UART2 transmit callback and clear the counters
+ ****************************************************************************************
+ */
+void stream_init(void)
+{
+	uart_register_tx_cb(UART2, stream_tx_done);
+	streamFill = 0;
+	streamCount = 0;
+	streamTxBusy = false;
+	streamStats.frames = 0;
+	streamStats.droppedFrames = 0;
+	streamStats.overruns = 0;
+	for(int i=0;i<XL_NUM_AXES;i++)
+	{
+		streamLastSample[i] = 0;
+	}
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Put the accelerometer in FIFO mode
+ ****************************************************************************************
+ */
+void stream_start(void)
+{
+	i2c_XL_Fifo_Mode(true);
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Send the partial frame and take the accelerometer out of FIFO mode
+ ****************************************************************************************
+ */
+void stream_stop(void)
+{
+	while(streamTxBusy);
+	if(streamCount > 0)
+	{
+		stream_send_frame();
+		while(streamTxBusy);
+	}
+	i2c_XL_Fifo_Mode(false);
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Drain the accelerometer FIFO into the stream
+ ****************************************************************************************
+ */
+void stream_xl_update(int8_t *sample)
+{
+	int16_t fifo[XL_FIFO_DEPTH * XL_NUM_AXES];
+	bool overrun;
+	uint8_t count = i2c_XL_Read_Fifo(fifo, XL_FIFO_DEPTH, &overrun);
+	uint32_t now = lld_evt_time_get();
+
+	if(overrun && (streamStats.overruns < UINT16_MAX))
+	{
+		streamStats.overruns++;
+	}
+	for(uint8_t i=0;i<count;i++)
+	{
+		uint8_t *bytes = &streamBuffers[streamFill][STREAM_HEADER_SIZE + (streamCount * STREAM_SAMPLE_SIZE)];
+		const int16_t *axes = &fifo[i * XL_NUM_AXES];
+
+		if(streamCount == 0)
+		{
+			// The newest sample was taken about now, the older ones one sample period apart
+			uint32_t timestamp = now - ((uint32_t)(count - 1 - i) * STREAM_SLOTS_PER_SAMPLE);
+			uint8_t *header = &streamBuffers[streamFill][STREAM_OFS_TIMESTAMP];
+
+			header[0] = (uint8_t)timestamp;
+			header[1] = (uint8_t)(timestamp >> 8);
+			header[2] = (uint8_t)(timestamp >> 16);
+			header[3] = (uint8_t)(timestamp >> 24);
+		}
+		for(int axis=0;axis<XL_NUM_AXES;axis++)
+		{
+			stream_put_u16(&bytes[2 * axis], (uint16_t)axes[axis]);
+		}
+		if(++streamCount == STREAM_FRAME_SAMPLES)
+		{
+			stream_send_frame();
+		}
+	}
+
+	// The pipeline gets the newest sample, or the previous one when the FIFO was empty
+	if(count > 0)
+	{
+		for(int axis=0;axis<XL_NUM_AXES;axis++)
+		{
+			streamLastSample[axis] = (int8_t)(fifo[((count - 1) * XL_NUM_AXES) + axis] >> 8);
+		}
+	}
+	for(int axis=0;axis<XL_NUM_AXES;axis++)
+	{
+		sample[axis] = streamLastSample[axis];
+	}
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Check whether a frame is being sent
+ ****************************************************************************************
+ */
+bool stream_busy(void)
+{
+	return streamTxBusy;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Read the stream counters
+ ****************************************************************************************
+ */
+void stream_get_stats(struct stream_stats *stats)
+{
+	*stats = streamStats;
+}
+
+#endif // CFG_STREAM
@@ -0,0 +1,103 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_stream.h
+ *
+ * @brief Raw sample streaming for data collection. The accelerometer runs from its
+ *        FIFO at XL_FIFO_RATE_HZ and every sample is sent on UART2 at 1Mbaud in
+ *        CRC-checked frames. See user_stream_format.h.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _USER_STREAM_H_
+#define _USER_STREAM_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "user_stream_format.h"
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Stream counters, since stream_init()
+struct stream_stats
+{
+	/// Frames completed, sent or dropped
+	uint16_t frames;
+	/// Frames dropped because the previous frame was still being sent
+	uint16_t droppedFrames;
+	/// Accelerometer FIFO overruns, i.e. samples lost before they were read
+	uint16_t overruns;
+};
+
+#if defined (CFG_STREAM)
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+ /**
+ ****************************************************************************************
+ * @brief Register the UART2 transmit callback and clear the counters
+ ****************************************************************************************
+ */
+void stream_init(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Put the accelerometer in FIFO mode. Called after every i2c_XL_initialize().
+ ****************************************************************************************
+ */
+void stream_start(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Send the partial frame, wait for the UART and take the accelerometer out of
+ *        FIFO mode. Called before the wand goes to sleep.
+ ****************************************************************************************
+ */
+void stream_stop(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Drain the accelerometer FIFO into the stream. Replaces i2c_XL_Read_Sample() in
+ *        the sample tick.
+ * @param[out] sample  newest sample as signed 8-bit values, for the gesture pipeline
+ ****************************************************************************************
+ */
+void stream_xl_update(int8_t *sample);
+
+ /**
+ ****************************************************************************************
+ * @brief Check whether a frame is being sent. The system must not enter extended sleep
+ *        meanwhile, the UART would lose its clock.
+ ****************************************************************************************
+ */
+bool stream_busy(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Read the stream counters
+ * @param[out] stats  counters
+ ****************************************************************************************
+ */
+void stream_get_stats(struct stream_stats *stats);
+
+#else
+
+#define stream_init()
+#define stream_start()
+#define stream_stop()
+#define stream_busy()                       (false)
+
+#endif // CFG_STREAM
+
+#endif // _USER_STREAM_H_
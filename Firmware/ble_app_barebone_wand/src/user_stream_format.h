@@ -0,0 +1,51 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_stream_format.h
+ *
+ * @brief Raw sample stream frame format, shared with the host decoder.
+ *
+ * This header is included by Firmware/host/stream_decode, so it must not depend on the
+ * SDK.
+ *
+ * Frame: STREAM_SYNC_0, STREAM_SYNC_1, then STREAM_HEADER_SIZE - 2 bytes of header,
+ * count * STREAM_SAMPLE_SIZE bytes of samples and the CRC. All fields little endian.
+ *
+ *   uint16_t sequence       incremented for every frame, sent or dropped
+ *   uint16_t droppedFrames  frames dropped because both buffers were busy, since start
+ *   uint16_t overruns       accelerometer FIFO overruns, since start
+ *   uint32_t timestamp      BLE slots when the first sample of the frame was read
+ *   uint16_t sampleRateHz   accelerometer output data rate
+ *   uint8_t  count          samples in the frame
+ *   int16_t  x, y, z        per sample, raw left-justified LIS3DH output
+ *   uint16_t crc            CRC-16/CCITT-FALSE of everything after the sync
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _USER_STREAM_FORMAT_H_
+#define _USER_STREAM_FORMAT_H_
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+#define STREAM_SYNC_0                       (0x5B)
+#define STREAM_SYNC_1                       (0xB5)
+#define STREAM_HEADER_SIZE                  (15)
+#define STREAM_SAMPLE_SIZE                  (6)
+#define STREAM_CRC_SIZE                     (2)
+
+/* Samples per frame. A full frame is 113 bytes, 1.1ms at 1Mbaud                            */
+#define STREAM_FRAME_SAMPLES                (16)
+#define STREAM_FRAME_MAX_SIZE               (STREAM_HEADER_SIZE + (STREAM_FRAME_SAMPLES * STREAM_SAMPLE_SIZE) + STREAM_CRC_SIZE)
+
+/* CRC-16/CCITT-FALSE: polynomial 0x1021, initial value 0xFFFF, no reflection               */
+#define STREAM_CRC_INIT                     (0xFFFF)
+#define STREAM_CRC_POLY                     (0x1021)
+
+/* Timestamps count BLE slots                                                               */
+#define STREAM_TICK_NS                      (625000)
+
+#endif // _USER_STREAM_FORMAT_H_
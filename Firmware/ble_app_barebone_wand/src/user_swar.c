@@ -0,0 +1,153 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_swar.c
+ *
+ * @brief SIMD-within-a-register kernels on packed accelerometer samples.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include "user_swar.h"
+
+#if defined (CFG_SWAR_BENCHMARK)
+#include "systick.h"
+#include "arch_console.h"
+#endif
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+ /**
+ ****************************************************************************************
+ * @brief One filter step over a window of packed samples
+ ****************************************************************************************
+ */
+void swar_window_update(uint32_t *window, uint16_t length, uint16_t index, uint32_t sample, uint8_t shift, int16_t *sum)
+{
+	// x and z accumulate in the 16-bit halves of one word, y (and the spare lane) in the other
+	uint32_t evenLanes = 0;
+	uint32_t oddLanes = 0;
+	uint32_t bias = (uint32_t)length << (SWAR_LANE_BITS - 1);
+
+	for(uint16_t i=0;i<length;i++)
+	{
+		uint32_t packed = (i == index) ? sample : swar_decay(window[i], shift);
+
+		window[i] = packed;
+
+		// Offset every lane by 128 so the lanes sum as unsigned values
+		packed ^= SWAR_LANE_MSB;
+		evenLanes += packed & SWAR_EVEN_LANES;
+		oddLanes += (packed >> SWAR_LANE_BITS) & SWAR_EVEN_LANES;
+	}
+
+	sum[XL_AXIS_X] = (int16_t)((evenLanes & 0xFFFF) - bias);
+	sum[XL_AXIS_Y] = (int16_t)((oddLanes & 0xFFFF) - bias);
+	sum[XL_AXIS_Z] = (int16_t)((evenLanes >> 16) - bias);
+}
+
+#if defined (CFG_SWAR_BENCHMARK)
+
+#define SWAR_BENCHMARK_WINDOW               (16)
+#define SWAR_BENCHMARK_ROUNDS               (1000)
+
+ /**
+ ****************************************************************************************
+ * @brief Microseconds elapsed since a systick_value() reading of the free-running systick
+ ****************************************************************************************
+ */
+static uint32_t swar_benchmark_elapsed(uint32_t start)
+{
+	return (start - systick_value()) & 0x00FFFFFF;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Time the packed kernel against the per-axis loop and print the result
+ ****************************************************************************************
+ */
+void swar_benchmark(void)
+{
+	volatile int8_t xWindow[SWAR_BENCHMARK_WINDOW];
+	volatile int8_t yWindow[SWAR_BENCHMARK_WINDOW];
+	volatile int8_t zWindow[SWAR_BENCHMARK_WINDOW];
+	uint32_t packedWindow[SWAR_BENCHMARK_WINDOW];
+	int16_t sum[XL_NUM_AXES];
+	volatile int checksum = 0;
+	uint32_t start;
+	uint32_t loopTime;
+	uint32_t swarTime;
+
+	for(int i=0;i<SWAR_BENCHMARK_WINDOW;i++)
+	{
+		int8_t sample[XL_NUM_AXES] = {(int8_t)(i * 7 - 50), (int8_t)(90 - i * 11), (int8_t)(i * 3)};
+
+		xWindow[i] = sample[XL_AXIS_X];
+		yWindow[i] = sample[XL_AXIS_Y];
+		zWindow[i] = sample[XL_AXIS_Z];
+		packedWindow[i] = swar_pack(sample);
+	}
+
+	// 1MHz free-running count, reloaded from 0xFFFFFF
+	systick_start(0x1000000, false);
+
+	// Per-axis loop as it used to run on every sample tick
+	start = systick_value();
+	for(int round=0;round<SWAR_BENCHMARK_ROUNDS;round++)
+	{
+		int xData = 0;
+		int yData = 0;
+		int zData = 0;
+		int index = round & (SWAR_BENCHMARK_WINDOW - 1);
+
+		for(int i=0;i<SWAR_BENCHMARK_WINDOW;i++)
+		{
+			xWindow[i] *= 0.9;
+			yWindow[i] *= 0.9;
+			zWindow[i] *= 0.9;
+		}
+		xWindow[index] = (int8_t)round;
+		yWindow[index] = (int8_t)(round >> 1);
+		zWindow[index] = (int8_t)(round >> 2);
+		for(int i=0;i<SWAR_BENCHMARK_WINDOW;i++)
+		{
+			xData += xWindow[i];
+			yData += yWindow[i];
+			zData += zWindow[i];
+		}
+		checksum += xData + yData + zData;
+	}
+	loopTime = swar_benchmark_elapsed(start);
+
+	// Packed kernel on the same window and samples. Its decay is v - ceil(|v| / 8) rather
+	// than the truncated v * 0.9 of the loop, so the windows and checksums differ: only
+	// the times compare
+	start = systick_value();
+	for(int round=0;round<SWAR_BENCHMARK_ROUNDS;round++)
+	{
+		int8_t sample[XL_NUM_AXES] = {(int8_t)round, (int8_t)(round >> 1), (int8_t)(round >> 2)};
+
+		swar_window_update(packedWindow, SWAR_BENCHMARK_WINDOW, round & (SWAR_BENCHMARK_WINDOW - 1),
+			swar_pack(sample), 3, sum);
+		checksum += sum[XL_AXIS_X] + sum[XL_AXIS_Y] + sum[XL_AXIS_Z];
+	}
+	swarTime = swar_benchmark_elapsed(start);
+
+	systick_stop();
+
+	// 16 CPU cycles per microsecond at 16MHz
+	arch_printf("\n\rSWAR benchmark, %d ticks of a %d sample window\n\r", SWAR_BENCHMARK_ROUNDS, SWAR_BENCHMARK_WINDOW);
+	arch_printf("per-axis loop: %d us, %d cycles/tick\n\r", loopTime, (loopTime * 16) / SWAR_BENCHMARK_ROUNDS);
+	arch_printf("packed kernel: %d us, %d cycles/tick\n\r", swarTime, (swarTime * 16) / SWAR_BENCHMARK_ROUNDS);
+}
+
+#endif // CFG_SWAR_BENCHMARK
@@ -0,0 +1,206 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_swar.h
+ *
+ * @brief SIMD-within-a-register kernels on packed accelerometer samples.
+ *
+ * One sample of all three axes fits in a 32-bit word, one signed 8-bit lane per axis
+ * plus a spare lane that is kept at zero:
+ *
+ *     bits 31..24  spare
+ *     bits 23..16  z
+ *     bits 15..8   y
+ *     bits  7..0   x
+ *
+ * The kernels work on all lanes at once without carries crossing lane boundaries, so
+ * the per-axis loops of the filter become one loop over packed words.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _USER_SWAR_H_
+#define _USER_SWAR_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include <stdint.h>
+#include "user_xl_driver.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/* Define to time the packed filter kernel against the per-axis loop at start-up and print   */
+/* the result on the console (needs CFG_PRINTF). Not measured on the target yet. Simulator   */
+/* estimate only, under Firmware/host/arm_bench/m0plus_sim with clang -O2 and the C soft     */
+/* double helpers of arm_bench/rt/arm_rt.c, not armcc's fplib: per-axis loop about 22.8k     */
+/* cycles a tick, 21.5k of them in those helpers; packed kernel about 1.09k cycles a tick    */
+#undef CFG_SWAR_BENCHMARK
+
+#define SWAR_LANE_BITS                      (8)
+#define SWAR_LANE_LSB                       (0x01010101UL)
+#define SWAR_LANE_MSB                       (0x80808080UL)
+#define SWAR_LANE_LOW7                      (0x7F7F7F7FUL)
+#define SWAR_AXES_MASK                      (0x00FFFFFFUL)
+#define SWAR_EVEN_LANES                     (0x00FF00FFUL)
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+ */
+
+ /**
+ ****************************************************************************************
+ * @brief Pack one sample
+ * @param[in] sample XL_NUM_AXES cell array (x,y,z)
+ * @return packed sample, spare lane zero
+ ****************************************************************************************
+ */
+static inline uint32_t swar_pack(const int8_t *sample)
+{
+	return (uint32_t)(uint8_t)sample[XL_AXIS_X] |
+		((uint32_t)(uint8_t)sample[XL_AXIS_Y] << SWAR_LANE_BITS) |
+		((uint32_t)(uint8_t)sample[XL_AXIS_Z] << (2 * SWAR_LANE_BITS));
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Extract one axis of a packed sample
+ * @param[in] packed  packed sample
+ * @param[in] axis    XL_AXIS_X, XL_AXIS_Y or XL_AXIS_Z
+ * @return signed lane value
+ ****************************************************************************************
+ */
+static inline int8_t swar_lane(uint32_t packed, uint8_t axis)
+{
+	return (int8_t)(uint8_t)(packed >> (axis * SWAR_LANE_BITS));
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Lane-wise wrapping add
+ ****************************************************************************************
+ */
+static inline uint32_t swar_add(uint32_t a, uint32_t b)
+{
+	// Add the low 7 bits of every lane, then fix up the top bits without a carry out
+	return ((a & SWAR_LANE_LOW7) + (b & SWAR_LANE_LOW7)) ^ ((a ^ b) & SWAR_LANE_MSB);
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Lane-wise wrapping subtract (a - b)
+ ****************************************************************************************
+ */
+static inline uint32_t swar_sub(uint32_t a, uint32_t b)
+{
+	// Set the top bit of every lane of a so no lane borrows from its neighbour
+	return ((a | SWAR_LANE_MSB) - (b & SWAR_LANE_LOW7)) ^ ((a ^ ~b) & SWAR_LANE_MSB);
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Full-lane mask of the negative lanes (0xFF where the lane is negative)
+ ****************************************************************************************
+ */
+static inline uint32_t swar_sign_mask(uint32_t packed)
+{
+	return ((packed & SWAR_LANE_MSB) >> (SWAR_LANE_BITS - 1)) * 0xFF;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Lane-wise absolute value. -128 saturates to 128 (0x80), which reads correctly
+ *        as an unsigned lane.
+ ****************************************************************************************
+ */
+static inline uint32_t swar_abs(uint32_t packed)
+{
+	uint32_t sign = swar_sign_mask(packed);
+
+	// Ones' complement plus one on the negative lanes. A lane never exceeds 0x80, so no carry
+	return (packed ^ sign) + (sign & SWAR_LANE_LSB);
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Lane-wise decay towards zero: v - ceil(|v| / 2^shift) with the sign of v
+ * @param[in] packed  packed sample
+ * @param[in] shift   decay shift, 1..7
+ ****************************************************************************************
+ */
+static inline uint32_t swar_decay(uint32_t packed, uint8_t shift)
+{
+	uint32_t sign = swar_sign_mask(packed);
+	uint32_t magnitude = (packed ^ sign) + (sign & SWAR_LANE_LSB);
+	uint32_t roundUp = ((1UL << shift) - 1) * SWAR_LANE_LSB;
+	uint32_t step = ((magnitude + roundUp) >> shift) & ((0xFFUL >> shift) * SWAR_LANE_LSB);
+
+	// Magnitudes are at most 0x80 and the rounding adds at most 0x7F, so nothing carries
+	magnitude -= step;
+
+	// Negate the negative lanes back; swar_sub keeps a zero lane from borrowing
+	return (magnitude & ~sign) | (swar_sub(0, magnitude) & sign);
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Largest absolute value of the x, y and z lanes
+ * @param[in] packed      packed sample
+ * @param[out] axis       axis holding the largest absolute value, the lowest on a tie
+ * @return largest absolute value (0..128)
+ ****************************************************************************************
+ */
+static inline uint8_t swar_abs_max(uint32_t packed, uint8_t *axis)
+{
+	uint32_t magnitude = swar_abs(packed);
+	uint8_t largest = (uint8_t)magnitude;
+	uint8_t largestAxis = XL_AXIS_X;
+
+	for(uint8_t i=XL_AXIS_Y;i<XL_NUM_AXES;i++)
+	{
+		uint8_t lane = (uint8_t)(magnitude >> (i * SWAR_LANE_BITS));
+
+		if(lane > largest)
+		{
+			largest = lane;
+			largestAxis = i;
+		}
+	}
+	*axis = largestAxis;
+	return largest;
+}
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+ /**
+ ****************************************************************************************
+ * @brief One filter step over a window of packed samples: decay every stored sample,
+ *        replace the one at index with the new sample and sum the axes.
+ * @param[in,out] window  packed samples
+ * @param[in] length      number of samples, at most 257
+ * @param[in] index       slot receiving the new sample
+ * @param[in] sample      new packed sample, stored without decay
+ * @param[in] shift       decay shift (see swar_decay())
+ * @param[out] sum        XL_NUM_AXES cell array of per-axis sums
+ ****************************************************************************************
+ */
+void swar_window_update(uint32_t *window, uint16_t length, uint16_t index, uint32_t sample, uint8_t shift, int16_t *sum);
+
+#if defined (CFG_SWAR_BENCHMARK)
+ /**
+ ****************************************************************************************
+ * @brief Time the packed kernel against the per-axis loop and print the result
+ ****************************************************************************************
+ */
+void swar_benchmark(void);
+#endif
+
+#endif // _USER_SWAR_H_
@@ -0,0 +1,139 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_timer_wheel.c
+ *
+ * @brief Application timer wheel driven by the 10ms sample tick.
+ *
+ * Every slot is a list linked through the timers, so the wheel itself is one pointer
+ * per slot. The back link of a timer points to whatever points to it, the slot or the
+ * previous timer, which lets a timer be unlinked without knowing its slot.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "user_timer_wheel.h"
+#include "compiler.h"
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+// Everything the module keeps across sleep, see struct timer_wheel_retained
+struct timer_wheel_retained timerWheelRetained  __SECTION_ZERO("retention_mem_area0"); //@RETENTION MEMORY
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+ /**
+ ****************************************************************************************
+ * @brief Insert a timer at the head of a list
+ ****************************************************************************************
+ */
+static void timer_wheel_link(struct timer_wheel_timer **head, struct timer_wheel_timer *timer)
+{
+	timer->next = *head;
+	if(timer->next != NULL)
+	{
+		timer->next->pprev = &timer->next;
+	}
+	*head = timer;
+	timer->pprev = head;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Remove a timer from its list
+ ****************************************************************************************
+ */
+static void timer_wheel_unlink(struct timer_wheel_timer *timer)
+{
+	*timer->pprev = timer->next;
+	if(timer->next != NULL)
+	{
+		timer->next->pprev = timer->pprev;
+	}
+	timer->next = NULL;
+	timer->pprev = NULL;
+}
+
+void timer_wheel_init(void)
+{
+	for(uint8_t i=0;i<TIMER_WHEEL_SLOTS;i++)
+	{
+		timerWheelRetained.slots[i] = NULL;
+	}
+	timerWheelRetained.now = 0;
+}
+
+void timer_wheel_arm(struct timer_wheel_timer *timer, uint32_t ticks, timer_wheel_cb_t callback)
+{
+	if(timer->pprev != NULL)
+	{
+		timer_wheel_unlink(timer);
+	}
+	if(ticks == 0)
+	{
+		ticks = 1;
+	}
+	timer->turns = (uint16_t)((ticks - 1) / TIMER_WHEEL_SLOTS);
+	timer->callback = callback;
+	timer_wheel_link(&timerWheelRetained.slots[(timerWheelRetained.now + ticks) & (TIMER_WHEEL_SLOTS - 1)], timer);
+}
+
+void timer_wheel_cancel(struct timer_wheel_timer *timer)
+{
+	if(timer->pprev != NULL)
+	{
+		timer_wheel_unlink(timer);
+	}
+}
+
+bool timer_wheel_armed(const struct timer_wheel_timer *timer)
+{
+	return timer->pprev != NULL;
+}
+
+void timer_wheel_tick(void)
+{
+	struct timer_wheel_timer **slot;
+	struct timer_wheel_timer *pending;
+
+	timerWheelRetained.now = (timerWheelRetained.now + 1) & (TIMER_WHEEL_SLOTS - 1);
+	slot = &timerWheelRetained.slots[timerWheelRetained.now];
+
+	// Take the slot over so callbacks can arm timers into it, or cancel the ones not
+	// handled yet, while it is walked
+	pending = *slot;
+	*slot = NULL;
+	if(pending != NULL)
+	{
+		pending->pprev = &pending;
+	}
+	while(pending != NULL)
+	{
+		struct timer_wheel_timer *timer = pending;
+
+		timer_wheel_unlink(timer);
+		if(timer->turns > 0)
+		{
+			timer->turns--;
+			timer_wheel_link(slot, timer);
+		}
+		else
+		{
+			timer->callback();
+		}
+	}
+}
@@ -0,0 +1,113 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_timer_wheel.h
+ *
+ * @brief Application timer wheel driven by the 10ms sample tick.
+ *
+ * Short timeouts that are armed and cancelled often, such as the gesture lockout, run
+ * here instead of in the app_easy_timer pool: arming, cancelling and re-arming is a few
+ * pointer writes, with no kernel message and no handle. The wheel only advances while
+ * the sample tick runs, so it suits timeouts of the sampling states; wake-ups that must
+ * happen without the tick stay on app_easy_timer().
+ *
+ * A timer is a struct timer_wheel_timer owned by the caller. It lands in slot
+ * (now + ticks) % TIMER_WHEEL_SLOTS and is skipped for as many turns of the wheel as
+ * its timeout is longer than one turn.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _USER_TIMER_WHEEL_H_
+#define _USER_TIMER_WHEEL_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/* Slots of the wheel, a power of 2. One pointer of retention RAM each                      */
+#define TIMER_WHEEL_SLOTS                   (32)
+
+/* Retention RAM of the wheel, struct timer_wheel_retained                                  */
+#define TIMER_WHEEL_RETAINED_SIZE           (sizeof(struct timer_wheel_retained))
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Called from timer_wheel_tick() when the timer expires; the timer is no longer armed
+typedef void (*timer_wheel_cb_t)(void);
+
+/// Timer, zero initialised or cancelled before its first use
+struct timer_wheel_timer
+{
+	struct timer_wheel_timer *next;
+	/// Link that points to this timer, NULL while not armed
+	struct timer_wheel_timer **pprev;
+	/// Turns of the wheel left before the timer expires in its slot
+	uint16_t turns;
+	timer_wheel_cb_t callback;
+};
+
+/// State of user_timer_wheel.c kept in retention RAM
+struct timer_wheel_retained
+{
+	struct timer_wheel_timer *slots[TIMER_WHEEL_SLOTS];
+	/// Slot of the last tick
+	uint8_t now;
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+ /**
+ ****************************************************************************************
+ * @brief Empty the wheel. Timers armed before are forgotten, not cancelled.
+ ****************************************************************************************
+ */
+void timer_wheel_init(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Arm a timer, or re-arm it when it is armed already
+ * @param[in] timer     timer
+ * @param[in] ticks     sample ticks before it expires, at least 1
+ * @param[in] callback  called when it expires
+ ****************************************************************************************
+ */
+void timer_wheel_arm(struct timer_wheel_timer *timer, uint32_t ticks, timer_wheel_cb_t callback);
+
+ /**
+ ****************************************************************************************
+ * @brief Cancel a timer; nothing happens when it is not armed
+ ****************************************************************************************
+ */
+void timer_wheel_cancel(struct timer_wheel_timer *timer);
+
+ /**
+ ****************************************************************************************
+ * @brief True while the timer is armed
+ ****************************************************************************************
+ */
+bool timer_wheel_armed(const struct timer_wheel_timer *timer);
+
+ /**
+ ****************************************************************************************
+ * @brief Advance the wheel by one sample tick and run the callbacks of the timers that
+ *        expire. Callbacks may arm and cancel any timer.
+ ****************************************************************************************
+ */
+void timer_wheel_tick(void);
+
+#endif // _USER_TIMER_WHEEL_H_
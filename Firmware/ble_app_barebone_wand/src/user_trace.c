@@ -0,0 +1,156 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_trace.c
+ *
+ * @brief Binary event trace. Events are recorded as fixed-size records in a RAM ring
+ *        and written to UART2 when the system is about to sleep.
+ *
+ * Recording costs a timestamp read and an 8-byte copy, no formatting. The host decoder
+ * (Firmware/host/trace_decode) turns the frames back into text.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include "user_trace.h"
+
+#if defined (CFG_TRACE)
+
+#include "ll.h"
+#include "lld_evt.h"
+#include "uart.h"
+
+#if (TRACE_RING_LEN & (TRACE_RING_LEN - 1)) || (TRACE_RING_LEN > 128)
+    #error "TRACE_RING_LEN must be a power of two, at most 128"
+#endif
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// One trace record, TRACE_RECORD_SIZE bytes
+struct trace_record
+{
+	uint32_t timestamp;
+	uint8_t event;
+	uint8_t argA;
+	uint16_t argB;
+};
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+struct trace_record traceRing[TRACE_RING_LEN];
+// Free-running indexes, the ring slot is the index modulo TRACE_RING_LEN
+volatile uint8_t traceHead;
+volatile uint8_t traceTail;
+volatile uint8_t traceDropped;
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+ /**
+ ****************************************************************************************
+ * @brief Empty the ring
+ ****************************************************************************************
+ */
+void trace_init(void)
+{
+	traceHead = 0;
+	traceTail = 0;
+	traceDropped = 0;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Record one event
+ ****************************************************************************************
+ */
+void trace_event(uint8_t event, uint8_t argA, uint16_t argB)
+{
+	GLOBAL_INT_DISABLE();
+	if((uint8_t)(traceHead - traceTail) < TRACE_RING_LEN)
+	{
+		struct trace_record *record = &traceRing[traceHead & (TRACE_RING_LEN - 1)];
+
+		record->timestamp = lld_evt_time_get();
+		record->event = event;
+		record->argA = argA;
+		record->argB = argB;
+		traceHead++;
+	}
+	else if(traceDropped < UINT8_MAX)
+	{
+		traceDropped++;
+	}
+	GLOBAL_INT_RESTORE();
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Write up to maxRecords records to UART2 as one frame
+ ****************************************************************************************
+ */
+void trace_flush(uint8_t maxRecords)
+{
+	uint8_t header[TRACE_HEADER_SIZE];
+	uint8_t count = (uint8_t)(traceHead - traceTail);
+	uint8_t checksum;
+
+	if(count == 0)
+	{
+		return;
+	}
+	if(count > maxRecords)
+	{
+		count = maxRecords;
+	}
+
+	header[0] = TRACE_SYNC_0;
+	header[1] = TRACE_SYNC_1;
+	header[2] = count;
+	GLOBAL_INT_DISABLE();
+	header[3] = traceDropped;
+	traceDropped = 0;
+	GLOBAL_INT_RESTORE();
+	checksum = header[2] + header[3];
+	uart_write_buffer(UART2, header, TRACE_HEADER_SIZE);
+
+	for(uint8_t i=0;i<count;i++)
+	{
+		const struct trace_record *record = &traceRing[traceTail & (TRACE_RING_LEN - 1)];
+		uint8_t bytes[TRACE_RECORD_SIZE];
+
+		// Serialise field by field so the wire format does not depend on struct layout
+		bytes[0] = (uint8_t)record->timestamp;
+		bytes[1] = (uint8_t)(record->timestamp >> 8);
+		bytes[2] = (uint8_t)(record->timestamp >> 16);
+		bytes[3] = (uint8_t)(record->timestamp >> 24);
+		bytes[4] = record->event;
+		bytes[5] = record->argA;
+		bytes[6] = (uint8_t)record->argB;
+		bytes[7] = (uint8_t)(record->argB >> 8);
+		for(int j=0;j<TRACE_RECORD_SIZE;j++)
+		{
+			checksum += bytes[j];
+		}
+		uart_write_buffer(UART2, bytes, TRACE_RECORD_SIZE);
+		// Only the flush moves the tail, so the slot is released after it has been sent
+		traceTail++;
+	}
+	uart_write_buffer(UART2, &checksum, 1);
+	uart_wait_tx_finish(UART2);
+}
+
+#endif // CFG_TRACE
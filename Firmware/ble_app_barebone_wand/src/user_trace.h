@@ -0,0 +1,78 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_trace.h
+ *
+ * @brief Binary event trace. Events are recorded as fixed-size records in a RAM ring
+ *        and written to UART2 when the system is about to sleep.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _USER_TRACE_H_
+#define _USER_TRACE_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include <stdint.h>
+#include "user_trace_events.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/* Records held in the ring. Must be a power of two, at most 128                            */
+#define TRACE_RING_LEN                      (32)
+
+/* Records written per pass of the idle flush. Each record takes about 0.8ms at 115200    */
+/* baud, so a small batch keeps the sample tick on time                                     */
+#define TRACE_FLUSH_BATCH                   (4)
+
+#if defined (CFG_TRACE)
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+ /**
+ ****************************************************************************************
+ * @brief Empty the ring
+ ****************************************************************************************
+ */
+void trace_init(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Record one event. Safe to call from interrupt context. When the ring is full
+ *        the event is dropped and counted.
+ * @param[in] event  TRACE_EVT_x value
+ * @param[in] argA   first argument, see the format in TRACE_EVENTS
+ * @param[in] argB   second argument, see the format in TRACE_EVENTS
+ ****************************************************************************************
+ */
+void trace_event(uint8_t event, uint8_t argA, uint16_t argB);
+
+ /**
+ ****************************************************************************************
+ * @brief Write up to maxRecords records to UART2 as one frame and wait for the UART to
+ *        drain. Does nothing when the ring is empty.
+ * @param[in] maxRecords  records to write at most
+ ****************************************************************************************
+ */
+void trace_flush(uint8_t maxRecords);
+
+#define TRACE_EVENT(event, argA, argB)      trace_event((event), (argA), (argB))
+
+#else
+
+#define trace_init()
+#define trace_flush(maxRecords)
+#define TRACE_EVENT(event, argA, argB)
+
+#endif // CFG_TRACE
+
+#endif // _USER_TRACE_H_
@@ -0,0 +1,76 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_trace_events.h
+ *
+ * @brief Trace event table and wire format, shared with the host decoder.
+ *
+ * This header is included by Firmware/host/trace_decode, so it must not depend on
+ * the SDK.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _USER_TRACE_EVENTS_H_
+#define _USER_TRACE_EVENTS_H_
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/* Frame on the wire: TRACE_SYNC_0, TRACE_SYNC_1, record count, dropped records,            */
+/* count * TRACE_RECORD_SIZE bytes of records, 8-bit sum of everything after the sync       */
+#define TRACE_SYNC_0                        (0xA5)
+#define TRACE_SYNC_1                        (0x5A)
+#define TRACE_HEADER_SIZE                   (4)
+
+/* Record: timestamp (uint32_t, little endian), event, argA (uint8_t), argB (uint16_t)      */
+#define TRACE_RECORD_SIZE                   (8)
+
+/* Timestamps count BLE slots                                                               */
+#define TRACE_TICK_NS                       (625000)
+
+/* Event table. X(name, id, format): the format is a printf format the decoder applies to   */
+/* argA and argB, in that order. Events that only carry argB pass argA = 0 and skip it      */
+/* with %.0u. A format starting with '#' carries one 24-bit value, (argA << 16) | argB,     */
+/* printed with %lu. Latency bins are log2 of BLE slots, see user_latency.h                 */
+#define TRACE_EVENTS(X)                                                                    \
+	X(GESTURE,                    0x01,   "gesture '%c' slot %u")                          \
+	X(LOCKOUT_END,                0x02,   "lockout end")                                   \
+	X(DISPLAY_RESET,              0x03,   "display reset, %u gestures")                    \
+	X(MOTOR_START,                0x04,   "motor start, pattern %u")                       \
+	X(MOTOR_STOP,                 0x05,   "motor stop")                                    \
+	X(WAKEUP,                     0x06,   "wakeup by button")                              \
+	X(SLEEP,                      0x07,   "going to sleep")                                \
+	X(LATENCY_MOVEMENTS,          0x08,   "latency: %.0u%u movements")                     \
+	X(LATENCY_TIMEOUTS,           0x09,   "latency: %.0u%u movements without gesture")     \
+	X(LATENCY_ONSET_TO_DETECT,    0x0A,   "latency onset->detect, bin %u: %u")             \
+	X(LATENCY_DETECT_TO_COMMIT,   0x0B,   "latency detect->commit, bin %u: %u")            \
+	X(LATENCY_COMMIT_TO_ADV,      0x0C,   "latency commit->adv, bin %u: %u")               \
+	X(LATENCY_ONSET_TO_ADV,       0x0D,   "latency onset->adv, bin %u: %u")                \
+	X(STATE,                      0x0E,   "state %u after event %u")                       \
+	X(STATE_RESIDENCY,            0x0F,   "state %u residency %u0ms")                      \
+	X(ENERGY_AWAKE_SLOTS,         0x10,   "#energy awake_slots %lu")                       \
+	X(ENERGY_SLEEP_SLOTS,         0x11,   "#energy sleep_slots %lu")                       \
+	X(ENERGY_I2C_TRANSACTIONS,    0x12,   "#energy i2c_transactions %lu")                  \
+	X(ENERGY_I2C_BYTES,           0x13,   "#energy i2c_bytes %lu")                         \
+	X(ENERGY_ADV_SLOTS,           0x14,   "#energy adv_slots %lu")                         \
+	X(ENERGY_ADV_INTERVAL_SLOTS,  0x15,   "#energy adv_interval_slots %lu")                \
+	X(ENERGY_MOTOR_SLOTS,         0x16,   "#energy motor_slots %lu")                       \
+	X(ENERGY_XL_ACTIVE_SLOTS,     0x17,   "#energy xl_active_slots %lu")                   \
+	X(ENERGY_SAMPLES,             0x18,   "#energy samples %lu")                           \
+	X(ENERGY_WAKEUPS,             0x19,   "#energy wakeups %lu")                           \
+	X(WORK_DROPPED,               0x1A,   "work queue full, %.0u%u samples dropped")      \
+	X(BATTERY,                    0x1B,   "battery level %u at %umV")                      \
+	X(XL_FAULT,                   0x1C,   "accelerometer bus fault %u, %u so far")
+
+#define TRACE_EVENT_ENUM(name, id, format)  TRACE_EVT_##name = (id),
+
+/// Trace event identifiers
+enum trace_event
+{
+	TRACE_EVENTS(TRACE_EVENT_ENUM)
+};
+
+#endif // _USER_TRACE_EVENTS_H_
@@ -0,0 +1,124 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_twist.c
+ *
+ * @brief Twist (roll about the long axis) detection from the gravity estimate.
+ *
+ * Twisting the wand barely changes the linear acceleration but rotates the gravity
+ * vector in the plane perpendicular to the long axis. The per-sample roll change is
+ * kept in a ring so the rotation over the window is a running sum, updated in O(1).
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "user_motion.h"
+#include "user_twist.h"
+#include "compiler.h"
+
+#if (CFG_GESTURE_STAGE_TWIST)
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+// Everything the module keeps across sleep, see struct twist_retained
+struct twist_retained twistRetained             __SECTION_ZERO("retention_mem_area0"); //@RETENTION MEMORY
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+ /**
+ ****************************************************************************************
+ * @brief Restart the roll window
+ ****************************************************************************************
+ */
+void twist_init(void)
+{
+	for(int i=0;i<TWIST_WINDOW_LEN;i++)
+	{
+		twistRetained.deltaRing[i] = 0;
+	}
+	twistRetained.ringIndex = 0;
+	twistRetained.windowSum = 0;
+	twistRetained.tracking = false;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Keep the length of the roll window in time at a lower sample rate
+ ****************************************************************************************
+ */
+void twist_set_rate(uint8_t rateShift)
+{
+	twistRetained.rateShift = rateShift;
+	twist_init();
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Track the roll of the gravity estimate. Call after motion_update().
+ ****************************************************************************************
+ */
+enum twist_direction twist_update(void)
+{
+	int8_t gravityA = motion_gravity(TWIST_ROLL_AXIS_A);
+	int8_t gravityB = motion_gravity(TWIST_ROLL_AXIS_B);
+	uint8_t roll;
+	int8_t rollDelta;
+	enum twist_direction direction;
+
+	// Swings drag the gravity estimate along and a vertical wand has no roll angle
+	if((abs(motion_norm_sq() - (MOTION_ONE_G * MOTION_ONE_G)) > TWIST_MAX_NORM_DEVIATION) ||
+		((abs(gravityA) + abs(gravityB)) < TWIST_MIN_GRAVITY))
+	{
+		if(twistRetained.tracking)
+		{
+			twist_init();
+		}
+		return TWIST_NONE;
+	}
+
+	roll = angle_atan2(gravityB, gravityA);
+	if(!twistRetained.tracking)
+	{
+		twistRetained.previousRoll = roll;
+		twistRetained.tracking = true;
+		return TWIST_NONE;
+	}
+
+	rollDelta = angle_delta(twistRetained.previousRoll, roll);
+	twistRetained.previousRoll = roll;
+
+	twistRetained.windowSum += rollDelta - twistRetained.deltaRing[twistRetained.ringIndex];
+	twistRetained.deltaRing[twistRetained.ringIndex] = rollDelta;
+	twistRetained.ringIndex = (twistRetained.ringIndex + 1) & ((TWIST_WINDOW_LEN >> twistRetained.rateShift) - 1);
+
+	if(abs(twistRetained.windowSum) < TWIST_ANGLE_THRESHOLD)
+	{
+		return TWIST_NONE;
+	}
+
+	// Gravity rolls the opposite way to the wand. Swap TWIST_ROLL_AXIS_A and
+	// TWIST_ROLL_AXIS_B if the sensor is mounted the other way round
+	direction = (twistRetained.windowSum > 0) ? TWIST_CLOCKWISE : TWIST_COUNTER_CLOCKWISE;
+
+	// Start a fresh window so one twist is reported once
+	twist_init();
+	twistRetained.previousRoll = roll;
+	twistRetained.tracking = true;
+	return direction;
+}
+
+#endif // CFG_GESTURE_STAGE_TWIST
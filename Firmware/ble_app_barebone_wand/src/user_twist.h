@@ -0,0 +1,107 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_twist.h
+ *
+ * @brief Twist (roll about the long axis) detection from the gravity estimate.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _USER_TWIST_H_
+#define _USER_TWIST_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "user_angle.h"
+#include "user_motion.h"
+#include "user_gesture_config.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/* Axes spanning the plane perpendicular to the long axis of the wand (Z)                    */
+#define TWIST_ROLL_AXIS_A                   XL_AXIS_X
+#define TWIST_ROLL_AXIS_B                   XL_AXIS_Y
+
+/* Roll change window. Must be a power of two                                                */
+#define TWIST_WINDOW_SHIFT                  CFG_GESTURE_TWIST_WINDOW_SHIFT
+#define TWIST_WINDOW_LEN                    (1 << TWIST_WINDOW_SHIFT)
+
+/* Roll change within the window that is reported as a twist                                */
+#define TWIST_ANGLE_THRESHOLD               ANGLE_DEG_TO_BRAD(CFG_GESTURE_TWIST_ANGLE_DEG)
+
+/* Gravity in the roll plane needed for a meaningful roll angle (|a|+|b| in counts).         */
+/* Pointing the wand straight up or down leaves no roll angle to track                       */
+#define TWIST_MIN_GRAVITY                   (24)
+
+/* Deviation of the squared sample magnitude from 1g^2 above which the wand is being swung,  */
+/* rather than rotated, and the window is restarted. 1600 is about +/-20% of 1g              */
+#define TWIST_MAX_NORM_DEVIATION            (1600)
+
+/// Result of twist_update()
+enum twist_direction
+{
+	TWIST_NONE = 0,
+	/// Clockwise looking from the handle towards the tip
+	TWIST_CLOCKWISE,
+	TWIST_COUNTER_CLOCKWISE
+};
+
+/* Retention RAM of the stage, struct twist_retained                                        */
+#define TWIST_RETAINED_SIZE                 ((CFG_GESTURE_STAGE_TWIST) ? sizeof(struct twist_retained) : 0)
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// State of user_twist.c kept in retention RAM
+struct twist_retained
+{
+	/// Sum of deltaRing, the roll change within the window
+	int16_t windowSum;
+	/// Roll change of the last samples
+	int8_t deltaRing[TWIST_WINDOW_LEN];
+	uint8_t ringIndex;
+	uint8_t previousRoll;
+	bool tracking;
+	uint8_t rateShift;
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+ /**
+ ****************************************************************************************
+ * @brief Restart the roll window
+ ****************************************************************************************
+ */
+void twist_init(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Keep the length of the roll window in time at a lower sample rate
+ * @param[in] rateShift  samples arrive every 1 << rateShift sample ticks
+ ****************************************************************************************
+ */
+void twist_set_rate(uint8_t rateShift);
+
+ /**
+ ****************************************************************************************
+ * @brief Track the roll of the gravity estimate. Call after motion_update().
+ * @return TWIST_CLOCKWISE or TWIST_COUNTER_CLOCKWISE once per recognised twist,
+ *         TWIST_NONE otherwise
+ ****************************************************************************************
+ */
+enum twist_direction twist_update(void);
+
+#endif // _USER_TWIST_H_
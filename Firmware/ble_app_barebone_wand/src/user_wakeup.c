@@ -47,6 +47,8 @@
 #include "uart_utils.h"
 #include "user_barebone.h"
 #include "arch_console.h"
+#include "user_trace.h"
+#include "user_lifecycle.h"
 
 /*
  * TYPE DEFINITIONS
@@ -88,25 +90,12 @@ void user_reset_event_counter(void){
 void user_app_wakeup_press_cb(void)
 {
 	SetBits16(WKUP_CTRL_REG, WKUP_ENABLE_IRQ, INTERRUPT_ENABLE); //Resets interupt
-	if (arch_ble_ext_wakeup_get())
+	// If wakeup is generated by SW2 while sleeping; a bounce leaves the system asleep
+	if (arch_ble_ext_wakeup_get() && !GPIO_GetPinStatus(GPIO_BUTTON_PORT, GPIO_BUTTON_PIN))
 	{
-		arch_set_sleep_mode(ARCH_SLEEP_OFF);
-		arch_ble_force_wakeup();
-		arch_ble_ext_wakeup_off();
-		// If wakeup is generated by SW2
-		if(!GPIO_GetPinStatus(GPIO_BUTTON_PORT, GPIO_BUTTON_PIN))						
-		{										
-				#ifdef CFG_PRINTF_UART2
-				arch_printf("\n\n\rWakeup source: INT\n\n\r",NULL);
-				user_app_waking_from_sleep();
-				#endif
-		}
-		// If state is idle, start advertising
-		if (ke_state_get(TASK_APP) == APP_CONNECTABLE)
-		{
-				user_app_adv_start();
-		}
-		
+		TRACE_EVENT(TRACE_EVT_WAKEUP, 0, 0);
+		// Leaving SLEEPING hands wake-up back to the BLE timer and starts advertising
+		lifecycle_post(LIFECYCLE_EVT_WAKE, 0);
 	}
 //	else if (!arch_ble_ext_wakeup_get()){
 //		#ifdef CFG_PRINTF_UART2
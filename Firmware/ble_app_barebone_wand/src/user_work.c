@@ -0,0 +1,104 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_work.c
+ *
+ * @brief Deferred work: samples queued by the sample tick, processed from the main loop.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "user_work.h"
+#include "compiler.h"
+#include "ll.h"
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+// Everything the module keeps across sleep, see struct work_retained
+struct work_retained workRetained               __SECTION_ZERO("retention_mem_area0"); //@RETENTION MEMORY
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+void work_init(void)
+{
+	GLOBAL_INT_DISABLE();
+	workRetained.head = 0;
+	workRetained.tail = 0;
+	workRetained.dropped = 0;
+	GLOBAL_INT_RESTORE();
+}
+
+bool work_push_sample(const int8_t *sample, uint8_t ticks)
+{
+	bool queued = false;
+
+	GLOBAL_INT_DISABLE();
+	if((uint8_t)(workRetained.head - workRetained.tail) < WORK_QUEUE_LEN)
+	{
+		int8_t *slot = workRetained.queue[workRetained.head & (WORK_QUEUE_LEN - 1)];
+
+		for(int i=0;i<XL_NUM_AXES;i++)
+		{
+			slot[i] = sample[i];
+		}
+		workRetained.ticks[workRetained.head & (WORK_QUEUE_LEN - 1)] = ticks;
+		workRetained.head++;
+		queued = true;
+	}
+	else if(workRetained.dropped < UINT16_MAX)
+	{
+		workRetained.dropped++;
+	}
+	GLOBAL_INT_RESTORE();
+	return queued;
+}
+
+bool work_pop_sample(int8_t *sample, uint8_t *ticks)
+{
+	bool popped = false;
+
+	GLOBAL_INT_DISABLE();
+	if(workRetained.head != workRetained.tail)
+	{
+		const int8_t *slot = workRetained.queue[workRetained.tail & (WORK_QUEUE_LEN - 1)];
+
+		for(int i=0;i<XL_NUM_AXES;i++)
+		{
+			sample[i] = slot[i];
+		}
+		*ticks = workRetained.ticks[workRetained.tail & (WORK_QUEUE_LEN - 1)];
+		workRetained.tail++;
+		popped = true;
+	}
+	GLOBAL_INT_RESTORE();
+	return popped;
+}
+
+bool work_pending(void)
+{
+	return workRetained.head != workRetained.tail;
+}
+
+uint16_t work_take_dropped(void)
+{
+	uint16_t dropped;
+
+	GLOBAL_INT_DISABLE();
+	dropped = workRetained.dropped;
+	workRetained.dropped = 0;
+	GLOBAL_INT_RESTORE();
+	return dropped;
+}
@@ -0,0 +1,106 @@
+/**
+ ****************************************************************************************
+ *
+ * @file user_work.h
+ *
+ * @brief Deferred work: samples queued by the sample tick, processed from the main loop.
+ *
+ * The sample tick only reads the accelerometer and queues the sample, with the number
+ * of 10ms ticks it stands for when a low battery level reads less often. The gesture
+ * pipeline runs later from the app_on_system_powered main loop callback, at most
+ * WORK_BUDGET samples per call, so the BLE scheduler runs between them however long a
+ * sample takes. The main loop does not sleep while samples are queued.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _USER_WORK_H_
+#define _USER_WORK_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "user_xl_driver.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/* Queued samples, a power of 2. A full queue drops the new sample                          */
+#define WORK_QUEUE_LEN                      (8)
+
+/* Samples processed per app_on_system_powered call before the BLE scheduler runs again     */
+#define WORK_BUDGET                         (2)
+
+/* Retention RAM of the queue, struct work_retained                                         */
+#define WORK_RETAINED_SIZE                  (sizeof(struct work_retained))
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// State of user_work.c kept in retention RAM
+struct work_retained
+{
+	/// Samples dropped on a full queue, saturated
+	uint16_t dropped;
+	int8_t queue[WORK_QUEUE_LEN][XL_NUM_AXES];
+	/// Sample ticks each queued sample stands for
+	uint8_t ticks[WORK_QUEUE_LEN];
+	/// Free-running, masked by WORK_QUEUE_LEN - 1
+	uint8_t head;
+	uint8_t tail;
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+ /**
+ ****************************************************************************************
+ * @brief Empty the queue, e.g. when sampling stops, and clear the dropped count
+ ****************************************************************************************
+ */
+void work_init(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Queue a sample. May be called from a timer callback or an interrupt handler.
+ * @param[in] sample  XL_NUM_AXES cell array (x,y,z)
+ * @param[in] ticks   sample ticks since the previous read, at least 1
+ * @return false when the queue was full and the sample was dropped
+ ****************************************************************************************
+ */
+bool work_push_sample(const int8_t *sample, uint8_t ticks);
+
+ /**
+ ****************************************************************************************
+ * @brief Take the oldest sample
+ * @param[out] sample  XL_NUM_AXES cell array (x,y,z)
+ * @param[out] ticks   sample ticks it stands for
+ * @return false when the queue is empty
+ ****************************************************************************************
+ */
+bool work_pop_sample(int8_t *sample, uint8_t *ticks);
+
+ /**
+ ****************************************************************************************
+ * @brief True while samples are queued
+ ****************************************************************************************
+ */
+bool work_pending(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Samples dropped since the last call, saturated
+ ****************************************************************************************
+ */
+uint16_t work_take_dropped(void);
+
+#endif // _USER_WORK_H_
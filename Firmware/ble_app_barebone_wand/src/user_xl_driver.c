@@ -10,42 +10,399 @@
 #include "ll.h"
 #include "user_xl_driver.h"
 #include "i2c.h"
+#include "gpio.h"
+#include "arch_system.h"
+#include "user_periph_setup.h"
 #include "stdlib.h"
+#include "user_profiler.h"
+#include "user_energy.h"
+#include "user_trace.h"
 
 
-volatile int8_t previousData[3];
+// Everything the module keeps across sleep, see struct xl_retained
+struct xl_retained xlRetained                   __SECTION_ZERO("retention_mem_area0"); //@RETENTION MEMORY
+
+// A sample is one burst of the output registers
+typedef char xl_burst_bytes[(I2C_XL_BURST_BYTES == (XL_NUM_AXES * 2)) ? 1 : -1];
 
  /**
  ****************************************************************************************
- * @brief Initialize I2C Accelerometer
+ * @brief Count a bus fault
  ****************************************************************************************
  */
-void i2c_XL_initialize(void)
+static void xl_i2c_fault(uint8_t fault)
+{
+	if(xlRetained.faults[fault] < UINT16_MAX)
 	{
-	uint8_t registerToSend[2];
-	uint8_t xlData[2];
-	i2c_abort_t abrt_code;
+		xlRetained.faults[fault]++;
+	}
+	// A skipped read is the backoff working, not news
+	if(fault != XL_FAULT_SKIPPED)
+	{
+		TRACE_EVENT(TRACE_EVT_XL_FAULT, fault, xlRetained.faults[fault]);
+	}
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Enable or disable the controller, waiting XL_I2C_STATUS_TIMEOUT_US at most
+ ****************************************************************************************
+ */
+static bool xl_i2c_set_status(i2c_controller_t status)
+{
+	i2c_set_controller_status(status);
+	for(uint16_t waited=0;waited<XL_I2C_STATUS_TIMEOUT_US;waited++)
+	{
+		if(i2c_get_controller_status() == status)
+		{
+			return true;
+		}
+		arch_asm_delay_us(1);
+	}
+	xl_i2c_fault(XL_FAULT_CONTROLLER);
+	return false;
+}
+
+static uint8_t xl_i2c_is_master_idle(void)
+{
+	return !i2c_is_master_busy();
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Wait XL_I2C_BYTE_TIMEOUT_US at most for a status of the controller; an abort
+ *        ends the wait early
+ * @return false when the wait ran out
+ ****************************************************************************************
+ */
+static bool xl_i2c_wait(uint8_t (*ready)(void))
+{
+	for(uint16_t waited=0;!ready() && (i2c_get_abort_source() == I2C_ABORT_NONE);waited++)
+	{
+		if(waited >= XL_I2C_BYTE_TIMEOUT_US)
+		{
+			xl_i2c_fault(XL_FAULT_TIMEOUT);
+			return false;
+		}
+		arch_asm_delay_us(1);
+	}
+	return true;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Write tx and, after a restart, read rx through the controller FIFOs, counted
+ *        for the energy model. Reads are queued up to XL_I2C_READ_AHEAD ahead of the
+ *        data. An abort stops the transfer, the controller ends it with a STOP.
+ * @return false when a wait ran out, with the transfer left where it stalled
+ ****************************************************************************************
+ */
+static bool xl_i2c_transfer(const uint8_t *tx, uint16_t txLen, uint8_t *rx, uint16_t rxLen, i2c_abort_t *abrt_code)
+{
+	uint16_t issued = 0;
+	uint16_t received = 0;
+
+	ENERGY_I2C(txLen + rxLen);
+	i2c_reset_int_tx_abort();
+	for(uint16_t i=0;(i<txLen) && (i2c_get_abort_source() == I2C_ABORT_NONE);i++)
+	{
+		if(!xl_i2c_wait(i2c_is_tx_fifo_not_full))
+		{
+			return false;
+		}
+		// A write alone ends with a STOP, one before a read with the restart of the read
+		i2c_write_byte(tx[i] | (((rxLen == 0) && (i == (txLen - 1))) ? I2C_STOP : 0));
+	}
+	while((received < rxLen) && (i2c_get_abort_source() == I2C_ABORT_NONE))
+	{
+		if((issued < rxLen) && ((issued - received) < XL_I2C_READ_AHEAD) && i2c_is_tx_fifo_not_full())
+		{
+			i2c_write_byte(I2C_CMD | ((issued == 0) ? I2C_RESTART : 0) | ((issued == (rxLen - 1)) ? I2C_STOP : 0));
+			issued++;
+		}
+		else if(!xl_i2c_wait((issued > received) ? i2c_is_rx_fifo_not_empty : i2c_is_tx_fifo_not_full))
+		{
+			return false;
+		}
+		else if(i2c_is_rx_fifo_not_empty())
+		{
+			rx[received++] = i2c_read_byte();
+		}
+	}
+	// The STOP, or the end of the abort
+	if(!xl_i2c_wait(xl_i2c_is_master_idle))
+	{
+		return false;
+	}
+	*abrt_code = (i2c_abort_t)i2c_get_abort_source();
+	return true;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Address the accelerometer; restarting the controller also flushes its FIFOs
+ ****************************************************************************************
+ */
+static bool xl_i2c_select(void)
+{
 	//Disable controller to change slave address 
-	i2c_set_controller_status(I2C_CONTROLLER_DISABLE);
-	while ((i2c_get_controller_status() != I2C_CONTROLLER_DISABLE));
+	if(!xl_i2c_set_status(I2C_CONTROLLER_DISABLE))
+	{
+		return false;
+	}
 	i2c_set_target_address(XL_ADDRESS);
-	i2c_set_controller_status(I2C_CONTROLLER_ENABLE);
-	while ((i2c_get_controller_status() != I2C_CONTROLLER_ENABLE));
-		
-	registerToSend[0] = XL_CONTROL_REG_1;
-	registerToSend[1] = 0x57;
-	i2c_master_transmit_buffer_sync(registerToSend,sizeof(registerToSend),&abrt_code,I2C_F_ADD_STOP);
-	
+	return xl_i2c_set_status(I2C_CONTROLLER_ENABLE);
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Both lines high, as between two transactions
+ ****************************************************************************************
+ */
+static bool xl_i2c_bus_idle(void)
+{
+	return GPIO_GetPinStatus(I2C_SDA_PORT, I2C_SDA_PIN) && GPIO_GetPinStatus(I2C_SCL_PORT, I2C_SCL_PIN);
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Pull a line low or release it to its pull-up, for half an SCL period
+ ****************************************************************************************
+ */
+static void xl_i2c_drive(GPIO_PORT port, GPIO_PIN pin, bool low)
+{
+	GPIO_ConfigurePin(port, pin, low ? OUTPUT : INPUT, PID_GPIO, false);
+	arch_asm_delay_us(XL_I2C_HALF_PERIOD_US);
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Bus clear: clock SCL until the accelerometer releases SDA, which it does
+ *        within one byte, then generate a STOP. The pads go back to the controller.
+ * @return true when both lines are high again
+ ****************************************************************************************
+ */
+static bool xl_i2c_bus_clear(void)
+{
+	bool idle;
+
+	xl_i2c_drive(I2C_SDA_PORT, I2C_SDA_PIN, false);
+	xl_i2c_drive(I2C_SCL_PORT, I2C_SCL_PIN, false);
+	for(uint8_t pulse=0;(pulse<XL_I2C_CLEAR_PULSES) && !GPIO_GetPinStatus(I2C_SDA_PORT, I2C_SDA_PIN);pulse++)
+	{
+		xl_i2c_drive(I2C_SCL_PORT, I2C_SCL_PIN, true);
+		xl_i2c_drive(I2C_SCL_PORT, I2C_SCL_PIN, false);
+	}
+	// STOP: SDA rises while SCL is high
+	xl_i2c_drive(I2C_SDA_PORT, I2C_SDA_PIN, true);
+	xl_i2c_drive(I2C_SDA_PORT, I2C_SDA_PIN, false);
+	idle = xl_i2c_bus_idle();
+
+	GPIO_ConfigurePin(I2C_SCL_PORT, I2C_SCL_PIN, INPUT, PID_I2C_SCL, false);
+	GPIO_ConfigurePin(I2C_SDA_PORT, I2C_SDA_PIN, INPUT, PID_I2C_SDA, false);
+	if(!idle)
+	{
+		xl_i2c_fault(XL_FAULT_BUS_CLEAR);
+	}
+	return idle;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief One attempt at a transaction: write tx, then read rx after a restart
+ ****************************************************************************************
+ */
+static bool xl_i2c_attempt(const uint8_t *tx, uint16_t txLen, uint8_t *rx, uint16_t rxLen)
+{
+	i2c_abort_t abrt_code = I2C_ABORT_NONE;
+
+	if(!xl_i2c_bus_idle())
+	{
+		xl_i2c_fault(XL_FAULT_BUS_STUCK);
+		if(!xl_i2c_bus_clear())
+		{
+			return false;
+		}
+	}
+	if(!xlRetained.selected)
+	{
+		xlRetained.selected = xl_i2c_select();
+		if(!xlRetained.selected)
+		{
+			return false;
+		}
+	}
+
+	if(!xl_i2c_transfer(tx, txLen, rx, rxLen, &abrt_code))
+	{
+		return false;
+	}
+	if(abrt_code != I2C_ABORT_NONE)
+	{
+		xl_i2c_fault((abrt_code & I2C_7B_ADDR_NOACK) ? XL_FAULT_ADDR_NOACK :
+			((abrt_code & I2C_TXDATA_NOACK) ? XL_FAULT_DATA_NOACK : XL_FAULT_ABORT));
+		return false;
+	}
+	return true;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief A transaction with its retries; nothing once one of the call failed
+ ****************************************************************************************
+ */
+static bool xl_i2c_transaction(const uint8_t *tx, uint16_t txLen, uint8_t *rx, uint16_t rxLen)
+{
+	if(xlRetained.callFailed)
+	{
+		return false;
+	}
+	for(uint8_t attempt=0;attempt<XL_I2C_ATTEMPTS;attempt++)
+	{
+		if(attempt > 0)
+		{
+			xl_i2c_fault(XL_FAULT_RETRY);
+			arch_asm_delay_us(XL_I2C_BACKOFF_US << (attempt - 1));
+		}
+		if(xl_i2c_attempt(tx, txLen, rx, rxLen))
+		{
+			return true;
+		}
+		// Start over from a restarted controller
+		xlRetained.selected = false;
+	}
+	xl_i2c_fault(XL_FAULT_FAILED);
+	xlRetained.callFailed = true;
+	return false;
+}
+
+static bool xl_write(uint8_t reg, uint8_t value)
+{
+	uint8_t registerToSend[2] = {reg, value};
+
+	return xl_i2c_transaction(registerToSend, sizeof(registerToSend), NULL, 0);
+}
+
+static bool xl_read(uint8_t reg, uint8_t *data, uint16_t len)
+{
+	return xl_i2c_transaction(&reg, 1, data, len);
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Start a call of the driver
+ * @param[in] read true for the reads that back off after a failure
+ * @return false when the call skips the bus
+ ****************************************************************************************
+ */
+static bool xl_i2c_begin(bool read)
+{
+	xlRetained.callFailed = false;
+	if(read && (xlRetained.skipLeft > 0))
+	{
+		xlRetained.skipLeft--;
+		xl_i2c_fault(XL_FAULT_SKIPPED);
+		return false;
+	}
+	return true;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief End a call started by xl_i2c_begin(); a failed read doubles the backoff
+ * @return false when a transaction of the call failed
+ ****************************************************************************************
+ */
+static bool xl_i2c_end(bool read)
+{
+	if(read && xlRetained.callFailed)
+	{
+		xlRetained.skipLeft = (xlRetained.skipNext > 0) ? xlRetained.skipNext : 1;
+		xlRetained.skipNext = (xlRetained.skipLeft <= (XL_I2C_MAX_SKIP / 2)) ? (xlRetained.skipLeft * 2) : XL_I2C_MAX_SKIP;
+	}
+	else if(read)
+	{
+		xlRetained.skipNext = 0;
+	}
+	return !xlRetained.callFailed;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Active mode configuration: 100Hz normal mode, all axes, no interrupt
+ ****************************************************************************************
+ */
+static void xl_configure(void)
+{
+	uint8_t xlData;
+
+	xl_write(XL_CONTROL_REG_1, 0x57);
 	//Set to off
-	registerToSend[0] = XL_INT1_CFG;
-	registerToSend[1] = 0x00;
-	i2c_master_transmit_buffer_sync(registerToSend,sizeof(registerToSend),&abrt_code,I2C_F_ADD_STOP);
-		
-	i2c_master_transmit_buffer_sync(registerToSend,sizeof(registerToSend),&abrt_code,I2C_F_NONE);
-	i2c_master_receive_buffer_sync(&xlData[0], sizeof(&xlData[0]), &abrt_code, I2C_F_ADD_STOP);
-	previousData[0] = 0;
-	previousData[1] = 0;
-	previousData[2] = 0;
+	xl_write(XL_INT1_CFG, 0x00);
+	xl_read(XL_INT1_CFG, &xlData, sizeof(xlData));
+	xlRetained.configPending = xlRetained.callFailed;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief One axis, the low and the high output register in one burst
+ ****************************************************************************************
+ */
+static bool xl_read_axis(uint8_t lowRegister, uint16_t *value)
+{
+	uint8_t xlData[2];
+
+	if(!xl_read(lowRegister | XL_AUTO_INCREMENT, xlData, sizeof(xlData)))
+	{
+		return false;
+	}
+	*value = xlData[0] | (xlData[1] << 8);
+	return true;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief A public axis read
+ ****************************************************************************************
+ */
+static uint16_t xl_read_axis_call(uint8_t lowRegister)
+{
+	uint16_t value = 0;
+
+	if(xl_i2c_begin(true))
+	{
+		if(xlRetained.configPending)
+		{
+			xl_configure();
+		}
+		xl_read_axis(lowRegister, &value);
+		if(!xl_i2c_end(true))
+		{
+			value = 0;
+		}
+	}
+	return value;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Initialize I2C Accelerometer
+ ****************************************************************************************
+ */
+bool i2c_XL_initialize(void)
+	{
+	PROFILER_BEGIN(XL_INIT);
+	bool configured;
+
+	xl_i2c_begin(false);
+	xl_configure();
+	configured = xl_i2c_end(false);
+	xlRetained.previousData[0] = 0;
+	xlRetained.previousData[1] = 0;
+	xlRetained.previousData[2] = 0;
+	energy_on(ENERGY_XL_ACTIVE_SLOTS);
+	PROFILER_END(XL_INIT);
+	return configured;
  }
 	
  /**
@@ -55,29 +412,9 @@ void i2c_XL_initialize(void)
  */
 uint16_t i2c_XL_Read_X(void)
 	{
-	uint8_t registerToSend[2];
-	uint8_t xlData[2];
-
-	i2c_abort_t abrt_code;
-	volatile uint16_t returnValue = 0;
-	//Disable controller to change slave address 
-	i2c_set_controller_status(I2C_CONTROLLER_DISABLE);
-	while ((i2c_get_controller_status() != I2C_CONTROLLER_DISABLE));
-	i2c_set_target_address(XL_ADDRESS);
-	i2c_set_controller_status(I2C_CONTROLLER_ENABLE);
-	while ((i2c_get_controller_status() != I2C_CONTROLLER_ENABLE));
-		
-	registerToSend[0] = XL_OUT_X_L;
-	registerToSend[1] = XL_OUT_X_H;
-	
-	i2c_master_transmit_buffer_sync(&registerToSend[0],sizeof(&registerToSend[0]),&abrt_code,I2C_F_NONE);
-	i2c_master_receive_buffer_sync(&xlData[0], sizeof(&xlData[0]), &abrt_code, I2C_F_ADD_STOP);
-	returnValue = xlData[0];
-		
-	i2c_master_transmit_buffer_sync(&registerToSend[1],sizeof(&registerToSend[1]),&abrt_code,I2C_F_NONE);
-	i2c_master_receive_buffer_sync(&xlData[1], sizeof(&xlData[1]), &abrt_code, I2C_F_ADD_STOP);
-	returnValue |= xlData[1] << 8;
-		
+	PROFILER_BEGIN(XL_READ_AXIS);
+	uint16_t returnValue = xl_read_axis_call(XL_OUT_X_L);
+	PROFILER_END(XL_READ_AXIS);
 	return returnValue;
  }
 	
@@ -88,29 +425,9 @@ uint16_t i2c_XL_Read_X(void)
  */
 uint16_t i2c_XL_Read_Y(void)
 	{
-	uint8_t registerToSend[2];
-	uint8_t xlData[2];
-
-	i2c_abort_t abrt_code;
-	volatile uint16_t returnValue = 0;
-	//Disable controller to change slave address 
-	i2c_set_controller_status(I2C_CONTROLLER_DISABLE);
-	while ((i2c_get_controller_status() != I2C_CONTROLLER_DISABLE));
-	i2c_set_target_address(XL_ADDRESS);
-	i2c_set_controller_status(I2C_CONTROLLER_ENABLE);
-	while ((i2c_get_controller_status() != I2C_CONTROLLER_ENABLE));
-		
-	registerToSend[0] = XL_OUT_Y_L;
-	registerToSend[1] = XL_OUT_Y_H;
-		
-	i2c_master_transmit_buffer_sync(&registerToSend[0],sizeof(&registerToSend[0]),&abrt_code,I2C_F_NONE);
-	i2c_master_receive_buffer_sync(&xlData[0], sizeof(&xlData[0]), &abrt_code, I2C_F_ADD_STOP);
-	returnValue = xlData[0];
-		
-	i2c_master_transmit_buffer_sync(&registerToSend[1],sizeof(&registerToSend[1]),&abrt_code,I2C_F_NONE);
-	i2c_master_receive_buffer_sync(&xlData[1], sizeof(&xlData[1]), &abrt_code, I2C_F_ADD_STOP);
-	returnValue |= xlData[1] << 8;
-		
+	PROFILER_BEGIN(XL_READ_AXIS);
+	uint16_t returnValue = xl_read_axis_call(XL_OUT_Y_L);
+	PROFILER_END(XL_READ_AXIS);
 	return returnValue;
  }
 	
@@ -121,29 +438,9 @@ uint16_t i2c_XL_Read_Y(void)
  */
 uint16_t i2c_XL_Read_Z(void)
 	{
-	uint8_t registerToSend[2];
-	uint8_t xlData[2];
-
-	i2c_abort_t abrt_code;
-	volatile uint16_t returnValue = 0;
-	//Disable controller to change slave address 
-	i2c_set_controller_status(I2C_CONTROLLER_DISABLE);
-	while ((i2c_get_controller_status() != I2C_CONTROLLER_DISABLE));
-	i2c_set_target_address(XL_ADDRESS);
-	i2c_set_controller_status(I2C_CONTROLLER_ENABLE);
-	while ((i2c_get_controller_status() != I2C_CONTROLLER_ENABLE));
-		
-	registerToSend[0] = XL_OUT_Z_L;
-	registerToSend[1] = XL_OUT_Z_H;
-		
-	i2c_master_transmit_buffer_sync(&registerToSend[0],sizeof(&registerToSend[0]),&abrt_code,I2C_F_NONE);
-	i2c_master_receive_buffer_sync(&xlData[0], sizeof(&xlData[0]), &abrt_code, I2C_F_ADD_STOP);
-	returnValue = xlData[0];
-		
-	i2c_master_transmit_buffer_sync(&registerToSend[1],sizeof(&registerToSend[1]),&abrt_code,I2C_F_NONE);
-	i2c_master_receive_buffer_sync(&xlData[1], sizeof(&xlData[1]), &abrt_code, I2C_F_ADD_STOP);
-	returnValue |= xlData[1] << 8;
-		
+	PROFILER_BEGIN(XL_READ_AXIS);
+	uint16_t returnValue = xl_read_axis_call(XL_OUT_Z_L);
+	PROFILER_END(XL_READ_AXIS);
 	return returnValue;
  }
 	
@@ -161,6 +458,39 @@ void i2c_XL_Read_ALL(void)
 	xlOutData[2] = i2c_XL_Read_Z();
 }
 
+ /**
+ ****************************************************************************************
+ * @brief Read one sample of all axes as signed 8-bit values (high byte of each axis)
+ ****************************************************************************************
+ */
+bool i2c_XL_Read_Sample(int8_t *sample)
+{
+	PROFILER_BEGIN(XL_READ_SAMPLE);
+	bool read = xl_i2c_begin(true);
+
+	if(read)
+	{
+		uint8_t xlData[I2C_XL_BURST_BYTES];
+
+		if(xlRetained.configPending)
+		{
+			xl_configure();
+		}
+		//All axes in one burst, the high byte of each
+		xl_read(XL_OUT_X_L | XL_AUTO_INCREMENT, xlData, sizeof(xlData));
+		read = xl_i2c_end(true);
+		for(int i=0;(i<XL_NUM_AXES) && read;i++)
+		{
+			xlRetained.lastSample[i] = (int8_t)xlData[(2 * i) + 1];
+		}
+	}
+	sample[XL_AXIS_X] = xlRetained.lastSample[XL_AXIS_X];
+	sample[XL_AXIS_Y] = xlRetained.lastSample[XL_AXIS_Y];
+	sample[XL_AXIS_Z] = xlRetained.lastSample[XL_AXIS_Z];
+	PROFILER_END(XL_READ_SAMPLE);
+	return read;
+}
+
  /**
  ****************************************************************************************
  * @brief Get largest vector direction of XL
@@ -179,8 +509,8 @@ void i2c_XL_Vector_Delta(int8_t *vectorData)
 	
 	for(int i=0;i<3;i++)
 	{		
-		vectorData[i] = xlOutData[i]-previousData[i];	
-		previousData[i] = xlOutData[i];
+		vectorData[i] = xlOutData[i]-xlRetained.previousData[i];	
+		xlRetained.previousData[i] = xlOutData[i];
 		if(abs(vectorData[i])>minMaxValue)
 		{
 			minMaxValue = abs(vectorData[i]);
@@ -195,41 +525,101 @@ void i2c_XL_Vector_Delta(int8_t *vectorData)
  * @brief Set XL to low power state with interrupt enabled
  ****************************************************************************************
  */
-void i2c_XL_Sleep_Mode(void)
+bool i2c_XL_Sleep_Mode(void)
 {
-	uint8_t registerToSend[2];
-	i2c_abort_t abrt_code;
-	//Disable controller to change slave address 
-	i2c_set_controller_status(I2C_CONTROLLER_DISABLE);
-	while ((i2c_get_controller_status() != I2C_CONTROLLER_DISABLE));
-	i2c_set_target_address(XL_ADDRESS);
-	i2c_set_controller_status(I2C_CONTROLLER_ENABLE);
-	while ((i2c_get_controller_status() != I2C_CONTROLLER_ENABLE));
-		 
+	PROFILER_BEGIN(XL_SLEEP);
+	bool configured;
+
+	xl_i2c_begin(false);
 	//Set lowest sampling rate, low power mode, and only Y axis enabled
-	registerToSend[0] = XL_CONTROL_REG_1;
-	registerToSend[1] = 0x1A;
-	i2c_master_transmit_buffer_sync(registerToSend,sizeof(registerToSend),&abrt_code,I2C_F_ADD_STOP);
-	
+	xl_write(XL_CONTROL_REG_1, 0x1A);
 	//Set Interrupt Active (1) onto Interrupt Pin 2 and setting interrupt to Active Low 
-	registerToSend[0] = XL_CONTROL_REG_6;
-	registerToSend[1] = 0x42;
-	i2c_master_transmit_buffer_sync(registerToSend,sizeof(registerToSend),&abrt_code,I2C_F_ADD_STOP);
-	
+	xl_write(XL_CONTROL_REG_6, 0x42);
 	//Set Interrupt to only fire on Y+ event
-	registerToSend[0] = XL_INT1_CFG;
-	registerToSend[1] = 0x88;
-	i2c_master_transmit_buffer_sync(registerToSend,sizeof(registerToSend),&abrt_code,I2C_F_ADD_STOP);
-	
+	xl_write(XL_INT1_CFG, 0x88);
 	//Set Interrupt threshhold
-	registerToSend[0] = XL_INT1_THS;
-	registerToSend[1] = 0x20;
-	i2c_master_transmit_buffer_sync(registerToSend,sizeof(registerToSend),&abrt_code,I2C_F_ADD_STOP);
-	
+	xl_write(XL_INT1_THS, 0x20);
 	//Set duration for interrupt to be recognnized
-	registerToSend[0] = XL_INT1_DUR;
-	registerToSend[1] = 0x01;
-	i2c_master_transmit_buffer_sync(registerToSend,sizeof(registerToSend),&abrt_code,I2C_F_ADD_STOP);
+	xl_write(XL_INT1_DUR, 0x01);
+	configured = xl_i2c_end(false);
+	energy_off(ENERGY_XL_ACTIVE_SLOTS);
+	PROFILER_END(XL_SLEEP);
+	return configured;
 } 
 
- 
\ No newline at end of file
+ /**
+ ****************************************************************************************
+ * @brief Switch between single-sample reads and the FIFO in stream mode
+ ****************************************************************************************
+ */
+bool i2c_XL_Fifo_Mode(bool enable)
+{
+	xl_i2c_begin(false);
+	//400Hz normal mode in FIFO mode, back to 100Hz otherwise
+	xl_write(XL_CONTROL_REG_1, enable ? 0x77 : 0x57);
+	//FIFO enable
+	xl_write(XL_CONTROL_REG_5, enable ? 0x40 : 0x00);
+	//Stream mode: the oldest sample is overwritten when the FIFO is full. Bypass mode
+	//empties the FIFO
+	xl_write(XL_FIFO_CTRL_REG, enable ? 0x80 : 0x00);
+	return xl_i2c_end(false);
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Drain the FIFO with one burst read
+ ****************************************************************************************
+ */
+uint8_t i2c_XL_Read_Fifo(int16_t *samples, uint8_t maxSamples, bool *overrun)
+{
+	uint8_t fifoSource;
+	uint8_t count;
+	uint8_t xlData[XL_FIFO_DEPTH * XL_NUM_AXES * 2];
+
+	*overrun = false;
+	if(!xl_i2c_begin(true))
+	{
+		return 0;
+	}
+	if(!xl_read(XL_FIFO_SRC_REG, &fifoSource, 1))
+	{
+		xl_i2c_end(true);
+		return 0;
+	}
+
+	//FSS counts up to 31, an overrun means all 32 entries are full
+	*overrun = (fifoSource & XL_FIFO_OVRN) != 0;
+	count = *overrun ? XL_FIFO_DEPTH : (fifoSource & XL_FIFO_FSS_MASK);
+	if(count > maxSamples)
+	{
+		count = maxSamples;
+	}
+	if(count == 0)
+	{
+		xl_i2c_end(true);
+		return 0;
+	}
+
+	//In FIFO mode the address wraps from OUT_Z_H back to OUT_X_L, so one read pops
+	//count samples
+	xl_read(XL_OUT_X_L | XL_AUTO_INCREMENT, xlData, count * XL_NUM_AXES * 2);
+	if(!xl_i2c_end(true))
+	{
+		return 0;
+	}
+	for(int i=0;i<count * XL_NUM_AXES;i++)
+	{
+		samples[i] = (int16_t)(xlData[2*i] | (xlData[(2*i)+1] << 8));
+	}
+	return count;
+}
+
+void i2c_XL_Session_Reset(void)
+{
+	xlRetained.selected = false;
+}
+
+uint16_t i2c_XL_Get_Faults(uint8_t fault)
+{
+	return (fault < XL_NUM_FAULTS) ? xlRetained.faults[fault] : 0;
+}
@@ -28,10 +28,107 @@
  #define XL_OUT_Y_H				0x2B
  #define XL_OUT_Z_L				0x2C
  #define XL_OUT_Z_H				0x2D
+ #define XL_FIFO_CTRL_REG		0x2E
+ #define XL_FIFO_SRC_REG		0x2F
  #define XL_INT1_CFG			0x30
  #define XL_INT1_THS			0x32
  #define XL_INT1_DUR			0x33
  
+ // Register address flag that makes multi-byte reads auto-increment
+ #define XL_AUTO_INCREMENT		0x80
+ // FIFO_SRC_REG fields
+ #define XL_FIFO_OVRN			0x40
+ #define XL_FIFO_FSS_MASK		0x1F
+ #define XL_FIFO_DEPTH			32
+ // Output data rate in FIFO mode, CTRL_REG1 = 0x77
+ #define XL_FIFO_RATE_HZ			400
+
+ // Bus recovery. Every wait of the driver is bounded: the transfers poll the controller
+ // FIFOs themselves and give a wait XL_I2C_BYTE_TIMEOUT_US, four byte times at 400kHz,
+ // so SCL held low in the middle of a transfer ends it too. A failed transaction is tried
+ // XL_I2C_ATTEMPTS times, backing off XL_I2C_BACKOFF_US and then twice as long before
+ // each retry. SDA or SCL found low before a transaction is cleared by clocking SCL up
+ // to XL_I2C_CLEAR_PULSES times and generating a STOP. Once a transaction fails on
+ // every attempt the rest of the call is given up, and after a failed read the next
+ // 1, 2, 4 ... XL_I2C_MAX_SKIP reads skip the bus and repeat the last sample, so an
+ // absent sensor costs a sample tick a few hundred microseconds at most.
+ #define XL_I2C_STATUS_TIMEOUT_US	50
+ #define XL_I2C_BYTE_TIMEOUT_US		100
+ // Read commands queued ahead of the data, no more than the receive FIFO holds
+ #define XL_I2C_READ_AHEAD			4
+ #define XL_I2C_ATTEMPTS			3
+ #define XL_I2C_BACKOFF_US		100
+ #define XL_I2C_CLEAR_PULSES		9
+ // Half the SCL period of the bus clear, 100kHz
+ #define XL_I2C_HALF_PERIOD_US		5
+ #define XL_I2C_MAX_SKIP			64
+
+/* Bus faults the driver counts. X(name)                                                    */
+/* CONTROLLER: the controller did not change its enable status in time                      */
+/* ADDR_NOACK, DATA_NOACK: the accelerometer did not acknowledge its address or a byte      */
+/* ABORT: any other transfer abort, a lost arbitration among them                           */
+/* TIMEOUT: the controller made no progress within XL_I2C_BYTE_TIMEOUT_US                   */
+/* BUS_STUCK: SDA or SCL low before a transaction; BUS_CLEAR: still low after the clear     */
+/* RETRY: a transaction tried again; FAILED: a transaction that failed every attempt        */
+/* SKIPPED: a read that skipped the bus while backing off                                   */
+#define XL_FAULTS(X)                                                                       \
+	X(CONTROLLER)                                                                          \
+	X(ADDR_NOACK)                                                                          \
+	X(DATA_NOACK)                                                                          \
+	X(ABORT)                                                                               \
+	X(TIMEOUT)                                                                             \
+	X(BUS_STUCK)                                                                           \
+	X(BUS_CLEAR)                                                                           \
+	X(RETRY)                                                                               \
+	X(FAILED)                                                                              \
+	X(SKIPPED)
+
+#define XL_FAULT_ENUM(name) XL_FAULT_##name,
+
+/// Axis index of a sample array read from the accelerometer
+enum xl_axis
+{
+	XL_AXIS_X = 0,
+	XL_AXIS_Y,
+	XL_AXIS_Z,
+	XL_NUM_AXES
+};
+
+/// Bus faults, see XL_FAULTS
+enum xl_fault
+{
+	XL_FAULTS(XL_FAULT_ENUM)
+	XL_NUM_FAULTS
+};
+
+/* Retention RAM of the driver, struct xl_retained                                          */
+#define XL_RETAINED_SIZE                    (sizeof(struct xl_retained))
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// State of user_xl_driver.c kept in retention RAM
+struct xl_retained
+{
+	/// Bus faults since power-up, saturated
+	uint16_t faults[XL_NUM_FAULTS];
+	/// Previous sample of i2c_XL_Vector_Delta
+	volatile int8_t previousData[XL_NUM_AXES];
+	/// Last sample i2c_XL_Read_Sample read, repeated while the bus fails
+	int8_t lastSample[XL_NUM_AXES];
+	/// Reads left to skip the bus, and the reads the next failed one skips, 0 for 1
+	uint8_t skipLeft;
+	uint8_t skipNext;
+	/// The configuration of i2c_XL_initialize() failed and is written by the next read
+	bool configPending;
+	/// The controller addresses the accelerometer, until periph_init() runs again or a fault
+	bool selected;
+	/// A transaction of the current call failed every attempt
+	bool callFailed;
+};
+
 /*
  * FUNCTION DECLARATIONS
  ****************************************************************************************
@@ -40,13 +137,15 @@
  /**
  ****************************************************************************************
  * @brief Initialize I2C Accelerometer
+ * @return false when the bus failed; the next read writes the configuration again
  ****************************************************************************************
  */
-void i2c_XL_initialize(void);
+bool i2c_XL_initialize(void);
 
  /**
  ****************************************************************************************
  * @brief Read X-axis I2C Accelerometer
+ * @return left-justified output, 0 when the bus failed
  ****************************************************************************************
  */
 uint16_t i2c_XL_Read_X(void);
@@ -54,6 +153,7 @@ uint16_t i2c_XL_Read_X(void);
  /**
  ****************************************************************************************
  * @brief Read Y-axis I2C Accelerometer
+ * @return left-justified output, 0 when the bus failed
  ****************************************************************************************
  */
 uint16_t i2c_XL_Read_Y(void);
@@ -61,6 +161,7 @@ uint16_t i2c_XL_Read_Y(void);
  /**
  ****************************************************************************************
  * @brief Read Z-axis I2C Accelerometer
+ * @return left-justified output, 0 when the bus failed
  ****************************************************************************************
  */
 uint16_t i2c_XL_Read_Z(void);
@@ -74,6 +175,15 @@ uint16_t i2c_XL_Read_Z(void);
  */
 void i2c_XL_Read_ALL(void);
 
+ /**
+ ****************************************************************************************
+ * @brief Read one sample of all axes as signed 8-bit values (high byte of each axis)
+ * @param[out] sample XL_NUM_AXES cell array (x,y,z)
+ * @return false when the bus failed or was skipped; sample repeats the last one read
+ ****************************************************************************************
+ */
+bool i2c_XL_Read_Sample(int8_t *sample);
+
 
  /**
  ****************************************************************************************
@@ -86,9 +196,49 @@ void i2c_XL_Vector_Delta(int8_t *vectorData);
  /**
  ****************************************************************************************
  * @brief Set XL to low power state with interrupt enabled
+ * @return false when the bus failed
+ ****************************************************************************************
+ */
+bool i2c_XL_Sleep_Mode(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Switch between single-sample reads at 100Hz and the FIFO in stream mode at
+ *        XL_FIFO_RATE_HZ
+ * @param[in] enable true for FIFO mode
+ * @return false when the bus failed
+ ****************************************************************************************
+ */
+bool i2c_XL_Fifo_Mode(bool enable);
+
+ /**
+ ****************************************************************************************
+ * @brief Drain the FIFO with one burst read
+ * @param[out] samples    maxSamples * XL_NUM_AXES cell array (x,y,z per sample), raw
+ *                        left-justified output
+ * @param[in] maxSamples  samples to read at most
+ * @param[out] overrun    set when the FIFO overflowed since the last read
+ * @return samples read, 0 when the bus failed
+ ****************************************************************************************
+ */
+uint8_t i2c_XL_Read_Fifo(int16_t *samples, uint8_t maxSamples, bool *overrun);
+
+ /**
+ ****************************************************************************************
+ * @brief The I2C controller was configured again, as periph_init() does after every
+ *        wake-up. The driver addresses the accelerometer once per bus session instead
+ *        of in every call, so the next transaction does it again.
+ ****************************************************************************************
+ */
+void i2c_XL_Session_Reset(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Bus faults counted since power-up, saturated
+ * @param[in] fault enum xl_fault
  ****************************************************************************************
  */
-void i2c_XL_Sleep_Mode(void);
+uint16_t i2c_XL_Get_Faults(uint8_t fault);
 #endif // _I2C_XL_H_
 
 ///@}
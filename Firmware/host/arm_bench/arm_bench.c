@@ -0,0 +1,302 @@
+/**
+ ****************************************************************************************
+ *
+ * @file arm_bench.c
+ *
+ * @brief Cortex-M0+ cost of a sample tick, measured under emulation.
+ *
+ * Usage: m0plus_sim arm_bench.elf [corpus.wcap...]   (make bench)
+ *
+ * Built for ARMv6-M by clang with the runtime of rt/ and run by m0plus_sim on the host;
+ * the corpus files are read through semihosting. Every sample of the corpus
+ * (or of a built-in motion when no file is given) takes the path of a sample tick of
+ * user_barebone.c: user_xl_driver.c reads it from the stand-in bus of xl_bus.c,
+ * gesture_pipeline_update() classifies it, and the manufacturer specific data is
+ * copied into the advertising data as adv_data_update_timer_cb() does. The SDK calls
+ * on that path (timers, app_easy_gap_update_adv_data) are not part of the count. The
+ * I2C functions of the SDK the driver calls are those of xl_bus.c and are counted in
+ * the tick, at more cycles than the register accesses they stand for. The GPIO
+ * functions the driver recovers the bus with only reach the I2C pads here.
+ *
+ * Calls to the marker functions below delimit the regions m0plus_sim counts:
+ *   empty    nothing, the cost of the markers themselves
+ *   sample   gesture_pipeline_update()
+ *   tick     the sample read, the pipeline and the payload copy
+ *   gesture  the commit of a recognised gesture
+ *
+ * The harness prints "key value" lines about the corpus, the simulator appends the
+ * figures of each region.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "capture_file.h"
+#include "arch_system.h"
+#include "gpio.h"
+#include "user_gesture.h"
+#include "user_periph_setup.h"
+#include "user_xl_driver.h"
+#include "xl_bus.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+#define ARM_BENCH_SLOTS_PER_SECOND          (1600)
+
+/* Samples missing before the pipeline is restarted as after a wake-up                      */
+#define ARM_BENCH_GAP_SAMPLES               (4)
+
+/* Lockout of user_barebone.c in samples: CFG_GESTURE_LOCK_TO counts 10ms timer ticks      */
+#define ARM_BENCH_LOCK_SAMPLES              ((CFG_GESTURE_LOCK_TO * CFG_GESTURE_SAMPLE_RATE_HZ) / 100)
+
+/* Payload of user_barebone.c: APP_AD_MSD_DATA_NUM_BYTES gesture codes after the AD header */
+/* and the battery byte after them                                                         */
+#define ARM_BENCH_PAYLOAD_BYTES             (5)
+#define ARM_BENCH_ADV_DATA_LEN              (31)
+#define ARM_BENCH_MNF_DATA_INDEX            (3)
+
+/* Built-in motion: seconds of samples, one swing every ARM_BENCH_SWING_PERIOD samples     */
+#define ARM_BENCH_BUILTIN_SECONDS           (60)
+#define ARM_BENCH_SWING_PERIOD              (200)
+#define ARM_BENCH_SWING_LENGTH              (30)
+
+/* Marker functions: kept out of line and apart, m0plus_sim watches their addresses        */
+#define ARM_BENCH_MARKER(name)              void __attribute__((noinline)) arm_bench_##name(void) { __asm volatile ("" ::: "memory"); }
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Manufacturer specific data AD structure of user_barebone.c
+struct arm_bench_mnf_data
+{
+	uint8_t ad_structure_size;
+	uint8_t ad_structure_type;
+	uint8_t proprietary_data[ARM_BENCH_PAYLOAD_BYTES];
+	uint8_t battery;
+};
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+static struct arm_bench_mnf_data mnfData;
+static uint8_t storedAdvData[ARM_BENCH_ADV_DATA_LEN];
+static uint8_t gestureCounter;
+static unsigned lockRemaining;
+
+static unsigned long benchFiles;
+static unsigned long benchSamples;
+static unsigned long benchGestures;
+static unsigned long benchRestarts;
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+ARM_BENCH_MARKER(empty_begin)
+ARM_BENCH_MARKER(empty_end)
+ARM_BENCH_MARKER(sample_begin)
+ARM_BENCH_MARKER(sample_end)
+ARM_BENCH_MARKER(tick_begin)
+ARM_BENCH_MARKER(tick_end)
+ARM_BENCH_MARKER(gesture_begin)
+ARM_BENCH_MARKER(gesture_end)
+
+ /**
+ ****************************************************************************************
+ * @brief gesture_commit() of user_barebone.c without the trace and the timers: store
+ *        the code in the next payload slot and start the lockout
+ ****************************************************************************************
+ */
+static void arm_bench_commit(uint8_t gestureCode)
+{
+	arm_bench_gesture_begin();
+	mnfData.proprietary_data[gestureCounter] = gestureCode;
+	if(gestureCounter<(ARM_BENCH_PAYLOAD_BYTES-1))
+	{
+		gestureCounter++;
+	}
+	else
+	{
+		gestureCounter = 0;
+	}
+	lockRemaining = ARM_BENCH_LOCK_SAMPLES;
+	arm_bench_gesture_end();
+	benchGestures++;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief One sample tick: mnf_data_update() and the copy of adv_data_update_timer_cb()
+ ****************************************************************************************
+ */
+static void arm_bench_tick(const int8_t *sample)
+{
+	int8_t xlSample[XL_NUM_AXES];
+	bool lockedOut = lockRemaining > 0;
+
+	// Count down before the update, a gesture of this sample restarts the lockout
+	if(lockedOut)
+	{
+		lockRemaining--;
+	}
+	xl_bus_set_sample(sample);
+
+	arm_bench_empty_begin();
+	arm_bench_empty_end();
+
+	arm_bench_tick_begin();
+	i2c_XL_Read_Sample(xlSample);
+	arm_bench_sample_begin();
+	gesture_pipeline_update(xlSample, lockedOut);
+	arm_bench_sample_end();
+	memcpy(&storedAdvData[ARM_BENCH_MNF_DATA_INDEX], &mnfData, sizeof(mnfData));
+	arm_bench_tick_end();
+	benchSamples++;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Run the ticks of one corpus file, decimated to the rate of the sample tick
+ ****************************************************************************************
+ */
+static int arm_bench_file(const char *path)
+{
+	FILE *file = fopen(path, "rb");
+	struct capture_reader reader;
+	struct capture_record record;
+	uint32_t previous = 0;
+	uint32_t elapsed = 0;
+	unsigned long index = 0;
+	unsigned decimation;
+	int first = 1;
+
+	if(file == NULL)
+	{
+		perror(path);
+		return -1;
+	}
+	capture_reader_init(&reader, file);
+	while(capture_read(&reader, &record))
+	{
+		if(record.type != CAPTURE_RECORD_SAMPLE)
+		{
+			continue;
+		}
+		if((reader.sampleRateHz < CFG_GESTURE_SAMPLE_RATE_HZ) || ((reader.sampleRateHz % CFG_GESTURE_SAMPLE_RATE_HZ) != 0))
+		{
+			fprintf(stderr, "%s: sample rate %u Hz is not a multiple of %u Hz\n", path, reader.sampleRateHz, CFG_GESTURE_SAMPLE_RATE_HZ);
+			fclose(file);
+			return -1;
+		}
+		decimation = reader.sampleRateHz / CFG_GESTURE_SAMPLE_RATE_HZ;
+		if(!first)
+		{
+			elapsed += (record.timestamp - previous) & CAPTURE_TIMESTAMP_MASK;
+		}
+		previous = record.timestamp;
+		if((index++ % decimation) != 0)
+		{
+			continue;
+		}
+
+		// A gap restarts the pipeline as the wake-up of user_barebone.c does
+		if(!first && (elapsed > (ARM_BENCH_GAP_SAMPLES * (ARM_BENCH_SLOTS_PER_SECOND / CFG_GESTURE_SAMPLE_RATE_HZ))))
+		{
+			gesture_pipeline_reset();
+			lockRemaining = 0;
+			benchRestarts++;
+		}
+		elapsed = 0;
+		first = 0;
+		arm_bench_tick(record.axis);
+	}
+	fclose(file);
+	benchFiles++;
+	return 0;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Run a built-in motion: the wand at rest with a left swing every two seconds
+ ****************************************************************************************
+ */
+static void arm_bench_builtin(void)
+{
+	uint32_t noise = 1;
+
+	for(unsigned i=0;i<(ARM_BENCH_BUILTIN_SECONDS * CFG_GESTURE_SAMPLE_RATE_HZ);i++)
+	{
+		unsigned phase = i % ARM_BENCH_SWING_PERIOD;
+		int8_t sample[XL_NUM_AXES];
+
+		noise = (noise * 1103515245u) + 12345u;
+		sample[XL_AXIS_X] = (int8_t)((noise >> 16) & 3) - 1;
+		sample[XL_AXIS_Y] = (int8_t)((noise >> 20) & 3) - 1;
+		sample[XL_AXIS_Z] = 64;
+		if(phase < ARM_BENCH_SWING_LENGTH)
+		{
+			sample[XL_AXIS_X] -= (int8_t)((phase < (ARM_BENCH_SWING_LENGTH / 2)) ? (phase * 4) : ((ARM_BENCH_SWING_LENGTH - phase) * 4));
+		}
+		arm_bench_tick(sample);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	mnfData.ad_structure_size = sizeof(mnfData) - sizeof(uint8_t);
+	mnfData.ad_structure_type = 0xFF;
+	i2c_XL_initialize();
+	gesture_pipeline_init(arm_bench_commit);
+
+	if(argc < 2)
+	{
+		arm_bench_builtin();
+	}
+	for(int arg=1;arg<argc;arg++)
+	{
+		if(arm_bench_file(argv[arg]) != 0)
+		{
+			return 1;
+		}
+	}
+
+	printf("corpus.files %lu\n", benchFiles);
+	printf("corpus.samples %lu\n", benchSamples);
+	printf("corpus.restarts %lu\n", benchRestarts);
+	printf("corpus.gestures %lu\n", benchGestures);
+	return 0;
+}
+
+/*
+ * SDK FUNCTIONS
+ ****************************************************************************************
+ */
+
+bool GPIO_GetPinStatus(GPIO_PORT port, GPIO_PIN pin)
+{
+	return xl_bus_get_line(pin == I2C_SCL_PIN);
+}
+
+void GPIO_ConfigurePin(GPIO_PORT port, GPIO_PIN pin, GPIO_PUPD mode, GPIO_FUNCTION function, const bool high)
+{
+	xl_bus_drive_line(pin == I2C_SCL_PIN, (function == PID_GPIO) && (mode == OUTPUT) && !high);
+}
+
+void arch_asm_delay_us(uint32_t nof_us)
+{
+}
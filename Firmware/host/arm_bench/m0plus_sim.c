@@ -0,0 +1,1175 @@
+/**
+ ****************************************************************************************
+ *
+ * @file m0plus_sim.c
+ *
+ * @brief ARMv6-M simulator counting Cortex-M0+ instructions and cycles in code regions.
+ *
+ * Usage: m0plus_sim [-m mul_cycles] image.elf [args...]
+ *
+ * Runs a static ARMv6-M ELF image, as the Makefile links it with rt/arm_rt.c or
+ * arm-none-eabi-gcc with rdimon.specs, from address 0 of a flat M0P_MEMORY_SIZE memory
+ * with the stack at its top. The image reaches the host through ARM semihosting
+ * (BKPT 0xAB): the console, the files of its arguments, the heap and stack limits and
+ * its exit. There are no exceptions, interrupts or peripherals; an instruction ARMv6-M
+ * does not have, an unaligned or out of range access and any other BKPT stop the run
+ * with an error.
+ *
+ * Every pair of functions arm_bench_<name>_begin and arm_bench_<name>_end in the symbol
+ * table of the image is a region (see arm_bench.c). A region starts at each execution
+ * of the first instruction of the begin function and stops at the first instruction
+ * of the end function. Regions may nest; an instruction counts for every region that
+ * is running.
+ *
+ * Cycles follow the instruction timings of the Cortex-M0+ Technical Reference Manual
+ * with zero wait state memory, as the DA14531 runs from SysRAM: loads and stores take
+ * 2 cycles, LDM/STM/PUSH/POP 1+N, POP with PC 3+N, BL and the other 32-bit
+ * instructions 3, other branches 2 and a conditional branch 1 when not taken, MULS 1
+ * (-m 32 for the small multiplier).
+ *
+ * At exit each region reports its count and the instructions and cycles per run, less
+ * the cost of the markers measured by a region named "empty" when there is one, after
+ * the output of the image.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+#define M0P_MEMORY_SIZE                     (0x01000000UL)
+#define M0P_STACK_SIZE                      (0x00010000UL)
+
+#define M0P_MAX_REGIONS                     (8)
+#define M0P_MAX_NAME                        (32)
+#define M0P_MARKER_PREFIX                   "arm_bench_"
+#define M0P_EMPTY_REGION                    "empty"
+
+#define M0P_MAX_FILES                       (16)
+#define M0P_MAX_CMDLINE                     (1024)
+
+/* Semihosting operations of newlib's rdimon                                                */
+#define M0P_SYS_OPEN                        (0x01)
+#define M0P_SYS_CLOSE                       (0x02)
+#define M0P_SYS_WRITEC                      (0x03)
+#define M0P_SYS_WRITE0                      (0x04)
+#define M0P_SYS_WRITE                       (0x05)
+#define M0P_SYS_READ                        (0x06)
+#define M0P_SYS_ISTTY                       (0x09)
+#define M0P_SYS_SEEK                        (0x0A)
+#define M0P_SYS_FLEN                        (0x0C)
+#define M0P_SYS_CLOCK                       (0x10)
+#define M0P_SYS_TIME                        (0x11)
+#define M0P_SYS_ERRNO                       (0x13)
+#define M0P_SYS_GET_CMDLINE                 (0x15)
+#define M0P_SYS_HEAPINFO                    (0x16)
+#define M0P_SYS_EXIT                        (0x18)
+#define M0P_SYS_EXIT_EXTENDED               (0x20)
+
+#define M0P_SEMIHOSTING_BKPT                (0xAB)
+#define M0P_EXIT_APPLICATION                (0x20026)
+
+/* ELF32 header and table fields used by the loader                                          */
+#define M0P_ELF_MACHINE_ARM                 (40)
+#define M0P_ELF_PT_LOAD                     (1)
+#define M0P_ELF_SHT_SYMTAB                  (2)
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// A counted code region
+struct m0p_region
+{
+	char name[M0P_MAX_NAME];
+	uint32_t begin;
+	uint32_t end;
+	int running;
+	/// Runs, and runs of other regions started inside this one
+	uint64_t count;
+	uint64_t nested;
+	uint64_t instructions;
+	uint64_t cycles;
+};
+
+/// Core registers; r[13] is SP, r[14] LR and r[15] the address of the instruction
+struct m0p_cpu
+{
+	uint32_t r[16];
+	int n;
+	int z;
+	int c;
+	int v;
+};
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+static uint8_t *memory;
+static uint32_t heapBase;
+static struct m0p_cpu cpu;
+
+static struct m0p_region regions[M0P_MAX_REGIONS];
+static int numRegions;
+static unsigned mulCycles = 1;
+
+static FILE *files[M0P_MAX_FILES];
+static int hostErrno;
+static char cmdline[M0P_MAX_CMDLINE];
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+static void m0p_fatal(const char *what, uint32_t value)
+{
+	fprintf(stderr, "m0plus_sim: %s 0x%08lx at pc 0x%08lx\n", what, (unsigned long)value, (unsigned long)cpu.r[15]);
+	exit(1);
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Check an access of size bytes; the core faults on unaligned ones
+ ****************************************************************************************
+ */
+static uint8_t *m0p_mem(uint32_t address, uint32_t size)
+{
+	if((address > (M0P_MEMORY_SIZE - size)) || (address & (size - 1)))
+	{
+		m0p_fatal("bad access to", address);
+	}
+	return &memory[address];
+}
+
+static uint32_t m0p_read(uint32_t address, uint32_t size)
+{
+	const uint8_t *p = m0p_mem(address, size);
+	uint32_t value = 0;
+
+	for(uint32_t i=size;i>0;i--)
+	{
+		value = (value << 8) | p[i - 1];
+	}
+	return value;
+}
+
+static void m0p_write(uint32_t address, uint32_t size, uint32_t value)
+{
+	uint8_t *p = m0p_mem(address, size);
+
+	for(uint32_t i=0;i<size;i++)
+	{
+		p[i] = (uint8_t)(value >> (8 * i));
+	}
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Bytes of the image for the host, at most size of them
+ ****************************************************************************************
+ */
+static uint8_t *m0p_block(uint32_t address, uint32_t size)
+{
+	if((address > M0P_MEMORY_SIZE) || (size > (M0P_MEMORY_SIZE - address)))
+	{
+		m0p_fatal("bad semihosting buffer", address);
+	}
+	return &memory[address];
+}
+
+static unsigned m0p_popcount(unsigned value)
+{
+	unsigned count = 0;
+
+	for(;value!=0;value>>=1)
+	{
+		count += value & 1;
+	}
+	return count;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Cycles of an ARMv6-M instruction, a conditional branch counted not taken
+ ****************************************************************************************
+ */
+static unsigned m0p_cycles(uint16_t hw)
+{
+	if((hw >> 11) >= 0x1D)
+	{
+		return 3;                                           // BL, MSR, MRS, DMB, DSB, ISB
+	}
+	if((hw & 0xFFC0) == 0x4340)
+	{
+		return mulCycles;                                   // MULS
+	}
+	if((hw & 0xFF00) == 0x4700)
+	{
+		return 2;                                           // BX, BLX
+	}
+	if(((hw & 0xFC00) == 0x4400) && ((hw & 0x0300) != 0x0100) && (((hw & 0x7) | ((hw >> 4) & 0x8)) == 15))
+	{
+		return 2;                                           // ADD, MOV to PC
+	}
+	if(((hw & 0xF800) == 0x4800) || ((hw & 0xF000) == 0x5000) || ((hw & 0xE000) == 0x6000) || ((hw & 0xE000) == 0x8000))
+	{
+		return 2;                                           // LDR, STR
+	}
+	if((hw & 0xFE00) == 0xB400)
+	{
+		return 1 + m0p_popcount(hw & 0x1FF);                // PUSH
+	}
+	if((hw & 0xFE00) == 0xBC00)
+	{
+		return ((hw & 0x100) ? 3 : 1) + m0p_popcount(hw & 0x1FF); // POP
+	}
+	if((hw & 0xF000) == 0xC000)
+	{
+		return 1 + m0p_popcount(hw & 0xFF);                 // LDM, STM
+	}
+	if(((hw & 0xF000) == 0xD000) && ((hw & 0x0E00) != 0x0E00))
+	{
+		return 1;                                           // B<cond>
+	}
+	if((hw & 0xF800) == 0xE000)
+	{
+		return 2;                                           // B
+	}
+	return 1;
+}
+
+static void m0p_set_nz(uint32_t result)
+{
+	cpu.n = (int)(result >> 31);
+	cpu.z = (result == 0);
+}
+
+ /**
+ ****************************************************************************************
+ * @brief AddWithCarry() of the ARM ARM, setting all four flags
+ ****************************************************************************************
+ */
+static uint32_t m0p_add(uint32_t x, uint32_t y, int carry)
+{
+	uint64_t unsignedSum = (uint64_t)x + y + (unsigned)carry;
+	int64_t signedSum = (int64_t)(int32_t)x + (int32_t)y + carry;
+	uint32_t result = (uint32_t)unsignedSum;
+
+	m0p_set_nz(result);
+	cpu.c = (unsignedSum >> 32) != 0;
+	cpu.v = signedSum != (int64_t)(int32_t)result;
+	return result;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Shift by a register or an immediate, setting N, Z and, for a non-zero
+ *        amount, C. type: 0 LSL, 1 LSR, 2 ASR, 3 ROR
+ ****************************************************************************************
+ */
+static uint32_t m0p_shift(uint32_t value, unsigned type, unsigned amount)
+{
+	uint32_t result = value;
+
+	if(amount != 0)
+	{
+		switch(type)
+		{
+			case 0:
+				cpu.c = (amount <= 32) ? (int)((value >> (32 - amount)) & 1) : 0;
+				result = (amount < 32) ? (value << amount) : 0;
+				break;
+			case 1:
+				cpu.c = (amount <= 32) ? (int)((value >> (amount - 1)) & 1) : 0;
+				result = (amount < 32) ? (value >> amount) : 0;
+				break;
+			case 2:
+				if(amount >= 32)
+				{
+					result = (value & 0x80000000UL) ? 0xFFFFFFFFUL : 0;
+					cpu.c = (int)(result & 1);
+				}
+				else
+				{
+					cpu.c = (int)((value >> (amount - 1)) & 1);
+					result = (uint32_t)((int32_t)value >> amount);
+				}
+				break;
+			default:
+				amount &= 31;
+				result = (amount != 0) ? ((value >> amount) | (value << (32 - amount))) : value;
+				cpu.c = (int)(result >> 31);
+				break;
+		}
+	}
+	m0p_set_nz(result);
+	return result;
+}
+
+static int m0p_condition(unsigned cond)
+{
+	switch(cond)
+	{
+		case 0x0: return cpu.z;
+		case 0x1: return !cpu.z;
+		case 0x2: return cpu.c;
+		case 0x3: return !cpu.c;
+		case 0x4: return cpu.n;
+		case 0x5: return !cpu.n;
+		case 0x6: return cpu.v;
+		case 0x7: return !cpu.v;
+		case 0x8: return cpu.c && !cpu.z;
+		case 0x9: return !cpu.c || cpu.z;
+		case 0xA: return cpu.n == cpu.v;
+		case 0xB: return cpu.n != cpu.v;
+		case 0xC: return !cpu.z && (cpu.n == cpu.v);
+		default:  return cpu.z || (cpu.n != cpu.v);
+	}
+}
+
+static const char *m0p_string(uint32_t address, uint32_t length)
+{
+	static char path[M0P_MAX_CMDLINE];
+
+	if(length >= sizeof(path))
+	{
+		m0p_fatal("semihosting string too long at", address);
+	}
+	memcpy(path, m0p_block(address, length), length);
+	path[length] = '\0';
+	return path;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Open a file for SYS_OPEN; ":tt" is the console
+ ****************************************************************************************
+ */
+static uint32_t m0p_open(const char *path, uint32_t mode)
+{
+	static const char * const modes[12] = {"r", "rb", "r+", "r+b", "w", "wb", "w+", "w+b", "a", "ab", "a+", "a+b"};
+
+	if(mode >= 12)
+	{
+		hostErrno = EINVAL;
+		return 0xFFFFFFFFUL;
+	}
+	for(int handle=1;handle<M0P_MAX_FILES;handle++)
+	{
+		if(files[handle] == NULL)
+		{
+			if(strcmp(path, ":tt") == 0)
+			{
+				files[handle] = (mode < 4) ? stdin : ((mode < 8) ? stdout : stderr);
+			}
+			else if((files[handle] = fopen(path, modes[mode])) == NULL)
+			{
+				hostErrno = errno;
+				return 0xFFFFFFFFUL;
+			}
+			return (uint32_t)handle;
+		}
+	}
+	hostErrno = EMFILE;
+	return 0xFFFFFFFFUL;
+}
+
+static FILE *m0p_file(uint32_t handle)
+{
+	if((handle == 0) || (handle >= M0P_MAX_FILES) || (files[handle] == NULL))
+	{
+		hostErrno = EBADF;
+		return NULL;
+	}
+	return files[handle];
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Semihosting call: operation in r0, parameter block (or value) in r1, result
+ *        in r0
+ ****************************************************************************************
+ */
+static void m0p_semihosting(void)
+{
+	uint32_t op = cpu.r[0];
+	uint32_t arg = cpu.r[1];
+	uint32_t result = 0xFFFFFFFFUL;
+	FILE *file;
+
+	switch(op)
+	{
+		case M0P_SYS_OPEN:
+			result = m0p_open(m0p_string(m0p_read(arg, 4), m0p_read(arg + 8, 4)), m0p_read(arg + 4, 4));
+			break;
+		case M0P_SYS_CLOSE:
+			if((file = m0p_file(m0p_read(arg, 4))) != NULL)
+			{
+				if((file != stdin) && (file != stdout) && (file != stderr))
+				{
+					fclose(file);
+				}
+				files[m0p_read(arg, 4)] = NULL;
+				result = 0;
+			}
+			break;
+		case M0P_SYS_WRITEC:
+			fputc((int)m0p_read(arg, 1), stdout);
+			result = 0;
+			break;
+		case M0P_SYS_WRITE0:
+			for(uint32_t p=arg;m0p_read(p, 1)!=0;p++)
+			{
+				fputc((int)m0p_read(p, 1), stdout);
+			}
+			result = 0;
+			break;
+		case M0P_SYS_WRITE:
+			result = m0p_read(arg + 8, 4);
+			if((file = m0p_file(m0p_read(arg, 4))) != NULL)
+			{
+				result -= (uint32_t)fwrite(m0p_block(m0p_read(arg + 4, 4), result), 1, result, file);
+			}
+			break;
+		case M0P_SYS_READ:
+			result = m0p_read(arg + 8, 4);
+			if((file = m0p_file(m0p_read(arg, 4))) != NULL)
+			{
+				result -= (uint32_t)fread(m0p_block(m0p_read(arg + 4, 4), result), 1, result, file);
+			}
+			break;
+		case M0P_SYS_ISTTY:
+			file = m0p_file(m0p_read(arg, 4));
+			result = (file == stdin) || (file == stdout) || (file == stderr);
+			break;
+		case M0P_SYS_SEEK:
+			if((file = m0p_file(m0p_read(arg, 4))) != NULL)
+			{
+				result = (fseek(file, (long)m0p_read(arg + 4, 4), SEEK_SET) == 0) ? 0 : 0xFFFFFFFFUL;
+			}
+			break;
+		case M0P_SYS_FLEN:
+			if((file = m0p_file(m0p_read(arg, 4))) != NULL)
+			{
+				long position = ftell(file);
+
+				fseek(file, 0, SEEK_END);
+				result = (uint32_t)ftell(file);
+				fseek(file, position, SEEK_SET);
+			}
+			break;
+		case M0P_SYS_CLOCK:
+			result = (uint32_t)((clock() * 100) / CLOCKS_PER_SEC);
+			break;
+		case M0P_SYS_TIME:
+			result = (uint32_t)time(NULL);
+			break;
+		case M0P_SYS_ERRNO:
+			result = (uint32_t)hostErrno;
+			break;
+		case M0P_SYS_GET_CMDLINE:
+		{
+			uint32_t length = (uint32_t)strlen(cmdline);
+
+			if(length < m0p_read(arg + 4, 4))
+			{
+				memcpy(m0p_block(m0p_read(arg, 4), length + 1), cmdline, length + 1);
+				m0p_write(arg + 4, 4, length);
+				result = 0;
+			}
+			break;
+		}
+		case M0P_SYS_HEAPINFO:
+		{
+			uint32_t block = m0p_read(arg, 4);
+
+			m0p_write(block, 4, heapBase);
+			m0p_write(block + 4, 4, M0P_MEMORY_SIZE - M0P_STACK_SIZE);
+			m0p_write(block + 8, 4, M0P_MEMORY_SIZE);
+			m0p_write(block + 12, 4, M0P_MEMORY_SIZE - M0P_STACK_SIZE);
+			result = 0;
+			break;
+		}
+		case M0P_SYS_EXIT:
+			exit((arg == M0P_EXIT_APPLICATION) ? 0 : 1);
+			break;
+		case M0P_SYS_EXIT_EXTENDED:
+			exit((m0p_read(arg, 4) == M0P_EXIT_APPLICATION) ? (int)m0p_read(arg + 4, 4) : 1);
+			break;
+		default:
+			hostErrno = ENOSYS;
+			break;
+	}
+	cpu.r[0] = result;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Execute the 32-bit instruction hw1:hw2; only BL and the system instructions
+ *        are in ARMv6-M
+ ****************************************************************************************
+ */
+static uint32_t m0p_execute32(uint32_t pc, uint16_t hw1, uint16_t hw2)
+{
+	if(((hw1 & 0xF800) == 0xF000) && ((hw2 & 0xD000) == 0xD000))
+	{
+		uint32_t s = (hw1 >> 10) & 1;
+		uint32_t i1 = !(((hw2 >> 13) & 1) ^ s);
+		uint32_t i2 = !(((hw2 >> 11) & 1) ^ s);
+		uint32_t offset = (s << 24) | (i1 << 23) | (i2 << 22) | ((uint32_t)(hw1 & 0x3FF) << 12) | ((uint32_t)(hw2 & 0x7FF) << 1);
+
+		if(s)
+		{
+			offset |= 0xFE000000UL;
+		}
+		cpu.r[14] = (pc + 4) | 1;
+		return pc + 4 + offset;
+	}
+	if(((hw1 & 0xFFF0) == 0xF380) && ((hw2 & 0xFF00) == 0x8800))
+	{
+		return pc + 4;                                      // MSR: no special register has an effect here
+	}
+	if((hw1 == 0xF3EF) && ((hw2 & 0xF000) == 0x8000))
+	{
+		cpu.r[(hw2 >> 8) & 0xF] = 0;                        // MRS
+		return pc + 4;
+	}
+	if((hw1 == 0xF3BF) && ((hw2 & 0xFF00) == 0x8F00))
+	{
+		return pc + 4;                                      // DMB, DSB, ISB
+	}
+	m0p_fatal("undefined instruction", ((uint32_t)hw1 << 16) | hw2);
+	return 0;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Execute the 16-bit instruction hw at pc
+ * @return address of the next instruction
+ ****************************************************************************************
+ */
+static uint32_t m0p_execute16(uint32_t pc, uint16_t hw, int *taken)
+{
+	uint32_t *r = cpu.r;
+	uint32_t next = pc + 2;
+	unsigned rd = hw & 7;
+	unsigned rn = (hw >> 3) & 7;
+	unsigned rm = (hw >> 6) & 7;
+
+	if((hw >> 13) == 0)
+	{
+		unsigned op = (hw >> 11) & 3;
+		unsigned imm5 = (hw >> 6) & 0x1F;
+
+		if(op != 3)
+		{
+			// LSLS, LSRS, ASRS by an immediate; 0 means 32 for the right shifts
+			r[rd] = m0p_shift(r[rn], op, ((op != 0) && (imm5 == 0)) ? 32 : imm5);
+		}
+		else
+		{
+			uint32_t operand = (hw & 0x400) ? rm : r[rm];
+
+			r[rd] = (hw & 0x200) ? m0p_add(r[rn], ~operand, 1) : m0p_add(r[rn], operand, 0);
+		}
+	}
+	else if((hw >> 13) == 1)
+	{
+		unsigned rdn = (hw >> 8) & 7;
+		uint32_t imm8 = hw & 0xFF;
+
+		switch((hw >> 11) & 3)
+		{
+			case 0: r[rdn] = imm8; m0p_set_nz(imm8); break;
+			case 1: m0p_add(r[rdn], ~imm8, 1); break;
+			case 2: r[rdn] = m0p_add(r[rdn], imm8, 0); break;
+			default: r[rdn] = m0p_add(r[rdn], ~imm8, 1); break;
+		}
+	}
+	else if((hw >> 10) == 0x10)
+	{
+		uint32_t x = r[rd];
+		uint32_t y = r[rn];
+
+		switch((hw >> 6) & 0xF)
+		{
+			case 0x0: r[rd] = x & y; m0p_set_nz(r[rd]); break;
+			case 0x1: r[rd] = x ^ y; m0p_set_nz(r[rd]); break;
+			case 0x2: r[rd] = m0p_shift(x, 0, y & 0xFF); break;
+			case 0x3: r[rd] = m0p_shift(x, 1, y & 0xFF); break;
+			case 0x4: r[rd] = m0p_shift(x, 2, y & 0xFF); break;
+			case 0x5: r[rd] = m0p_add(x, y, cpu.c); break;
+			case 0x6: r[rd] = m0p_add(x, ~y, cpu.c); break;
+			case 0x7: r[rd] = m0p_shift(x, 3, y & 0xFF); break;
+			case 0x8: m0p_set_nz(x & y); break;
+			case 0x9: r[rd] = m0p_add(~y, 0, 1); break;
+			case 0xA: m0p_add(x, ~y, 1); break;
+			case 0xB: m0p_add(x, y, 0); break;
+			case 0xC: r[rd] = x | y; m0p_set_nz(r[rd]); break;
+			case 0xD: r[rd] = x * y; m0p_set_nz(r[rd]); break;
+			case 0xE: r[rd] = x & ~y; m0p_set_nz(r[rd]); break;
+			default:  r[rd] = ~y; m0p_set_nz(r[rd]); break;
+		}
+	}
+	else if((hw >> 10) == 0x11)
+	{
+		unsigned rdn = (hw & 7) | ((hw >> 4) & 8);
+		unsigned rs = (hw >> 3) & 0xF;
+		uint32_t value = (rs == 15) ? (pc + 4) : r[rs];
+
+		switch((hw >> 8) & 3)
+		{
+			case 0:
+				value += (rdn == 15) ? (pc + 4) : r[rdn];
+				if(rdn == 15)
+				{
+					next = value & ~1UL;
+				}
+				else
+				{
+					r[rdn] = value;
+				}
+				break;
+			case 1:
+				m0p_add(r[rdn], ~value, 1);
+				break;
+			case 2:
+				if(rdn == 15)
+				{
+					next = value & ~1UL;
+				}
+				else
+				{
+					r[rdn] = value;
+				}
+				break;
+			default:
+				if(!(value & 1))
+				{
+					m0p_fatal("interworking branch to ARM state at", value);
+				}
+				if(hw & 0x80)
+				{
+					r[14] = (pc + 2) | 1;
+				}
+				next = value & ~1UL;
+				break;
+		}
+	}
+	else if((hw >> 11) == 0x09)
+	{
+		r[(hw >> 8) & 7] = m0p_read(((pc + 4) & ~3UL) + ((hw & 0xFF) << 2), 4);
+	}
+	else if((hw >> 12) == 0x5)
+	{
+		uint32_t address = r[rn] + r[rm];
+
+		switch((hw >> 9) & 7)
+		{
+			case 0: m0p_write(address, 4, r[rd]); break;
+			case 1: m0p_write(address, 2, r[rd]); break;
+			case 2: m0p_write(address, 1, r[rd]); break;
+			case 3: r[rd] = (uint32_t)(int32_t)(int8_t)m0p_read(address, 1); break;
+			case 4: r[rd] = m0p_read(address, 4); break;
+			case 5: r[rd] = m0p_read(address, 2); break;
+			case 6: r[rd] = m0p_read(address, 1); break;
+			default: r[rd] = (uint32_t)(int32_t)(int16_t)m0p_read(address, 2); break;
+		}
+	}
+	else if(((hw >> 13) == 3) || ((hw >> 12) == 8))
+	{
+		unsigned imm5 = (hw >> 6) & 0x1F;
+		// STR/LDR word, STRB/LDRB, STRH/LDRH with the offset scaled to the size
+		uint32_t size = ((hw >> 12) == 8) ? 2 : ((hw & 0x1000) ? 1 : 4);
+		uint32_t address = r[rn] + (imm5 * size);
+
+		if(hw & 0x800)
+		{
+			r[rd] = m0p_read(address, size);
+		}
+		else
+		{
+			m0p_write(address, size, r[rd]);
+		}
+	}
+	else if((hw >> 12) == 9)
+	{
+		uint32_t address = r[13] + ((hw & 0xFF) << 2);
+
+		if(hw & 0x800)
+		{
+			r[(hw >> 8) & 7] = m0p_read(address, 4);
+		}
+		else
+		{
+			m0p_write(address, 4, r[(hw >> 8) & 7]);
+		}
+	}
+	else if((hw >> 12) == 0xA)
+	{
+		uint32_t base = (hw & 0x800) ? r[13] : ((pc + 4) & ~3UL);
+
+		r[(hw >> 8) & 7] = base + ((hw & 0xFF) << 2);
+	}
+	else if((hw & 0xFF00) == 0xB000)
+	{
+		uint32_t offset = (hw & 0x7F) << 2;
+
+		r[13] = (hw & 0x80) ? (r[13] - offset) : (r[13] + offset);
+	}
+	else if((hw & 0xFF00) == 0xB200)
+	{
+		uint32_t value = r[rn];
+
+		switch((hw >> 6) & 3)
+		{
+			case 0: r[rd] = (uint32_t)(int32_t)(int16_t)value; break;
+			case 1: r[rd] = (uint32_t)(int32_t)(int8_t)value; break;
+			case 2: r[rd] = value & 0xFFFF; break;
+			default: r[rd] = value & 0xFF; break;
+		}
+	}
+	else if((hw & 0xFE00) == 0xB400)
+	{
+		uint32_t address = r[13] - (4 * m0p_popcount(hw & 0x1FF));
+
+		r[13] = address;
+		for(unsigned i=0;i<8;i++)
+		{
+			if(hw & (1 << i))
+			{
+				m0p_write(address, 4, r[i]);
+				address += 4;
+			}
+		}
+		if(hw & 0x100)
+		{
+			m0p_write(address, 4, r[14]);
+		}
+	}
+	else if((hw & 0xFFE8) == 0xB660)
+	{
+		// CPS: there are no interrupts to mask
+	}
+	else if((hw & 0xFF00) == 0xBA00)
+	{
+		uint32_t value = r[rn];
+
+		switch((hw >> 6) & 3)
+		{
+			case 0:
+				r[rd] = (value >> 24) | ((value >> 8) & 0xFF00) | ((value << 8) & 0xFF0000) | (value << 24);
+				break;
+			case 1:
+				r[rd] = ((value >> 8) & 0x00FF00FFUL) | ((value << 8) & 0xFF00FF00UL);
+				break;
+			case 3:
+				r[rd] = (uint32_t)(int32_t)(int16_t)(((value >> 8) & 0xFF) | ((value << 8) & 0xFF00));
+				break;
+			default:
+				m0p_fatal("undefined instruction", hw);
+				break;
+		}
+	}
+	else if((hw & 0xFE00) == 0xBC00)
+	{
+		uint32_t address = r[13];
+
+		for(unsigned i=0;i<8;i++)
+		{
+			if(hw & (1 << i))
+			{
+				r[i] = m0p_read(address, 4);
+				address += 4;
+			}
+		}
+		if(hw & 0x100)
+		{
+			next = m0p_read(address, 4) & ~1UL;
+			address += 4;
+		}
+		r[13] = address;
+	}
+	else if((hw & 0xFF00) == 0xBE00)
+	{
+		if((hw & 0xFF) != M0P_SEMIHOSTING_BKPT)
+		{
+			m0p_fatal("breakpoint", hw & 0xFF);
+		}
+		m0p_semihosting();
+	}
+	else if((hw & 0xFF00) == 0xBF00)
+	{
+		// NOP, YIELD, WFE, WFI, SEV
+	}
+	else if((hw >> 12) == 0xC)
+	{
+		unsigned rb = (hw >> 8) & 7;
+		uint32_t address = r[rb];
+
+		for(unsigned i=0;i<8;i++)
+		{
+			if(hw & (1 << i))
+			{
+				if(hw & 0x800)
+				{
+					r[i] = m0p_read(address, 4);
+				}
+				else
+				{
+					m0p_write(address, 4, r[i]);
+				}
+				address += 4;
+			}
+		}
+		// LDM writes the base back unless it is loaded
+		if(!(hw & 0x800) || !(hw & (1 << rb)))
+		{
+			r[rb] = address;
+		}
+	}
+	else if(((hw >> 12) == 0xD) && (((hw >> 9) & 7) != 7))
+	{
+		if(m0p_condition((hw >> 8) & 0xF))
+		{
+			next = pc + 4 + (uint32_t)((int32_t)(int8_t)(hw & 0xFF) * 2);
+			*taken = 1;
+		}
+	}
+	else if((hw >> 11) == 0x1C)
+	{
+		int32_t offset = (int32_t)((hw & 0x7FF) << 21) >> 20;
+
+		next = pc + 4 + (uint32_t)offset;
+	}
+	else
+	{
+		m0p_fatal("undefined instruction", hw);
+	}
+	return next;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Start and stop the regions at a marker address
+ ****************************************************************************************
+ */
+static void m0p_mark(uint32_t pc)
+{
+	for(int i=0;i<numRegions;i++)
+	{
+		if(pc == regions[i].end)
+		{
+			regions[i].running = 0;
+		}
+	}
+	for(int i=0;i<numRegions;i++)
+	{
+		if(pc == regions[i].begin)
+		{
+			for(int j=0;j<numRegions;j++)
+			{
+				regions[j].nested += regions[j].running;
+			}
+			regions[i].running = 1;
+			regions[i].count++;
+		}
+	}
+}
+
+static void m0p_count(unsigned cycles)
+{
+	for(int i=0;i<numRegions;i++)
+	{
+		if(regions[i].running)
+		{
+			regions[i].instructions++;
+			regions[i].cycles += cycles;
+		}
+	}
+}
+
+static void m0p_report(void)
+{
+	double emptyInstructions = 0;
+	double emptyCycles = 0;
+
+	fflush(stdout);
+	for(int i=0;i<numRegions;i++)
+	{
+		if((strcmp(regions[i].name, M0P_EMPTY_REGION) == 0) && (regions[i].count > 0))
+		{
+			emptyInstructions = (double)regions[i].instructions / regions[i].count;
+			emptyCycles = (double)regions[i].cycles / regions[i].count;
+		}
+	}
+
+	for(int i=0;i<numRegions;i++)
+	{
+		const struct m0p_region *region = &regions[i];
+		// The markers of a run, and a begin and an end call for each nested run
+		double markers = (double)(region->count + (2 * region->nested));
+
+		if(strcmp(region->name, M0P_EMPTY_REGION) == 0)
+		{
+			continue;
+		}
+		printf("m0plus.%s.count %llu\n", region->name, (unsigned long long)region->count);
+		if(region->count == 0)
+		{
+			printf("m0plus.%s.instructions -\nm0plus.%s.cycles -\n", region->name, region->name);
+		}
+		else
+		{
+			printf("m0plus.%s.instructions %.1f\nm0plus.%s.cycles %.1f\n",
+				region->name, ((double)region->instructions - (markers * emptyInstructions)) / region->count,
+				region->name, ((double)region->cycles - (markers * emptyCycles)) / region->count);
+		}
+	}
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Add the begin or end marker of a region, by the name between the prefix and
+ *        the suffix
+ ****************************************************************************************
+ */
+static void m0p_add_marker(const char *symbol, uint32_t address)
+{
+	static const char * const suffixes[2] = {"_begin", "_end"};
+	size_t prefixLen = strlen(M0P_MARKER_PREFIX);
+	size_t symbolLen = strlen(symbol);
+
+	if(strncmp(symbol, M0P_MARKER_PREFIX, prefixLen) != 0)
+	{
+		return;
+	}
+	for(int end=0;end<2;end++)
+	{
+		size_t suffixLen = strlen(suffixes[end]);
+		size_t nameLen;
+		int i;
+
+		if((symbolLen <= prefixLen + suffixLen) || (strcmp(symbol + symbolLen - suffixLen, suffixes[end]) != 0))
+		{
+			continue;
+		}
+		nameLen = symbolLen - prefixLen - suffixLen;
+		if(nameLen >= M0P_MAX_NAME)
+		{
+			return;
+		}
+		for(i=0;i<numRegions;i++)
+		{
+			if((strlen(regions[i].name) == nameLen) && (strncmp(regions[i].name, symbol + prefixLen, nameLen) == 0))
+			{
+				break;
+			}
+		}
+		if(i == numRegions)
+		{
+			if(numRegions == M0P_MAX_REGIONS)
+			{
+				return;
+			}
+			memcpy(regions[i].name, symbol + prefixLen, nameLen);
+			numRegions++;
+		}
+		// Thumb function symbols have bit 0 set
+		if(end)
+		{
+			regions[i].end = address & ~1UL;
+		}
+		else
+		{
+			regions[i].begin = address & ~1UL;
+		}
+	}
+}
+
+static int m0p_compare_regions(const void *a, const void *b)
+{
+	const struct m0p_region *x = a;
+	const struct m0p_region *y = b;
+
+	return (x->begin > y->begin) - (x->begin < y->begin);
+}
+
+static uint32_t m0p_le32(const uint8_t *p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t m0p_le16(const uint8_t *p)
+{
+	return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Load the PT_LOAD segments of an ELF32 ARM image and the markers of its symbol
+ *        table
+ * @return entry point, or 0 when the file is not such an image
+ ****************************************************************************************
+ */
+static uint32_t m0p_load(const char *path)
+{
+	FILE *file = fopen(path, "rb");
+	uint8_t *elf;
+	long size;
+	uint32_t entry = 0;
+
+	if(file == NULL)
+	{
+		perror(path);
+		return 0;
+	}
+	fseek(file, 0, SEEK_END);
+	size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	elf = malloc((size_t)size);
+	if((elf == NULL) || (size < 52) || (fread(elf, 1, (size_t)size, file) != (size_t)size) ||
+		(memcmp(elf, "\177ELF\001\001", 6) != 0) || (m0p_le16(elf + 18) != M0P_ELF_MACHINE_ARM))
+	{
+		fprintf(stderr, "%s: not a little endian ELF32 ARM image\n", path);
+	}
+	else
+	{
+		uint32_t phoff = m0p_le32(elf + 28);
+		uint32_t shoff = m0p_le32(elf + 32);
+		unsigned phentsize = m0p_le16(elf + 42);
+		unsigned phnum = m0p_le16(elf + 44);
+		unsigned shentsize = m0p_le16(elf + 46);
+		unsigned shnum = m0p_le16(elf + 48);
+
+		entry = m0p_le32(elf + 24);
+		for(unsigned i=0;(i<phnum) && (entry!=0);i++)
+		{
+			const uint8_t *ph = elf + phoff + (i * phentsize);
+			uint32_t offset = m0p_le32(ph + 4);
+			uint32_t address = m0p_le32(ph + 12);
+			uint32_t fileSize = m0p_le32(ph + 16);
+			uint32_t memSize = m0p_le32(ph + 20);
+
+			if(m0p_le32(ph) != M0P_ELF_PT_LOAD)
+			{
+				continue;
+			}
+			if((memSize < fileSize) || (address > (M0P_MEMORY_SIZE - M0P_STACK_SIZE)) ||
+				(memSize > (M0P_MEMORY_SIZE - M0P_STACK_SIZE - address)) || ((uint64_t)offset + fileSize > (uint64_t)size))
+			{
+				fprintf(stderr, "%s: segment at 0x%08lx does not fit in memory\n", path, (unsigned long)address);
+				entry = 0;
+				break;
+			}
+			memcpy(&memory[address], elf + offset, fileSize);
+			if(address + memSize > heapBase)
+			{
+				heapBase = (address + memSize + 7) & ~7UL;
+			}
+		}
+		for(unsigned i=0;(i<shnum) && (entry!=0);i++)
+		{
+			const uint8_t *sh = elf + shoff + (i * shentsize);
+			const uint8_t *strtab;
+
+			if(m0p_le32(sh + 4) != M0P_ELF_SHT_SYMTAB)
+			{
+				continue;
+			}
+			strtab = elf + m0p_le32(elf + shoff + (m0p_le32(sh + 24) * shentsize) + 16);
+			for(uint32_t j=0;j<m0p_le32(sh + 20);j+=16)
+			{
+				const uint8_t *sym = elf + m0p_le32(sh + 16) + j;
+
+				m0p_add_marker((const char *)strtab + m0p_le32(sym), m0p_le32(sym + 4));
+			}
+		}
+	}
+	free(elf);
+	fclose(file);
+	qsort(regions, (size_t)numRegions, sizeof(regions[0]), m0p_compare_regions);
+	return entry;
+}
+
+int main(int argc, char **argv)
+{
+	uint32_t pc;
+	int arg = 1;
+
+	if((arg + 1 < argc) && (strcmp(argv[arg], "-m") == 0))
+	{
+		mulCycles = (unsigned)atoi(argv[arg + 1]);
+		arg += 2;
+	}
+	if(arg >= argc)
+	{
+		fprintf(stderr, "usage: %s [-m mul_cycles] image.elf [args...]\n", argv[0]);
+		return 2;
+	}
+	memory = calloc(1, M0P_MEMORY_SIZE);
+	if((memory == NULL) || ((pc = m0p_load(argv[arg])) == 0))
+	{
+		return 1;
+	}
+	for(int i=arg;i<argc;i++)
+	{
+		if(strlen(cmdline) + strlen(argv[i]) + 2 > sizeof(cmdline))
+		{
+			fprintf(stderr, "m0plus_sim: command line too long\n");
+			return 1;
+		}
+		if(i > arg)
+		{
+			strcat(cmdline, " ");
+		}
+		strcat(cmdline, argv[i]);
+	}
+	atexit(m0p_report);
+
+	cpu.r[13] = M0P_MEMORY_SIZE;
+	cpu.r[14] = 0xFFFFFFFFUL;
+	pc &= ~1UL;
+	for(;;)
+	{
+		uint16_t hw = (uint16_t)m0p_read(pc, 2);
+		unsigned cycles = m0p_cycles(hw);
+		int taken = 0;
+
+		cpu.r[15] = pc;
+		m0p_mark(pc);
+		if((hw >> 11) >= 0x1D)
+		{
+			pc = m0p_execute32(pc, hw, (uint16_t)m0p_read(pc + 2, 2));
+		}
+		else
+		{
+			pc = m0p_execute16(pc, hw, &taken);
+		}
+		// A taken conditional branch refills the pipeline
+		m0p_count(cycles + (unsigned)taken);
+		if(pc == 0xFFFFFFFEUL)
+		{
+			fprintf(stderr, "m0plus_sim: returned from the entry point\n");
+			return 1;
+		}
+	}
+}
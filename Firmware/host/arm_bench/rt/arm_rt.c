@@ -0,0 +1,757 @@
+/**
+ ****************************************************************************************
+ *
+ * @file arm_rt.c
+ *
+ * @brief Minimal freestanding runtime of the arm_bench image.
+ *
+ * What arm_bench.c and the application sources need from a C library, with the
+ * headers of include/, and nothing else: the start-up code, the console and files
+ * through ARM semihosting (BKPT 0xAB, served by m0plus_sim), a printf of %d %u %s %c
+ * with l and ll, the string functions and the AEABI helpers clang calls for ARMv6-M.
+ *
+ * The helpers are plain C rather than the hand-written assembly of a toolchain
+ * library, so the cycles they take are those of this file: restoring division, the
+ * 64-bit multiply from 16x16 partial products in 32-bit arithmetic as libgcc does
+ * on ARMv6-M, and the three soft double operations of the per-axis SWAR reference
+ * loop, without infinities, NaNs or denormals. The figures of baseline.txt include
+ * them wherever the measured code divides or multiplies 64-bit values.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/* Semihosting operations                                                                  */
+#define RT_SYS_OPEN                         (0x01)
+#define RT_SYS_CLOSE                        (0x02)
+#define RT_SYS_WRITE                        (0x05)
+#define RT_SYS_READ                         (0x06)
+#define RT_SYS_GET_CMDLINE                  (0x15)
+#define RT_SYS_EXIT_EXTENDED                (0x20)
+
+/* SYS_OPEN modes: "rb", and "w" and "a" of the console                                    */
+#define RT_MODE_READ                        (1)
+#define RT_MODE_WRITE                       (5)
+#define RT_MODE_TT_WRITE                    (4)
+#define RT_MODE_TT_APPEND                   (8)
+
+/* ADP_Stopped_ApplicationExit, the reason of SYS_EXIT_EXTENDED                            */
+#define RT_EXIT_APPLICATION                 (0x20026)
+
+#define RT_MAX_FILES                        (8)
+#define RT_MAX_ARGS                         (16)
+#define RT_CMDLINE_SIZE                     (512)
+#define RT_PRINTF_SIZE                      (256)
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+typedef struct
+{
+	unsigned q;
+	unsigned r;
+} rt_uqr_t;
+
+typedef struct
+{
+	unsigned long long q;
+	unsigned long long r;
+} rt_ulqr_t;
+
+typedef union
+{
+	unsigned long long v;
+	struct
+	{
+		unsigned lo;
+		unsigned hi;
+	} w;
+} rt_u64_t;
+
+typedef union
+{
+	double d;
+	uint64_t u;
+} rt_double_t;
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+static FILE rtFiles[RT_MAX_FILES];
+static FILE rtStdout;
+static FILE rtStderr;
+
+FILE *stdout = &rtStdout;
+FILE *stderr = &rtStderr;
+
+int main(int argc, char **argv);
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+ */
+
+static int rt_semihost(int op, void *arg)
+{
+	register int r0 __asm("r0") = op;
+	register void *r1 __asm("r1") = arg;
+
+	__asm volatile ("bkpt 0xab" : "+r"(r0) : "r"(r1) : "memory");
+	return r0;
+}
+
+size_t strlen(const char *s)
+{
+	size_t n = 0;
+
+	while(s[n])
+	{
+		n++;
+	}
+	return n;
+}
+
+int strcmp(const char *a, const char *b)
+{
+	while(*a && (*a == *b))
+	{
+		a++;
+		b++;
+	}
+	return (unsigned char)*a - (unsigned char)*b;
+}
+
+void *memcpy(void *d, const void *s, size_t n)
+{
+	uint8_t *dd = d;
+	const uint8_t *ss = s;
+
+	while(n--)
+	{
+		*dd++ = *ss++;
+	}
+	return d;
+}
+
+void *memmove(void *d, const void *s, size_t n)
+{
+	uint8_t *dd = d;
+	const uint8_t *ss = s;
+
+	if(dd < ss)
+	{
+		while(n--)
+		{
+			*dd++ = *ss++;
+		}
+	}
+	else
+	{
+		while(n--)
+		{
+			dd[n] = ss[n];
+		}
+	}
+	return d;
+}
+
+void *memset(void *d, int c, size_t n)
+{
+	uint8_t *dd = d;
+
+	while(n--)
+	{
+		*dd++ = (uint8_t)c;
+	}
+	return d;
+}
+
+int memcmp(const void *a, const void *b, size_t n)
+{
+	const uint8_t *x = a;
+	const uint8_t *y = b;
+
+	for(size_t i = 0; i < n; i++)
+	{
+		if(x[i] != y[i])
+		{
+			return x[i] - y[i];
+		}
+	}
+	return 0;
+}
+
+int abs(int x)
+{
+	return (x < 0) ? -x : x;
+}
+
+int atoi(const char *s)
+{
+	int v = 0;
+	int neg = 0;
+
+	if(*s == '-')
+	{
+		neg = 1;
+		s++;
+	}
+	while((*s >= '0') && (*s <= '9'))
+	{
+		v = (v * 10) + (*s++ - '0');
+	}
+	return neg ? -v : v;
+}
+
+void exit(int code)
+{
+	int block[2] = {RT_EXIT_APPLICATION, code};
+
+	rt_semihost(RT_SYS_EXIT_EXTENDED, block);
+	for(;;)
+	{
+	}
+}
+
+FILE *fopen(const char *path, const char *mode)
+{
+	int block[3] = {(int)path, (mode[0] == 'r') ? RT_MODE_READ : RT_MODE_WRITE, (int)strlen(path)};
+	int handle = rt_semihost(RT_SYS_OPEN, block);
+
+	if(handle < 0)
+	{
+		return NULL;
+	}
+	for(int i = 0; i < RT_MAX_FILES; i++)
+	{
+		if(rtFiles[i].handle == 0)
+		{
+			rtFiles[i].handle = handle;
+			return &rtFiles[i];
+		}
+	}
+	return NULL;
+}
+
+int fclose(FILE *f)
+{
+	int block[1] = {f->handle};
+
+	rt_semihost(RT_SYS_CLOSE, block);
+	f->handle = 0;
+	return 0;
+}
+
+size_t fread(void *p, size_t size, size_t n, FILE *f)
+{
+	int block[3] = {f->handle, (int)p, (int)(size * n)};
+	int left = rt_semihost(RT_SYS_READ, block);
+
+	return size ? (((size * n) - (size_t)left) / size) : 0;
+}
+
+size_t fwrite(const void *p, size_t size, size_t n, FILE *f)
+{
+	int block[3] = {f->handle, (int)p, (int)(size * n)};
+	int left = rt_semihost(RT_SYS_WRITE, block);
+
+	return size ? (((size * n) - (size_t)left) / size) : 0;
+}
+
+int fgetc(FILE *f)
+{
+	uint8_t c;
+
+	return (fread(&c, 1, 1, f) == 1) ? c : EOF;
+}
+
+int fputc(int c, FILE *f)
+{
+	uint8_t b = (uint8_t)c;
+
+	fwrite(&b, 1, 1, f);
+	return c;
+}
+
+static char *rt_put_number(char *o, char *end, unsigned long long v, int neg)
+{
+	char digits[24];
+	int n = 0;
+
+	do
+	{
+		digits[n++] = (char)('0' + (v % 10));
+		v /= 10;
+	} while(v);
+	if(neg && (o < end))
+	{
+		*o++ = '-';
+	}
+	while(n && (o < end))
+	{
+		*o++ = digits[--n];
+	}
+	return o;
+}
+
+static int rt_format(char *buf, size_t size, const char *fmt, va_list ap)
+{
+	char *o = buf;
+	char *end = buf + size - 1;
+
+	for(; *fmt && (o < end); fmt++)
+	{
+		int longs = 0;
+
+		if(*fmt != '%')
+		{
+			*o++ = *fmt;
+			continue;
+		}
+		fmt++;
+		while(*fmt == 'l')
+		{
+			longs++;
+			fmt++;
+		}
+		switch(*fmt)
+		{
+			case 'd':
+			{
+				long long v = (longs == 2) ? va_arg(ap, long long) : longs ? va_arg(ap, long) : va_arg(ap, int);
+
+				o = rt_put_number(o, end, (v < 0) ? -v : v, v < 0);
+				break;
+			}
+			case 'u':
+			{
+				unsigned long long v = (longs == 2) ? va_arg(ap, unsigned long long) :
+					longs ? va_arg(ap, unsigned long) : va_arg(ap, unsigned);
+
+				o = rt_put_number(o, end, v, 0);
+				break;
+			}
+			case 's':
+			{
+				const char *s = va_arg(ap, const char *);
+
+				while(*s && (o < end))
+				{
+					*o++ = *s++;
+				}
+				break;
+			}
+			case 'c':
+				*o++ = (char)va_arg(ap, int);
+				break;
+			case '%':
+				*o++ = '%';
+				break;
+			default:
+				*o++ = '?';
+				break;
+		}
+	}
+	*o = 0;
+	return (int)(o - buf);
+}
+
+static int rt_vfprintf(FILE *f, const char *fmt, va_list ap)
+{
+	char buf[RT_PRINTF_SIZE];
+	int n = rt_format(buf, sizeof(buf), fmt, ap);
+
+	fwrite(buf, 1, (size_t)n, f);
+	return n;
+}
+
+int printf(const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	int n = rt_vfprintf(stdout, fmt, ap);
+	va_end(ap);
+	return n;
+}
+
+int fprintf(FILE *f, const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	int n = rt_vfprintf(f, fmt, ap);
+	va_end(ap);
+	return n;
+}
+
+void perror(const char *s)
+{
+	fprintf(stderr, "%s: error\n", s);
+}
+
+static rt_uqr_t rt_udivmod(unsigned n, unsigned d)
+{
+	rt_uqr_t res = {0, 0};
+
+	for(int i = 31; i >= 0; i--)
+	{
+		res.r = (res.r << 1) | ((n >> i) & 1);
+		if(res.r >= d)
+		{
+			res.r -= d;
+			res.q |= 1u << i;
+		}
+	}
+	return res;
+}
+
+unsigned __aeabi_uidiv(unsigned n, unsigned d)
+{
+	return rt_udivmod(n, d).q;
+}
+
+int __aeabi_idiv(int n, int d)
+{
+	unsigned q = rt_udivmod((n < 0) ? -(unsigned)n : (unsigned)n, (d < 0) ? -(unsigned)d : (unsigned)d).q;
+
+	return ((n < 0) != (d < 0)) ? -(int)q : (int)q;
+}
+
+// Quotient in r0, remainder in r1
+unsigned long long __aeabi_uidivmod(unsigned n, unsigned d)
+{
+	rt_uqr_t r = rt_udivmod(n, d);
+
+	return ((unsigned long long)r.r << 32) | r.q;
+}
+
+long long __aeabi_lmul(long long a, long long b)
+{
+	uint32_t al = (uint32_t)a;
+	uint32_t ah = (uint32_t)((unsigned long long)a >> 32);
+	uint32_t bl = (uint32_t)b;
+	uint32_t bh = (uint32_t)((unsigned long long)b >> 32);
+	uint32_t a0 = al & 0xFFFF;
+	uint32_t a1 = al >> 16;
+	uint32_t b0 = bl & 0xFFFF;
+	uint32_t b1 = bl >> 16;
+	uint32_t p00 = a0 * b0;
+	uint32_t p01 = a0 * b1;
+	uint32_t p10 = a1 * b0;
+	uint32_t p11 = a1 * b1;
+	uint32_t mid = (p00 >> 16) + (p01 & 0xFFFF) + (p10 & 0xFFFF);
+	rt_u64_t r;
+
+	r.w.lo = (p00 & 0xFFFF) | (mid << 16);
+	r.w.hi = p11 + (p01 >> 16) + (p10 >> 16) + (mid >> 16) + (al * bh) + (ah * bl);
+	return (long long)r.v;
+}
+
+static rt_ulqr_t rt_uldivmod(unsigned long long n, unsigned long long d)
+{
+	rt_ulqr_t res = {0, 0};
+
+	for(int i = 63; i >= 0; i--)
+	{
+		res.r = (res.r << 1) | ((n >> i) & 1);
+		if(res.r >= d)
+		{
+			res.r -= d;
+			res.q |= 1ull << i;
+		}
+	}
+	return res;
+}
+
+void rt_uldivmod_helper(unsigned long long n, unsigned long long d, rt_ulqr_t *out)
+{
+	*out = rt_uldivmod(n, d);
+}
+
+// Quotient in r0:r1, remainder in r2:r3, which C cannot return
+__attribute__((naked)) void __aeabi_uldivmod(void)
+{
+	__asm volatile (
+		"push {r4, lr}\n"
+		"sub sp, #24\n"
+		"add r4, sp, #8\n"
+		"str r4, [sp, #0]\n"
+		"bl rt_uldivmod_helper\n"
+		"ldr r0, [sp, #8]\n"
+		"ldr r1, [sp, #12]\n"
+		"ldr r2, [sp, #16]\n"
+		"ldr r3, [sp, #20]\n"
+		"add sp, #24\n"
+		"pop {r4, pc}\n");
+}
+
+unsigned long long __aeabi_llsl(unsigned long long v, int n)
+{
+	rt_u64_t x;
+
+	x.v = v;
+	if(n >= 32)
+	{
+		x.w.hi = x.w.lo << (n - 32);
+		x.w.lo = 0;
+	}
+	else if(n > 0)
+	{
+		x.w.hi = (x.w.hi << n) | (x.w.lo >> (32 - n));
+		x.w.lo <<= n;
+	}
+	return x.v;
+}
+
+unsigned long long __aeabi_llsr(unsigned long long v, int n)
+{
+	rt_u64_t x;
+
+	x.v = v;
+	if(n >= 32)
+	{
+		x.w.lo = x.w.hi >> (n - 32);
+		x.w.hi = 0;
+	}
+	else if(n > 0)
+	{
+		x.w.lo = (x.w.lo >> n) | (x.w.hi << (32 - n));
+		x.w.hi >>= n;
+	}
+	return x.v;
+}
+
+void __aeabi_memcpy(void *d, const void *s, size_t n)
+{
+	memcpy(d, s, n);
+}
+
+void __aeabi_memcpy4(void *d, const void *s, size_t n)
+{
+	memcpy(d, s, n);
+}
+
+void __aeabi_memcpy8(void *d, const void *s, size_t n)
+{
+	memcpy(d, s, n);
+}
+
+void __aeabi_memmove(void *d, const void *s, size_t n)
+{
+	memmove(d, s, n);
+}
+
+void __aeabi_memmove4(void *d, const void *s, size_t n)
+{
+	memmove(d, s, n);
+}
+
+void __aeabi_memset(void *d, size_t n, int c)
+{
+	memset(d, c, n);
+}
+
+void __aeabi_memset4(void *d, size_t n, int c)
+{
+	memset(d, c, n);
+}
+
+void __aeabi_memclr(void *d, size_t n)
+{
+	memset(d, 0, n);
+}
+
+void __aeabi_memclr4(void *d, size_t n)
+{
+	memset(d, 0, n);
+}
+
+void __aeabi_memclr8(void *d, size_t n)
+{
+	memset(d, 0, n);
+}
+
+double __aeabi_i2d(int a)
+{
+	rt_double_t r;
+	uint32_t m;
+	int clz = 0;
+	uint64_t sign = 0;
+
+	if(a == 0)
+	{
+		r.u = 0;
+		return r.d;
+	}
+	if(a < 0)
+	{
+		sign = 1ULL << 63;
+		m = (uint32_t)(-(int64_t)a);
+	}
+	else
+	{
+		m = (uint32_t)a;
+	}
+	if(!(m >> 16))
+	{
+		m <<= 16;
+		clz += 16;
+	}
+	if(!(m >> 24))
+	{
+		m <<= 8;
+		clz += 8;
+	}
+	if(!(m >> 28))
+	{
+		m <<= 4;
+		clz += 4;
+	}
+	if(!(m >> 30))
+	{
+		m <<= 2;
+		clz += 2;
+	}
+	if(!(m >> 31))
+	{
+		m <<= 1;
+		clz += 1;
+	}
+	r.u = sign | ((uint64_t)(1023 + 31 - clz) << 52) | (((uint64_t)m << 21) & 0xFFFFFFFFFFFFFULL);
+	return r.d;
+}
+
+int __aeabi_d2iz(double a)
+{
+	rt_double_t x;
+
+	x.d = a;
+	int e = (int)((x.u >> 52) & 0x7FF) - 1023;
+	if(e < 0)
+	{
+		return 0;
+	}
+	uint64_t m = (x.u & 0xFFFFFFFFFFFFFULL) | (1ULL << 52);
+	uint32_t v = (e >= 31) ? 0x7FFFFFFFu : (uint32_t)(m >> (52 - e));
+
+	return (x.u >> 63) ? -(int)v : (int)v;
+}
+
+double __aeabi_dmul(double a, double b)
+{
+	rt_double_t x;
+	rt_double_t y;
+	rt_double_t r;
+
+	x.d = a;
+	y.d = b;
+	uint64_t sign = (x.u ^ y.u) & (1ULL << 63);
+	int ea = (int)((x.u >> 52) & 0x7FF);
+	int eb = (int)((y.u >> 52) & 0x7FF);
+	if((ea == 0) || (eb == 0))
+	{
+		r.u = sign;
+		return r.d;
+	}
+	uint64_t ma = (x.u & 0xFFFFFFFFFFFFFULL) | (1ULL << 52);
+	uint64_t mb = (y.u & 0xFFFFFFFFFFFFFULL) | (1ULL << 52);
+	uint32_t al = (uint32_t)ma;
+	uint32_t ah = (uint32_t)(ma >> 32);
+	uint32_t bl = (uint32_t)mb;
+	uint32_t bh = (uint32_t)(mb >> 32);
+	uint64_t ll = (uint64_t)al * bl;
+	uint64_t lh = (uint64_t)al * bh;
+	uint64_t hl = (uint64_t)ah * bl;
+	uint64_t hh = (uint64_t)ah * bh;
+	uint64_t mid = (ll >> 32) + (uint32_t)lh + (uint32_t)hl;
+	uint64_t lo = (mid << 32) | (uint32_t)ll;
+	uint64_t hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+	int e = ea + eb - 1023;
+	int shift = 52;
+
+	if(hi & (1ULL << 41))
+	{
+		shift = 53;
+		e++;
+	}
+	// The 128-bit product hi:lo shifted down, rounded to nearest even
+	uint64_t m = (hi << (64 - shift)) | (lo >> shift);
+	uint64_t rest = lo << (64 - shift);
+	if((rest > (1ULL << 63)) || ((rest == (1ULL << 63)) && (m & 1)))
+	{
+		m++;
+		if(m >> 53)
+		{
+			m >>= 1;
+			e++;
+		}
+	}
+	if(e <= 0)
+	{
+		r.u = sign;
+		return r.d;
+	}
+	r.u = sign | ((uint64_t)e << 52) | (m & 0xFFFFFFFFFFFFFULL);
+	return r.d;
+}
+
+__attribute__((used, noinline)) static void rt_start(void)
+{
+	static char cmdline[RT_CMDLINE_SIZE];
+	static char *argv[RT_MAX_ARGS];
+	int argc = 0;
+	int block[2] = {(int)cmdline, sizeof(cmdline)};
+	int ttOut[3] = {(int)":tt", RT_MODE_TT_WRITE, 3};
+	int ttErr[3] = {(int)":tt", RT_MODE_TT_APPEND, 3};
+
+	// The console as newlib opens it: stdout "w" and stderr "a" on ":tt"
+	rtStdout.handle = rt_semihost(RT_SYS_OPEN, ttOut);
+	rtStderr.handle = rt_semihost(RT_SYS_OPEN, ttErr);
+	if(rt_semihost(RT_SYS_GET_CMDLINE, block) != 0)
+	{
+		cmdline[0] = 0;
+	}
+	for(char *p = cmdline; *p && (argc < (RT_MAX_ARGS - 1));)
+	{
+		while(*p == ' ')
+		{
+			*p++ = 0;
+		}
+		if(!*p)
+		{
+			break;
+		}
+		argv[argc++] = p;
+		while(*p && (*p != ' '))
+		{
+			p++;
+		}
+	}
+	argv[argc] = NULL;
+	exit(main(argc, argv));
+}
+
+// Entry point of the image; m0plus_sim sets the stack pointer
+__attribute__((naked, used)) void _start(void)
+{
+	__asm volatile ("bl rt_start\n");
+}
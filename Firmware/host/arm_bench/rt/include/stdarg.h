@@ -0,0 +1,11 @@
+/* Freestanding <stdarg.h> of the arm_bench runtime (see ../arm_rt.c)                      */
+#ifndef _STDARG_H_
+#define _STDARG_H_
+
+typedef __builtin_va_list va_list;
+
+#define va_start(ap, last)                  __builtin_va_start(ap, last)
+#define va_end(ap)                          __builtin_va_end(ap)
+#define va_arg(ap, type)                    __builtin_va_arg(ap, type)
+
+#endif // _STDARG_H_
@@ -0,0 +1,9 @@
+/* Freestanding <stdbool.h> of the arm_bench runtime (see ../arm_rt.c)                     */
+#ifndef _STDBOOL_H_
+#define _STDBOOL_H_
+
+#define bool                                _Bool
+#define true                                1
+#define false                               0
+
+#endif // _STDBOOL_H_
@@ -0,0 +1,11 @@
+/* Freestanding <stddef.h> of the arm_bench runtime (see ../arm_rt.c)                      */
+#ifndef _STDDEF_H_
+#define _STDDEF_H_
+
+typedef unsigned int size_t;
+typedef int ptrdiff_t;
+
+#define NULL                                ((void *)0)
+#define offsetof(type, member)              __builtin_offsetof(type, member)
+
+#endif // _STDDEF_H_
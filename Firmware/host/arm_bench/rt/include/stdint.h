@@ -0,0 +1,27 @@
+/* Freestanding <stdint.h> of the arm_bench runtime (see ../arm_rt.c)                      */
+#ifndef _STDINT_H_
+#define _STDINT_H_
+
+typedef signed char int8_t;
+typedef unsigned char uint8_t;
+typedef short int16_t;
+typedef unsigned short uint16_t;
+typedef int int32_t;
+typedef unsigned int uint32_t;
+typedef long long int64_t;
+typedef unsigned long long uint64_t;
+typedef int intptr_t;
+typedef unsigned int uintptr_t;
+
+#define INT8_MAX                            127
+#define INT8_MIN                            (-128)
+#define UINT8_MAX                           255
+#define INT16_MAX                           32767
+#define INT16_MIN                           (-32768)
+#define UINT16_MAX                          65535
+#define INT32_MAX                           2147483647
+#define INT32_MIN                           (-2147483647 - 1)
+#define UINT32_MAX                          4294967295u
+#define UINT64_MAX                          18446744073709551615ull
+
+#endif // _STDINT_H_
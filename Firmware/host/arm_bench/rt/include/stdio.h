@@ -0,0 +1,27 @@
+/* <stdio.h> of the arm_bench runtime: files and console through semihosting (../arm_rt.c) */
+#ifndef _STDIO_H_
+#define _STDIO_H_
+
+#include <stddef.h>
+
+typedef struct
+{
+	int handle;
+} FILE;
+
+extern FILE *stdout, *stderr;
+
+#define EOF                                 (-1)
+
+FILE *fopen(const char *path, const char *mode);
+int fclose(FILE *f);
+size_t fread(void *p, size_t size, size_t n, FILE *f);
+size_t fwrite(const void *p, size_t size, size_t n, FILE *f);
+int printf(const char *fmt, ...);
+int fprintf(FILE *f, const char *fmt, ...);
+int snprintf(char *s, size_t n, const char *fmt, ...);
+void perror(const char *s);
+int fgetc(FILE *f);
+int fputc(int c, FILE *f);
+
+#endif // _STDIO_H_
@@ -0,0 +1,13 @@
+/* <stdlib.h> of the arm_bench runtime (see ../arm_rt.c)                                   */
+#ifndef _STDLIB_H_
+#define _STDLIB_H_
+
+#include <stddef.h>
+
+int abs(int x);
+int atoi(const char *s);
+void exit(int code);
+void *malloc(size_t n);
+void free(void *p);
+
+#endif // _STDLIB_H_
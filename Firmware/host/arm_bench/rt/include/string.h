@@ -0,0 +1,14 @@
+/* <string.h> of the arm_bench runtime (see ../arm_rt.c)                                   */
+#ifndef _STRING_H_
+#define _STRING_H_
+
+#include <stddef.h>
+
+void *memcpy(void *d, const void *s, size_t n);
+void *memset(void *d, int c, size_t n);
+void *memmove(void *d, const void *s, size_t n);
+int memcmp(const void *a, const void *b, size_t n);
+size_t strlen(const char *s);
+int strcmp(const char *a, const char *b);
+
+#endif // _STRING_H_
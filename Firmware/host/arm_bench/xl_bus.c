@@ -0,0 +1,349 @@
+/**
+ ****************************************************************************************
+ *
+ * @file xl_bus.c
+ *
+ * @brief Stand-in for the I2C bus and the accelerometer behind it.
+ *
+ * Every command written to the controller goes out on the bus at once, so the transmit
+ * FIFO always has room and a read command puts its byte in the receive FIFO straight
+ * away. A write transfer sets the register address from its first byte and writes the
+ * others, a read transfer reads from the address. Bit 7 of the address
+ * (XL_AUTO_INCREMENT) makes either move on to the next register, as on the LIS3DH.
+ * Writes to read-only registers are dropped, so a transfer longer than intended does
+ * no more harm than on the real part.
+ *
+ * A START or RESTART with SCL or SDA low loses arbitration, and one to a missing
+ * accelerometer is not acknowledged; both abort the transfer. As on the controller,
+ * commands are then dropped until the abort is cleared. Bus time counts the address
+ * byte and the data bytes of every transfer at 9 bits each.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "i2c.h"
+#include "user_xl_driver.h"
+#include "xl_bus.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+#define XL_BUS_NUM_REGISTERS                (0x40)
+
+/* Receive FIFO of the controller; reads beyond it are lost, as on an overrun               */
+#define XL_BUS_RX_FIFO_DEPTH                (4)
+
+/* CTRL_REG1 data rate field, and its 100Hz setting that the sample tick needs             */
+#define XL_BUS_ODR_SHIFT                    (4)
+#define XL_BUS_ODR_100HZ                    (5)
+
+/* Bit time of I2C_XL_SPEED, 400kHz, and bits of a byte with its acknowledge               */
+#define XL_BUS_BIT_NS                       (2500)
+#define XL_BUS_BYTE_BITS                    (9)
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+static uint8_t xlRegisters[XL_BUS_NUM_REGISTERS];
+static uint8_t xlAddress;
+static bool xlAutoIncrement;
+static i2c_controller_t controllerStatus;
+// Between a START and a STOP, and reading rather than writing
+static bool busActive;
+static bool busReading;
+// The next byte written is the register address
+static bool addressNext;
+static uint16_t abortSource;
+static uint8_t rxFifo[XL_BUS_RX_FIFO_DEPTH];
+static uint8_t rxCount;
+static struct xl_bus_stats busStats;
+static unsigned long long busBits;
+static enum xl_bus_fault busFault;
+// SCL pulses left until the accelerometer releases SDA, bytes left until SCL is held
+static uint8_t sdaClocks;
+static bool sclHeld;
+static bool driverSclLow;
+static bool driverSdaLow;
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+static bool xl_bus_writable(uint8_t reg)
+{
+	return ((reg >= XL_CONTROL_REG_0) && (reg <= XL_CONTROL_REG_6)) ||
+		(reg == XL_FIFO_CTRL_REG) || (reg == XL_INT1_CFG) ||
+		((reg >= XL_INT1_THS) && (reg <= XL_INT1_DUR)) || (reg > 0x35);
+}
+
+static void xl_bus_next(void)
+{
+	if(xlAutoIncrement)
+	{
+		xlAddress = (xlAddress + 1) % XL_BUS_NUM_REGISTERS;
+	}
+}
+
+// Bits only: the conversion to time waits for xl_bus_get_stats(), out of the sample tick arm_bench counts
+static void xl_bus_time(uint16_t bytes)
+{
+	busBits += (unsigned long long)bytes * XL_BUS_BYTE_BITS;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief One byte on the bus: false when SCL is held, from then on
+ ****************************************************************************************
+ */
+static bool xl_bus_clock_byte(void)
+{
+	if(sclHeld)
+	{
+		return false;
+	}
+	if(busFault == XL_BUS_FAULT_SCL_HOLD)
+	{
+		if(sdaClocks == 0)
+		{
+			sclHeld = true;
+			busFault = XL_BUS_FAULT_NONE;
+			return false;
+		}
+		sdaClocks--;
+	}
+	xl_bus_time(1);
+	return true;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief START or RESTART and the address byte: false, with the abort set, when the
+ *        transfer goes no further
+ ****************************************************************************************
+ */
+static bool xl_bus_start(bool read)
+{
+	busStats.transfers++;
+	busActive = true;
+	busReading = read;
+	addressNext = !read;
+	if(!xl_bus_clock_byte())
+	{
+		return false;
+	}
+	if(!xl_bus_get_line(true) || !xl_bus_get_line(false))
+	{
+		abortSource = I2C_ARB_LOST;
+	}
+	else if(busFault == XL_BUS_FAULT_NOACK)
+	{
+		abortSource = I2C_7B_ADDR_NOACK;
+	}
+	else
+	{
+		return true;
+	}
+	busStats.aborts++;
+	busActive = false;
+	return false;
+}
+
+void xl_bus_set_sample(const int8_t *sample)
+{
+	xlRegisters[XL_OUT_X_L] = 0;
+	xlRegisters[XL_OUT_X_H] = (uint8_t)sample[XL_AXIS_X];
+	xlRegisters[XL_OUT_Y_L] = 0;
+	xlRegisters[XL_OUT_Y_H] = (uint8_t)sample[XL_AXIS_Y];
+	xlRegisters[XL_OUT_Z_L] = 0;
+	xlRegisters[XL_OUT_Z_H] = (uint8_t)sample[XL_AXIS_Z];
+}
+
+void xl_bus_reset(void)
+{
+	memset(xlRegisters, 0, sizeof(xlRegisters));
+	memset(&busStats, 0, sizeof(busStats));
+	busBits = 0;
+	xlAddress = 0;
+	xlAutoIncrement = false;
+	busActive = false;
+	busReading = false;
+	addressNext = false;
+	abortSource = I2C_ABORT_NONE;
+	rxCount = 0;
+	busFault = XL_BUS_FAULT_NONE;
+	sdaClocks = 0;
+	sclHeld = false;
+	driverSclLow = false;
+	driverSdaLow = false;
+}
+
+void xl_bus_set_fault(enum xl_bus_fault fault, uint8_t clocks)
+{
+	busFault = fault;
+	sdaClocks = clocks;
+}
+
+bool xl_bus_get_line(bool scl)
+{
+	if(scl)
+	{
+		return !driverSclLow && !sclHeld && (busFault != XL_BUS_FAULT_SCL_LOW);
+	}
+	return !driverSdaLow && ((busFault != XL_BUS_FAULT_SDA_LOW) || (sdaClocks == 0));
+}
+
+void xl_bus_drive_line(bool scl, bool low)
+{
+	if(!scl)
+	{
+		driverSdaLow = low;
+		return;
+	}
+	// The pads leave the controller, and the stalled transfer with them
+	sclHeld = false;
+	if(driverSclLow && !low && (busFault == XL_BUS_FAULT_SDA_LOW) && (sdaClocks > 0))
+	{
+		sdaClocks--;
+	}
+	driverSclLow = low;
+}
+
+uint8_t xl_bus_get_register(uint8_t reg)
+{
+	return xlRegisters[reg % XL_BUS_NUM_REGISTERS];
+}
+
+void xl_bus_get_stats(struct xl_bus_stats *stats)
+{
+	*stats = busStats;
+	stats->busTimeUs = (unsigned long)((busBits * XL_BUS_BIT_NS) / 1000);
+}
+
+void i2c_set_controller_status(i2c_controller_t status)
+{
+	if(busFault == XL_BUS_FAULT_CONTROLLER)
+	{
+		return;
+	}
+	controllerStatus = status;
+	// Disabling abandons the transfer and flushes the FIFOs
+	if(status == I2C_CONTROLLER_DISABLE)
+	{
+		busActive = false;
+		sclHeld = false;
+		rxCount = 0;
+	}
+}
+
+i2c_controller_t i2c_get_controller_status(void)
+{
+	return controllerStatus;
+}
+
+void i2c_set_target_address(uint16_t address)
+{
+}
+
+void i2c_write_byte(uint16_t byte)
+{
+	bool read = (byte & I2C_CMD) != 0;
+
+	// Dropped while disabled, after an abort until it is cleared, and while SCL is held
+	if((controllerStatus != I2C_CONTROLLER_ENABLE) || (abortSource != I2C_ABORT_NONE) || sclHeld)
+	{
+		return;
+	}
+	// The controller turns the bus around by itself when the direction changes
+	if((!busActive || ((byte & I2C_RESTART) != 0) || (read != busReading)) && !xl_bus_start(read))
+	{
+		return;
+	}
+	if(!xl_bus_clock_byte())
+	{
+		return;
+	}
+	if(read)
+	{
+		if(xlAddress == XL_OUT_Z_H)
+		{
+			busStats.sampleReads++;
+			if((xlRegisters[XL_CONTROL_REG_1] >> XL_BUS_ODR_SHIFT) < XL_BUS_ODR_100HZ)
+			{
+				busStats.sleepingReads++;
+			}
+		}
+		if(rxCount < XL_BUS_RX_FIFO_DEPTH)
+		{
+			rxFifo[rxCount++] = xlRegisters[xlAddress];
+		}
+		xl_bus_next();
+	}
+	else if(addressNext)
+	{
+		xlAddress = byte & (XL_BUS_NUM_REGISTERS - 1);
+		xlAutoIncrement = (byte & XL_AUTO_INCREMENT) != 0;
+		addressNext = false;
+	}
+	else
+	{
+		if(xl_bus_writable(xlAddress))
+		{
+			xlRegisters[xlAddress] = (uint8_t)(byte & I2C_DAT);
+		}
+		xl_bus_next();
+	}
+	if(byte & I2C_STOP)
+	{
+		busActive = false;
+	}
+}
+
+uint8_t i2c_read_byte(void)
+{
+	uint8_t data = rxFifo[0];
+
+	if(rxCount > 0)
+	{
+		rxCount--;
+		memmove(&rxFifo[0], &rxFifo[1], rxCount);
+	}
+	return data;
+}
+
+uint8_t i2c_is_tx_fifo_not_full(void)
+{
+	return !sclHeld;
+}
+
+uint8_t i2c_is_rx_fifo_not_empty(void)
+{
+	return rxCount > 0;
+}
+
+uint8_t i2c_is_master_busy(void)
+{
+	return busActive;
+}
+
+uint16_t i2c_get_abort_source(void)
+{
+	return abortSource;
+}
+
+void i2c_reset_int_tx_abort(void)
+{
+	abortSource = I2C_ABORT_NONE;
+}
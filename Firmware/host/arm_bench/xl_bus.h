@@ -0,0 +1,128 @@
+/**
+ ****************************************************************************************
+ *
+ * @file xl_bus.h
+ *
+ * @brief Stand-in for the I2C bus and the accelerometer behind it.
+ *
+ * Implements the SDK I2C controller accessors declared in Firmware/host/sdk_stub/i2c.h
+ * over a register file, so user_xl_driver.c runs unchanged and its register traffic
+ * is part of the measured cost. The bus can be given faults to exercise the recovery
+ * of the driver; the tool that provides the GPIO functions hands the I2C pads to
+ * xl_bus_get_line() and xl_bus_drive_line() while the driver uses them as GPIOs.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _XL_BUS_H_
+#define _XL_BUS_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Faults of the bus
+enum xl_bus_fault
+{
+	/// No fault, removes the one set before
+	XL_BUS_FAULT_NONE = 0,
+	/// The accelerometer acknowledges nothing, as when it is missing
+	XL_BUS_FAULT_NOACK,
+	/// The accelerometer holds SDA low, as after a reset in the middle of a read, until
+	/// SCL is clocked a number of times
+	XL_BUS_FAULT_SDA_LOW,
+	/// SCL shorted low
+	XL_BUS_FAULT_SCL_LOW,
+	/// The controller never changes its enable status
+	XL_BUS_FAULT_CONTROLLER,
+	/// Once, a number of bytes into the next transfer, SCL is held low and the transfer
+	/// stalls, until the controller is disabled or the driver takes the pads
+	XL_BUS_FAULT_SCL_HOLD,
+	XL_BUS_NUM_FAULTS
+};
+
+/// Bus traffic since the last xl_bus_reset()
+struct xl_bus_stats
+{
+	/// START and RESTART conditions, one for the write and one for the read of a
+	/// register read
+	unsigned long transfers;
+	/// Reads of the last output register (XL_OUT_Z_H), one for each sample read
+	unsigned long sampleReads;
+	/// Sample reads while CTRL_REG1 selects a data rate below the sample tick
+	unsigned long sleepingReads;
+	/// Transfers that ended with an abort
+	unsigned long aborts;
+	/// Time the transfers took on the bus, in us
+	unsigned long busTimeUs;
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+ /**
+ ****************************************************************************************
+ * @brief Load the output registers with the next sample, as the 8-bit high bytes the
+ *        driver keeps
+ * @param[in] sample XL_NUM_AXES cell array (x,y,z)
+ ****************************************************************************************
+ */
+void xl_bus_set_sample(const int8_t *sample);
+
+ /**
+ ****************************************************************************************
+ * @brief Clear the registers, as at power-up, the statistics and the fault
+ ****************************************************************************************
+ */
+void xl_bus_reset(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Give the bus a fault from now on
+ * @param[in] clocks SCL pulses that release SDA for XL_BUS_FAULT_SDA_LOW, bytes before
+ *                   SCL is held for XL_BUS_FAULT_SCL_HOLD, ignored by the others
+ ****************************************************************************************
+ */
+void xl_bus_set_fault(enum xl_bus_fault fault, uint8_t clocks);
+
+ /**
+ ****************************************************************************************
+ * @brief Level of SCL or SDA: low when the driver or the fault pulls it low
+ ****************************************************************************************
+ */
+bool xl_bus_get_line(bool scl);
+
+ /**
+ ****************************************************************************************
+ * @brief The driver pulls SCL or SDA low through its GPIO, or releases it; SCL
+ *        released after being low is one clock
+ ****************************************************************************************
+ */
+void xl_bus_drive_line(bool scl, bool low);
+
+ /**
+ ****************************************************************************************
+ * @brief Current value of a register
+ ****************************************************************************************
+ */
+uint8_t xl_bus_get_register(uint8_t reg);
+
+ /**
+ ****************************************************************************************
+ * @brief Copy the statistics since the last xl_bus_reset()
+ ****************************************************************************************
+ */
+void xl_bus_get_stats(struct xl_bus_stats *stats);
+
+#endif // _XL_BUS_H_
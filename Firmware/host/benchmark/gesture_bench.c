@@ -0,0 +1,692 @@
+/**
+ ****************************************************************************************
+ *
+ * @file gesture_bench.c
+ *
+ * @brief Score the firmware gesture pipeline against a labelled capture corpus.
+ *
+ * Usage: gesture_bench [-g grace_ms] [-r reads] [-o results.txt] corpus.wcap...
+ *
+ * The pipeline sources in src/ are built for the host and fed every sample of the
+ * corpus (Firmware/host/capture), one per sample tick. With -r it only gets one sample
+ * every `reads` ticks, at the rate and with the windows of a battery level of
+ * user_battery.h. The sample tick, the lockout and the display reset, the SAMPLING,
+ * LOCKED and DISPLAY_HOLD states of user_barebone.c, run on the virtual time
+ * app_easy_timer of Firmware/host/sdk_stub, so their ordering is the device's and
+ * every run is the same. A gap in the samples is treated as the wand waking up again
+ * and restarts the pipeline, as the wake-up does.
+ *
+ * A detection matches a LABEL of the same gesture when it falls between the label
+ * start and grace_ms after its end; each label matches once. Every other detection
+ * is a false positive of its class, and one outside all labels is also a false
+ * trigger of the idle motion. Latency is measured from the label start.
+ *
+ * The results are "key value" lines in a fixed order, so two runs compare with diff.
+ *
+ ****************************************************************************************
+ */
+
+#define _GNU_SOURCE
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "app_easy_timer.h"
+#include "capture_file.h"
+#include "user_gesture.h"
+
+#if defined (__linux__)
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+#define BENCH_SLOTS_PER_SECOND              (1600)
+#define BENCH_DEFAULT_GRACE_MS              (500)
+
+/* Samples missing before the pipeline is restarted as after a wake-up                      */
+#define BENCH_GAP_SAMPLES                   (4)
+
+/* Sample tick period in 10ms timer units, APP_ADV_DATA_UPDATE_TO                           */
+#define BENCH_TICK_TO                       (100 / CFG_GESTURE_SAMPLE_RATE_HZ)
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Ground truth gesture, times in slots since the start of the file
+struct bench_label
+{
+	uint64_t start;
+	uint64_t end;
+	uint8_t code;
+	int matched;
+};
+
+/// Scores of one gesture class
+struct bench_class
+{
+	const char *name;
+	uint8_t code;
+	unsigned long labels;
+	unsigned long truePositives;
+	unsigned long falsePositives;
+	/// Latencies of the true positives, in ms
+	double *latencies;
+	size_t numLatencies;
+};
+
+/// Growable array
+struct bench_vector
+{
+	void *data;
+	size_t count;
+	size_t capacity;
+};
+
+/// File being run by the sample tick
+struct bench_run
+{
+	const int8_t *samples;
+	const uint64_t *times;
+	size_t numSamples;
+	size_t next;
+	unsigned decimation;
+	struct bench_label *labels;
+	size_t numLabels;
+	uint64_t lastTime;
+	double activeSlots;
+	double idleSlots;
+};
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+#define BENCH_CLASS(name, code)             {#name, (code), 0, 0, 0, NULL, 0},
+
+static struct bench_class benchClasses[] =
+{
+	CFG_GESTURE_ALPHABET(BENCH_CLASS)
+};
+
+#define BENCH_NUM_CLASSES                   (sizeof(benchClasses) / sizeof(benchClasses[0]))
+
+static unsigned benchReads = 1;
+static unsigned long benchFiles;
+static unsigned long benchSamples;
+static unsigned long benchRestarts;
+static double benchMinutes;
+static double benchIdleMinutes;
+static unsigned long benchFalseTriggers;
+static unsigned long benchUnknownLabels;
+
+// Detections of the sample being run, filled by the commit callback
+static uint8_t benchCommits[8];
+static unsigned benchNumCommits;
+
+// Timer state of user_barebone.c
+static struct bench_run benchRun;
+static bool gestureLockedOut;
+static bool gestureDisplayReset;
+static timer_hnd benchLockoutTimer;
+static timer_hnd benchDisplayResetTimer;
+static unsigned long benchDisplayResets;
+static struct app_easy_timer_sim_stats benchTimerStats;
+
+// Cost of gesture_pipeline_update()
+static int benchPerfFd = -1;
+static long long benchPerfOverhead;
+static double benchCost;
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+static void *bench_push(struct bench_vector *vector, size_t size)
+{
+	if(vector->count == vector->capacity)
+	{
+		vector->capacity = (vector->capacity == 0) ? 256 : (vector->capacity * 2);
+		if((vector->data = realloc(vector->data, vector->capacity * size)) == NULL)
+		{
+			perror("realloc");
+			exit(1);
+		}
+	}
+	return (uint8_t *)vector->data + (vector->count++ * size);
+}
+
+static struct bench_class *bench_class_find(uint8_t code)
+{
+	for(size_t i=0;i<BENCH_NUM_CLASSES;i++)
+	{
+		if(benchClasses[i].code == code)
+		{
+			return &benchClasses[i];
+		}
+	}
+	return NULL;
+}
+
+static void bench_lockout_timer_cb(void)
+{
+	gestureLockedOut = false;
+}
+
+static void bench_display_reset_timer_cb(void)
+{
+	// The wand goes to sleep here, the corpus carries on
+	gestureDisplayReset = false;
+	benchDisplayResets++;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Record a detection and restart the timers as gesture_commit() does
+ ****************************************************************************************
+ */
+static void bench_commit(uint8_t gestureCode)
+{
+	if(benchNumCommits < sizeof(benchCommits))
+	{
+		benchCommits[benchNumCommits++] = gestureCode;
+	}
+	if(gestureLockedOut)
+	{
+		app_easy_timer_cancel(benchLockoutTimer);
+	}
+	gestureLockedOut = true;
+	benchLockoutTimer = app_easy_timer(CFG_GESTURE_LOCK_TO, bench_lockout_timer_cb);
+	if(gestureDisplayReset)
+	{
+		app_easy_timer_cancel(benchDisplayResetTimer);
+	}
+	benchDisplayResetTimer = app_easy_timer(CFG_GESTURE_RESET_DISPLAY_TO, bench_display_reset_timer_cb);
+	gestureDisplayReset = true;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Open the user-space instruction counter, or leave benchPerfFd at -1 when the
+ *        kernel does not allow it
+ ****************************************************************************************
+ */
+static void bench_perf_init(void)
+{
+#if defined (__linux__)
+	struct perf_event_attr attr;
+	long long count;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.size = sizeof(attr);
+	attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	benchPerfFd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+	if(benchPerfFd < 0)
+	{
+		return;
+	}
+
+	// Instructions counted by an empty enable/disable pair
+	ioctl(benchPerfFd, PERF_EVENT_IOC_RESET, 0);
+	ioctl(benchPerfFd, PERF_EVENT_IOC_ENABLE, 0);
+	ioctl(benchPerfFd, PERF_EVENT_IOC_DISABLE, 0);
+	if(read(benchPerfFd, &count, sizeof(count)) != sizeof(count))
+	{
+		close(benchPerfFd);
+		benchPerfFd = -1;
+		return;
+	}
+	benchPerfOverhead = count;
+#endif
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Run one sample through the pipeline and add its cost, in instructions when
+ *        the counter is available, in ns otherwise
+ ****************************************************************************************
+ */
+static void bench_pipeline_update(const int8_t *sample, bool lockedOut)
+{
+#if defined (__linux__)
+	if(benchPerfFd >= 0)
+	{
+		long long count = 0;
+
+		ioctl(benchPerfFd, PERF_EVENT_IOC_RESET, 0);
+		ioctl(benchPerfFd, PERF_EVENT_IOC_ENABLE, 0);
+		gesture_pipeline_update(sample, lockedOut);
+		ioctl(benchPerfFd, PERF_EVENT_IOC_DISABLE, 0);
+		if(read(benchPerfFd, &count, sizeof(count)) == sizeof(count))
+		{
+			benchCost += (double)(count - benchPerfOverhead);
+		}
+		return;
+	}
+#endif
+	struct timespec before, after;
+
+	clock_gettime(CLOCK_MONOTONIC, &before);
+	gesture_pipeline_update(sample, lockedOut);
+	clock_gettime(CLOCK_MONOTONIC, &after);
+	benchCost += ((after.tv_sec - before.tv_sec) * 1e9) + (after.tv_nsec - before.tv_nsec);
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Score one detection against the labels of the file
+ ****************************************************************************************
+ */
+static void bench_score(uint8_t code, uint64_t time, struct bench_label *labels, size_t numLabels)
+{
+	struct bench_class *class = bench_class_find(code);
+	int insideLabel = 0;
+
+	if(class == NULL)
+	{
+		return;
+	}
+	for(size_t i=0;i<numLabels;i++)
+	{
+		struct bench_label *label = &labels[i];
+
+		if((time < label->start) || (time > label->end))
+		{
+			continue;
+		}
+		insideLabel = 1;
+		if((label->code == code) && !label->matched)
+		{
+			label->matched = 1;
+			class->truePositives++;
+			class->latencies = realloc(class->latencies, (class->numLatencies + 1) * sizeof(double));
+			class->latencies[class->numLatencies++] = (double)(time - label->start) * 1000.0 / BENCH_SLOTS_PER_SECOND;
+			return;
+		}
+	}
+	class->falsePositives++;
+	if(!insideLabel)
+	{
+		benchFalseTriggers++;
+	}
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Sample tick: run the next sample of benchRun and restart the timer, as
+ *        adv_data_update_timer_cb() does
+ ****************************************************************************************
+ */
+static void bench_tick_timer_cb(void)
+{
+	struct bench_run *run = &benchRun;
+	const int8_t *sample = run->samples + (run->next * CAPTURE_NUM_AXES);
+	uint64_t time = run->times[run->next];
+	uint64_t period = (BENCH_SLOTS_PER_SECOND / CFG_GESTURE_SAMPLE_RATE_HZ) * benchReads;
+	int idle = 1;
+
+	if(run->next > 0)
+	{
+		uint64_t delta = time - run->lastTime;
+
+		if(delta > (BENCH_GAP_SAMPLES * period))
+		{
+			gesture_pipeline_reset();
+			if(gestureLockedOut)
+			{
+				app_easy_timer_cancel(benchLockoutTimer);
+				gestureLockedOut = false;
+			}
+			benchRestarts++;
+		}
+		else
+		{
+			for(size_t j=0;j<run->numLabels;j++)
+			{
+				if((time >= run->labels[j].start) && (time <= run->labels[j].end))
+				{
+					idle = 0;
+					break;
+				}
+			}
+			run->activeSlots += (double)delta;
+			if(idle)
+			{
+				run->idleSlots += (double)delta;
+			}
+		}
+	}
+	run->lastTime = time;
+
+	benchNumCommits = 0;
+	bench_pipeline_update(sample, gestureLockedOut);
+	benchSamples++;
+	for(unsigned j=0;j<benchNumCommits;j++)
+	{
+		bench_score(benchCommits[j], time, run->labels, run->numLabels);
+	}
+
+	run->next += run->decimation * benchReads;
+	if(run->next < run->numSamples)
+	{
+		app_easy_timer(BENCH_TICK_TO * benchReads, bench_tick_timer_cb);
+	}
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Run the pipeline over one corpus file
+ ****************************************************************************************
+ */
+static int bench_file(const char *path, uint64_t graceSlots)
+{
+	FILE *file = fopen(path, "rb");
+	struct capture_reader reader;
+	struct capture_record record;
+	struct bench_vector samples = {NULL, 0, 0};
+	struct bench_vector times = {NULL, 0, 0};
+	struct bench_vector labels = {NULL, 0, 0};
+	uint64_t now = 0;
+	uint32_t previous = 0;
+	int first = 1;
+
+	if(file == NULL)
+	{
+		perror(path);
+		return -1;
+	}
+
+	// Load the file, unwrapping the 27-bit timestamps
+	capture_reader_init(&reader, file);
+	while(capture_read(&reader, &record))
+	{
+		if(!first)
+		{
+			now += (record.timestamp - previous) & CAPTURE_TIMESTAMP_MASK;
+		}
+		first = 0;
+		previous = record.timestamp;
+
+		if(record.type == CAPTURE_RECORD_SAMPLE)
+		{
+			memcpy(bench_push(&samples, CAPTURE_NUM_AXES), record.axis, CAPTURE_NUM_AXES);
+			*(uint64_t *)bench_push(&times, sizeof(uint64_t)) = now;
+		}
+		else if(record.type == CAPTURE_RECORD_LABEL)
+		{
+			struct bench_label *label = bench_push(&labels, sizeof(struct bench_label));
+			struct bench_class *class = bench_class_find(record.code);
+
+			label->start = now;
+			label->end = now + record.length + graceSlots;
+			label->code = record.code;
+			label->matched = 0;
+			if(class != NULL)
+			{
+				class->labels++;
+			}
+			else
+			{
+				benchUnknownLabels++;
+			}
+		}
+	}
+	fclose(file);
+
+	// Faster captures (CFG_STREAM) are decimated to the rate of the sample tick
+	if((reader.sampleRateHz < CFG_GESTURE_SAMPLE_RATE_HZ) || ((reader.sampleRateHz % CFG_GESTURE_SAMPLE_RATE_HZ) != 0))
+	{
+		fprintf(stderr, "%s: sample rate %u Hz is not a multiple of %u Hz\n", path, reader.sampleRateHz, CFG_GESTURE_SAMPLE_RATE_HZ);
+		return -1;
+	}
+
+	// Tick until the last sample, then let the pending timers run out
+	struct app_easy_timer_sim_stats stats;
+	struct bench_run *run = &benchRun;
+
+	memset(run, 0, sizeof(struct bench_run));
+	run->samples = samples.data;
+	run->times = times.data;
+	run->numSamples = samples.count;
+	run->decimation = reader.sampleRateHz / CFG_GESTURE_SAMPLE_RATE_HZ;
+	run->labels = labels.data;
+	run->numLabels = labels.count;
+
+	app_easy_timer_sim_reset();
+	gestureLockedOut = false;
+	gestureDisplayReset = false;
+	gesture_pipeline_init(bench_commit);
+	gesture_pipeline_set_rate((uint8_t)benchReads);
+	if(run->numSamples > 0)
+	{
+		app_easy_timer(BENCH_TICK_TO, bench_tick_timer_cb);
+	}
+	while(app_easy_timer_sim_step());
+
+	app_easy_timer_sim_get_stats(&stats);
+	benchTimerStats.fired += stats.fired;
+	benchTimerStats.cancelled += stats.cancelled;
+	benchTimerStats.droppedExpiries += stats.droppedExpiries;
+	benchTimerStats.poolExhausted += stats.poolExhausted;
+	benchTimerStats.badDelays += stats.badDelays;
+	benchTimerStats.staleCancels += stats.staleCancels;
+	benchTimerStats.staleModifies += stats.staleModifies;
+	if(stats.maxInUse > benchTimerStats.maxInUse)
+	{
+		benchTimerStats.maxInUse = stats.maxInUse;
+	}
+	benchMinutes += run->activeSlots / BENCH_SLOTS_PER_SECOND / 60.0;
+	benchIdleMinutes += run->idleSlots / BENCH_SLOTS_PER_SECOND / 60.0;
+	benchFiles++;
+	free(samples.data);
+	free(times.data);
+	free(labels.data);
+	return 0;
+}
+
+static int bench_compare(const void *a, const void *b)
+{
+	double x = *(const double *)a;
+	double y = *(const double *)b;
+
+	return (x > y) - (x < y);
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Nearest-rank percentile of a sorted array
+ ****************************************************************************************
+ */
+static double bench_percentile(const double *sorted, size_t count, unsigned percent)
+{
+	size_t rank = ((count * percent) + 99) / 100;
+
+	return sorted[(rank > 0) ? (rank - 1) : 0];
+}
+
+static void bench_print_ratio(FILE *out, const char *key, unsigned long num, unsigned long den)
+{
+	if(den == 0)
+	{
+		fprintf(out, "%s -\n", key);
+	}
+	else
+	{
+		fprintf(out, "%s %.3f\n", key, (double)num / den);
+	}
+}
+
+static void bench_print_latency(FILE *out, const char *name, double *latencies, size_t count)
+{
+	static const unsigned percents[] = {50, 90, 99};
+
+	qsort(latencies, count, sizeof(double), bench_compare);
+	for(size_t i=0;i<sizeof(percents)/sizeof(percents[0]);i++)
+	{
+		if(count == 0)
+		{
+			fprintf(out, "latency.%s.p%u_ms -\n", name, percents[i]);
+		}
+		else
+		{
+			fprintf(out, "latency.%s.p%u_ms %.0f\n", name, percents[i], bench_percentile(latencies, count, percents[i]));
+		}
+	}
+}
+
+static void bench_report(FILE *out)
+{
+	unsigned long totalTp = 0, totalFp = 0, totalLabels = 0;
+	size_t numLatencies = 0;
+	double *all;
+
+	fprintf(out, "corpus.files %lu\n", benchFiles);
+	fprintf(out, "corpus.samples %lu\n", benchSamples);
+	fprintf(out, "corpus.reads %u\n", benchReads);
+	fprintf(out, "corpus.minutes %.2f\n", benchMinutes);
+	fprintf(out, "corpus.restarts %lu\n", benchRestarts);
+	fprintf(out, "corpus.unknown_labels %lu\n", benchUnknownLabels);
+	fprintf(out, "corpus.display_resets %lu\n", benchDisplayResets);
+	fprintf(out, "timer.fired %lu\n", benchTimerStats.fired);
+	fprintf(out, "timer.cancelled %lu\n", benchTimerStats.cancelled);
+	fprintf(out, "timer.dropped_expiries %lu\n", benchTimerStats.droppedExpiries);
+	fprintf(out, "timer.max_in_use %u\n", benchTimerStats.maxInUse);
+	fprintf(out, "timer.pool_exhausted %lu\n", benchTimerStats.poolExhausted);
+	fprintf(out, "timer.asserts %lu\n", benchTimerStats.badDelays + benchTimerStats.staleCancels + benchTimerStats.staleModifies);
+
+	for(size_t i=0;i<BENCH_NUM_CLASSES;i++)
+	{
+		const struct bench_class *class = &benchClasses[i];
+		char key[64];
+
+		fprintf(out, "class.%s.labels %lu\n", class->name, class->labels);
+		fprintf(out, "class.%s.tp %lu\n", class->name, class->truePositives);
+		fprintf(out, "class.%s.fp %lu\n", class->name, class->falsePositives);
+		fprintf(out, "class.%s.fn %lu\n", class->name, class->labels - class->truePositives);
+		snprintf(key, sizeof(key), "class.%s.precision", class->name);
+		bench_print_ratio(out, key, class->truePositives, class->truePositives + class->falsePositives);
+		snprintf(key, sizeof(key), "class.%s.recall", class->name);
+		bench_print_ratio(out, key, class->truePositives, class->labels);
+		totalTp += class->truePositives;
+		totalFp += class->falsePositives;
+		totalLabels += class->labels;
+		numLatencies += class->numLatencies;
+	}
+	bench_print_ratio(out, "all.precision", totalTp, totalTp + totalFp);
+	bench_print_ratio(out, "all.recall", totalTp, totalLabels);
+
+	fprintf(out, "idle.minutes %.2f\n", benchIdleMinutes);
+	fprintf(out, "idle.false_triggers %lu\n", benchFalseTriggers);
+	if(benchIdleMinutes > 0)
+	{
+		fprintf(out, "idle.false_triggers_per_minute %.3f\n", benchFalseTriggers / benchIdleMinutes);
+	}
+	else
+	{
+		fprintf(out, "idle.false_triggers_per_minute -\n");
+	}
+
+	all = malloc((numLatencies + 1) * sizeof(double));
+	numLatencies = 0;
+	for(size_t i=0;i<BENCH_NUM_CLASSES;i++)
+	{
+		memcpy(&all[numLatencies], benchClasses[i].latencies, benchClasses[i].numLatencies * sizeof(double));
+		numLatencies += benchClasses[i].numLatencies;
+	}
+	bench_print_latency(out, "all", all, numLatencies);
+	for(size_t i=0;i<BENCH_NUM_CLASSES;i++)
+	{
+		bench_print_latency(out, benchClasses[i].name, benchClasses[i].latencies, benchClasses[i].numLatencies);
+	}
+	free(all);
+
+	// Host figures, only comparable between runs on the same machine
+	if(benchSamples == 0)
+	{
+		fprintf(out, "cost.none -\n");
+	}
+	else if(benchPerfFd >= 0)
+	{
+		fprintf(out, "cost.host_instructions_per_sample %.0f\n", benchCost / benchSamples);
+	}
+	else
+	{
+		fprintf(out, "cost.host_ns_per_sample %.0f\n", benchCost / benchSamples);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	uint64_t graceSlots = (BENCH_DEFAULT_GRACE_MS * BENCH_SLOTS_PER_SECOND) / 1000;
+	const char *outPath = NULL;
+	FILE *out = stdout;
+	int arg = 1;
+
+	while((arg + 1 < argc) && (argv[arg][0] == '-'))
+	{
+		if(strcmp(argv[arg], "-g") == 0)
+		{
+			graceSlots = ((uint64_t)atoi(argv[arg + 1]) * BENCH_SLOTS_PER_SECOND) / 1000;
+		}
+		else if(strcmp(argv[arg], "-r") == 0)
+		{
+			benchReads = (unsigned)atoi(argv[arg + 1]);
+		}
+		else if(strcmp(argv[arg], "-o") == 0)
+		{
+			outPath = argv[arg + 1];
+		}
+		else
+		{
+			break;
+		}
+		arg += 2;
+	}
+	if((arg >= argc) || (argv[arg][0] == '-') || (benchReads == 0) ||
+		(benchReads > (1 << CFG_GESTURE_MAX_RATE_SHIFT)) || (benchReads & (benchReads - 1)))
+	{
+		fprintf(stderr, "usage: %s [-g grace_ms] [-r reads] [-o results.txt] corpus.wcap...\n", argv[0]);
+		return 2;
+	}
+
+	bench_perf_init();
+	for(;arg<argc;arg++)
+	{
+		if(bench_file(argv[arg], graceSlots) != 0)
+		{
+			return 1;
+		}
+	}
+
+	if((outPath != NULL) && ((out = fopen(outPath, "w")) == NULL))
+	{
+		perror(outPath);
+		return 1;
+	}
+	bench_report(out);
+	if(out != stdout)
+	{
+		fclose(out);
+	}
+	return 0;
+}
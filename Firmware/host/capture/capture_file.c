@@ -0,0 +1,313 @@
+/**
+ ****************************************************************************************
+ *
+ * @file capture_file.c
+ *
+ * @brief Read and write accelerometer captures (see src/user_capture_format.h).
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <string.h>
+#include "capture_file.h"
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+ /**
+ ****************************************************************************************
+ * @brief Next input byte, -1 at the end of the input
+ ****************************************************************************************
+ */
+static int capture_getc(struct capture_reader *reader)
+{
+	if(reader->pendingPos < reader->pendingLen)
+	{
+		return reader->pending[reader->pendingPos++];
+	}
+	return fgetc(reader->file);
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Read the next valid chunk into the reader
+ * @return 1 when a chunk was read, 0 at the end of the input
+ ****************************************************************************************
+ */
+static int capture_next_chunk(struct capture_reader *reader)
+{
+	int c = capture_getc(reader);
+
+	while(c >= 0)
+	{
+		int type, length, sum;
+		uint8_t checksum;
+
+		if(c != CAPTURE_SYNC_0)
+		{
+			reader->skippedBytes++;
+			c = capture_getc(reader);
+			continue;
+		}
+		if((c = capture_getc(reader)) != CAPTURE_SYNC_1)
+		{
+			// c may be the start of the real sync, look at it again
+			reader->skippedBytes++;
+			continue;
+		}
+		if(((type = capture_getc(reader)) < 0) || ((length = capture_getc(reader)) < 0))
+		{
+			break;
+		}
+		for(int i=0;i<length;i++)
+		{
+			if((c = capture_getc(reader)) < 0)
+			{
+				return 0;
+			}
+			reader->payload[i] = (uint8_t)c;
+		}
+		if((sum = capture_getc(reader)) < 0)
+		{
+			break;
+		}
+		checksum = (uint8_t)(type + length);
+		for(int i=0;i<length;i++)
+		{
+			checksum += reader->payload[i];
+		}
+		if(checksum != (uint8_t)sum)
+		{
+			reader->badChunks++;
+			c = capture_getc(reader);
+			continue;
+		}
+
+		reader->type = (uint8_t)type;
+		reader->length = (uint8_t)length;
+		reader->pos = 0;
+		reader->prevTimestamp = 0;
+		memset(reader->prevSample, 0, sizeof(reader->prevSample));
+		if(reader->type == CAPTURE_CHUNK_SAMPLES)
+		{
+			reader->dropped = (length > 0) ? reader->payload[reader->pos++] : 0;
+		}
+		reader->chunks++;
+		return 1;
+	}
+	return 0;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Decode a varint from the chunk
+ * @return 1 on success, 0 when the chunk ends inside the number
+ ****************************************************************************************
+ */
+static int capture_get_varint(struct capture_reader *reader, uint32_t *value)
+{
+	uint32_t result = 0;
+
+	for(int shift=0;shift<32;shift+=7)
+	{
+		uint8_t byte;
+
+		if(reader->pos >= reader->length)
+		{
+			return 0;
+		}
+		byte = reader->payload[reader->pos++];
+		result |= (uint32_t)(byte & 0x7F) << shift;
+		if((byte & 0x80) == 0)
+		{
+			*value = result;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+void capture_reader_init(struct capture_reader *reader, FILE *file)
+{
+	memset(reader, 0, sizeof(*reader));
+	reader->file = file;
+	reader->sampleRateHz = CAPTURE_DEFAULT_SAMPLE_RATE_HZ;
+
+	reader->pendingLen = (uint8_t)fread(reader->pending, 1, CAPTURE_FILE_HEADER_SIZE, file);
+	if((reader->pendingLen == CAPTURE_FILE_HEADER_SIZE) &&
+		(memcmp(reader->pending, CAPTURE_FILE_MAGIC, 4) == 0))
+	{
+		if(reader->pending[4] != CAPTURE_FILE_VERSION)
+		{
+			fprintf(stderr, "capture format version %u, expected %u\n", reader->pending[4], CAPTURE_FILE_VERSION);
+		}
+		reader->sampleRateHz = (uint16_t)(reader->pending[5] | (reader->pending[6] << 8));
+		reader->pendingPos = reader->pendingLen;
+	}
+}
+
+int capture_read(struct capture_reader *reader, struct capture_record *record)
+{
+	for(;;)
+	{
+		uint32_t delta;
+		uint32_t axis[CAPTURE_NUM_AXES];
+
+		if((reader->pos >= reader->length) || (reader->type == 0))
+		{
+			reader->type = 0;
+			if(!capture_next_chunk(reader))
+			{
+				return 0;
+			}
+			continue;
+		}
+
+		memset(record, 0, sizeof(*record));
+		record->type = (enum capture_record_type)reader->type;
+		switch(reader->type)
+		{
+			case CAPTURE_CHUNK_SAMPLES:
+				if(!capture_get_varint(reader, &delta) || !capture_get_varint(reader, &axis[0]) ||
+					!capture_get_varint(reader, &axis[1]) || !capture_get_varint(reader, &axis[2]))
+				{
+					reader->badChunks++;
+					reader->type = 0;
+					continue;
+				}
+				record->timestamp = (reader->prevTimestamp + delta) & CAPTURE_TIMESTAMP_MASK;
+				for(int i=0;i<CAPTURE_NUM_AXES;i++)
+				{
+					record->axis[i] = (int8_t)(reader->prevSample[i] + CAPTURE_UNZIGZAG(axis[i]));
+					reader->prevSample[i] = record->axis[i];
+				}
+				reader->prevTimestamp = record->timestamp;
+				record->dropped = reader->dropped;
+				reader->dropped = 0;
+				return 1;
+
+			case CAPTURE_CHUNK_GESTURE:
+				if(!capture_get_varint(reader, &record->timestamp) || (reader->pos >= reader->length))
+				{
+					break;
+				}
+				record->code = reader->payload[reader->pos++];
+				return 1;
+
+			case CAPTURE_CHUNK_LABEL:
+				if(!capture_get_varint(reader, &record->timestamp) || !capture_get_varint(reader, &record->length) ||
+					(reader->pos >= reader->length))
+				{
+					break;
+				}
+				record->code = reader->payload[reader->pos++];
+				return 1;
+
+			default:
+				// Chunk type from a newer format, skip it
+				reader->type = 0;
+				continue;
+		}
+		reader->badChunks++;
+		reader->type = 0;
+	}
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Append an unsigned varint to the open chunk
+ ****************************************************************************************
+ */
+static void capture_put_varint(struct capture_writer *writer, uint32_t value)
+{
+	while(value >= 0x80)
+	{
+		writer->payload[writer->length++] = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+	writer->payload[writer->length++] = (uint8_t)value;
+}
+
+void capture_writer_init(struct capture_writer *writer, FILE *file, uint16_t sampleRateHz)
+{
+	uint8_t header[CAPTURE_FILE_HEADER_SIZE] = {0};
+
+	memset(writer, 0, sizeof(*writer));
+	writer->file = file;
+	memcpy(header, CAPTURE_FILE_MAGIC, 4);
+	header[4] = CAPTURE_FILE_VERSION;
+	header[5] = (uint8_t)sampleRateHz;
+	header[6] = (uint8_t)(sampleRateHz >> 8);
+	fwrite(header, 1, sizeof(header), file);
+}
+
+void capture_writer_flush(struct capture_writer *writer)
+{
+	uint8_t header[CAPTURE_CHUNK_HEADER_SIZE];
+	uint8_t checksum;
+
+	if(writer->type == 0)
+	{
+		return;
+	}
+	header[0] = CAPTURE_SYNC_0;
+	header[1] = CAPTURE_SYNC_1;
+	header[2] = writer->type;
+	header[3] = writer->length;
+	checksum = (uint8_t)(writer->type + writer->length);
+	for(int i=0;i<writer->length;i++)
+	{
+		checksum += writer->payload[i];
+	}
+	fwrite(header, 1, sizeof(header), writer->file);
+	fwrite(writer->payload, 1, writer->length, writer->file);
+	fputc(checksum, writer->file);
+	writer->type = 0;
+	writer->length = 0;
+}
+
+void capture_write(struct capture_writer *writer, const struct capture_record *record)
+{
+	uint32_t timestamp = record->timestamp & CAPTURE_TIMESTAMP_MASK;
+
+	if(record->type != CAPTURE_RECORD_SAMPLE)
+	{
+		capture_writer_flush(writer);
+		writer->type = (uint8_t)record->type;
+		capture_put_varint(writer, timestamp);
+		if(record->type == CAPTURE_RECORD_LABEL)
+		{
+			capture_put_varint(writer, record->length);
+		}
+		writer->payload[writer->length++] = record->code;
+		capture_writer_flush(writer);
+		return;
+	}
+
+	// A drop count can only sit at the start of a chunk
+	if((writer->type != CAPTURE_CHUNK_SAMPLES) || (record->dropped != 0) ||
+		((writer->length + CAPTURE_SAMPLE_MAX_SIZE) > CAPTURE_CHUNK_MAX_PAYLOAD))
+	{
+		capture_writer_flush(writer);
+		writer->type = CAPTURE_CHUNK_SAMPLES;
+		writer->payload[writer->length++] = record->dropped;
+		writer->prevTimestamp = 0;
+		memset(writer->prevSample, 0, sizeof(writer->prevSample));
+	}
+	capture_put_varint(writer, (timestamp - writer->prevTimestamp) & CAPTURE_TIMESTAMP_MASK);
+	for(int i=0;i<CAPTURE_NUM_AXES;i++)
+	{
+		int16_t delta = (int16_t)record->axis[i] - writer->prevSample[i];
+
+		capture_put_varint(writer, CAPTURE_ZIGZAG(delta));
+		writer->prevSample[i] = record->axis[i];
+	}
+	writer->prevTimestamp = timestamp;
+}
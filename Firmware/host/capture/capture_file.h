@@ -0,0 +1,150 @@
+/**
+ ****************************************************************************************
+ *
+ * @file capture_file.h
+ *
+ * @brief Read and write accelerometer captures (see src/user_capture_format.h).
+ *
+ * The reader accepts a corpus file or a raw UART2 log: the file header is optional,
+ * bytes outside valid chunks (event trace frames, console text, line noise) are
+ * skipped and counted.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _CAPTURE_FILE_H_
+#define _CAPTURE_FILE_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include "user_capture_format.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+#define CAPTURE_NUM_AXES                    (3)
+
+/* Sample rate assumed for a raw UART2 log, which has no header                             */
+#define CAPTURE_DEFAULT_SAMPLE_RATE_HZ      (100)
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Kind of a decoded record, one per chunk type
+enum capture_record_type
+{
+	CAPTURE_RECORD_SAMPLE = CAPTURE_CHUNK_SAMPLES,
+	CAPTURE_RECORD_GESTURE = CAPTURE_CHUNK_GESTURE,
+	CAPTURE_RECORD_LABEL = CAPTURE_CHUNK_LABEL
+};
+
+/// One decoded record. Timestamps are in CAPTURE_TICK_NS ticks
+struct capture_record
+{
+	enum capture_record_type type;
+	uint32_t timestamp;
+	/// SAMPLE: the axes
+	int8_t axis[CAPTURE_NUM_AXES];
+	/// SAMPLE: samples the firmware dropped just before this one
+	uint8_t dropped;
+	/// GESTURE, LABEL: the gesture code
+	uint8_t code;
+	/// LABEL: length of the labelled motion
+	uint32_t length;
+};
+
+/// Reader state
+struct capture_reader
+{
+	FILE *file;
+	uint16_t sampleRateHz;
+	/// Chunk being decoded
+	uint8_t type;
+	uint8_t length;
+	uint8_t pos;
+	uint8_t payload[CAPTURE_CHUNK_MAX_PAYLOAD];
+	uint8_t dropped;
+	uint32_t prevTimestamp;
+	int8_t prevSample[CAPTURE_NUM_AXES];
+	/// Bytes read back after a failed header check
+	uint8_t pending[CAPTURE_FILE_HEADER_SIZE];
+	uint8_t pendingLen;
+	uint8_t pendingPos;
+	/// Statistics
+	unsigned long chunks;
+	unsigned long badChunks;
+	unsigned long skippedBytes;
+};
+
+/// Writer state
+struct capture_writer
+{
+	FILE *file;
+	uint8_t type;
+	uint8_t length;
+	uint8_t payload[CAPTURE_CHUNK_MAX_PAYLOAD];
+	uint32_t prevTimestamp;
+	int8_t prevSample[CAPTURE_NUM_AXES];
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+ /**
+ ****************************************************************************************
+ * @brief Start reading a capture. Reads the file header when there is one.
+ * @param[out] reader  reader state
+ * @param[in] file     stream opened in binary mode
+ ****************************************************************************************
+ */
+void capture_reader_init(struct capture_reader *reader, FILE *file);
+
+ /**
+ ****************************************************************************************
+ * @brief Read the next record
+ * @param[in] reader   reader state
+ * @param[out] record  the record
+ * @return 1 when a record was read, 0 at the end of the input
+ ****************************************************************************************
+ */
+int capture_read(struct capture_reader *reader, struct capture_record *record);
+
+ /**
+ ****************************************************************************************
+ * @brief Start a corpus file and write its header
+ * @param[out] writer      writer state
+ * @param[in] file         stream opened in binary mode
+ * @param[in] sampleRateHz sample rate recorded in the header
+ ****************************************************************************************
+ */
+void capture_writer_init(struct capture_writer *writer, FILE *file, uint16_t sampleRateHz);
+
+ /**
+ ****************************************************************************************
+ * @brief Write one record. Samples are packed into chunks, gestures and labels get a
+ *        chunk of their own.
+ * @param[in] writer  writer state
+ * @param[in] record  the record
+ ****************************************************************************************
+ */
+void capture_write(struct capture_writer *writer, const struct capture_record *record);
+
+ /**
+ ****************************************************************************************
+ * @brief Write the open chunk. Call before closing the file.
+ * @param[in] writer  writer state
+ ****************************************************************************************
+ */
+void capture_writer_flush(struct capture_writer *writer);
+
+#endif // _CAPTURE_FILE_H_
@@ -0,0 +1,262 @@
+/**
+ ****************************************************************************************
+ *
+ * @file capture_tool.c
+ *
+ * @brief Build and inspect accelerometer capture corpus files.
+ *
+ * Usage:
+ *   capture_tool import <uart2.bin> <out.wcap> [sample_rate_hz]
+ *       Keep the capture chunks of a raw UART2 log (CFG_CAPTURE) and write a corpus file.
+ *   capture_tool csv <in.wcap>
+ *       Print every record as CSV on stdout.
+ *   capture_tool fromcsv <in.csv> <out.wcap> [sample_rate_hz]
+ *       Build a corpus file from CSV in the format printed by csv.
+ *   capture_tool label <in.wcap> <labels.txt> <out.wcap>
+ *       Add ground truth labels. labels.txt holds one "start length code" line per
+ *       gesture, timestamps in ticks, code as a character, sorted by start.
+ *
+ * CSV lines: "sample,timestamp,x,y,z,dropped", "gesture,timestamp,code" and
+ * "label,timestamp,length,code", timestamps in CAPTURE_TICK_NS ticks.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "capture_file.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+#define CAPTURE_LINE_LEN                    (256)
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+static FILE *capture_open(const char *path, const char *mode)
+{
+	FILE *file = fopen(path, mode);
+
+	if(file == NULL)
+	{
+		perror(path);
+		exit(1);
+	}
+	return file;
+}
+
+static void capture_print_stats(const struct capture_reader *reader, unsigned long records)
+{
+	fprintf(stderr, "%lu records in %lu chunks, %lu bad chunks, %lu bytes skipped\n",
+		records, reader->chunks, reader->badChunks, reader->skippedBytes);
+}
+
+static int capture_import(const char *inPath, const char *outPath, uint16_t sampleRateHz)
+{
+	FILE *in = capture_open(inPath, "rb");
+	FILE *out = capture_open(outPath, "wb");
+	struct capture_reader reader;
+	struct capture_writer writer;
+	struct capture_record record;
+	unsigned long records = 0;
+
+	capture_reader_init(&reader, in);
+	capture_writer_init(&writer, out, sampleRateHz);
+	while(capture_read(&reader, &record))
+	{
+		capture_write(&writer, &record);
+		records++;
+	}
+	capture_writer_flush(&writer);
+	capture_print_stats(&reader, records);
+	fclose(in);
+	fclose(out);
+	return 0;
+}
+
+static int capture_csv(const char *inPath)
+{
+	FILE *in = capture_open(inPath, "rb");
+	struct capture_reader reader;
+	struct capture_record record;
+	unsigned long records = 0;
+
+	capture_reader_init(&reader, in);
+	while(capture_read(&reader, &record))
+	{
+		switch(record.type)
+		{
+			case CAPTURE_RECORD_SAMPLE:
+				printf("sample,%lu,%d,%d,%d,%u\n", (unsigned long)record.timestamp,
+					record.axis[0], record.axis[1], record.axis[2], record.dropped);
+				break;
+			case CAPTURE_RECORD_GESTURE:
+				printf("gesture,%lu,%c\n", (unsigned long)record.timestamp, record.code);
+				break;
+			case CAPTURE_RECORD_LABEL:
+				printf("label,%lu,%lu,%c\n", (unsigned long)record.timestamp, (unsigned long)record.length, record.code);
+				break;
+		}
+		records++;
+	}
+	fprintf(stderr, "sample rate %u Hz, ", reader.sampleRateHz);
+	capture_print_stats(&reader, records);
+	fclose(in);
+	return 0;
+}
+
+static int capture_fromcsv(const char *inPath, const char *outPath, uint16_t sampleRateHz)
+{
+	FILE *in = capture_open(inPath, "r");
+	FILE *out = capture_open(outPath, "wb");
+	struct capture_writer writer;
+	char line[CAPTURE_LINE_LEN];
+	unsigned long lineNumber = 0;
+
+	capture_writer_init(&writer, out, sampleRateHz);
+	while(fgets(line, sizeof(line), in) != NULL)
+	{
+		struct capture_record record;
+		unsigned long timestamp, length;
+		int x, y, z;
+		unsigned dropped;
+		char code;
+
+		lineNumber++;
+		memset(&record, 0, sizeof(record));
+		if(sscanf(line, "sample,%lu,%d,%d,%d,%u", &timestamp, &x, &y, &z, &dropped) == 5)
+		{
+			record.type = CAPTURE_RECORD_SAMPLE;
+			record.axis[0] = (int8_t)x;
+			record.axis[1] = (int8_t)y;
+			record.axis[2] = (int8_t)z;
+			record.dropped = (uint8_t)dropped;
+		}
+		else if(sscanf(line, "gesture,%lu,%c", &timestamp, &code) == 2)
+		{
+			record.type = CAPTURE_RECORD_GESTURE;
+			record.code = (uint8_t)code;
+		}
+		else if(sscanf(line, "label,%lu,%lu,%c", &timestamp, &length, &code) == 3)
+		{
+			record.type = CAPTURE_RECORD_LABEL;
+			record.length = (uint32_t)length;
+			record.code = (uint8_t)code;
+		}
+		else
+		{
+			fprintf(stderr, "%s:%lu: not a capture record\n", inPath, lineNumber);
+			continue;
+		}
+		record.timestamp = (uint32_t)timestamp;
+		capture_write(&writer, &record);
+	}
+	capture_writer_flush(&writer);
+	fclose(in);
+	fclose(out);
+	return 0;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Read the next label line
+ * @return 1 when a label was read, 0 at the end of the file
+ ****************************************************************************************
+ */
+static int capture_next_label(FILE *labels, struct capture_record *label)
+{
+	char line[CAPTURE_LINE_LEN];
+
+	while(fgets(line, sizeof(line), labels) != NULL)
+	{
+		unsigned long start, length;
+		char code;
+
+		if((line[0] == '#') || (sscanf(line, "%lu %lu %c", &start, &length, &code) != 3))
+		{
+			continue;
+		}
+		memset(label, 0, sizeof(*label));
+		label->type = CAPTURE_RECORD_LABEL;
+		label->timestamp = (uint32_t)start;
+		label->length = (uint32_t)length;
+		label->code = (uint8_t)code;
+		return 1;
+	}
+	return 0;
+}
+
+static int capture_label(const char *inPath, const char *labelPath, const char *outPath)
+{
+	FILE *in = capture_open(inPath, "rb");
+	FILE *labels = capture_open(labelPath, "r");
+	FILE *out;
+	struct capture_reader reader;
+	struct capture_writer writer;
+	struct capture_record record, label;
+	int haveLabel;
+	unsigned long records = 0;
+
+	capture_reader_init(&reader, in);
+	out = capture_open(outPath, "wb");
+	capture_writer_init(&writer, out, reader.sampleRateHz);
+	haveLabel = capture_next_label(labels, &label);
+	while(capture_read(&reader, &record))
+	{
+		// Labels go in front of the first record at or after their start
+		while(haveLabel && (label.timestamp <= record.timestamp))
+		{
+			capture_write(&writer, &label);
+			haveLabel = capture_next_label(labels, &label);
+		}
+		capture_write(&writer, &record);
+		records++;
+	}
+	while(haveLabel)
+	{
+		capture_write(&writer, &label);
+		haveLabel = capture_next_label(labels, &label);
+	}
+	capture_writer_flush(&writer);
+	capture_print_stats(&reader, records);
+	fclose(in);
+	fclose(labels);
+	fclose(out);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	if((argc >= 4) && (strcmp(argv[1], "import") == 0))
+	{
+		return capture_import(argv[2], argv[3], (uint16_t)((argc > 4) ? atoi(argv[4]) : CAPTURE_DEFAULT_SAMPLE_RATE_HZ));
+	}
+	if((argc == 3) && (strcmp(argv[1], "csv") == 0))
+	{
+		return capture_csv(argv[2]);
+	}
+	if((argc >= 4) && (strcmp(argv[1], "fromcsv") == 0))
+	{
+		return capture_fromcsv(argv[2], argv[3], (uint16_t)((argc > 4) ? atoi(argv[4]) : CAPTURE_DEFAULT_SAMPLE_RATE_HZ));
+	}
+	if((argc == 5) && (strcmp(argv[1], "label") == 0))
+	{
+		return capture_label(argv[2], argv[3], argv[4]);
+	}
+	fprintf(stderr, "usage: %s import <uart2.bin> <out.wcap> [sample_rate_hz]\n"
+		"       %s csv <in.wcap>\n"
+		"       %s fromcsv <in.csv> <out.wcap> [sample_rate_hz]\n"
+		"       %s label <in.wcap> <labels.txt> <out.wcap>\n", argv[0], argv[0], argv[0], argv[0]);
+	return 2;
+}
@@ -0,0 +1,47 @@
+/**
+ ****************************************************************************************
+ *
+ * @file energy_currents.h
+ *
+ * @brief Currents and charges used by the energy model.
+ *
+ * Typical values at VBAT = 3.0V. DA14531 figures are from the DA14531 datasheet (buck
+ * mode), accelerometer figures from the LIS3DH datasheet. Replace them with bench
+ * measurements of the actual board when they are available.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _ENERGY_CURRENTS_H_
+#define _ENERGY_CURRENTS_H_
+
+/* BLE slot, the unit of every time counter                                                  */
+#define ENERGY_SLOT_US                      (625.0)
+
+/* DA14531 running from RAM at 16MHz, peripherals idle                                       */
+#define ENERGY_I_AWAKE_UA                   (900.0)
+
+/* DA14531 extended sleep with all RAM retained                                              */
+#define ENERGY_I_SLEEP_UA                   (1.8)
+
+/* One wake-up from extended sleep before the app_resume_from_sleep callback, which starts  */
+/* the awake count: about 1ms of XTAL32M settling and ROM wake-up code at roughly 1mA        */
+#define ENERGY_Q_WAKEUP_UC                  (1.0)
+
+/* One advertising event on three channels at 0dBm: about 0.5ms of TX at 3.5mA per channel */
+/* plus the radio ramp-up and the event processing                                           */
+#define ENERGY_Q_ADV_EVENT_UC               (7.0)
+
+/* One byte at 400kHz is nine bit times (22.5us) with the pull-ups sinking about 0.3mA      */
+#define ENERGY_Q_I2C_BYTE_UC                (0.00675)
+
+/* LIS3DH at 100Hz ODR, normal mode (CTRL_REG1 = 0x57)                                       */
+#define ENERGY_I_XL_ACTIVE_UA               (20.0)
+
+/* LIS3DH at 1Hz ODR, low-power mode with the wake-up interrupt (CTRL_REG1 = 0x1A)           */
+#define ENERGY_I_XL_SLEEP_UA                (2.0)
+
+/* Vibration motor                                                                           */
+#define ENERGY_I_MOTOR_UA                   (60000.0)
+
+#endif // _ENERGY_CURRENTS_H_
@@ -0,0 +1,187 @@
+/**
+ ****************************************************************************************
+ *
+ * @file energy_model.c
+ *
+ * @brief Turn the firmware energy counters into charge per subsystem.
+ *
+ * Usage: energy_model [-c capacity_mAh] [decoded_trace.txt]
+ *
+ * The input is text holding "energy <counter> <value>" lines, as printed by
+ * trace_decode from the CFG_ENERGY_COUNTERS reports or written by a simulator. Lines
+ * of other kinds are ignored, and every report is added up.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "energy_currents.h"
+#include "user_energy.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+#define ENERGY_LINE_LEN                     (256)
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+#define ENERGY_COUNTER_NAME(name)           #name,
+
+static const char * const energyCounterNames[ENERGY_NUM_COUNTERS] =
+{
+	ENERGY_COUNTERS(ENERGY_COUNTER_NAME)
+};
+
+static double energyTotals[ENERGY_NUM_COUNTERS];
+static double energyAdvIntervalSlots;
+static unsigned long energyReports;
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+ /**
+ ****************************************************************************************
+ * @brief Counter index of a name as printed by trace_decode (lower case), or -1
+ ****************************************************************************************
+ */
+static int energy_counter_lookup(const char *name)
+{
+	for(int i=0;i<ENERGY_NUM_COUNTERS;i++)
+	{
+		const char *ref = energyCounterNames[i];
+		size_t j;
+
+		for(j=0;(ref[j] != '\0') && (name[j] != '\0');j++)
+		{
+			if((ref[j] | 0x20) != (name[j] | 0x20))
+			{
+				break;
+			}
+		}
+		if((ref[j] == '\0') && (name[j] == '\0'))
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+static void energy_read(FILE *in)
+{
+	char line[ENERGY_LINE_LEN];
+
+	while(fgets(line, sizeof(line), in) != NULL)
+	{
+		const char *text = strstr(line, "energy ");
+		char name[64];
+		unsigned long value;
+		int counter;
+
+		if((text == NULL) || (sscanf(text, "energy %63s %lu", name, &value) != 2))
+		{
+			continue;
+		}
+		if((counter = energy_counter_lookup(name)) < 0)
+		{
+			fprintf(stderr, "unknown counter %s\n", name);
+			continue;
+		}
+		if(counter == ENERGY_ADV_INTERVAL_SLOTS)
+		{
+			// A setting, not an amount; the last one wins
+			energyAdvIntervalSlots = (double)value;
+			energyReports++;
+			continue;
+		}
+		energyTotals[counter] += (double)value;
+	}
+}
+
+static void energy_print(const char *name, double chargeUc, double totalUc, double hours)
+{
+	printf("  %-12s %12.1f uC  %5.1f%%  %9.2f uA avg\n", name, chargeUc,
+		(totalUc > 0) ? (100.0 * chargeUc / totalUc) : 0.0, (hours > 0) ? (chargeUc / (hours * 3600.0)) : 0.0);
+}
+
+int main(int argc, char **argv)
+{
+	double capacityMah = 0;
+	FILE *in = stdin;
+	int arg = 1;
+
+	if((argc > 2) && (strcmp(argv[1], "-c") == 0))
+	{
+		capacityMah = atof(argv[2]);
+		arg = 3;
+	}
+	if(argc > arg + 1)
+	{
+		fprintf(stderr, "usage: %s [-c capacity_mAh] [decoded_trace.txt]\n", argv[0]);
+		return 2;
+	}
+	if((argc == arg + 1) && ((in = fopen(argv[arg], "r")) == NULL))
+	{
+		perror(argv[arg]);
+		return 1;
+	}
+	energy_read(in);
+	if(in != stdin)
+	{
+		fclose(in);
+	}
+
+	double slotS = ENERGY_SLOT_US / 1e6;
+	double awakeS = energyTotals[ENERGY_AWAKE_SLOTS] * slotS;
+	double sleepS = energyTotals[ENERGY_SLEEP_SLOTS] * slotS;
+	double totalS = awakeS + sleepS;
+	double xlActiveS = energyTotals[ENERGY_XL_ACTIVE_SLOTS] * slotS;
+	double advEvents = (energyAdvIntervalSlots > 0) ? (energyTotals[ENERGY_ADV_SLOTS] / energyAdvIntervalSlots) : 0;
+
+	if(totalS <= 0)
+	{
+		fprintf(stderr, "no energy reports found\n");
+		return 1;
+	}
+
+	// Charges in uC (uA * s)
+	double cpuUc = (awakeS * ENERGY_I_AWAKE_UA) + (sleepS * ENERGY_I_SLEEP_UA) +
+		(energyTotals[ENERGY_WAKEUPS] * ENERGY_Q_WAKEUP_UC);
+	double advUc = advEvents * ENERGY_Q_ADV_EVENT_UC;
+	double i2cUc = energyTotals[ENERGY_I2C_BYTES] * ENERGY_Q_I2C_BYTE_UC;
+	double xlUc = (xlActiveS * ENERGY_I_XL_ACTIVE_UA) +
+		(((totalS > xlActiveS) ? (totalS - xlActiveS) : 0) * ENERGY_I_XL_SLEEP_UA);
+	double motorUc = energyTotals[ENERGY_MOTOR_SLOTS] * slotS * ENERGY_I_MOTOR_UA;
+	double totalUc = cpuUc + advUc + i2cUc + xlUc + motorUc;
+	double hours = totalS / 3600.0;
+	double mahPerHour = (totalUc / 3600.0 / 1000.0) / hours;
+
+	printf("%lu reports, %.1f s (%.2f%% awake, %.0f wake-ups), %.0f adv events, %.0f samples, %.0f I2C transactions\n",
+		energyReports, totalS, 100.0 * awakeS / totalS, energyTotals[ENERGY_WAKEUPS], advEvents,
+		energyTotals[ENERGY_SAMPLES], energyTotals[ENERGY_I2C_TRANSACTIONS]);
+	energy_print("cpu", cpuUc, totalUc, hours);
+	energy_print("advertising", advUc, totalUc, hours);
+	energy_print("i2c", i2cUc, totalUc, hours);
+	energy_print("xl", xlUc, totalUc, hours);
+	energy_print("motor", motorUc, totalUc, hours);
+	printf("total %.1f uC, %.4f mAh per hour (%.2f uA average)\n", totalUc, mahPerHour, mahPerHour * 1000.0);
+	if((capacityMah > 0) && (mahPerHour > 0))
+	{
+		printf("%.0f mAh lasts %.0f hours (%.1f days) at this usage\n", capacityMah,
+			capacityMah / mahPerHour, capacityMah / mahPerHour / 24.0);
+	}
+	return 0;
+}
@@ -0,0 +1,200 @@
+/**
+ ****************************************************************************************
+ *
+ * @file ret_report.c
+ *
+ * @brief Retention RAM report from a Keil linker map.
+ *
+ * Usage: ret_report [image.map]   (reads stdin when no file is given)
+ *
+ * Prints the bytes every object keeps in the retained regions (RET_DATA, RET_HEAP and
+ * the other RET_ execution regions). The application modules keep theirs in one struct
+ * each, so retained.<module>.o is the size of that struct, padding included; their sum
+ * is checked against APP_RETAINED_TOTAL_SIZE when user_barebone.c is compiled.
+ *
+ * The map must come from a build of the current sources: the figures are those of the
+ * image the map describes.
+ *
+ * Output lines are "key value":
+ *   retained.<object>     bytes in the retained regions, largest first
+ *   retained.total        sum of the above
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+#define RET_LINE_LEN                        (512)
+#define RET_NAME_LEN                        (128)
+#define RET_MAX_OBJECTS                     (256)
+
+/* Execution regions with this prefix are the retained ones of the SDK scatter files      */
+#define RET_REGION_PREFIX                   "RET_"
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Retained bytes of one object
+struct ret_object
+{
+	char name[RET_NAME_LEN];
+	unsigned long bytes;
+};
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+static struct ret_object retObjects[RET_MAX_OBJECTS];
+static int retNumObjects;
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+static void ret_add_object(const char *name, unsigned long bytes)
+{
+	int i;
+
+	for(i=0;i<retNumObjects;i++)
+	{
+		if(strcmp(retObjects[i].name, name) == 0)
+		{
+			break;
+		}
+	}
+	if(i == retNumObjects)
+	{
+		if(retNumObjects == RET_MAX_OBJECTS)
+		{
+			fprintf(stderr, "more than %d retained objects, %s not counted\n", RET_MAX_OBJECTS, name);
+			return;
+		}
+		snprintf(retObjects[i].name, sizeof(retObjects[i].name), "%s", name);
+		retNumObjects++;
+	}
+	retObjects[i].bytes += bytes;
+}
+
+static int ret_object_compare(const void *a, const void *b)
+{
+	const struct ret_object *x = a;
+	const struct ret_object *y = b;
+
+	if(x->bytes != y->bytes)
+	{
+		return (x->bytes < y->bytes) ? 1 : -1;
+	}
+	return strcmp(x->name, y->name);
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Read the "Memory Map of the image" part of the map
+ * @return number of sections found
+ ****************************************************************************************
+ */
+static unsigned long ret_read(FILE *in)
+{
+	char line[RET_LINE_LEN];
+	char region[RET_NAME_LEN] = "";
+	int inMemoryMap = 0;
+	unsigned long sections = 0;
+
+	while(fgets(line, sizeof(line), in) != NULL)
+	{
+		char tokens[9][RET_NAME_LEN];
+		unsigned long size;
+		int n;
+
+		if(strstr(line, "Memory Map of the image") != NULL)
+		{
+			inMemoryMap = 1;
+			continue;
+		}
+		if(!inMemoryMap)
+		{
+			continue;
+		}
+		if(strstr(line, "Image component sizes") != NULL)
+		{
+			break;
+		}
+		if(sscanf(line, " Execution Region %127s", region) == 1)
+		{
+			continue;
+		}
+		// Exec Addr, Load Addr or "-", Size, Type, Attr, Idx, optional "*" entry mark,
+		// Section Name, Object; padding lines stop after the type
+		n = sscanf(line, "%127s %127s %127s %127s %127s %127s %127s %127s %127s",
+			tokens[0], tokens[1], tokens[2], tokens[3], tokens[4], tokens[5], tokens[6], tokens[7], tokens[8]);
+		if((n < 4) || (strncmp(tokens[0], "0x", 2) != 0) || (strncmp(tokens[2], "0x", 2) != 0))
+		{
+			continue;
+		}
+		size = strtoul(tokens[2], NULL, 16);
+		sections++;
+
+		if((n < 8) || ((n == 8) && (strcmp(tokens[6], "*") == 0)))
+		{
+			continue;
+		}
+		if(strncmp(region, RET_REGION_PREFIX, strlen(RET_REGION_PREFIX)) == 0)
+		{
+			ret_add_object((strcmp(tokens[6], "*") == 0) ? tokens[8] : tokens[7], size);
+		}
+	}
+	return sections;
+}
+
+int main(int argc, char **argv)
+{
+	FILE *in = stdin;
+	unsigned long total = 0;
+
+	if(argc > 2)
+	{
+		fprintf(stderr, "usage: %s [image.map]\n", argv[0]);
+		return 2;
+	}
+	if((argc == 2) && ((in = fopen(argv[1], "r")) == NULL))
+	{
+		perror(argv[1]);
+		return 1;
+	}
+	unsigned long sections = ret_read(in);
+	if(in != stdin)
+	{
+		fclose(in);
+	}
+	if(sections == 0)
+	{
+		fprintf(stderr, "no memory map found\n");
+		return 1;
+	}
+
+	qsort(retObjects, retNumObjects, sizeof(retObjects[0]), ret_object_compare);
+	for(int i=0;i<retNumObjects;i++)
+	{
+		printf("retained.%s %lu\n", retObjects[i].name, retObjects[i].bytes);
+		total += retObjects[i].bytes;
+	}
+	printf("retained.total %lu\n", total);
+	return 0;
+}
@@ -0,0 +1,177 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app.h
+ *
+ * @brief Host stand-in for the SDK application header.
+ *
+ * The configuration structures of user_config.h and the advertising and connection
+ * calls of the application, with the names and types of SDK 6.0.14. Only the fields
+ * the application sets or reads are there. The host tool that builds the application
+ * sources provides app_env and the functions.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _APP_H_
+#define _APP_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "co_bt.h"
+#include "gap.h"
+#include "gapc_task.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+#define APP_EASY_MAX_ACTIVE_CONNECTION      (1)
+
+#define GAPM_MASK_ATT_SVC_CHG_EN            (0x20)
+#define GAPM_CONNECTION_DIRECT              (0x13)
+
+/* Unit conversions                                                                         */
+#define MS_TO_BLESLOTS(x)                   ((uint16_t)((x) / 0.625))
+#define MS_TO_DOUBLESLOTS(x)                ((uint16_t)((x) / 1.25))
+#define MS_TO_TIMERUNITS(x)                 ((uint16_t)((x) / 10))
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Per connection environment
+struct app_env_tag
+{
+	/// GAP_INVALID_CONIDX when no connection is established
+	uint8_t conidx;
+	bool connection_active;
+};
+
+/// Advertising data of a GAPM_START_ADVERTISE_CMD
+struct gapm_adv_host
+{
+	uint8_t mode;
+	uint8_t adv_filt_policy;
+	uint8_t adv_data_len;
+	uint8_t adv_data[ADV_DATA_LEN];
+	uint8_t scan_rsp_data_len;
+	uint8_t scan_rsp_data[SCAN_RSP_DATA_LEN];
+};
+
+struct gapm_start_advertise_cmd
+{
+	uint8_t op;
+	uint16_t intv_min;
+	uint16_t intv_max;
+	uint8_t channel_map;
+	union
+	{
+		struct gapm_adv_host host;
+	} info;
+};
+
+struct advertise_configuration
+{
+	uint8_t addr_src;
+	uint16_t intv_min;
+	uint16_t intv_max;
+	uint8_t channel_map;
+	uint8_t mode;
+	uint8_t adv_filt_policy;
+	uint8_t peer_addr[6];
+	uint8_t peer_addr_type;
+};
+
+struct gapm_configuration
+{
+	uint8_t role;
+	uint16_t max_mtu;
+	uint8_t addr_type;
+	uint16_t renew_dur;
+	uint8_t addr[6];
+	uint8_t irk[KEY_LEN];
+	uint8_t att_cfg;
+	uint16_t gap_start_hdl;
+	uint16_t gatt_start_hdl;
+	uint16_t max_mps;
+	uint16_t max_txoctets;
+	uint16_t max_txtime;
+};
+
+struct connection_param_configuration
+{
+	uint16_t intv_min;
+	uint16_t intv_max;
+	uint16_t latency;
+	uint16_t time_out;
+	uint16_t ce_len_min;
+	uint16_t ce_len_max;
+};
+
+struct central_configuration
+{
+	uint8_t code;
+	uint8_t addr_src;
+	uint16_t scan_interval;
+	uint16_t scan_window;
+	uint16_t con_intv_min;
+	uint16_t con_intv_max;
+	uint16_t con_latency;
+	uint16_t superv_to;
+	uint16_t ce_len_min;
+	uint16_t ce_len_max;
+	uint8_t peer_addr_0[6];
+	uint8_t peer_addr_0_type;
+	uint8_t peer_addr_1[6];
+	uint8_t peer_addr_1_type;
+	uint8_t peer_addr_2[6];
+	uint8_t peer_addr_2_type;
+	uint8_t peer_addr_3[6];
+	uint8_t peer_addr_3_type;
+	uint8_t peer_addr_4[6];
+	uint8_t peer_addr_4_type;
+	uint8_t peer_addr_5[6];
+	uint8_t peer_addr_5_type;
+	uint8_t peer_addr_6[6];
+	uint8_t peer_addr_6_type;
+	uint8_t peer_addr_7[6];
+	uint8_t peer_addr_7_type;
+};
+
+/*
+ * GLOBAL VARIABLE DECLARATIONS
+ ****************************************************************************************
+ */
+
+extern struct app_env_tag app_env[APP_EASY_MAX_ACTIVE_CONNECTION];
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+void default_app_on_init(void);
+
+void default_app_on_connection(uint8_t conidx, struct gapc_connection_req_ind const *param);
+
+struct gapm_start_advertise_cmd *app_easy_gap_undirected_advertise_get_active(void);
+
+void app_easy_gap_undirected_advertise_start(void);
+
+void app_easy_gap_advertise_stop(void);
+
+void app_easy_gap_update_adv_data(const uint8_t *update_adv_data, uint8_t update_adv_data_len,
+                                  const uint8_t *update_scan_rsp_data, uint8_t update_scan_rsp_data_len);
+
+void app_easy_gap_param_update_start(uint8_t conidx);
+
+#endif // _APP_H_
@@ -0,0 +1,22 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_adv_data.h
+ *
+ * @brief Host stand-in for the SDK advertising data constants.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _APP_ADV_DATA_H_
+#define _APP_ADV_DATA_H_
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+#define ADV_TYPE_COMPLETE_LIST_16BIT_SERVICE_IDS "\x03"
+#define ADV_UUID_DEVICE_INFORMATION_SERVICE "\x0A\x18"
+
+#endif // _APP_ADV_DATA_H_
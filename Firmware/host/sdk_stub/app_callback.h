@@ -0,0 +1,14 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_callback.h
+ *
+ * @brief Host stand-in for the SDK application callback header, nothing is used.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _APP_CALLBACK_H_
+#define _APP_CALLBACK_H_
+
+#endif // _APP_CALLBACK_H_
@@ -0,0 +1,47 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_default_handlers.h
+ *
+ * @brief Host stand-in for the SDK default handlers configuration.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _APP_DEFAULT_HANDLERS_H_
+#define _APP_DEFAULT_HANDLERS_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include "app.h"
+#include "app_security.h"
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+enum default_adv_scenario
+{
+	DEF_ADV_FOREVER,
+	DEF_ADV_WITH_TIMEOUT
+};
+
+enum default_sec_req_scenario
+{
+	DEF_SEC_REQ_NEVER,
+	DEF_SEC_REQ_ON_CONNECT
+};
+
+struct default_handlers_configuration
+{
+	enum default_adv_scenario adv_scenario;
+	uint32_t advertise_period;
+	enum default_sec_req_scenario security_request_scenario;
+};
+
+#endif // _APP_DEFAULT_HANDLERS_H_
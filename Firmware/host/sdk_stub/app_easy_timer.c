@@ -0,0 +1,370 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_easy_timer.c
+ *
+ * @brief Host stand-in for the SDK app_easy_timer API, run in virtual time.
+ *
+ * The kernel is modelled by a timer list and a message queue. A timer that expires
+ * moves to the queue as an expiry message; app_easy_timer_cancel() takes the timer off
+ * the list and queues a cancel message that frees the handle, as the SDK does. Messages
+ * posted by the host share the queue.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "app_easy_timer.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+#define TIMER_HND_TO_IDX(timer_id)          ((timer_id) - 1)
+#define TIMER_IDX_TO_HND(idx)               ((timer_hnd)((idx) + 1))
+#define TIMER_HND_IS_VALID(timer_id)        (((timer_id) > 0) && ((timer_id) <= APP_TIMER_MAX_NUM))
+
+/* An expiry, a cancel and a stray expiry after a modify can be queued for every timer,
+   with room for as many posted messages                                                    */
+#define TIMER_QUEUE_SIZE                    (8 * APP_TIMER_MAX_NUM)
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Kernel message of the application task
+enum timer_msg_type
+{
+	TIMER_MSG_EXPIRY,
+	TIMER_MSG_CANCEL,
+	TIMER_MSG_POSTED
+};
+
+struct timer_msg
+{
+	enum timer_msg_type type;
+	uint8_t idx;
+	app_easy_timer_sim_handler handler;
+	uint32_t param;
+};
+
+/// One timer. callback is NULL when the handle is free, timer_canceled_handler while a
+/// cancel is pending
+struct timer_slot
+{
+	timer_callback callback;
+	bool armed;
+	uint64_t expiry;
+	/// Order of ke_timer_set() calls, for timers that expire together
+	uint64_t seq;
+};
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+static struct timer_slot timerSlots[APP_TIMER_MAX_NUM];
+static struct timer_msg timerQueue[TIMER_QUEUE_SIZE];
+static unsigned timerQueueHead;
+static unsigned timerQueueCount;
+static uint64_t timerNow;
+static uint64_t timerSeq;
+static struct app_easy_timer_sim_stats timerStats;
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+static void timer_canceled_handler(void)
+{
+}
+
+static struct timer_msg *timer_queue_push(enum timer_msg_type type, uint8_t idx)
+{
+	struct timer_msg *msg;
+
+	if(timerQueueCount == TIMER_QUEUE_SIZE)
+	{
+		fprintf(stderr, "app_easy_timer: kernel message queue overflow\n");
+		abort();
+	}
+	msg = &timerQueue[(timerQueueHead + timerQueueCount) % TIMER_QUEUE_SIZE];
+	msg->type = type;
+	msg->idx = idx;
+	timerQueueCount++;
+	return msg;
+}
+
+static void timer_arm(struct timer_slot *slot, uint32_t delay)
+{
+	slot->armed = true;
+	slot->expiry = timerNow + delay;
+	slot->seq = timerSeq++;
+}
+
+static bool timer_delay_is_valid(uint32_t delay)
+{
+	if((delay == 0) || (delay >= KE_TIMER_DELAY_MAX))
+	{
+		timerStats.badDelays++;
+		return false;
+	}
+	return true;
+}
+
+static bool timer_is_running(timer_hnd timer_id)
+{
+	return TIMER_HND_IS_VALID(timer_id) && (timerSlots[TIMER_HND_TO_IDX(timer_id)].callback != NULL) &&
+		(timerSlots[TIMER_HND_TO_IDX(timer_id)].callback != timer_canceled_handler);
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Deliver the message at the head of the queue
+ ****************************************************************************************
+ */
+static void timer_process_msg(void)
+{
+	struct timer_msg msg = timerQueue[timerQueueHead];
+	struct timer_slot *slot = &timerSlots[msg.idx];
+	timer_callback fn = slot->callback;
+
+	timerQueueHead = (timerQueueHead + 1) % TIMER_QUEUE_SIZE;
+	timerQueueCount--;
+
+	if(msg.type == TIMER_MSG_POSTED)
+	{
+		msg.handler(msg.param);
+		return;
+	}
+
+	if(msg.type == TIMER_MSG_CANCEL)
+	{
+		if(fn == timer_canceled_handler)
+		{
+			slot->callback = NULL;
+		}
+		return;
+	}
+
+	if((fn == NULL) || (fn == timer_canceled_handler))
+	{
+		// Cancelled after the expiry was queued, or a second expiry after a modify
+		timerStats.droppedExpiries++;
+		if(fn == timer_canceled_handler)
+		{
+			slot->callback = NULL;
+		}
+		return;
+	}
+	// The handle is free again before the callback runs, so it can restart itself
+	slot->callback = NULL;
+	timerStats.fired++;
+	fn();
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Move time to the earliest expiry and queue every timer expiring then
+ * @return false when no timer is armed or the earliest expires after limit
+ ****************************************************************************************
+ */
+static bool timer_expire_next(uint64_t limit)
+{
+	struct timer_slot *next = NULL;
+
+	for(int i=0;i<APP_TIMER_MAX_NUM;i++)
+	{
+		struct timer_slot *slot = &timerSlots[i];
+
+		if(slot->armed && ((next == NULL) || (slot->expiry < next->expiry) ||
+			((slot->expiry == next->expiry) && (slot->seq < next->seq))))
+		{
+			next = slot;
+		}
+	}
+	if((next == NULL) || (next->expiry > limit))
+	{
+		return false;
+	}
+	timerNow = next->expiry;
+
+	// Expired together: queued in the order they were set
+	for(;;)
+	{
+		int first = -1;
+
+		for(int i=0;i<APP_TIMER_MAX_NUM;i++)
+		{
+			if(timerSlots[i].armed && (timerSlots[i].expiry == timerNow) &&
+				((first < 0) || (timerSlots[i].seq < timerSlots[first].seq)))
+			{
+				first = i;
+			}
+		}
+		if(first < 0)
+		{
+			break;
+		}
+		timerSlots[first].armed = false;
+		timer_queue_push(TIMER_MSG_EXPIRY, (uint8_t)first);
+	}
+	return true;
+}
+
+timer_hnd app_easy_timer(const uint32_t delay, timer_callback fn)
+{
+	unsigned inUse = 0;
+	int freeIdx = -1;
+
+	if(!timer_delay_is_valid(delay))
+	{
+		return EASY_TIMER_INVALID_TIMER;
+	}
+	for(int i=0;i<APP_TIMER_MAX_NUM;i++)
+	{
+		if(timerSlots[i].callback != NULL)
+		{
+			inUse++;
+		}
+		else if(freeIdx < 0)
+		{
+			freeIdx = i;
+		}
+	}
+	if(freeIdx < 0)
+	{
+		timerStats.poolExhausted++;
+		return EASY_TIMER_INVALID_TIMER;
+	}
+	if(inUse + 1 > timerStats.maxInUse)
+	{
+		timerStats.maxInUse = inUse + 1;
+	}
+	timerSlots[freeIdx].callback = fn;
+	timer_arm(&timerSlots[freeIdx], delay);
+	return TIMER_IDX_TO_HND(freeIdx);
+}
+
+void app_easy_timer_cancel(const timer_hnd timer_id)
+{
+	struct timer_slot *slot;
+
+	if(!timer_is_running(timer_id))
+	{
+		timerStats.staleCancels++;
+		return;
+	}
+	slot = &timerSlots[TIMER_HND_TO_IDX(timer_id)];
+	slot->armed = false;
+	slot->callback = timer_canceled_handler;
+	timer_queue_push(TIMER_MSG_CANCEL, (uint8_t)TIMER_HND_TO_IDX(timer_id));
+	timerStats.cancelled++;
+}
+
+timer_hnd app_easy_timer_modify(const timer_hnd timer_id, const uint32_t delay)
+{
+	if(!timer_delay_is_valid(delay))
+	{
+		return EASY_TIMER_INVALID_TIMER;
+	}
+	if(!timer_is_running(timer_id))
+	{
+		timerStats.staleModifies++;
+		return EASY_TIMER_INVALID_TIMER;
+	}
+	timer_arm(&timerSlots[TIMER_HND_TO_IDX(timer_id)], delay);
+	return timer_id;
+}
+
+void app_easy_timer_cancel_all(void)
+{
+	for(int i=0;i<APP_TIMER_MAX_NUM;i++)
+	{
+		if(timer_is_running(TIMER_IDX_TO_HND(i)))
+		{
+			app_easy_timer_cancel(TIMER_IDX_TO_HND(i));
+		}
+	}
+}
+
+void app_easy_timer_sim_reset(void)
+{
+	memset(timerSlots, 0, sizeof(timerSlots));
+	memset(&timerStats, 0, sizeof(timerStats));
+	timerQueueHead = 0;
+	timerQueueCount = 0;
+	timerNow = 0;
+	timerSeq = 0;
+}
+
+uint64_t app_easy_timer_sim_now(void)
+{
+	return timerNow;
+}
+
+bool app_easy_timer_sim_step(void)
+{
+	if(timerQueueCount > 0)
+	{
+		timer_process_msg();
+		return true;
+	}
+	return timer_expire_next(UINT64_MAX);
+}
+
+void app_easy_timer_sim_run_until(uint64_t time)
+{
+	for(;;)
+	{
+		if(timerQueueCount > 0)
+		{
+			timer_process_msg();
+		}
+		else if(!timer_expire_next(time))
+		{
+			break;
+		}
+	}
+	if(time > timerNow)
+	{
+		timerNow = time;
+	}
+}
+
+bool app_easy_timer_sim_running(const timer_hnd timer_id)
+{
+	return timer_is_running(timer_id);
+}
+
+void app_easy_timer_sim_post(app_easy_timer_sim_handler handler, uint32_t param)
+{
+	struct timer_msg *msg = timer_queue_push(TIMER_MSG_POSTED, 0);
+
+	msg->handler = handler;
+	msg->param = param;
+}
+
+void app_easy_timer_sim_get_stats(struct app_easy_timer_sim_stats *stats)
+{
+	*stats = timerStats;
+	stats->inUse = 0;
+	for(int i=0;i<APP_TIMER_MAX_NUM;i++)
+	{
+		if(timerSlots[i].callback != NULL)
+		{
+			stats->inUse++;
+		}
+	}
+}
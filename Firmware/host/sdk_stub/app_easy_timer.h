@@ -0,0 +1,170 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_easy_timer.h
+ *
+ * @brief Host stand-in for the SDK app_easy_timer API, run in virtual time.
+ *
+ * The functions of SDK 6.0.14 keep their names, units (10ms) and behaviour:
+ * - at most APP_TIMER_MAX_NUM timers exist at a time; app_easy_timer() returns
+ *   EASY_TIMER_INVALID_TIMER when they are all in use,
+ * - an expiry is delivered as a kernel message, so timers that expire together run in
+ *   the order they were set, and only after the messages already queued,
+ * - app_easy_timer_cancel() only marks the timer; its handle stays in use until the
+ *   cancel message is processed, and an expiry already queued is dropped,
+ * - cancelling a handle that is invalid, has fired or is already cancelled is an
+ *   ASSERT_WARNING on the device; here it is counted.
+ *
+ * Messages of other tasks (the BLE stack of a simulator) can be queued with
+ * app_easy_timer_sim_post() and are delivered in order with the timer messages.
+ *
+ * Nothing runs until the host steps the kernel with app_easy_timer_sim_step() or
+ * app_easy_timer_sim_run_until(). Time only moves to the next expiry, so hours of
+ * timers run in as many steps as there are callbacks, and every run is identical.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _APP_EASY_TIMER_H_
+#define _APP_EASY_TIMER_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+#define EASY_TIMER_INVALID_TIMER            (0x00)
+
+/* Timer messages of the application task (APP_TIMER_API_MES0...)                          */
+#define APP_TIMER_MAX_NUM                   (10)
+
+/* Longest delay, 41943sec                                                                  */
+#define KE_TIMER_DELAY_MAX                  (4194300)
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+typedef uint8_t timer_hnd;
+typedef void (*timer_callback)(void);
+
+/// Handler of a message queued with app_easy_timer_sim_post()
+typedef void (*app_easy_timer_sim_handler)(uint32_t param);
+
+/// Virtual time statistics
+struct app_easy_timer_sim_stats
+{
+	/// Callbacks run
+	unsigned long fired;
+	/// Timers cancelled, and expiries dropped because the timer was cancelled first
+	unsigned long cancelled;
+	unsigned long droppedExpiries;
+	/// app_easy_timer() calls that found no free timer
+	unsigned long poolExhausted;
+	/// Device asserts: bad delay, cancel or modify of a handle not running
+	unsigned long badDelays;
+	unsigned long staleCancels;
+	unsigned long staleModifies;
+	/// Timers in use now, and most in use at once
+	unsigned inUse;
+	unsigned maxInUse;
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+ /**
+ ****************************************************************************************
+ * @brief Start a timer
+ * @param[in] delay Delay in 10ms units, 1..KE_TIMER_DELAY_MAX-1
+ * @param[in] fn    Callback
+ * @return Timer handle, EASY_TIMER_INVALID_TIMER when no timer is free
+ ****************************************************************************************
+ */
+timer_hnd app_easy_timer(const uint32_t delay, timer_callback fn);
+
+ /**
+ ****************************************************************************************
+ * @brief Cancel a running timer
+ ****************************************************************************************
+ */
+void app_easy_timer_cancel(const timer_hnd timer_id);
+
+ /**
+ ****************************************************************************************
+ * @brief Restart a running timer with a new delay
+ * @return The handle, EASY_TIMER_INVALID_TIMER when the timer was not running
+ ****************************************************************************************
+ */
+timer_hnd app_easy_timer_modify(const timer_hnd timer_id, const uint32_t delay);
+
+ /**
+ ****************************************************************************************
+ * @brief Cancel every running timer
+ ****************************************************************************************
+ */
+void app_easy_timer_cancel_all(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Drop every timer and message, restart time at zero and clear the statistics
+ ****************************************************************************************
+ */
+void app_easy_timer_sim_reset(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Current virtual time in 10ms units
+ ****************************************************************************************
+ */
+uint64_t app_easy_timer_sim_now(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Process the next kernel message, or move time to the next expiry when none is
+ *        queued
+ * @return false when no timer is running and no message is queued
+ ****************************************************************************************
+ */
+bool app_easy_timer_sim_step(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Run every message and expiry up to and including time, then set the time
+ ****************************************************************************************
+ */
+void app_easy_timer_sim_run_until(uint64_t time);
+
+ /**
+ ****************************************************************************************
+ * @brief Whether a timer is running: set, and neither fired nor cancelled
+ ****************************************************************************************
+ */
+bool app_easy_timer_sim_running(const timer_hnd timer_id);
+
+ /**
+ ****************************************************************************************
+ * @brief Queue a kernel message, handled after the messages already queued
+ ****************************************************************************************
+ */
+void app_easy_timer_sim_post(app_easy_timer_sim_handler handler, uint32_t param);
+
+ /**
+ ****************************************************************************************
+ * @brief Copy the statistics since the last app_easy_timer_sim_reset()
+ ****************************************************************************************
+ */
+void app_easy_timer_sim_get_stats(struct app_easy_timer_sim_stats *stats);
+
+#endif // _APP_EASY_TIMER_H_
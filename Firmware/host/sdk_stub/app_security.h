@@ -0,0 +1,38 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_security.h
+ *
+ * @brief Host stand-in for the SDK security configuration structure.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _APP_SECURITY_H_
+#define _APP_SECURITY_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include "gap.h"
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+struct security_configuration
+{
+	uint8_t iocap;
+	uint8_t oob;
+	uint8_t auth;
+	uint8_t key_size;
+	uint8_t ikey_dist;
+	uint8_t rkey_dist;
+	uint8_t sec_req;
+};
+
+#endif // _APP_SECURITY_H_
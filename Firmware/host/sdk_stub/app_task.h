@@ -0,0 +1,36 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_task.h
+ *
+ * @brief Host stand-in for the SDK application task header.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _APP_TASK_H_
+#define _APP_TASK_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include "ke_task.h"
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// States of the application task
+enum app_state
+{
+	APP_DISABLED,
+	APP_DB_INIT,
+	APP_CONNECTABLE,
+	APP_CONNECTED,
+	APP_STATE_MAX
+};
+
+#endif // _APP_TASK_H_
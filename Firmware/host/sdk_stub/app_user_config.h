@@ -0,0 +1,25 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_user_config.h
+ *
+ * @brief Host stand-in for the SDK address configuration header.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _APP_USER_CONFIG_H_
+#define _APP_USER_CONFIG_H_
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+#define APP_CFG_ADDR_PUB                    (0x00)
+#define APP_CFG_CNTL_PRIV_MODE_NETWORK      (0x00)
+
+#define APP_CFG_ADDR_SRC(mode)              ((uint8_t)(mode))
+#define APP_CFG_ADDR_TYPE(mode)             ((uint8_t)(mode))
+
+#endif // _APP_USER_CONFIG_H_
@@ -0,0 +1,62 @@
+/**
+ ****************************************************************************************
+ *
+ * @file arch.h
+ *
+ * @brief Host stand-in for the SDK architecture header.
+ *
+ * ASSERT_WARNING() calls assert_warning() as the development build of the SDK does;
+ * the host tool that builds the application sources provides it. Register accesses
+ * compile to nothing.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _ARCH_H_
+#define _ARCH_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "compiler.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+#define ASSERT_WARNING(cond)                do { if(!(cond)) { assert_warning(#cond, __FILE__, __LINE__); } } while(0)
+#define ASSERT_ERROR(cond)                  ASSERT_WARNING(cond)
+
+#define SetWord16(addr, value)              ((void)(addr), (void)(value))
+#define SetBits16(addr, mask, value)        ((void)(addr), (void)(mask), (void)(value))
+#define GetWord16(addr)                     ((void)(addr), (uint16_t)0)
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Sleep mode picked by the main loop for the next idle period
+typedef enum
+{
+	mode_active = 0,
+	mode_idle,
+	mode_ext_sleep,
+	mode_ext_sleep_otp,
+	mode_deep_sleep,
+} sleep_mode_t;
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+void assert_warning(const char *condition, const char *file, int line);
+
+#endif // _ARCH_H_
@@ -0,0 +1,62 @@
+/**
+ ****************************************************************************************
+ *
+ * @file arch_api.h
+ *
+ * @brief Host stand-in for the SDK sleep and main loop API.
+ *
+ * Names and types of SDK 6.0.14; the host tool that builds the application sources
+ * provides the functions.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _ARCH_API_H_
+#define _ARCH_API_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdbool.h>
+#include "arch.h"
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Sleep mode set by the application
+typedef enum
+{
+	ARCH_SLEEP_OFF,
+	ARCH_EXT_SLEEP_ON,
+	ARCH_EXT_SLEEP_OTP_COPY_ON,
+} sleep_state_t;
+
+/// Return value of the main loop callbacks
+typedef enum
+{
+	GOTO_SLEEP = 0,
+	KEEP_POWERED,
+} arch_main_loop_callback_ret_t;
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+void arch_set_sleep_mode(sleep_state_t sleep_state);
+
+sleep_state_t arch_get_sleep_mode(void);
+
+void arch_ble_ext_wakeup_on(void);
+
+void arch_ble_ext_wakeup_off(void);
+
+bool arch_ble_ext_wakeup_get(void);
+
+bool arch_ble_force_wakeup(void);
+
+#endif // _ARCH_API_H_
@@ -0,0 +1,14 @@
+/**
+ ****************************************************************************************
+ *
+ * @file arch_console.h
+ *
+ * @brief Host stand-in for the SDK console header; arch_printf() is only called with CFG_PRINTF.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _ARCH_CONSOLE_H_
+#define _ARCH_CONSOLE_H_
+
+#endif // _ARCH_CONSOLE_H_
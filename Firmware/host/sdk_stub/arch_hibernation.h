@@ -0,0 +1,54 @@
+/**
+ ****************************************************************************************
+ *
+ * @file arch_hibernation.h
+ *
+ * @brief Host stand-in for the SDK hibernation header of the DA14531.
+ *
+ * Names and types of SDK 6.0.14; the host tool that builds the application sources
+ * with CFG_HIBERNATION provides the function.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _ARCH_HIBERNATION_H_
+#define _ARCH_HIBERNATION_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Power of a RAM block in hibernation
+typedef enum
+{
+	PD_SYS_DOWN_RAM_OFF = 0,
+	PD_SYS_DOWN_RAM_ON,
+} pd_sys_down_ram_t;
+
+/// Memory at address 0 after the wake-up reset
+typedef enum
+{
+	REMAP_ADDR0_TO_ROM = 0,
+	REMAP_ADDR0_TO_OTP,
+	REMAP_ADDR0_TO_RAM1,
+	REMAP_ADDR0_TO_RAM3,
+} remap_addr0_t;
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+void arch_set_hibernation(uint8_t wkup_mask, pd_sys_down_ram_t ram1, pd_sys_down_ram_t ram2, pd_sys_down_ram_t ram3,
+	remap_addr0_t remap_addr0, bool pad_latch_en);
+
+#endif // _ARCH_HIBERNATION_H_
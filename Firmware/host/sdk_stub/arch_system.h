@@ -0,0 +1,27 @@
+/**
+ ****************************************************************************************
+ *
+ * @file arch_system.h
+ *
+ * @brief Host stand-in for the SDK system header.
+ *
+ * Names and types of SDK 6.0.14; the host tool that builds the application sources
+ * provides the functions.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _ARCH_SYSTEM_H_
+#define _ARCH_SYSTEM_H_
+
+#include <stdint.h>
+#include "arch_api.h"
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+void arch_asm_delay_us(uint32_t nof_us);
+
+#endif // _ARCH_SYSTEM_H_
@@ -0,0 +1,33 @@
+/**
+ ****************************************************************************************
+ *
+ * @file battery.h
+ *
+ * @brief Host stand-in for the SDK battery driver header.
+ *
+ * Names and types of SDK 6.0.14; the host tool that builds the application sources
+ * provides the functions.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _BATTERY_H_
+#define _BATTERY_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+#if defined (__DA14531__)
+uint16_t battery_get_voltage(void);
+#endif
+
+#endif // _BATTERY_H_
@@ -0,0 +1,26 @@
+/**
+ ****************************************************************************************
+ *
+ * @file co_bt.h
+ *
+ * @brief Host stand-in for the SDK Bluetooth constants header.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _CO_BT_H_
+#define _CO_BT_H_
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+#define ADV_DATA_LEN                        (0x1F)
+#define SCAN_RSP_DATA_LEN                   (0x1F)
+#define KEY_LEN                             (0x10)
+
+#define ADV_ALL_CHNLS_EN                    (0x07)
+#define ADV_ALLOW_SCAN_ANY_CON_ANY          (0x00)
+
+#endif // _CO_BT_H_
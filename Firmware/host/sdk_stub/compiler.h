@@ -0,0 +1,21 @@
+/**
+ ****************************************************************************************
+ *
+ * @file compiler.h
+ *
+ * @brief Host stand-in for the SDK compiler abstraction header.
+ *
+ * Only the section attributes of retained variables are used by the sources the host
+ * tools build; outside the firmware image they are ordinary variables.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _COMPILER_H_
+#define _COMPILER_H_
+
+#define __SECTION_ZERO(sec_name)
+#define __INLINE                            static inline
+#define __STATIC_INLINE                     static inline
+
+#endif // _COMPILER_H_
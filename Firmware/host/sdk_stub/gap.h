@@ -0,0 +1,45 @@
+/**
+ ****************************************************************************************
+ *
+ * @file gap.h
+ *
+ * @brief Host stand-in for the SDK GAP constants header.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _GAP_H_
+#define _GAP_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include "co_bt.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/* Status of a completed operation                                                          */
+#define GAP_ERR_NO_ERROR                    (0x00)
+#define GAP_ERR_COMMAND_DISALLOWED          (0x43)
+#define GAP_ERR_CANCELED                    (0x44)
+
+#define GAP_INVALID_CONIDX                  (0xFF)
+
+#define GAP_AD_TYPE_MANU_SPECIFIC_DATA      (0xFF)
+
+#define GAP_GEN_DISCOVERABLE                (0x01)
+#define GAP_ROLE_PERIPHERAL                 (0x02)
+
+#define GAP_IO_CAP_NO_INPUT_NO_OUTPUT       (0x03)
+#define GAP_OOB_AUTH_DATA_NOT_PRESENT       (0x00)
+#define GAP_AUTH_NONE                       (0x00)
+#define GAP_KDIST_NONE                      (0x00)
+#define GAP_KDIST_ENCKEY                    (0x01)
+#define GAP_NO_SEC                          (0x00)
+
+#endif // _GAP_H_
@@ -0,0 +1,60 @@
+/**
+ ****************************************************************************************
+ *
+ * @file gapc_task.h
+ *
+ * @brief Host stand-in for the SDK GAP controller messages.
+ *
+ * Only the fields the application reads.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _GAPC_TASK_H_
+#define _GAPC_TASK_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include "ke_task.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+#define GAPC_PARAM_UPDATED_IND              (0x0E17)
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Connection established
+struct gapc_connection_req_ind
+{
+	uint16_t conhdl;
+	uint16_t con_interval;
+	uint16_t con_latency;
+	uint16_t sup_to;
+};
+
+/// Connection lost
+struct gapc_disconnect_ind
+{
+	uint16_t conhdl;
+	uint8_t reason;
+};
+
+/// Connection parameters changed
+struct gapc_param_updated_ind
+{
+	uint16_t con_interval;
+	uint16_t con_latency;
+	uint16_t sup_to;
+};
+
+#endif // _GAPC_TASK_H_
@@ -0,0 +1,82 @@
+/**
+ ****************************************************************************************
+ *
+ * @file gpio.h
+ *
+ * @brief Host stand-in for the SDK GPIO driver header.
+ *
+ * Names and types of SDK 6.0.14; the host tool that builds the application sources
+ * provides the functions.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _GPIO_H_
+#define _GPIO_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdbool.h>
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+typedef enum
+{
+	GPIO_PORT_0 = 0,
+	GPIO_PORT_1,
+	GPIO_PORT_2,
+	GPIO_PORT_3,
+} GPIO_PORT;
+
+typedef enum
+{
+	GPIO_PIN_0 = 0,
+	GPIO_PIN_1,
+	GPIO_PIN_2,
+	GPIO_PIN_3,
+	GPIO_PIN_4,
+	GPIO_PIN_5,
+	GPIO_PIN_6,
+	GPIO_PIN_7,
+	GPIO_PIN_8,
+	GPIO_PIN_9,
+	GPIO_PIN_10,
+	GPIO_PIN_11,
+} GPIO_PIN;
+
+typedef enum
+{
+	INPUT = 0,
+	INPUT_PULLUP = 0x100,
+	INPUT_PULLDOWN = 0x200,
+	OUTPUT = 0x300,
+} GPIO_PUPD;
+
+typedef enum
+{
+	PID_GPIO = 0,
+	PID_I2C_SCL = 9,
+	PID_I2C_SDA = 10,
+	PID_PWM0 = 18,
+} GPIO_FUNCTION;
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+void GPIO_SetActive(GPIO_PORT port, GPIO_PIN pin);
+
+void GPIO_SetInactive(GPIO_PORT port, GPIO_PIN pin);
+
+bool GPIO_GetPinStatus(GPIO_PORT port, GPIO_PIN pin);
+
+void GPIO_ConfigurePin(GPIO_PORT port, GPIO_PIN pin, GPIO_PUPD mode, GPIO_FUNCTION function, const bool high);
+
+#endif // _GPIO_H_
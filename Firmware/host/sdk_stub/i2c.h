@@ -0,0 +1,72 @@
+/**
+ ****************************************************************************************
+ *
+ * @file i2c.h
+ *
+ * @brief Host stand-in for the SDK I2C driver header.
+ *
+ * user_xl_driver.h includes the SDK header for its own implementation only. The host
+ * tools that build the gesture pipeline need the accelerometer definitions, not the
+ * driver, and ignore these declarations. The tools that build user_xl_driver.c as
+ * well (Firmware/host/arm_bench) provide the functions, with the names and types of
+ * SDK 6.0.14; the FIFO and status accessors, register accesses inlined by the SDK,
+ * are functions here.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _I2C_H_
+#define _I2C_H_
+
+#include <stdint.h>
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/* I2C_DATA_CMD_REG fields: the byte, a read instead of a write, and a STOP after or a     */
+/* RESTART before the byte                                                                 */
+#define I2C_DAT                             (0x00FF)
+#define I2C_CMD                             (0x0100)
+#define I2C_STOP                            (0x0200)
+#define I2C_RESTART                         (0x0400)
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Controller enable status
+typedef enum
+{
+	I2C_CONTROLLER_DISABLE = 0,
+	I2C_CONTROLLER_ENABLE = 1
+} i2c_controller_t;
+
+/// Transfer abort source, bits of I2C_TX_ABRT_SOURCE_REG; the subset the stand-ins report
+typedef enum
+{
+	I2C_ABORT_NONE = 0,
+	I2C_7B_ADDR_NOACK = (1 << 0),
+	I2C_TXDATA_NOACK = (1 << 3),
+	I2C_ARB_LOST = (1 << 12)
+} i2c_abort_t;
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+void i2c_set_controller_status(i2c_controller_t status);
+i2c_controller_t i2c_get_controller_status(void);
+void i2c_set_target_address(uint16_t address);
+void i2c_write_byte(uint16_t byte);
+uint8_t i2c_read_byte(void);
+uint8_t i2c_is_tx_fifo_not_full(void);
+uint8_t i2c_is_rx_fifo_not_empty(void);
+uint8_t i2c_is_master_busy(void);
+uint16_t i2c_get_abort_source(void);
+void i2c_reset_int_tx_abort(void);
+
+#endif // _I2C_H_
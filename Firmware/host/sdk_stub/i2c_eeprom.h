@@ -0,0 +1,14 @@
+/**
+ ****************************************************************************************
+ *
+ * @file i2c_eeprom.h
+ *
+ * @brief Host stand-in for the SDK I2C EEPROM driver header, nothing is used.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _I2C_EEPROM_H_
+#define _I2C_EEPROM_H_
+
+#endif // _I2C_EEPROM_H_
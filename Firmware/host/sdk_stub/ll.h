@@ -0,0 +1,20 @@
+/**
+ ****************************************************************************************
+ *
+ * @file ll.h
+ *
+ * @brief Host stand-in for the SDK low level header.
+ *
+ * The host tools run single threaded without interrupts, so the critical sections of
+ * the firmware sources compile to nothing.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _LL_H_
+#define _LL_H_
+
+#define GLOBAL_INT_DISABLE()                do {
+#define GLOBAL_INT_RESTORE()                } while(0)
+
+#endif // _LL_H_
@@ -0,0 +1,22 @@
+/**
+ ****************************************************************************************
+ *
+ * @file lld_evt.h
+ *
+ * @brief Host stand-in for the SDK link layer event header.
+ *
+ * Only the BLE timer is used by the sources the host tools build; each tool that links
+ * them provides lld_evt_time_get() on its own time base.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _LLD_EVT_H_
+#define _LLD_EVT_H_
+
+#include <stdint.h>
+
+/// BLE slots of 625us, 27 bits
+uint32_t lld_evt_time_get(void);
+
+#endif // _LLD_EVT_H_
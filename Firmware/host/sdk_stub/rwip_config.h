@@ -0,0 +1,14 @@
+/**
+ ****************************************************************************************
+ *
+ * @file rwip_config.h
+ *
+ * @brief Host stand-in for the SDK software configuration header, nothing is used.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _RWIP_CONFIG_H_
+#define _RWIP_CONFIG_H_
+
+#endif // _RWIP_CONFIG_H_
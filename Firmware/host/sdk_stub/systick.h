@@ -0,0 +1,14 @@
+/**
+ ****************************************************************************************
+ *
+ * @file systick.h
+ *
+ * @brief Host stand-in for the SDK SysTick driver header, nothing is used.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _SYSTICK_H_
+#define _SYSTICK_H_
+
+#endif // _SYSTICK_H_
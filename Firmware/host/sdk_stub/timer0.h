@@ -0,0 +1,60 @@
+/**
+ ****************************************************************************************
+ *
+ * @file timer0.h
+ *
+ * @brief Host stand-in for the SDK Timer0 driver header.
+ *
+ * Names and types of SDK 6.0.14; the host tool that builds the application sources
+ * provides the functions.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _TIMER0_H_
+#define _TIMER0_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+typedef enum
+{
+	TIM0_CLK_32K = 0,
+	TIM0_CLK_FAST = 1,
+} TIM0_CLK_SEL_t;
+
+typedef enum
+{
+	PWM_MODE_ONE = 0,
+	PWM_MODE_CLOCK_DIV_BY_TWO = 1,
+} PWM_MODE_t;
+
+typedef enum
+{
+	TIM0_CLK_DIV_BY_10 = 0,
+	TIM0_CLK_NO_DIV = 1,
+} TIM0_CLK_DIV_t;
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+void timer0_init(TIM0_CLK_SEL_t tim_clk_src, PWM_MODE_t pwm_mode, TIM0_CLK_DIV_t tim_clk_div);
+
+void timer0_set(uint16_t pwm_on, uint16_t pwm_high, uint16_t pwm_low);
+
+void timer0_start(void);
+
+void timer0_stop(void);
+
+#endif // _TIMER0_H_
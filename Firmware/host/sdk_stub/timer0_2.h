@@ -0,0 +1,46 @@
+/**
+ ****************************************************************************************
+ *
+ * @file timer0_2.h
+ *
+ * @brief Host stand-in for the SDK Timer0/Timer2 common clock header.
+ *
+ * Names and types of SDK 6.0.14; the host tool that builds the application sources
+ * provides the functions.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _TIMER0_2_H_
+#define _TIMER0_2_H_
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+typedef enum
+{
+	TIM0_2_CLK_DIV_8 = 0,
+	TIM0_2_CLK_DIV_4 = 1,
+	TIM0_2_CLK_DIV_2 = 2,
+	TIM0_2_CLK_DIV_1 = 3,
+} TIM0_2_CLK_DIV_t;
+
+typedef struct
+{
+	TIM0_2_CLK_DIV_t clk_div;
+} tim0_2_clk_div_config_t;
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+void timer0_2_clk_enable(void);
+
+void timer0_2_clk_disable(void);
+
+void timer0_2_clk_div_set(tim0_2_clk_div_config_t *clk_div_config);
+
+#endif // _TIMER0_2_H_
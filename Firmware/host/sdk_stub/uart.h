@@ -0,0 +1,14 @@
+/**
+ ****************************************************************************************
+ *
+ * @file uart.h
+ *
+ * @brief Host stand-in for the SDK UART driver header, nothing is used.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _UART_H_
+#define _UART_H_
+
+#endif // _UART_H_
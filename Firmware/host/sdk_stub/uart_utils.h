@@ -0,0 +1,14 @@
+/**
+ ****************************************************************************************
+ *
+ * @file uart_utils.h
+ *
+ * @brief Host stand-in for the SDK UART print helpers, nothing is used.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _UART_UTILS_H_
+#define _UART_UTILS_H_
+
+#endif // _UART_UTILS_H_
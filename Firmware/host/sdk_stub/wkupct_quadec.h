@@ -0,0 +1,62 @@
+/**
+ ****************************************************************************************
+ *
+ * @file wkupct_quadec.h
+ *
+ * @brief Host stand-in for the SDK wake-up controller driver header.
+ *
+ * Names and types of SDK 6.0.14; the host tool that builds the application sources
+ * provides the functions. The registers are only written, through the no-op access
+ * macros of arch.h.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _WKUPCT_QUADEC_H_
+#define _WKUPCT_QUADEC_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include "arch.h"
+#include "gpio.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+#define WKUP_CTRL_REG                       (0x50000100)
+#define WKUP_IRQ_STATUS_REG                 (0x5000010C)
+#define WKUP_ENABLE_IRQ                     (0x0080)
+#define WKUP_CNTR_RST                       (0x0001)
+
+#define WKUPCT_PIN_POLARITY_HIGH            (0)
+#define WKUPCT_PIN_POLARITY_LOW             (1)
+
+/* Bit of a pin in the 32-bit select and polarity masks, 8 pins a port                     */
+#define WKUPCT_PIN_SELECT(port, pin)        ((uint32_t)1 << (((port) * 8) + (pin)))
+#define WKUPCT_PIN_POLARITY(port, pin, pol) ((uint32_t)(pol) << (((port) * 8) + (pin)))
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+typedef void (*wakeup_handler_function_t)(void);
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+void wkupct_enable_irq(uint32_t sel_pins, uint32_t pol_pins, uint16_t events_num, uint16_t deb_time);
+
+void wkupct_disable_irq(void);
+
+void wkupct_register_callback(wakeup_handler_function_t callback);
+
+#endif // _WKUPCT_QUADEC_H_
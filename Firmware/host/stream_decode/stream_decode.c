@@ -0,0 +1,234 @@
+/**
+ ****************************************************************************************
+ *
+ * @file stream_decode.c
+ *
+ * @brief Decode the raw sample stream written by the wand on UART2 (CFG_STREAM).
+ *
+ * Usage: stream_decode [-w corpus.wcap] [stream.bin]   (reads stdin when no file is given)
+ *
+ * Every sample is printed as "time_us,x,y,z" with the raw 16-bit axes. With -w the
+ * samples are also written to a capture corpus file (Firmware/host/capture), reduced
+ * to the 8-bit values the gesture pipeline sees. Frame, CRC and loss counts are
+ * printed on stderr.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "user_stream_format.h"
+#include "capture_file.h"
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+static unsigned long framesDecoded;
+static unsigned long framesBad;
+static unsigned long framesMissing;
+static unsigned long samplesDecoded;
+static unsigned lastDropped;
+static unsigned lastOverruns;
+static long lastSequence = -1;
+
+static struct capture_writer corpus;
+static FILE *corpusFile;
+static int corpusStarted;
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+static uint16_t stream_get_u16(const uint8_t *bytes)
+{
+	return (uint16_t)(bytes[0] | (bytes[1] << 8));
+}
+
+static uint16_t stream_crc(const uint8_t *data, size_t len)
+{
+	uint16_t crc = STREAM_CRC_INIT;
+
+	for(size_t i=0;i<len;i++)
+	{
+		crc ^= (uint16_t)(data[i] << 8);
+		for(int bit=0;bit<8;bit++)
+		{
+			crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ STREAM_CRC_POLY) : (uint16_t)(crc << 1);
+		}
+	}
+	return crc;
+}
+
+static void stream_print_frame(const uint8_t *frame)
+{
+	uint16_t sequence = stream_get_u16(&frame[2]);
+	uint16_t dropped = stream_get_u16(&frame[4]);
+	uint16_t overruns = stream_get_u16(&frame[6]);
+	uint32_t timestamp = (uint32_t)frame[8] | ((uint32_t)frame[9] << 8) | ((uint32_t)frame[10] << 16) | ((uint32_t)frame[11] << 24);
+	uint16_t rate = stream_get_u16(&frame[12]);
+	uint8_t count = frame[14];
+
+	// Gaps in the sequence are frames lost on the wire or dropped by the firmware
+	if((lastSequence >= 0) && (sequence != (uint16_t)(lastSequence + 1)))
+	{
+		framesMissing += (uint16_t)(sequence - lastSequence - 1);
+	}
+	lastSequence = sequence;
+	lastDropped = dropped;
+	lastOverruns = overruns;
+
+	for(uint8_t i=0;i<count;i++)
+	{
+		const uint8_t *bytes = &frame[STREAM_HEADER_SIZE + (i * STREAM_SAMPLE_SIZE)];
+		int16_t axis[3];
+		double timeUs = ((double)timestamp * (STREAM_TICK_NS / 1000)) + ((rate > 0) ? (i * 1e6 / rate) : 0);
+
+		for(int j=0;j<3;j++)
+		{
+			axis[j] = (int16_t)stream_get_u16(&bytes[2 * j]);
+		}
+		printf("%.0f,%d,%d,%d\n", timeUs, axis[0], axis[1], axis[2]);
+
+		if(corpusFile != NULL)
+		{
+			struct capture_record record;
+
+			if(!corpusStarted)
+			{
+				capture_writer_init(&corpus, corpusFile, rate);
+				corpusStarted = 1;
+			}
+
+			memset(&record, 0, sizeof(record));
+			record.type = CAPTURE_RECORD_SAMPLE;
+			record.timestamp = timestamp + (uint32_t)((rate > 0) ? ((i * 1600UL) / rate) : 0);
+			for(int j=0;j<3;j++)
+			{
+				record.axis[j] = (int8_t)(axis[j] >> 8);
+			}
+			capture_write(&corpus, &record);
+		}
+		samplesDecoded++;
+	}
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Try to decode a frame at the start of buf
+ * @return bytes consumed, 0 when buf does not start with a valid frame, -1 when more
+ *         data is needed
+ ****************************************************************************************
+ */
+static long stream_decode_frame(const uint8_t *buf, size_t len)
+{
+	size_t frameSize;
+
+	if(len < STREAM_HEADER_SIZE)
+	{
+		return -1;
+	}
+	if((buf[0] != STREAM_SYNC_0) || (buf[1] != STREAM_SYNC_1) || (buf[14] > STREAM_FRAME_SAMPLES))
+	{
+		return 0;
+	}
+	frameSize = STREAM_HEADER_SIZE + ((size_t)buf[14] * STREAM_SAMPLE_SIZE) + STREAM_CRC_SIZE;
+	if(len < frameSize)
+	{
+		return -1;
+	}
+	if(stream_crc(&buf[2], frameSize - STREAM_CRC_SIZE - 2) != stream_get_u16(&buf[frameSize - STREAM_CRC_SIZE]))
+	{
+		framesBad++;
+		return 0;
+	}
+	stream_print_frame(buf);
+	framesDecoded++;
+	return (long)frameSize;
+}
+
+int main(int argc, char **argv)
+{
+	static uint8_t buf[4 * STREAM_FRAME_MAX_SIZE];
+	size_t len = 0;
+	int eof = 0;
+	int arg = 1;
+	FILE *in = stdin;
+
+	if((argc > 2) && (strcmp(argv[1], "-w") == 0))
+	{
+		if((corpusFile = fopen(argv[2], "wb")) == NULL)
+		{
+			perror(argv[2]);
+			return 1;
+		}
+		arg = 3;
+	}
+	if(argc > arg + 1)
+	{
+		fprintf(stderr, "usage: %s [-w corpus.wcap] [stream.bin]\n", argv[0]);
+		return 2;
+	}
+	if((argc == arg + 1) && ((in = fopen(argv[arg], "rb")) == NULL))
+	{
+		perror(argv[arg]);
+		return 1;
+	}
+	while(!eof || (len > 0))
+	{
+		if(!eof && (len < sizeof(buf)))
+		{
+			size_t n = fread(&buf[len], 1, sizeof(buf) - len, in);
+
+			if(n == 0)
+			{
+				eof = 1;
+			}
+			len += n;
+		}
+
+		size_t pos = 0;
+		while(pos < len)
+		{
+			long consumed = stream_decode_frame(&buf[pos], len - pos);
+
+			if(consumed > 0)
+			{
+				pos += (size_t)consumed;
+			}
+			else if((consumed < 0) && !eof)
+			{
+				// Partial frame, wait for more input
+				break;
+			}
+			else
+			{
+				pos++;
+			}
+		}
+		memmove(buf, &buf[pos], len - pos);
+		len -= pos;
+	}
+
+	if(in != stdin)
+	{
+		fclose(in);
+	}
+	if(corpusFile != NULL)
+	{
+		capture_writer_flush(&corpus);
+		fclose(corpusFile);
+	}
+	fprintf(stderr, "%lu frames, %lu samples, %lu bad frames, %lu frames missing "
+		"(firmware dropped %u, accelerometer overruns %u)\n",
+		framesDecoded, samplesDecoded, framesBad, framesMissing, lastDropped, lastOverruns);
+	return 0;
+}
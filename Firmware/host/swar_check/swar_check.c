@@ -0,0 +1,298 @@
+/**
+ ****************************************************************************************
+ *
+ * @file swar_check.c
+ *
+ * @brief Check of the SWAR kernels of user_swar.h against scalar reference code.
+ *
+ * Usage: swar_check   (make check)
+ *
+ * Every lane-wise kernel is run on every value, or pair of values, of one lane, with
+ * each lane position in turn holding them and the other lanes set to the values at
+ * the edges of carries and borrows (0x00, 0x01, 0x7F, 0x80, 0x81, 0xFF). Every lane of
+ * the result must match the scalar operation on that lane alone, so a carry or borrow
+ * crossing a lane boundary is caught wherever it happens. swar_abs_max() is checked on
+ * the same words, and swar_window_update() against a per-axis window on random samples.
+ *
+ * Output lines are "key value":
+ *   <kernel>.checked      results compared
+ *   <kernel>.errors       results that differ from the reference
+ *
+ * The first differences are printed to stderr; the exit status is 1 when any is found.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "user_swar.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+#define SWAR_CHECK_LANES                    (4)
+#define SWAR_CHECK_MAX_REPORTS              (10)
+
+/* Windows of swar_window_update(): lengths from 1 up to the limit of the kernel          */
+#define SWAR_CHECK_MAX_WINDOW               (257)
+#define SWAR_CHECK_WINDOW_STEPS             (2000)
+
+/* Kernel table. X(name)                                                                   */
+#define SWAR_CHECK_KERNELS(X)                                                              \
+	X(add)                                                                                 \
+	X(sub)                                                                                 \
+	X(sign_mask)                                                                           \
+	X(abs)                                                                                 \
+	X(decay)                                                                               \
+	X(abs_max)                                                                             \
+	X(window_update)
+
+#define SWAR_CHECK_KERNEL_ENUM(name) SWAR_CHECK_##name,
+#define SWAR_CHECK_KERNEL_NAME(name) #name,
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+enum swar_check_kernel
+{
+	SWAR_CHECK_KERNELS(SWAR_CHECK_KERNEL_ENUM)
+	SWAR_CHECK_NUM_KERNELS
+};
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+static const char *const swarCheckNames[SWAR_CHECK_NUM_KERNELS] = {SWAR_CHECK_KERNELS(SWAR_CHECK_KERNEL_NAME)};
+
+/* Neighbour lanes at the edges of carries and borrows                                     */
+static const uint8_t swarCheckEdges[] = {0x00, 0x01, 0x7F, 0x80, 0x81, 0xFF};
+
+#define SWAR_CHECK_NUM_EDGES                (sizeof(swarCheckEdges) / sizeof(swarCheckEdges[0]))
+
+static unsigned long swarChecked[SWAR_CHECK_NUM_KERNELS];
+static unsigned long swarErrors[SWAR_CHECK_NUM_KERNELS];
+static uint32_t swarRandom = 1;
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+ */
+
+static uint32_t swar_check_random(void)
+{
+	swarRandom = (swarRandom * 1103515245UL) + 12345UL;
+	return swarRandom >> 8;
+}
+
+/* Word holding value in one lane and edge in the other three                              */
+static uint32_t swar_check_word(uint8_t lane, uint8_t value, uint8_t edge)
+{
+	uint32_t word = 0;
+
+	for(uint8_t i=0;i<SWAR_CHECK_LANES;i++)
+	{
+		word |= (uint32_t)((i == lane) ? value : edge) << (i * SWAR_LANE_BITS);
+	}
+	return word;
+}
+
+static uint8_t swar_check_lane(uint32_t word, uint8_t lane)
+{
+	return (uint8_t)(word >> (lane * SWAR_LANE_BITS));
+}
+
+static void swar_check_result(enum swar_check_kernel kernel, int ok, const char *what, uint32_t a, uint32_t b,
+	uint32_t result)
+{
+	swarChecked[kernel]++;
+	if(!ok)
+	{
+		if(swarErrors[kernel] < SWAR_CHECK_MAX_REPORTS)
+		{
+			fprintf(stderr, "%s: %s of 0x%08lx, 0x%08lx gives 0x%08lx\n", swarCheckNames[kernel], what,
+				(unsigned long)a, (unsigned long)b, (unsigned long)result);
+		}
+		swarErrors[kernel]++;
+	}
+}
+
+/* Every lane of result against the scalar operation on the lanes of a and b               */
+static void swar_check_binary(enum swar_check_kernel kernel, uint32_t a, uint32_t b, uint32_t result)
+{
+	int ok = 1;
+
+	for(uint8_t i=0;i<SWAR_CHECK_LANES;i++)
+	{
+		uint8_t x = swar_check_lane(a, i);
+		uint8_t y = swar_check_lane(b, i);
+		uint8_t expected = (kernel == SWAR_CHECK_add) ? (uint8_t)(x + y) : (uint8_t)(x - y);
+
+		ok &= (swar_check_lane(result, i) == expected);
+	}
+	swar_check_result(kernel, ok, "lane", a, b, result);
+}
+
+/* Scalar decay of swar_decay(): v - ceil(|v| / 2^shift) with the sign of v               */
+static uint8_t swar_check_decay_lane(uint8_t lane, uint8_t shift)
+{
+	int v = (int8_t)lane;
+	int magnitude = abs(v);
+	int step = (magnitude + (1 << shift) - 1) >> shift;
+
+	magnitude -= step;
+	return (uint8_t)((v < 0) ? -magnitude : magnitude);
+}
+
+static void swar_check_unary(uint32_t word)
+{
+	uint32_t mask = swar_sign_mask(word);
+	uint32_t magnitude = swar_abs(word);
+	int maskOk = 1;
+	int absOk = 1;
+
+	for(uint8_t i=0;i<SWAR_CHECK_LANES;i++)
+	{
+		int v = (int8_t)swar_check_lane(word, i);
+
+		maskOk &= (swar_check_lane(mask, i) == ((v < 0) ? 0xFF : 0x00));
+		absOk &= (swar_check_lane(magnitude, i) == (uint8_t)abs(v));
+	}
+	swar_check_result(SWAR_CHECK_sign_mask, maskOk, "mask", word, 0, mask);
+	swar_check_result(SWAR_CHECK_abs, absOk, "abs", word, 0, magnitude);
+
+	for(uint8_t shift=1;shift<=7;shift++)
+	{
+		uint32_t decayed = swar_decay(word, shift);
+		int decayOk = 1;
+
+		for(uint8_t i=0;i<SWAR_CHECK_LANES;i++)
+		{
+			decayOk &= (swar_check_lane(decayed, i) == swar_check_decay_lane(swar_check_lane(word, i), shift));
+		}
+		swar_check_result(SWAR_CHECK_decay, decayOk, "decay", word, shift, decayed);
+	}
+
+	// swar_abs_max() looks at the x, y and z lanes only, the lowest axis wins a tie
+	uint8_t axis;
+	uint8_t largest = swar_abs_max(word, &axis);
+	uint8_t expected = 0;
+	uint8_t expectedAxis = XL_AXIS_X;
+
+	for(uint8_t i=XL_AXIS_X;i<XL_NUM_AXES;i++)
+	{
+		uint8_t lane = (uint8_t)abs((int8_t)swar_check_lane(word, i));
+
+		if((i == XL_AXIS_X) || (lane > expected))
+		{
+			expected = lane;
+			expectedAxis = i;
+		}
+	}
+	swar_check_result(SWAR_CHECK_abs_max, (largest == expected) && (axis == expectedAxis), "abs_max", word, axis,
+		largest);
+}
+
+/* swar_window_update() against the same window kept per axis                             */
+static void swar_check_window(uint16_t length, uint8_t shift)
+{
+	static uint32_t window[SWAR_CHECK_MAX_WINDOW];
+	static int8_t axes[SWAR_CHECK_MAX_WINDOW][XL_NUM_AXES];
+
+	for(uint16_t i=0;i<length;i++)
+	{
+		for(uint8_t a=0;a<XL_NUM_AXES;a++)
+		{
+			axes[i][a] = (int8_t)swar_check_random();
+		}
+		window[i] = swar_pack(axes[i]);
+	}
+
+	for(int step=0;step<SWAR_CHECK_WINDOW_STEPS;step++)
+	{
+		uint16_t index = (uint16_t)(swar_check_random() % length);
+		int8_t sample[XL_NUM_AXES];
+		int16_t sum[XL_NUM_AXES];
+		int expected[XL_NUM_AXES] = {0, 0, 0};
+		int ok = 1;
+
+		for(uint8_t a=0;a<XL_NUM_AXES;a++)
+		{
+			sample[a] = (int8_t)swar_check_random();
+		}
+		swar_window_update(window, length, index, swar_pack(sample), shift, sum);
+
+		for(uint16_t i=0;i<length;i++)
+		{
+			for(uint8_t a=0;a<XL_NUM_AXES;a++)
+			{
+				axes[i][a] = (i == index) ? sample[a] : (int8_t)swar_check_decay_lane((uint8_t)axes[i][a], shift);
+				expected[a] += axes[i][a];
+			}
+			ok &= (window[i] == swar_pack(axes[i]));
+		}
+		for(uint8_t a=0;a<XL_NUM_AXES;a++)
+		{
+			ok &= (sum[a] == expected[a]);
+		}
+		swar_check_result(SWAR_CHECK_window_update, ok, "window of length", length, shift, index);
+	}
+}
+
+int main(void)
+{
+	int errors = 0;
+
+	for(uint8_t lane=0;lane<SWAR_CHECK_LANES;lane++)
+	{
+		for(unsigned e=0;e<SWAR_CHECK_NUM_EDGES;e++)
+		{
+			for(unsigned x=0;x<=0xFF;x++)
+			{
+				uint32_t a = swar_check_word(lane, (uint8_t)x, swarCheckEdges[e]);
+
+				swar_check_unary(a);
+				for(unsigned f=0;f<SWAR_CHECK_NUM_EDGES;f++)
+				{
+					for(unsigned y=0;y<=0xFF;y++)
+					{
+						uint32_t b = swar_check_word(lane, (uint8_t)y, swarCheckEdges[f]);
+
+						swar_check_binary(SWAR_CHECK_add, a, b, swar_add(a, b));
+						swar_check_binary(SWAR_CHECK_sub, a, b, swar_sub(a, b));
+					}
+				}
+			}
+		}
+	}
+
+	// Windows from one sample up to the longest the kernel takes
+	const uint16_t lengths[] = {1, 2, 16, 64, SWAR_CHECK_MAX_WINDOW};
+
+	for(unsigned l=0;l<sizeof(lengths)/sizeof(lengths[0]);l++)
+	{
+		for(uint8_t shift=1;shift<=7;shift++)
+		{
+			swar_check_window(lengths[l], shift);
+		}
+	}
+
+	for(int k=0;k<SWAR_CHECK_NUM_KERNELS;k++)
+	{
+		printf("%s.checked %lu\n", swarCheckNames[k], swarChecked[k]);
+		printf("%s.errors %lu\n", swarCheckNames[k], swarErrors[k]);
+		errors |= (swarErrors[k] != 0);
+	}
+	return errors;
+}
@@ -0,0 +1,263 @@
+/**
+ ****************************************************************************************
+ *
+ * @file trace_decode.c
+ *
+ * @brief Decode the binary event trace written by the wand on UART2.
+ *
+ * Usage: trace_decode [capture.bin]   (reads stdin when no file is given)
+ *
+ * Trace frames are decoded into one line per event. Accelerometer capture chunks
+ * (CFG_CAPTURE) are skipped, Firmware/host/capture reads them. Other bytes, i.e. the
+ * arch_printf console when CFG_PRINTF is also defined, are passed through unchanged.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "user_trace_events.h"
+#include "user_capture_format.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+#define TRACE_MAX_FRAME_SIZE                (TRACE_HEADER_SIZE + (255 * TRACE_RECORD_SIZE) + 1)
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Decoder view of one entry of TRACE_EVENTS
+struct trace_event_desc
+{
+	uint8_t id;
+	const char *name;
+	const char *format;
+};
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+#define TRACE_EVENT_DESC(name, id, format)  {(id), #name, (format)},
+
+static const struct trace_event_desc traceEventTable[] =
+{
+	TRACE_EVENTS(TRACE_EVENT_DESC)
+};
+
+static unsigned long framesDecoded;
+static unsigned long framesBad;
+static unsigned long captureChunks;
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+static const struct trace_event_desc *trace_event_lookup(uint8_t id)
+{
+	for(size_t i=0;i<sizeof(traceEventTable)/sizeof(traceEventTable[0]);i++)
+	{
+		if(traceEventTable[i].id == id)
+		{
+			return &traceEventTable[i];
+		}
+	}
+	return NULL;
+}
+
+static void trace_print_record(const uint8_t *bytes)
+{
+	uint32_t timestamp = (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) |
+		((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+	uint8_t argA = bytes[5];
+	uint16_t argB = (uint16_t)(bytes[6] | (bytes[7] << 8));
+	const struct trace_event_desc *desc = trace_event_lookup(bytes[4]);
+	unsigned long long timeUs = ((unsigned long long)timestamp * TRACE_TICK_NS) / 1000;
+
+	printf("[%10llu.%03llu ms] ", timeUs / 1000, timeUs % 1000);
+	if(desc == NULL)
+	{
+		printf("unknown event 0x%02X (%u, %u)\n", bytes[4], argA, argB);
+		return;
+	}
+	if(desc->format[0] == '#')
+	{
+		// One 24-bit value split over both arguments
+		printf(&desc->format[1], ((unsigned long)argA << 16) | argB);
+	}
+	else
+	{
+		// Every format takes at most argA then argB, extra arguments are ignored
+		printf(desc->format, argA, argB);
+	}
+	printf("\n");
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Try to decode a frame at the start of buf
+ * @return bytes consumed, 0 when buf does not start with a valid frame, -1 when more
+ *         data is needed
+ ****************************************************************************************
+ */
+static long trace_decode_frame(const uint8_t *buf, size_t len)
+{
+	size_t frameSize;
+	uint8_t checksum = 0;
+
+	if(len < TRACE_HEADER_SIZE)
+	{
+		return -1;
+	}
+	if((buf[0] != TRACE_SYNC_0) || (buf[1] != TRACE_SYNC_1) || (buf[2] == 0))
+	{
+		return 0;
+	}
+	frameSize = TRACE_HEADER_SIZE + ((size_t)buf[2] * TRACE_RECORD_SIZE) + 1;
+	if(len < frameSize)
+	{
+		return -1;
+	}
+	for(size_t i=2;i<frameSize-1;i++)
+	{
+		checksum += buf[i];
+	}
+	if(checksum != buf[frameSize-1])
+	{
+		framesBad++;
+		return 0;
+	}
+
+	if(buf[3] != 0)
+	{
+		printf("[ %u events dropped, trace ring was full ]\n", buf[3]);
+	}
+	for(size_t i=0;i<buf[2];i++)
+	{
+		trace_print_record(&buf[TRACE_HEADER_SIZE + (i * TRACE_RECORD_SIZE)]);
+	}
+	framesDecoded++;
+	return (long)frameSize;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Try to skip a capture chunk at the start of buf
+ * @return bytes consumed, 0 when buf does not start with a valid chunk, -1 when more
+ *         data is needed
+ ****************************************************************************************
+ */
+static long trace_skip_capture_chunk(const uint8_t *buf, size_t len)
+{
+	size_t chunkSize;
+	uint8_t checksum = 0;
+
+	if(len < CAPTURE_CHUNK_HEADER_SIZE)
+	{
+		return -1;
+	}
+	if((buf[0] != CAPTURE_SYNC_0) || (buf[1] != CAPTURE_SYNC_1))
+	{
+		return 0;
+	}
+	chunkSize = CAPTURE_CHUNK_HEADER_SIZE + buf[3] + 1;
+	if(len < chunkSize)
+	{
+		return -1;
+	}
+	for(size_t i=2;i<chunkSize-1;i++)
+	{
+		checksum += buf[i];
+	}
+	if(checksum != buf[chunkSize-1])
+	{
+		return 0;
+	}
+	captureChunks++;
+	return (long)chunkSize;
+}
+
+int main(int argc, char **argv)
+{
+	static uint8_t buf[2 * TRACE_MAX_FRAME_SIZE];
+	size_t len = 0;
+	int eof = 0;
+	FILE *in = stdin;
+
+	if(argc > 2)
+	{
+		fprintf(stderr, "usage: %s [capture.bin]\n", argv[0]);
+		return 2;
+	}
+	if((argc == 2) && ((in = fopen(argv[1], "rb")) == NULL))
+	{
+		perror(argv[1]);
+		return 1;
+	}
+
+	while(!eof || (len > 0))
+	{
+		if(!eof && (len < sizeof(buf)))
+		{
+			size_t n = fread(&buf[len], 1, sizeof(buf) - len, in);
+
+			if(n == 0)
+			{
+				eof = 1;
+			}
+			len += n;
+		}
+
+		size_t pos = 0;
+		while(pos < len)
+		{
+			long consumed = trace_decode_frame(&buf[pos], len - pos);
+
+			if(consumed == 0)
+			{
+				consumed = trace_skip_capture_chunk(&buf[pos], len - pos);
+			}
+
+			if(consumed > 0)
+			{
+				pos += (size_t)consumed;
+			}
+			else if((consumed < 0) && !eof)
+			{
+				// Partial frame, wait for more input
+				break;
+			}
+			else
+			{
+				// Console text (or a broken frame) passes through byte by byte
+				if(buf[pos] != '\r')
+				{
+					putchar(buf[pos]);
+				}
+				pos++;
+			}
+		}
+		memmove(buf, &buf[pos], len - pos);
+		len -= pos;
+	}
+
+	if(in != stdin)
+	{
+		fclose(in);
+	}
+	fprintf(stderr, "%lu frames decoded, %lu bad frames, %lu capture chunks skipped\n", framesDecoded, framesBad, captureChunks);
+	return 0;
+}
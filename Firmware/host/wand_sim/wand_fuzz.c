@@ -0,0 +1,438 @@
+/**
+ ****************************************************************************************
+ *
+ * @file wand_fuzz.c
+ *
+ * @brief Property based fuzzing of the wand state machine.
+ *
+ * An input is a sequence of two-byte operations, an opcode and an argument, run
+ * against the simulator of wand_sim.c from power-up: button presses and bounces,
+ * connections, disconnections, parameter updates, motion, battery voltage, faults of
+ * the accelerometer bus and time, up to hours left alone. After the last operation the wand is left alone for
+ * WAND_FUZZ_TAIL_TICKS, long enough to go back to sleep. Every tick is checked against
+ * the invariants of wand_sim.h.
+ *
+ * Built with -fsanitize=fuzzer (make fuzz) it is a libFuzzer target that aborts on the
+ * first violation. Otherwise (make) it has its own driver:
+ *
+ *   wand_fuzz [-n runs] [-s seed] [-l length] [-o dir]   random inputs
+ *   wand_fuzz [-v] input...                              replay inputs, -v prints them
+ *
+ * Random runs save the first input that breaks each invariant as
+ * <dir>/crash-<invariant>.bin, to be replayed. The driver prints "key value" lines
+ * and exits with 1 when an invariant was broken.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "user_barebone.h"
+#include "user_xl_driver.h"
+#include "xl_bus.h"
+#include "wand_sim.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/* Quiet time after the last operation: the display reset timeout, twice                   */
+#define WAND_FUZZ_TAIL_TICKS                (2 * APP_GESTURE_RESET_DISPLAY_TO)
+
+/* Longest RUN_LONG, and longest button hold                                               */
+#define WAND_FUZZ_LONG_TICKS                (16)
+#define WAND_FUZZ_MAX_HOLD_TICKS            (32)
+
+/* Motion: period of a swing in ticks, and the rest value of gravity                       */
+#define WAND_FUZZ_SWING_PERIOD              (40)
+#define WAND_FUZZ_GRAVITY                   (64)
+
+/* Battery: VBAT_HIGH from below the protection cut-off to above the regulated 3.3V        */
+#define WAND_FUZZ_BATTERY_MIN_MV            (2800)
+#define WAND_FUZZ_BATTERY_STEP_MV           (4)
+
+#define WAND_FUZZ_DEFAULT_RUNS              (10000)
+#define WAND_FUZZ_DEFAULT_LENGTH            (64)
+
+/* Operation table. X(name, description of the argument)                                   */
+#define WAND_FUZZ_OPS(X)                                                                   \
+	X(RUN,              "ticks - 1")                                                       \
+	X(RUN_LONG,         "(ticks / WAND_FUZZ_LONG_TICKS) - 1")                              \
+	X(MOTION,           "axis, sign and strength of a repeated swing, 0 at rest")         \
+	X(PRESS,            "hold time in ticks")                                              \
+	X(BOUNCE,           "unused")                                                          \
+	X(CONNECT,          "bit 4 preferred parameters, low nibble 0xF not established")     \
+	X(DISCONNECT,       "unused")                                                          \
+	X(PARAM_UPDATE,     "bit 0 preferred parameters")                                     \
+	X(BATTERY,          "VBAT_HIGH in WAND_FUZZ_BATTERY_STEP_MV steps above the lowest")  \
+	X(XL_FAULT,         "bits 0-2 enum xl_bus_fault, bits 3-7 its clocks or bytes")        \
+	X(IDLE,             "periodic wake-ups - 1, put down, disconnected, bus working")
+
+#define WAND_FUZZ_OP_ENUM(name, argument)   WAND_FUZZ_OP_##name,
+#define WAND_FUZZ_OP_NAME(name, argument)   #name,
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+enum wand_fuzz_op
+{
+	WAND_FUZZ_OPS(WAND_FUZZ_OP_ENUM)
+	WAND_FUZZ_NUM_OPS
+};
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+static const char * const opNames[] = { WAND_FUZZ_OPS(WAND_FUZZ_OP_NAME) };
+
+// Swing of the MOTION operation in progress
+static uint8_t motionArg;
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+ /**
+ ****************************************************************************************
+ * @brief Repeated swing: bits 0-1 pick the axis (3 at rest), bit 2 the sign, bits 3-7
+ *        the peak; a triangle over half a period, at rest for the other half
+ ****************************************************************************************
+ */
+static void wand_fuzz_motion(uint64_t tick, int8_t *sample)
+{
+	unsigned axis = motionArg & 0x3;
+	int sign = (motionArg & 0x4) ? -1 : 1;
+	int peak = 8 + (motionArg >> 3) * 3;
+	unsigned phase = (unsigned)(tick % WAND_FUZZ_SWING_PERIOD);
+	int swing = 0;
+
+	if(phase < (WAND_FUZZ_SWING_PERIOD / 2))
+	{
+		unsigned half = WAND_FUZZ_SWING_PERIOD / 4;
+
+		swing = (phase < half) ? (int)((peak * phase) / half) : (int)((peak * ((2 * half) - phase)) / half);
+	}
+	sample[XL_AXIS_X] = 0;
+	sample[XL_AXIS_Y] = 0;
+	sample[XL_AXIS_Z] = WAND_FUZZ_GRAVITY;
+	if(axis < XL_NUM_AXES)
+	{
+		int value = sample[axis] + (sign * swing);
+
+		sample[axis] = (int8_t)((value > 127) ? 127 : ((value < -128) ? -128 : value));
+	}
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Run one input from power-up
+ * @param[in] verbose Print the operations to stderr
+ * @return Number of invariant violations
+ ****************************************************************************************
+ */
+static unsigned long wand_fuzz_run(const uint8_t *data, size_t size, bool verbose)
+{
+	const struct wand_sim_report *report;
+	unsigned long violations = 0;
+
+	wand_sim_boot();
+	wand_sim_set_verbose(verbose);
+	for(size_t i=0;i<size;i+=2)
+	{
+		enum wand_fuzz_op op = (enum wand_fuzz_op)(data[i] % WAND_FUZZ_NUM_OPS);
+		uint8_t arg = ((i + 1) < size) ? data[i + 1] : 0;
+
+		if(verbose)
+		{
+			fprintf(stderr, "%8llu0ms %s %u\n", (unsigned long long)wand_sim_get_report()->ticks, opNames[op], arg);
+		}
+		switch(op)
+		{
+			case WAND_FUZZ_OP_RUN:
+				wand_sim_run((uint32_t)arg + 1);
+				break;
+			case WAND_FUZZ_OP_RUN_LONG:
+				wand_sim_run(((uint32_t)arg + 1) * WAND_FUZZ_LONG_TICKS);
+				break;
+			case WAND_FUZZ_OP_MOTION:
+				motionArg = arg;
+				wand_sim_set_motion(wand_fuzz_motion);
+				break;
+			case WAND_FUZZ_OP_PRESS:
+				wand_sim_button(true);
+				wand_sim_run((arg % WAND_FUZZ_MAX_HOLD_TICKS) + 1);
+				wand_sim_button(false);
+				break;
+			case WAND_FUZZ_OP_BOUNCE:
+				wand_sim_bounce();
+				break;
+			case WAND_FUZZ_OP_CONNECT:
+				wand_sim_connect((arg & 0x0F) != 0x0F, (arg & 0x10) != 0);
+				break;
+			case WAND_FUZZ_OP_DISCONNECT:
+				wand_sim_disconnect();
+				break;
+			case WAND_FUZZ_OP_PARAM_UPDATE:
+				wand_sim_param_update((arg & 0x01) != 0);
+				break;
+			case WAND_FUZZ_OP_BATTERY:
+				wand_sim_set_battery(WAND_FUZZ_BATTERY_MIN_MV + (arg * WAND_FUZZ_BATTERY_STEP_MV));
+				break;
+			case WAND_FUZZ_OP_XL_FAULT:
+				wand_sim_set_xl_fault(arg & 0x07, arg >> 3);
+				break;
+			case WAND_FUZZ_OP_IDLE:
+				// The central goes away and the bus works, or the wand would stay connected,
+				// or gesture on the sample a bus fault holds, and tick for hours
+				wand_sim_set_motion(NULL);
+				wand_sim_disconnect();
+				wand_sim_set_xl_fault(XL_BUS_FAULT_NONE, 0);
+				wand_sim_run(((uint32_t)arg + 1) * WAND_SIM_EXT_WAKEUP_TICKS);
+				break;
+			default:
+				break;
+		}
+	}
+	wand_sim_set_motion(NULL);
+	wand_sim_run(WAND_FUZZ_TAIL_TICKS);
+
+	report = wand_sim_get_report();
+	for(int i=0;i<WAND_SIM_NUM_INVARIANTS;i++)
+	{
+		violations += report->violations[i];
+	}
+	return violations;
+}
+
+#if defined (WAND_FUZZ_LIBFUZZER)
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	if(wand_fuzz_run(data, size, false) > 0)
+	{
+		const struct wand_sim_report *report = wand_sim_get_report();
+
+		for(int i=0;i<WAND_SIM_NUM_INVARIANTS;i++)
+		{
+			if(report->violations[i] > 0)
+			{
+				fprintf(stderr, "%s at %llu0ms: %s\n", wand_sim_invariant_name((enum wand_sim_invariant)i),
+					(unsigned long long)report->firstTick[i], wand_sim_invariant_description((enum wand_sim_invariant)i));
+			}
+		}
+		abort();
+	}
+	return 0;
+}
+
+#else
+
+static uint32_t wand_fuzz_random(uint32_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+static int wand_fuzz_save(const char *dir, const char *name, const uint8_t *data, size_t size)
+{
+	char path[256];
+	FILE *file;
+
+	snprintf(path, sizeof(path), "%s/crash-%s.bin", dir, name);
+	file = fopen(path, "wb");
+	if(file == NULL)
+	{
+		perror(path);
+		return -1;
+	}
+	fwrite(data, 1, size, file);
+	fclose(file);
+	return 0;
+}
+
+static int wand_fuzz_replay(const char *path, bool verbose, unsigned long *violations)
+{
+	FILE *file = fopen(path, "rb");
+	uint8_t *data;
+	long size;
+
+	if(file == NULL)
+	{
+		perror(path);
+		return -1;
+	}
+	fseek(file, 0, SEEK_END);
+	size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	data = malloc((size > 0) ? (size_t)size : 1);
+	if((data == NULL) || (fread(data, 1, (size_t)size, file) != (size_t)size))
+	{
+		fprintf(stderr, "%s: read error\n", path);
+		free(data);
+		fclose(file);
+		return -1;
+	}
+	fclose(file);
+	if(verbose)
+	{
+		fprintf(stderr, "%s:\n", path);
+	}
+	wand_fuzz_run(data, (size_t)size, verbose);
+	for(int i=0;i<WAND_SIM_NUM_INVARIANTS;i++)
+	{
+		violations[i] += wand_sim_get_report()->violations[i];
+	}
+	free(data);
+	return 0;
+}
+
+static void wand_fuzz_usage(void)
+{
+	fprintf(stderr, "usage: wand_fuzz [-n runs] [-s seed] [-l length] [-o dir]\n"
+		"       wand_fuzz [-v] input...\n");
+}
+
+int main(int argc, char **argv)
+{
+	unsigned long runs = WAND_FUZZ_DEFAULT_RUNS;
+	uint32_t seed = 1;
+	size_t maxLength = WAND_FUZZ_DEFAULT_LENGTH;
+	const char *dir = ".";
+	bool verbose = false;
+	unsigned long violations[WAND_SIM_NUM_INVARIANTS] = {0};
+	unsigned long failedRuns = 0;
+	unsigned long long ticks = 0;
+	unsigned long hibernations = 0;
+	unsigned maxTimers = 0;
+	unsigned maxMessages = 0;
+	unsigned long maxBusUs = 0;
+	unsigned long inputs = 0;
+	bool broken = false;
+	int arg;
+
+	for(arg=1;(arg<argc) && (argv[arg][0]=='-');arg++)
+	{
+		if((strcmp(argv[arg], "-v") == 0))
+		{
+			verbose = true;
+		}
+		else if(((arg + 1) < argc) && (strcmp(argv[arg], "-n") == 0))
+		{
+			runs = strtoul(argv[++arg], NULL, 0);
+		}
+		else if(((arg + 1) < argc) && (strcmp(argv[arg], "-s") == 0))
+		{
+			seed = (uint32_t)strtoul(argv[++arg], NULL, 0);
+		}
+		else if(((arg + 1) < argc) && (strcmp(argv[arg], "-l") == 0))
+		{
+			maxLength = strtoul(argv[++arg], NULL, 0);
+		}
+		else if(((arg + 1) < argc) && (strcmp(argv[arg], "-o") == 0))
+		{
+			dir = argv[++arg];
+		}
+		else
+		{
+			wand_fuzz_usage();
+			return 2;
+		}
+	}
+	if((seed == 0) || (maxLength == 0))
+	{
+		wand_fuzz_usage();
+		return 2;
+	}
+
+	if(arg < argc)
+	{
+		for(;arg<argc;arg++)
+		{
+			if(wand_fuzz_replay(argv[arg], verbose, violations) != 0)
+			{
+				return 2;
+			}
+			inputs++;
+		}
+	}
+	else
+	{
+		uint8_t *data = malloc(maxLength);
+
+		if(data == NULL)
+		{
+			return 2;
+		}
+		for(unsigned long run=0;run<runs;run++)
+		{
+			size_t size = 1 + (wand_fuzz_random(&seed) % maxLength);
+			const struct wand_sim_report *report;
+
+			for(size_t i=0;i<size;i++)
+			{
+				data[i] = (uint8_t)wand_fuzz_random(&seed);
+			}
+			if(wand_fuzz_run(data, size, false) > 0)
+			{
+				failedRuns++;
+			}
+			report = wand_sim_get_report();
+			ticks += report->ticks;
+			hibernations += report->hibernations;
+			if(report->maxTimersInUse > maxTimers)
+			{
+				maxTimers = report->maxTimersInUse;
+			}
+			if(report->maxTickMessages > maxMessages)
+			{
+				maxMessages = report->maxTickMessages;
+			}
+			if(report->maxTickBusUs > maxBusUs)
+			{
+				maxBusUs = report->maxTickBusUs;
+			}
+			for(int i=0;i<WAND_SIM_NUM_INVARIANTS;i++)
+			{
+				if((report->violations[i] > 0) && (violations[i] == 0))
+				{
+					wand_fuzz_save(dir, wand_sim_invariant_name((enum wand_sim_invariant)i), data, size);
+				}
+				violations[i] += report->violations[i];
+			}
+			inputs++;
+		}
+		free(data);
+		printf("fuzz.failed_runs %lu\n", failedRuns);
+		printf("fuzz.ticks %llu\n", ticks);
+		printf("fuzz.hibernations %lu\n", hibernations);
+		printf("fuzz.max_timers_in_use %u\n", maxTimers);
+		printf("fuzz.max_tick_messages %u\n", maxMessages);
+		printf("fuzz.max_tick_bus_us %lu\n", maxBusUs);
+	}
+
+	printf("fuzz.inputs %lu\n", inputs);
+	for(int i=0;i<WAND_SIM_NUM_INVARIANTS;i++)
+	{
+		printf("invariant.%s %lu\n", wand_sim_invariant_name((enum wand_sim_invariant)i), violations[i]);
+		broken |= (violations[i] > 0);
+	}
+	return broken ? 1 : 0;
+}
+
+#endif // WAND_FUZZ_LIBFUZZER
@@ -0,0 +1,799 @@
+/**
+ ****************************************************************************************
+ *
+ * @file wand_sim.c
+ *
+ * @brief Simulator of the wand application in virtual time.
+ *
+ * The SDK model follows SDK 6.0.14 where the application can tell the difference:
+ * - app_easy_gap_advertise_stop() completes the advertising operation with
+ *   GAP_ERR_CANCELED, delivered as a kernel message to user_app_adv_undirect_complete(),
+ * - a connection ends advertising; user_app_connection() runs first, then the
+ *   advertising operation completes with GAP_ERR_NO_ERROR,
+ * - starting advertising while it runs or while a link is up completes at once with
+ *   GAP_ERR_COMMAND_DISALLOWED,
+ * - the wake-up interrupt calls its callback directly, as the ISR does,
+ * - kernel timers keep running in extended sleep, as the BLE core wakes the system
+ *   for them,
+ * - with external wake-up and no kernel timer, the BLE core still wakes the system
+ *   every CFG_MAX_SLEEP_DURATION_EXTERNAL_WAKEUP_MS and the main loop runs.
+ *
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "app_easy_timer.h"
+#include "arch_api.h"
+#include "arch_system.h"
+#include "app.h"
+#include "app_task.h"
+#include "gpio.h"
+#include "timer0.h"
+#include "timer0_2.h"
+#include "wkupct_quadec.h"
+#if defined (CFG_HIBERNATION)
+#include "arch_hibernation.h"
+#endif
+#include "user_barebone.h"
+#include "user_battery.h"
+#include "user_haptic.h"
+#include "user_periph_setup.h"
+#include "user_xl_driver.h"
+#include "xl_bus.h"
+#include "wand_sim.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+#define WAND_SIM_NUM_PINS                   (12)
+
+/* Parameter of the connection message                                                      */
+#define WAND_SIM_CONNECTION_ESTABLISHED     (0x01)
+#define WAND_SIM_CONNECTION_PREFERRED       (0x02)
+
+/* Connection parameters in and out of user_connection_param_conf                          */
+#define WAND_SIM_PREFERRED_INTERVAL         (12)    // 15ms
+#define WAND_SIM_OTHER_INTERVAL             (36)    // 45ms
+
+#define WAND_SIM_INVARIANT_NAME(name, description) #name,
+#define WAND_SIM_INVARIANT_DESCRIPTION(name, description) description,
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// State of the SDK and the board around the application
+struct wand_sim_state
+{
+	bool pinLevel[WAND_SIM_NUM_PINS];
+	GPIO_FUNCTION pinFunction[WAND_SIM_NUM_PINS];
+	bool timer0Running;
+	bool timer0Clock;
+	/// VBAT_HIGH the ADC measures
+	uint16_t batteryMv;
+	/// Time the application waited in arch_asm_delay_us() this tick
+	unsigned long tickDelayUs;
+	bool buttonPressed;
+	sleep_state_t sleepMode;
+	bool extWakeup;
+	uint64_t asleepSince;
+	/// Powered down by arch_set_hibernation(), nothing runs any more
+	bool hibernated;
+	wakeup_handler_function_t wakeupCallback;
+	bool wakeupEnabled;
+	bool advertising;
+	/// A link is up in the stack; the application task may not have been told yet
+	bool connected;
+	/// app_easy_gap_undirected_advertise_get_active() was called since the last start
+	bool advCmdActive;
+	struct gapm_start_advertise_cmd advCmd;
+	ke_state_t appState;
+	wand_sim_motion_t motion;
+	/// Stack messages the application caused, the central's own are not counted
+	unsigned long postedMessages;
+	bool verbose;
+};
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+struct app_env_tag app_env[APP_EASY_MAX_ACTIVE_CONNECTION];
+
+static struct wand_sim_state sim;
+static struct wand_sim_report report;
+
+static const char * const invariantNames[] = { WAND_SIM_INVARIANTS(WAND_SIM_INVARIANT_NAME) };
+static const char * const invariantDescriptions[] = { WAND_SIM_INVARIANTS(WAND_SIM_INVARIANT_DESCRIPTION) };
+
+// Variables of user_barebone.c, set to their initial values at every boot
+extern bool buttonActive;
+// Retained state of user_haptic.c, for the pulse or gap timer
+extern struct haptic_retained hapticRetained;
+// Retained state of user_xl_driver.c, zero at power-up
+extern struct xl_retained xlRetained;
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+*/
+
+static void wand_sim_violation(enum wand_sim_invariant invariant, const char *detail)
+{
+	if(report.violations[invariant]++ == 0)
+	{
+		report.firstTick[invariant] = app_easy_timer_sim_now();
+	}
+	if(sim.verbose)
+	{
+		fprintf(stderr, "%8llu0ms %s: %s%s%s\n", (unsigned long long)app_easy_timer_sim_now(),
+			invariantNames[invariant], invariantDescriptions[invariant], detail ? ", " : "", detail ? detail : "");
+	}
+}
+
+static void wand_sim_adv_complete_msg(uint32_t status)
+{
+	sim.postedMessages++;
+	user_app_adv_undirect_complete((uint8_t)status);
+}
+
+static void wand_sim_central_adv_complete_msg(uint32_t status)
+{
+	user_app_adv_undirect_complete((uint8_t)status);
+}
+
+static void wand_sim_default_adv_msg(uint32_t param)
+{
+	sim.postedMessages++;
+	user_app_adv_start();
+}
+
+static void wand_sim_connection_msg(uint32_t flags)
+{
+	struct gapc_connection_req_ind param;
+
+	app_env[0].conidx = (flags & WAND_SIM_CONNECTION_ESTABLISHED) ? 0 : GAP_INVALID_CONIDX;
+	memset(&param, 0, sizeof(param));
+	param.con_interval = (flags & WAND_SIM_CONNECTION_PREFERRED) ? WAND_SIM_PREFERRED_INTERVAL : WAND_SIM_OTHER_INTERVAL;
+	param.con_latency = user_connection_param_conf.latency;
+	param.sup_to = user_connection_param_conf.time_out;
+	user_app_connection(0, &param);
+}
+
+static void wand_sim_disconnect_msg(uint32_t param)
+{
+	struct gapc_disconnect_ind ind;
+
+	sim.appState = APP_CONNECTABLE;
+	app_env[0].conidx = GAP_INVALID_CONIDX;
+	memset(&ind, 0, sizeof(ind));
+	ind.reason = 0x13;
+	user_app_disconnect(&ind);
+}
+
+static void wand_sim_param_updated_msg(uint32_t preferred)
+{
+	struct gapc_param_updated_ind ind;
+
+	ind.con_interval = preferred ? WAND_SIM_PREFERRED_INTERVAL : WAND_SIM_OTHER_INTERVAL;
+	ind.con_latency = user_connection_param_conf.latency;
+	ind.sup_to = user_connection_param_conf.time_out;
+	user_catch_rest_hndl(GAPC_PARAM_UPDATED_IND, &ind, TASK_APP, 0);
+}
+
+static bool wand_sim_handle_is_used(timer_hnd handle)
+{
+	return (handle == appRetained.app_adv_data_update_timer_used) || (handle == appRetained.app_param_update_request_timer_used) ||
+		(handle == hapticRetained.timer);
+}
+
+static unsigned wand_sim_running_timers(void)
+{
+	unsigned running = 0;
+
+	for(timer_hnd handle=1;handle<=APP_TIMER_MAX_NUM;handle++)
+	{
+		running += app_easy_timer_sim_running(handle) ? 1 : 0;
+	}
+	return running;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Ticks the system sleeps through from now on: with external wake-up, no timer
+ *        and no advertising, until the next periodic wake-up of the BLE core
+ ****************************************************************************************
+ */
+static uint32_t wand_sim_sleep_ticks(void)
+{
+	uint64_t asleep = app_easy_timer_sim_now() - sim.asleepSince;
+
+	if(!sim.extWakeup || sim.advertising || (wand_sim_running_timers() > 0) ||
+		((asleep > 0) && ((asleep % WAND_SIM_EXT_WAKEUP_TICKS) == 0)))
+	{
+		return 0;
+	}
+	return WAND_SIM_EXT_WAKEUP_TICKS - (uint32_t)(asleep % WAND_SIM_EXT_WAKEUP_TICKS);
+}
+
+ /**
+ ****************************************************************************************
+ * @brief Check the invariants at the end of a tick
+ * @param[in] before Timer statistics at the start of the tick
+ * @param[in] busBefore Bus statistics at the start of the tick
+ * @param[in] postedBefore Stack messages handled before the tick
+ ****************************************************************************************
+ */
+static void wand_sim_check_tick(const struct app_easy_timer_sim_stats *before, const struct xl_bus_stats *busBefore,
+	unsigned long postedBefore)
+{
+	struct app_easy_timer_sim_stats after;
+	struct xl_bus_stats bus;
+	unsigned long messages;
+	unsigned long busUs;
+	unsigned running = 0;
+	char detail[64];
+
+	app_easy_timer_sim_get_stats(&after);
+	xl_bus_get_stats(&bus);
+
+	if(after.poolExhausted != before->poolExhausted)
+	{
+		wand_sim_violation(WAND_SIM_TIMER_POOL, NULL);
+	}
+	if((after.staleCancels != before->staleCancels) || (after.staleModifies != before->staleModifies) ||
+		(after.badDelays != before->badDelays))
+	{
+		wand_sim_violation(WAND_SIM_TIMER_STALE, NULL);
+	}
+	for(timer_hnd handle=1;handle<=APP_TIMER_MAX_NUM;handle++)
+	{
+		if(!app_easy_timer_sim_running(handle))
+		{
+			continue;
+		}
+		running++;
+		if(!wand_sim_handle_is_used(handle))
+		{
+			snprintf(detail, sizeof(detail), "handle %u", handle);
+			wand_sim_violation(WAND_SIM_TIMER_ORPHAN, detail);
+		}
+	}
+
+	if(sim.extWakeup && ((app_easy_timer_sim_now() - sim.asleepSince) > WAND_SIM_SETTLE_TICKS))
+	{
+		if(running > 0)
+		{
+			snprintf(detail, sizeof(detail), "%u running", running);
+			wand_sim_violation(WAND_SIM_TIMER_ASLEEP, detail);
+		}
+		if(sim.advertising)
+		{
+			wand_sim_violation(WAND_SIM_ADV_ASLEEP, NULL);
+		}
+	}
+	if(bus.sleepingReads != busBefore->sleepingReads)
+	{
+		wand_sim_violation(WAND_SIM_READ_ASLEEP, NULL);
+	}
+#if defined (CFG_HIBERNATION)
+	if(sim.extWakeup && ((app_easy_timer_sim_now() - sim.asleepSince) > (APP_HIBERNATE_TO + WAND_SIM_EXT_WAKEUP_TICKS)))
+	{
+		wand_sim_violation(WAND_SIM_HIBERNATE, "late");
+	}
+#endif
+
+	busUs = (bus.busTimeUs - busBefore->busTimeUs) + sim.tickDelayUs;
+	if(busUs > WAND_SIM_TICK_MAX_BUS_US)
+	{
+		snprintf(detail, sizeof(detail), "%luus", busUs);
+		wand_sim_violation(WAND_SIM_TICK_BUS, detail);
+	}
+	if((bus.sampleReads - busBefore->sampleReads) > 1)
+	{
+		snprintf(detail, sizeof(detail), "%lu reads", bus.sampleReads - busBefore->sampleReads);
+		wand_sim_violation(WAND_SIM_TICK_READS, detail);
+	}
+	messages = (after.fired - before->fired) + (after.cancelled - before->cancelled) +
+		(after.droppedExpiries - before->droppedExpiries) + (sim.postedMessages - postedBefore);
+	if(messages > WAND_SIM_TICK_MAX_MESSAGES)
+	{
+		snprintf(detail, sizeof(detail), "%lu messages", messages);
+		wand_sim_violation(WAND_SIM_TICK_MESSAGES, detail);
+	}
+
+	if(messages > report.maxTickMessages)
+	{
+		report.maxTickMessages = (unsigned)messages;
+	}
+	if(busUs > report.maxTickBusUs)
+	{
+		report.maxTickBusUs = busUs;
+	}
+	if(after.maxInUse > report.maxTimersInUse)
+	{
+		report.maxTimersInUse = after.maxInUse;
+	}
+	report.sampleReads = bus.sampleReads;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief The SDK main loop once the kernel is idle: app_on_system_powered until it
+ *        returns GOTO_SLEEP, then app_validate_sleep
+ ****************************************************************************************
+ */
+static void wand_sim_main_loop(void)
+{
+	for(unsigned pass=0;pass<WAND_SIM_MAX_MAIN_LOOP_PASSES;pass++)
+	{
+		if(user_app_on_system_powered() == GOTO_SLEEP)
+		{
+			break;
+		}
+	}
+	if(work_pending() && (user_app_validate_sleep(mode_ext_sleep) != mode_active))
+	{
+		wand_sim_violation(WAND_SIM_WORK_SLEEP, NULL);
+	}
+}
+
+ /**
+ ****************************************************************************************
+ * @brief The wand at rest, face up
+ ****************************************************************************************
+ */
+static void wand_sim_rest(uint64_t tick, int8_t *sample)
+{
+	sample[XL_AXIS_X] = 0;
+	sample[XL_AXIS_Y] = 0;
+	sample[XL_AXIS_Z] = 64;
+}
+
+void wand_sim_boot(void)
+{
+	app_easy_timer_sim_reset();
+	xl_bus_reset();
+	memset(&sim, 0, sizeof(sim));
+	memset(&report, 0, sizeof(report));
+	memset(app_env, 0, sizeof(app_env));
+	app_env[0].conidx = GAP_INVALID_CONIDX;
+	sim.pinLevel[GPIO_BUTTON_PIN] = true;
+	sim.sleepMode = app_default_sleep_mode;
+	sim.motion = wand_sim_rest;
+	sim.batteryMv = WAND_SIM_BATTERY_MV;
+
+	// Initialisers of user_barebone.c; the retained variables are zeroed
+	buttonActive = false;
+	memset(&appRetained, 0, sizeof(appRetained));
+	hapticRetained.timer = EASY_TIMER_INVALID_TIMER;
+	memset(&xlRetained, 0, sizeof(xlRetained));
+
+	// periph_init()
+	i2c_XL_Session_Reset();
+	sim.appState = APP_DB_INIT;
+	user_app_init();
+	// The database is ready: the SDK runs default_operation_adv, user_app_adv_start()
+	sim.appState = APP_CONNECTABLE;
+	app_easy_timer_sim_post(wand_sim_default_adv_msg, 0);
+}
+
+void wand_sim_set_verbose(bool verbose)
+{
+	sim.verbose = verbose;
+}
+
+void wand_sim_set_motion(wand_sim_motion_t motion)
+{
+	sim.motion = (motion != NULL) ? motion : wand_sim_rest;
+}
+
+void wand_sim_set_battery(uint16_t mv)
+{
+	sim.batteryMv = mv;
+}
+
+void wand_sim_set_xl_fault(uint8_t fault, uint8_t clocks)
+{
+	xl_bus_set_fault((enum xl_bus_fault)(fault % XL_BUS_NUM_FAULTS), clocks);
+}
+
+void wand_sim_run(uint32_t ticks)
+{
+	for(uint32_t i=0;i<ticks;i++)
+	{
+		struct app_easy_timer_sim_stats before;
+		struct xl_bus_stats busBefore;
+		unsigned long postedBefore = sim.postedMessages;
+		uint64_t now = app_easy_timer_sim_now();
+		uint32_t sleep = wand_sim_sleep_ticks();
+		int8_t sample[XL_NUM_AXES];
+
+		if(sim.hibernated)
+		{
+			report.ticks += ticks - i;
+			return;
+		}
+		if(sleep > 0)
+		{
+			// Nothing runs until the periodic wake-up, the tick of which runs below
+			sleep = (sleep < (ticks - i)) ? sleep : (ticks - i);
+			app_easy_timer_sim_run_until(now + sleep);
+			report.ticks += sleep;
+			i += sleep - 1;
+			continue;
+		}
+		app_easy_timer_sim_get_stats(&before);
+		xl_bus_get_stats(&busBefore);
+		sim.tickDelayUs = 0;
+		sim.motion(now, sample);
+		xl_bus_set_sample(sample);
+		app_easy_timer_sim_run_until(now + 1);
+		wand_sim_main_loop();
+		report.ticks++;
+		wand_sim_check_tick(&before, &busBefore, postedBefore);
+	}
+}
+
+void wand_sim_button(bool pressed)
+{
+	sim.buttonPressed = pressed;
+	sim.pinLevel[GPIO_BUTTON_PIN] = !pressed;
+	if(pressed && sim.wakeupEnabled && (sim.wakeupCallback != NULL))
+	{
+		sim.wakeupCallback();
+	}
+}
+
+void wand_sim_bounce(void)
+{
+	if(sim.wakeupEnabled && (sim.wakeupCallback != NULL))
+	{
+		sim.wakeupCallback();
+	}
+}
+
+bool wand_sim_connect(bool established, bool preferred)
+{
+	if(!sim.advertising)
+	{
+		return false;
+	}
+	sim.advertising = false;
+	sim.connected = established;
+	app_easy_timer_sim_post(wand_sim_connection_msg, (established ? WAND_SIM_CONNECTION_ESTABLISHED : 0) |
+		(preferred ? WAND_SIM_CONNECTION_PREFERRED : 0));
+	app_easy_timer_sim_post(wand_sim_central_adv_complete_msg, GAP_ERR_NO_ERROR);
+	return true;
+}
+
+bool wand_sim_disconnect(void)
+{
+	if(!sim.connected)
+	{
+		return false;
+	}
+	sim.connected = false;
+	app_easy_timer_sim_post(wand_sim_disconnect_msg, 0);
+	return true;
+}
+
+bool wand_sim_param_update(bool preferred)
+{
+	if(!sim.connected)
+	{
+		return false;
+	}
+	app_easy_timer_sim_post(wand_sim_param_updated_msg, preferred);
+	return true;
+}
+
+const struct wand_sim_report *wand_sim_get_report(void)
+{
+	return &report;
+}
+
+const char *wand_sim_invariant_name(enum wand_sim_invariant invariant)
+{
+	return invariantNames[invariant];
+}
+
+const char *wand_sim_invariant_description(enum wand_sim_invariant invariant)
+{
+	return invariantDescriptions[invariant];
+}
+
+/*
+ * SDK FUNCTIONS
+ ****************************************************************************************
+ */
+
+void assert_warning(const char *condition, const char *file, int line)
+{
+	char detail[64];
+
+	snprintf(detail, sizeof(detail), "%.40s:%d", file, line);
+	wand_sim_violation(WAND_SIM_ASSERT, detail);
+}
+
+uint32_t lld_evt_time_get(void)
+{
+	// 16 BLE slots per 10ms tick
+	return (uint32_t)(app_easy_timer_sim_now() * 16) & 0x07FFFFFF;
+}
+
+ /**
+ ****************************************************************************************
+ * @brief The motor pad drives the motor: a GPIO high or the running Timer0 PWM
+ ****************************************************************************************
+ */
+static bool wand_sim_motor_on(void)
+{
+	if(sim.pinFunction[MOTOR_PIN] == PID_PWM0)
+	{
+		return sim.timer0Running;
+	}
+	return sim.pinLevel[MOTOR_PIN];
+}
+
+ /**
+ ****************************************************************************************
+ * @brief The motor pad or Timer0 changed
+ ****************************************************************************************
+ */
+static void wand_sim_motor_check(void)
+{
+	if(wand_sim_motor_on() && (battery_current()->haptic == 0))
+	{
+		wand_sim_violation(WAND_SIM_MOTOR_BATTERY, NULL);
+	}
+}
+
+ /**
+ ****************************************************************************************
+ * @brief The pad is SCL or SDA of the accelerometer bus
+ ****************************************************************************************
+ */
+static bool wand_sim_i2c_pin(GPIO_PIN pin)
+{
+	return (pin == I2C_SCL_PIN) || (pin == I2C_SDA_PIN);
+}
+
+void GPIO_SetActive(GPIO_PORT port, GPIO_PIN pin)
+{
+	sim.pinLevel[pin] = true;
+	wand_sim_motor_check();
+}
+
+void GPIO_SetInactive(GPIO_PORT port, GPIO_PIN pin)
+{
+	sim.pinLevel[pin] = false;
+}
+
+bool GPIO_GetPinStatus(GPIO_PORT port, GPIO_PIN pin)
+{
+	if(wand_sim_i2c_pin(pin))
+	{
+		return xl_bus_get_line(pin == I2C_SCL_PIN);
+	}
+	return sim.pinLevel[pin];
+}
+
+void GPIO_ConfigurePin(GPIO_PORT port, GPIO_PIN pin, GPIO_PUPD mode, GPIO_FUNCTION function, const bool high)
+{
+	sim.pinFunction[pin] = function;
+	if(wand_sim_i2c_pin(pin))
+	{
+		// Open drain: the pad only pulls its line low as a GPIO output driven low
+		xl_bus_drive_line(pin == I2C_SCL_PIN, (function == PID_GPIO) && (mode == OUTPUT) && !high);
+		return;
+	}
+	if(function == PID_GPIO)
+	{
+		sim.pinLevel[pin] = high;
+	}
+	wand_sim_motor_check();
+}
+
+void timer0_2_clk_enable(void)
+{
+	sim.timer0Clock = true;
+}
+
+void timer0_2_clk_disable(void)
+{
+	if(!sim.timer0Clock)
+	{
+		wand_sim_violation(WAND_SIM_PWM_STALE, "clock");
+	}
+	sim.timer0Clock = false;
+}
+
+void timer0_2_clk_div_set(tim0_2_clk_div_config_t *clk_div_config)
+{
+}
+
+void timer0_init(TIM0_CLK_SEL_t tim_clk_src, PWM_MODE_t pwm_mode, TIM0_CLK_DIV_t tim_clk_div)
+{
+}
+
+void timer0_set(uint16_t pwm_on, uint16_t pwm_high, uint16_t pwm_low)
+{
+}
+
+void timer0_start(void)
+{
+	sim.timer0Running = true;
+	wand_sim_motor_check();
+}
+
+void timer0_stop(void)
+{
+	if(!sim.timer0Running)
+	{
+		wand_sim_violation(WAND_SIM_PWM_STALE, "timer");
+	}
+	sim.timer0Running = false;
+}
+
+void arch_asm_delay_us(uint32_t nof_us)
+{
+	sim.tickDelayUs += nof_us;
+}
+
+uint16_t battery_get_voltage(void)
+{
+	return sim.batteryMv;
+}
+
+void arch_set_sleep_mode(sleep_state_t sleep_state)
+{
+	sim.sleepMode = sleep_state;
+}
+
+sleep_state_t arch_get_sleep_mode(void)
+{
+	return sim.sleepMode;
+}
+
+void arch_ble_ext_wakeup_on(void)
+{
+	if(wand_sim_motor_on() || sim.connected)
+	{
+		wand_sim_violation(WAND_SIM_SLEEP_BUSY, wand_sim_motor_on() ? "motor on" : "connected");
+	}
+	if(!sim.extWakeup)
+	{
+		report.sleeps++;
+		sim.asleepSince = app_easy_timer_sim_now();
+	}
+	sim.extWakeup = true;
+}
+
+#if defined (CFG_HIBERNATION)
+void arch_set_hibernation(uint8_t wkup_mask, pd_sys_down_ram_t ram1, pd_sys_down_ram_t ram2, pd_sys_down_ram_t ram3,
+	remap_addr0_t remap_addr0, bool pad_latch_en)
+{
+	char detail[64];
+
+	if(!sim.extWakeup || ((app_easy_timer_sim_now() - sim.asleepSince) < APP_HIBERNATE_TO))
+	{
+		wand_sim_violation(WAND_SIM_HIBERNATE, "early");
+	}
+	if((wand_sim_running_timers() > 0) || sim.advertising || sim.wakeupEnabled)
+	{
+		snprintf(detail, sizeof(detail), "%u timers%s%s", wand_sim_running_timers(), sim.advertising ? ", advertising" : "",
+			sim.wakeupEnabled ? ", button wake-up" : "");
+		wand_sim_violation(WAND_SIM_HIBERNATE, detail);
+	}
+	report.hibernations++;
+	sim.hibernated = true;
+}
+#endif
+
+void arch_ble_ext_wakeup_off(void)
+{
+	if(sim.extWakeup)
+	{
+		report.wakes++;
+	}
+	sim.extWakeup = false;
+}
+
+bool arch_ble_ext_wakeup_get(void)
+{
+	return sim.extWakeup;
+}
+
+bool arch_ble_force_wakeup(void)
+{
+	return true;
+}
+
+void wkupct_enable_irq(uint32_t sel_pins, uint32_t pol_pins, uint16_t events_num, uint16_t deb_time)
+{
+	sim.wakeupEnabled = (sel_pins & WKUPCT_PIN_SELECT(GPIO_BUTTON_PORT, GPIO_BUTTON_PIN)) != 0;
+}
+
+void wkupct_disable_irq(void)
+{
+	sim.wakeupEnabled = false;
+}
+
+void wkupct_register_callback(wakeup_handler_function_t callback)
+{
+	sim.wakeupCallback = callback;
+}
+
+ke_state_t ke_state_get(ke_task_id_t const id)
+{
+	return sim.appState;
+}
+
+void default_app_on_init(void)
+{
+}
+
+void default_app_on_connection(uint8_t conidx, struct gapc_connection_req_ind const *param)
+{
+	if(app_env[conidx].conidx != GAP_INVALID_CONIDX)
+	{
+		sim.appState = APP_CONNECTED;
+		report.connections++;
+	}
+}
+
+struct gapm_start_advertise_cmd *app_easy_gap_undirected_advertise_get_active(void)
+{
+	if(!sim.advCmdActive)
+	{
+		memset(&sim.advCmd, 0, sizeof(sim.advCmd));
+		memcpy(sim.advCmd.info.host.adv_data, USER_ADVERTISE_DATA, USER_ADVERTISE_DATA_LEN);
+		sim.advCmd.info.host.adv_data_len = USER_ADVERTISE_DATA_LEN;
+		memcpy(sim.advCmd.info.host.scan_rsp_data, USER_ADVERTISE_SCAN_RESPONSE_DATA, USER_ADVERTISE_SCAN_RESPONSE_DATA_LEN);
+		sim.advCmd.info.host.scan_rsp_data_len = USER_ADVERTISE_SCAN_RESPONSE_DATA_LEN;
+		sim.advCmdActive = true;
+	}
+	return &sim.advCmd;
+}
+
+void app_easy_gap_undirected_advertise_start(void)
+{
+	sim.advCmdActive = false;
+	if(sim.advertising || sim.connected)
+	{
+		wand_sim_violation(WAND_SIM_ADV_START, sim.advertising ? "advertising" : "connected");
+		app_easy_timer_sim_post(wand_sim_adv_complete_msg, GAP_ERR_COMMAND_DISALLOWED);
+		return;
+	}
+	sim.advertising = true;
+}
+
+void app_easy_gap_advertise_stop(void)
+{
+	if(sim.advertising)
+	{
+		sim.advertising = false;
+		app_easy_timer_sim_post(wand_sim_adv_complete_msg, GAP_ERR_CANCELED);
+	}
+}
+
+void app_easy_gap_update_adv_data(const uint8_t *update_adv_data, uint8_t update_adv_data_len,
+                                  const uint8_t *update_scan_rsp_data, uint8_t update_scan_rsp_data_len)
+{
+	report.advUpdates++;
+}
+
+void app_easy_gap_param_update_start(uint8_t conidx)
+{
+}
@@ -0,0 +1,234 @@
+/**
+ ****************************************************************************************
+ *
+ * @file wand_sim.h
+ *
+ * @brief Simulator of the wand application in virtual time.
+ *
+ * The application sources, user_barebone.c and the modules it drives, are built
+ * unchanged against the SDK stand-ins of Firmware/host/sdk_stub. This module provides
+ * the SDK behind them: the kernel timers and messages (sdk_stub/app_easy_timer.c), the
+ * accelerometer on its bus (arm_bench/xl_bus.c), and a small model of the rest: GPIOs,
+ * sleep, the wake-up controller, advertising and one connection. The I2C pads are the
+ * lines of the bus.
+ *
+ * The host drives it with button presses, connections and motion, and runs it in
+ * 10ms ticks. Every tick the kernel messages are handled first, then the main loop
+ * callbacks run as the SDK main loop calls them when the stack is idle, until the
+ * application lets the system sleep. In sleep with external wake-up they only run after
+ * a kernel message or at the periodic wake-ups of the BLE core, and the ticks between
+ * those are skipped. After every tick the invariants below are checked; a violation is
+ * counted and, with wand_sim_set_verbose(), printed with its time.
+ *
+ * Built with CFG_HIBERNATION, the application hibernates after a long sleep; from then
+ * on nothing runs, as the simulator has no accelerometer interrupt to wake it.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _WAND_SIM_H_
+#define _WAND_SIM_H_
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "user_work.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/* Kernel messages a tick may take: the sample, lifecycle state, haptic and parameter      */
+/* update timers can all expire in the same tick, plus two stack messages the application  */
+/* caused. The messages of the central, connections and their updates, are not counted     */
+#define WAND_SIM_TICK_MAX_MESSAGES          (6)
+
+/* Main loop passes after a tick's kernel messages; more mean the deferred work never ends */
+#define WAND_SIM_MAX_MAIN_LOOP_PASSES       (WORK_QUEUE_LEN)
+
+/* Ticks after going to sleep for the messages in flight to drain                          */
+#define WAND_SIM_SETTLE_TICKS               (2)
+
+/* Periodic wake-up of the BLE core in sleep with external wake-up, in ticks:              */
+/* CFG_MAX_SLEEP_DURATION_EXTERNAL_WAKEUP_MS of da1458x_config_advanced.h                  */
+#define WAND_SIM_EXT_WAKEUP_TICKS           (600000 / 10)
+
+/* VBAT_HIGH at boot: the output of the 3.3V buck while the cell is charged                */
+#define WAND_SIM_BATTERY_MV                 (3300)
+
+/* Time the accelerometer driver may spend in a tick, on the bus and in its waits: half of */
+/* the 10ms tick, whatever the fault of the bus                                            */
+#define WAND_SIM_TICK_MAX_BUS_US            (5000)
+
+/* Invariant table. X(name, description)                                                   */
+/* No leaked timers:    TIMER_POOL, TIMER_STALE, TIMER_ORPHAN                              */
+/* Sleep only when idle: SLEEP_BUSY, TIMER_ASLEEP, ADV_ASLEEP, READ_ASLEEP                 */
+/* Bounded tick time:   TICK_READS, TICK_MESSAGES, TICK_BUS                                */
+/* Deferred work done:  WORK_SLEEP                                                         */
+/* Battery policy:      MOTOR_BATTERY                                                      */
+/* Motor PWM:           PWM_STALE                                                          */
+/* Hibernation:         HIBERNATE, with CFG_HIBERNATION                                    */
+#define WAND_SIM_INVARIANTS(X)                                                             \
+	X(TIMER_POOL,       "app_easy_timer() found no free timer")                            \
+	X(TIMER_STALE,      "cancel or modify of a timer that is not running")                 \
+	X(TIMER_ORPHAN,     "timer running that no handle of the application refers to")       \
+	X(SLEEP_BUSY,       "sleep entered with the motor on or a connection up")              \
+	X(TIMER_ASLEEP,     "timer still running after going to sleep")                        \
+	X(ADV_ASLEEP,       "advertising after going to sleep")                                \
+	X(READ_ASLEEP,      "sample read with the accelerometer in sleep mode")                \
+	X(ADV_START,        "advertising started while running or connected")                  \
+	X(TICK_READS,       "more than one sample read in a tick")                             \
+	X(TICK_MESSAGES,    "more than WAND_SIM_TICK_MAX_MESSAGES kernel messages in a tick")  \
+	X(TICK_BUS,         "accelerometer bus over WAND_SIM_TICK_MAX_BUS_US in a tick")       \
+	X(WORK_SLEEP,       "main loop allowed to sleep with samples queued")                  \
+	X(MOTOR_BATTERY,    "motor driven at a battery level that allows no motor")            \
+	X(PWM_STALE,        "Timer0 stopped or its clock gated while not started")             \
+	X(HIBERNATE,        "hibernation not in the wake-up after APP_HIBERNATE_TO asleep")    \
+	X(ASSERT,           "ASSERT_WARNING failed")
+
+#define WAND_SIM_INVARIANT_ENUM(name, description) WAND_SIM_##name,
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+enum wand_sim_invariant
+{
+	WAND_SIM_INVARIANTS(WAND_SIM_INVARIANT_ENUM)
+	WAND_SIM_NUM_INVARIANTS
+};
+
+/// Accelerometer sample for a tick, in the 8-bit cells of i2c_XL_Read_Sample()
+typedef void (*wand_sim_motion_t)(uint64_t tick, int8_t *sample);
+
+/// Totals since wand_sim_boot()
+struct wand_sim_report
+{
+	uint64_t ticks;
+	unsigned long violations[WAND_SIM_NUM_INVARIANTS];
+	/// Time of the first violation of each invariant
+	uint64_t firstTick[WAND_SIM_NUM_INVARIANTS];
+	unsigned long wakes;
+	unsigned long sleeps;
+	unsigned long connections;
+	unsigned long hibernations;
+	unsigned long sampleReads;
+	unsigned long advUpdates;
+	unsigned maxTimersInUse;
+	unsigned maxTickMessages;
+	/// Longest time of the accelerometer driver in a tick, in us
+	unsigned long maxTickBusUs;
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+ /**
+ ****************************************************************************************
+ * @brief Power up: reset the kernel, the accelerometer and the application variables,
+ *        run user_app_init() and start advertising as the SDK does after its database
+ *        initialisation
+ ****************************************************************************************
+ */
+void wand_sim_boot(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Print each violation to stderr as it is found
+ ****************************************************************************************
+ */
+void wand_sim_set_verbose(bool verbose);
+
+ /**
+ ****************************************************************************************
+ * @brief Motion the accelerometer reports from the next tick on, NULL for the wand at rest
+ ****************************************************************************************
+ */
+void wand_sim_set_motion(wand_sim_motion_t motion);
+
+ /**
+ ****************************************************************************************
+ * @brief VBAT_HIGH the battery driver measures from now on, in mV
+ ****************************************************************************************
+ */
+void wand_sim_set_battery(uint16_t mv);
+
+ /**
+ ****************************************************************************************
+ * @brief Fault of the accelerometer bus from now on, see xl_bus_set_fault()
+ ****************************************************************************************
+ */
+void wand_sim_set_xl_fault(uint8_t fault, uint8_t clocks);
+
+ /**
+ ****************************************************************************************
+ * @brief Run the kernel for a number of 10ms ticks
+ ****************************************************************************************
+ */
+void wand_sim_run(uint32_t ticks);
+
+ /**
+ ****************************************************************************************
+ * @brief Press or release the button; a press raises the wake-up interrupt
+ ****************************************************************************************
+ */
+void wand_sim_button(bool pressed);
+
+ /**
+ ****************************************************************************************
+ * @brief Raise the wake-up interrupt with the button released, as a bounce does
+ ****************************************************************************************
+ */
+void wand_sim_bounce(void);
+
+ /**
+ ****************************************************************************************
+ * @brief A central connects to the advertising wand
+ * @param[in] established false for a connection the stack could not set up
+ * @param[in] preferred   Connection parameters within user_connection_param_conf
+ * @return false when the wand is not advertising
+ ****************************************************************************************
+ */
+bool wand_sim_connect(bool established, bool preferred);
+
+ /**
+ ****************************************************************************************
+ * @brief The connection is lost
+ * @return false when there is no connection
+ ****************************************************************************************
+ */
+bool wand_sim_disconnect(void);
+
+ /**
+ ****************************************************************************************
+ * @brief The central changed the connection parameters
+ * @return false when there is no connection
+ ****************************************************************************************
+ */
+bool wand_sim_param_update(bool preferred);
+
+ /**
+ ****************************************************************************************
+ * @brief Totals since wand_sim_boot()
+ ****************************************************************************************
+ */
+const struct wand_sim_report *wand_sim_get_report(void);
+
+ /**
+ ****************************************************************************************
+ * @brief Name and description of an invariant
+ ****************************************************************************************
+ */
+const char *wand_sim_invariant_name(enum wand_sim_invariant invariant);
+
+const char *wand_sim_invariant_description(enum wand_sim_invariant invariant);
+
+#endif // _WAND_SIM_H_